@@ -36,6 +36,7 @@
 #include "brics_3d/algorithm/registration/RigidTransformationEstimationAPX.h"
 #include "brics_3d/algorithm/registration/RigidTransformationEstimationORTHO.h"
 #include "brics_3d/algorithm/registration/RigidTransformationEstimationQUAT.h"
+#include "brics_3d/algorithm/registration/RigidTransformationEstimationPointToPlane.h"
 #include "brics_3d/algorithm/registration/IterativeClosestPoint.h"
 #include "brics_3d/algorithm/registration/IIterativeClosestPointSetup.h"
 #include "brics_3d/util/Timer.h"
@@ -67,6 +68,7 @@ int main(int argc, char **argv) {
 	 * 1 QUAT
 	 * 2 HELIX
 	 * 3 APX
+	 * 4 PointToPlane
 	 * (ORTHO does not work)
 	 *
 	 */
@@ -158,7 +160,7 @@ int main(int argc, char **argv) {
 
 
 	for (int i = 0; i <= 3; ++i) { // loop over all combinations
-		for (int j = 0; j <= 3; ++j) {
+		for (int j = 0; j <= 4; ++j) {
 			pointCorrespondence = i;
 			rigidTransformationEstimation = j;
 
@@ -215,6 +217,10 @@ int main(int argc, char **argv) {
 				estimator = new RigidTransformationEstimationAPX();
 				cout << "INFO: Using RigidTransformationEstimationAPX." << endl;
 				break;
+			case 4:
+				estimator = new RigidTransformationEstimationPointToPlane();
+				cout << "INFO: Using RigidTransformationEstimationPointToPlane." << endl;
+				break;
 
 			default:
 				cout << "ERROR: No rigidTransformationEstimation algorithm given." << endl;
@@ -0,0 +1,163 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include "brics_3d/core/PointCloud3D.h"
+#include "brics_3d/core/NormalSet3D.h"
+#include "brics_3d/algorithm/nearestNeighbor/NearestNeighborANN.h"
+#include "brics_3d/algorithm/nearestNeighbor/NearestNeighborKDTree3D.h"
+#include "brics_3d/algorithm/featureExtraction/NormalEstimation.h"
+#include "brics_3d/algorithm/segmentation/EuclideanClustering.h"
+#include "brics_3d/util/Timer.h"
+#include "brics_3d/util/Benchmark.h"
+
+using namespace std;
+using namespace brics_3d;
+
+/*
+ * Shows the effect of PointCloud3D::sortByMortonOrder() on algorithms that run neighborhood queries for every
+ * point. The scene is a wavy surface that is split into 4x4 separated patches, sampled like a depth sensor.
+ * Two scenarios: the points in scan order (row by row) and in random order (e.g. merged or filtered clouds).
+ * Each scenario is processed as is and after sorting along the Morton curve.
+ */
+int main(int argc, char **argv) {
+
+	unsigned int numberOfPoints = 500000;
+	unsigned int k = 10;
+	if (argc == 3) {
+		numberOfPoints = atoi(argv[1]);
+		k = atoi(argv[2]);
+	} else if (argc != 1) {
+		cout << "Usage: " << argv[0] << " [<numberOfPoints> <k>]" << endl;
+		return -1;
+	}
+	cout << "Points: " << numberOfPoints << ", k: " << k << endl;
+
+	Timer timer0;
+	Benchmark mortonBenchmark("mortonOrder_benchmark");
+	mortonBenchmark.output << "#scenario order, timing sort, timing KDTree3D k nearest neighbors, timing ANN radius queries, "
+			<< "timing normal estimation, timing euclidean clustering, number of clusters" << endl;
+
+	/* scenarios */
+	PointCloud3D scan;
+	unsigned int width = static_cast<unsigned int>(sqrt(static_cast<double>(numberOfPoints)));
+	double spacing = 1.0 / width;
+	for (unsigned int row = 0; row < width; ++row) {
+		for (unsigned int column = 0; column < width; ++column) {
+			double x = column * spacing;
+			double y = row * spacing;
+			if ((column % (width / 4) < 2) || (row % (width / 4) < 2)) { // gaps between the patches
+				continue;
+			}
+			scan.addPoint(Point3D(x, y, 0.1 * sin(10.0 * x) * cos(10.0 * y)));
+		}
+	}
+	srand(42);
+	vector<int> shuffledIndices(scan.getSize());
+	for (unsigned int i = 0; i < shuffledIndices.size(); ++i) {
+		shuffledIndices[i] = i;
+	}
+	random_shuffle(shuffledIndices.begin(), shuffledIndices.end());
+	PointCloud3D shuffled;
+	shuffled.addPoints(&scan, shuffledIndices);
+
+	PointCloud3D* scenarios[] = {&scan, &shuffled};
+	const char* scenarioNames[] = {"scan", "shuffled"};
+	double radius = 1.5 * spacing;
+
+	for (int s = 0; s < 2; ++s) {
+		for (int sorted = 0; sorted <= 1; ++sorted) {
+			PointCloud3D data(*scenarios[s]);
+			string name = sorted ? "morton" : "original";
+			cout << "INFO: " << scenarioNames[s] << " in " << name << " order" << endl;
+			mortonBenchmark.output << scenarioNames[s] << " " << name << " ";
+
+			timer0.reset();
+			if (sorted) {
+				vector<unsigned int> order;
+				data.sortByMortonOrder(&order);
+			}
+			long double sortTime = timer0.getElapsedTime();
+			mortonBenchmark.output << sortTime << " ";
+
+			/* k nearest neighbors of all points */
+			NearestNeighborKDTree3D kdTree;
+			kdTree.setData(&data);
+			vector<int> resultIndices;
+			timer0.reset();
+			kdTree.findNearestNeighbors(&data, &resultIndices, k);
+			long double nearestTime = timer0.getElapsedTime();
+			mortonBenchmark.output << nearestTime << " ";
+
+			/* one radius query per point */
+			NearestNeighborANN ann;
+			ann.setData(&data);
+			const PointCloud3DStorage* storage = data.getStorage();
+			Point3D query;
+			timer0.reset();
+			for (unsigned int i = 0; i < data.getSize(); ++i) {
+				query.setX(storage->getRawX()[i]);
+				query.setY(storage->getRawY()[i]);
+				query.setZ(storage->getRawZ()[i]);
+				ann.findNeighborsWithinRadius(&query, &resultIndices, radius);
+			}
+			long double radiusTime = timer0.getElapsedTime();
+			mortonBenchmark.output << radiusTime << " ";
+
+			/* normal estimation */
+			NormalSet3D normals;
+			NormalEstimation normalEstimator;
+			NearestNeighborKDTree3D normalSearch;
+			normalEstimator.setInputCloud(&data);
+			normalEstimator.setSearchMethod(&normalSearch);
+			normalEstimator.setkneighbours(k);
+			timer0.reset();
+			normalEstimator.computeFeature(&normals);
+			long double normalTime = timer0.getElapsedTime();
+			mortonBenchmark.output << normalTime << " ";
+
+			/* clustering */
+			EuclideanClustering clustering;
+			clustering.setClusterTolerance(radius);
+			clustering.setMinClusterSize(1);
+			clustering.setMaxClusterSize(data.getSize());
+			clustering.setPointCloud(&data);
+			timer0.reset();
+			clustering.segment();
+			long double clusteringTime = timer0.getElapsedTime();
+			vector<PointCloud3D*> clusters;
+			clustering.getExtractedClusters(clusters);
+			mortonBenchmark.output << clusteringTime << " " << clusters.size() << endl;
+			for (unsigned int i = 0; i < clusters.size(); ++i) {
+				delete clusters[i];
+			}
+
+			cout << "    sort: " << sortTime << "ms, k-NN: " << nearestTime << "ms, radius: " << radiusTime
+					<< "ms, normals: " << normalTime << "ms, clustering: " << clusteringTime << "ms (" << clusters.size()
+					<< " clusters)" << endl;
+		}
+	}
+
+	return 0;
+}
+
+/* EOF */
@@ -0,0 +1,147 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#include <iostream>
+#include <cstdlib>
+#include "brics_3d/core/PointCloud3D.h"
+#include "brics_3d/algorithm/nearestNeighbor/NearestNeighborANN.h"
+#include "brics_3d/algorithm/nearestNeighbor/NearestNeighborFLANN.h"
+#include "brics_3d/algorithm/nearestNeighbor/NearestNeighborSTANN.h"
+#include "brics_3d/algorithm/nearestNeighbor/NearestNeighborKDTree3D.h"
+#include "brics_3d/algorithm/nearestNeighbor/NearestNeighborVoxelGrid.h"
+#include "brics_3d/util/Timer.h"
+#include "brics_3d/util/Benchmark.h"
+
+using namespace std;
+using namespace brics_3d;
+
+/*
+ * Compares the fixed radius and k nearest neighbor queries of the voxel grid with the tree based
+ * search structures. Two scenarios as in the NearestNeighborTest: a uniform cube and a dense surface
+ * as seen by a depth sensor (a noisy plane). Every point of the cloud is used as a query.
+ */
+int main(int argc, char **argv) {
+
+	unsigned int numberOfPoints = 100000;
+	double radius = 0.01;
+	unsigned int k = 10;
+	if (argc == 4) {
+		numberOfPoints = atoi(argv[1]);
+		radius = atof(argv[2]);
+		k = atoi(argv[3]);
+	} else if (argc != 1) {
+		cout << "Usage: " << argv[0] << " [<numberOfPoints> <radius> <k>]" << endl;
+		return -1;
+	}
+	cout << "Points: " << numberOfPoints << ", radius: " << radius << ", k: " << k << endl;
+
+	Timer timer0;
+	long double tmpTimeStamp = 0.0;
+	Benchmark nnBenchmark("nearestNeighborRadius_benchmark");
+	nnBenchmark.output << "#scenario algorithm, timing setData, timing radius queries, timing k nearest neighbor queries, average neighbors within radius" << endl;
+
+	/* scenarios */
+	PointCloud3D cube;
+	PointCloud3D surface;
+	srand(42);
+	for (unsigned int i = 0; i < numberOfPoints; ++i) {
+		cube.addPoint(Point3D(rand() / (RAND_MAX + 1.0), rand() / (RAND_MAX + 1.0), rand() / (RAND_MAX + 1.0)));
+	}
+	unsigned int width = static_cast<unsigned int>(sqrt(static_cast<double>(numberOfPoints)));
+	for (unsigned int i = 0; i < numberOfPoints; ++i) {
+		double noise = 0.001 * (rand() / (RAND_MAX + 1.0) - 0.5);
+		surface.addPoint(Point3D(static_cast<double>(i % width) / width, static_cast<double>(i / width) / width, 1.0 + noise));
+	}
+	PointCloud3D* scenarios[] = {&cube, &surface};
+	const char* scenarioNames[] = {"cube", "surface"};
+
+	for (int s = 0; s < 2; ++s) {
+		PointCloud3D* data = scenarios[s];
+
+		/*
+		 * nearest neighbor search
+		 * 0 ANN
+		 * 1 FLANN
+		 * 2 STANN
+		 * 3 KDTree3D
+		 * 4 VoxelGrid (voxel size = radius)
+		 */
+		for (int i = 0; i <= 4; ++i) {
+			INearestPoint3DNeighbor* nearestNeighbor = 0;
+			string name;
+			switch (i) {
+			case 0:
+				nearestNeighbor = new NearestNeighborANN();
+				name = "ANN";
+				break;
+			case 1:
+				nearestNeighbor = new NearestNeighborFLANN();
+				name = "FLANN";
+				break;
+			case 2:
+				nearestNeighbor = new NearestNeighborSTANN();
+				name = "STANN";
+				break;
+			case 3:
+				nearestNeighbor = new NearestNeighborKDTree3D();
+				name = "KDTree3D";
+				break;
+			case 4:
+				nearestNeighbor = new NearestNeighborVoxelGrid(radius);
+				name = "VoxelGrid";
+				break;
+			default:
+				break;
+			}
+			cout << "INFO: " << scenarioNames[s] << " with " << name << endl;
+			nnBenchmark.output << scenarioNames[s] << " " << name << " ";
+
+			timer0.reset();
+			nearestNeighbor->setData(data);
+			tmpTimeStamp = timer0.getElapsedTime();
+			nnBenchmark.output << tmpTimeStamp << " ";
+
+			vector<int> resultIndices;
+			long unsigned int totalNeighbors = 0;
+			timer0.reset();
+			for (unsigned int j = 0; j < data->getSize(); ++j) {
+				nearestNeighbor->findNeighborsWithinRadius(&(*data->getPointCloud())[j], &resultIndices, radius);
+				totalNeighbors += resultIndices.size();
+			}
+			long double radiusTime = timer0.getElapsedTime();
+			nnBenchmark.output << radiusTime << " ";
+
+			timer0.reset();
+			nearestNeighbor->findNearestNeighbors(data, &resultIndices, k);
+			long double nearestTime = timer0.getElapsedTime();
+			nnBenchmark.output << nearestTime << " ";
+
+			double averageNeighbors = static_cast<double>(totalNeighbors) / data->getSize();
+			nnBenchmark.output << averageNeighbors << endl;
+			cout << "    setData: " << tmpTimeStamp << "ms, radius: " << radiusTime << "ms, k-NN: " << nearestTime
+					<< "ms, neighbors within radius: " << averageNeighbors << endl;
+
+			delete nearestNeighbor;
+		}
+	}
+
+	return 0;
+}
+
+/* EOF */
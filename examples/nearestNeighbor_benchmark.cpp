@@ -0,0 +1,239 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#ifndef WIN32
+#include <time.h>
+#include <unistd.h>
+#endif
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#include "brics_3d/core/PointCloud3D.h"
+#include "brics_3d/algorithm/nearestNeighbor/NearestNeighborFactory.h"
+#include "brics_3d/util/Timer.h"
+#include "brics_3d/util/Benchmark.h"
+
+using namespace std;
+using namespace brics_3d;
+
+/// Current time in [ms] with sub-microsecond resolution where available, to measure single queries.
+double getPreciseTime() {
+#ifndef WIN32
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1.0e3 + now.tv_nsec * 1.0e-6;
+#else
+	static Timer timer;
+	return static_cast<double>(timer.getCurrentTime());
+#endif
+}
+
+/// Resident memory of the process in [MB], 0 if unknown.
+double getResidentMemory() {
+#ifdef __GLIBC__
+	malloc_trim(0); // return freed memory, so the difference reflects the allocations in between
+#endif
+#ifdef __linux__
+	long pages = 0;
+	long residentPages = 0;
+	ifstream statm("/proc/self/statm");
+	if (statm >> pages >> residentPages) {
+		return residentPages * (sysconf(_SC_PAGESIZE) / (1024.0 * 1024.0));
+	}
+#endif
+	return 0.0;
+}
+
+/// Value at the given fraction of the sorted samples
+double getPercentile(const vector<double>& sortedSamples, double fraction) {
+	if (sortedSamples.empty()) {
+		return 0.0;
+	}
+	unsigned int index = static_cast<unsigned int>(fraction * (sortedSamples.size() - 1) + 0.5);
+	return sortedSamples[index];
+}
+
+inline double squaredDistance(const PointCloud3DStorage* queries, unsigned int i, const PointCloud3DStorage* data, int j) {
+	double dx = queries->getRawX()[i] - data->getRawX()[j];
+	double dy = queries->getRawY()[i] - data->getRawY()[j];
+	double dz = queries->getRawZ()[i] - data->getRawZ()[j];
+	return dx * dx + dy * dy + dz * dz;
+}
+
+/*
+ * Systematic comparison of the nearest neighbor backends on uniformly distributed points for increasing cloud
+ * sizes (10k, 100k, 1M, 10M up to the given maximum). For each backend it measures:
+ * - build time and memory footprint (resident memory before and after setData)
+ * - for k nearest neighbor queries (k = 1, 10, 50) and a radius query (~10 neighbors on average):
+ *   latency percentiles of single queries, throughput of a batch query (k-NN only) and the recall with respect to
+ *   a brute force search over (up to 1000 of) the queries, i.e. the fraction of the exact neighbors that is found.
+ *
+ * Every measurement is one line of the benchmark file, to track regressions with scripts.
+ */
+int main(int argc, char **argv) {
+
+	unsigned int maxNumberOfPoints = 1000000;
+	unsigned int numberOfQueries = 10000;
+	if (argc == 3) {
+		maxNumberOfPoints = atoi(argv[1]);
+		numberOfQueries = atoi(argv[2]);
+	} else if (argc != 1) {
+		cout << "Usage: " << argv[0] << " [<maxNumberOfPoints> <numberOfQueries>]" << endl;
+		return -1;
+	}
+	cout << "Maximum number of points: " << maxNumberOfPoints << ", queries: " << numberOfQueries << endl;
+
+	Benchmark nnBenchmark("nearestNeighbor_benchmark");
+	nnBenchmark.output << "#points backend query k-or-radius, timing setData [ms], memory [MB], latency p50 p90 p99 max [us], "
+			<< "batch throughput [queries/s], recall" << endl;
+
+	const char* implementations[] = {"NearestNeighborANN", "NearestNeighborFLANN", "NearestNeighborSTANN",
+			"NearestNeighborKDTree3D", "NearestNeighborVoxelGrid"};
+	const unsigned int numberOfImplementations = sizeof(implementations) / sizeof(implementations[0]);
+	const unsigned int kValues[] = {1, 10, 50};
+	const unsigned int numberOfKValues = sizeof(kValues) / sizeof(kValues[0]);
+	const double expectedNeighborsWithinRadius = 10.0;
+	const unsigned int maxReferenceQueries = 1000;
+	NearestNeighborFactory factory;
+	Timer timer;
+
+	for (unsigned int numberOfPoints = 10000; numberOfPoints <= maxNumberOfPoints; numberOfPoints *= 10) {
+		PointCloud3D data;
+		PointCloud3D queries;
+		srand(42);
+		data.reserve(numberOfPoints);
+		for (unsigned int i = 0; i < numberOfPoints; ++i) {
+			data.addPoint(Point3D(rand() / (RAND_MAX + 1.0), rand() / (RAND_MAX + 1.0), rand() / (RAND_MAX + 1.0)));
+		}
+		for (unsigned int i = 0; i < numberOfQueries; ++i) {
+			queries.addPoint(Point3D(rand() / (RAND_MAX + 1.0), rand() / (RAND_MAX + 1.0), rand() / (RAND_MAX + 1.0)));
+		}
+		const PointCloud3DStorage* dataPoints = data.getStorage();
+		const PointCloud3DStorage* queryPoints = queries.getStorage();
+		double radius = pow(3.0 * expectedNeighborsWithinRadius / (4.0 * M_PI * numberOfPoints), 1.0 / 3.0);
+
+		/*
+		 * exact reference by a brute force scan in double precision, so it does not depend on any of the backends:
+		 * squared distance of the k-th neighbor for each k and neighbor count within the radius. It is determined
+		 * for every referenceStride-th query only, to keep the scan affordable for large clouds.
+		 */
+		const unsigned int referenceStride = max(1u, (numberOfQueries + maxReferenceQueries - 1) / maxReferenceQueries);
+		const unsigned int numberOfReferenceQueries = (numberOfQueries + referenceStride - 1) / referenceStride;
+		const unsigned int maxK = min(kValues[numberOfKValues - 1], numberOfPoints);
+		vector<vector<double> > maxSquaredDistances(numberOfKValues, vector<double>(numberOfReferenceQueries, 0.0));
+		vector<double> squaredDistances(numberOfPoints);
+		unsigned long long exactNeighborsWithinRadius = 0;
+		for (unsigned int r = 0; r < numberOfReferenceQueries; ++r) {
+			unsigned int i = r * referenceStride;
+			for (unsigned int j = 0; j < numberOfPoints; ++j) {
+				squaredDistances[j] = squaredDistance(queryPoints, i, dataPoints, j);
+				if (squaredDistances[j] <= radius * radius) {
+					++exactNeighborsWithinRadius;
+				}
+			}
+			nth_element(squaredDistances.begin(), squaredDistances.begin() + (maxK - 1), squaredDistances.end());
+			sort(squaredDistances.begin(), squaredDistances.begin() + maxK);
+			for (unsigned int kIndex = 0; kIndex < numberOfKValues; ++kIndex) {
+				maxSquaredDistances[kIndex][r] = squaredDistances[min(kValues[kIndex], maxK) - 1];
+			}
+		}
+		vector<int> resultIndices;
+		Point3D query;
+
+		for (unsigned int b = 0; b < numberOfImplementations; ++b) {
+			NearestNeighborConfiguration configuration;
+			configuration.implementation = implementations[b];
+			configuration.voxelSize = radius;
+			cout << "INFO: " << numberOfPoints << " points with " << configuration.toString() << endl;
+
+			double memoryBefore = getResidentMemory();
+			INearestPoint3DNeighborPtr nearestNeighbor = factory.createNearestNeighbor(configuration);
+			timer.reset();
+			nearestNeighbor->setData(&data);
+			double buildTime = static_cast<double>(timer.getElapsedTime());
+			double memory = getResidentMemory() - memoryBefore;
+			cout << "    setData: " << buildTime << "ms, memory: " << memory << "MB" << endl;
+
+			/* k nearest neighbors */
+			for (unsigned int kIndex = 0; kIndex < numberOfKValues; ++kIndex) {
+				unsigned int k = kValues[kIndex];
+				vector<double> latencies(numberOfQueries);
+				unsigned long long foundNeighbors = 0;
+				for (unsigned int i = 0; i < numberOfQueries; ++i) {
+					query = Point3D(queryPoints->getRawX()[i], queryPoints->getRawY()[i], queryPoints->getRawZ()[i]);
+					double start = getPreciseTime();
+					nearestNeighbor->findNearestNeighbors(&query, &resultIndices, k);
+					latencies[i] = (getPreciseTime() - start) * 1.0e3;
+					if (i % referenceStride != 0) {
+						continue;
+					}
+					for (unsigned int j = 0; j < resultIndices.size(); ++j) {
+						if (squaredDistance(queryPoints, i, dataPoints, resultIndices[j]) <= maxSquaredDistances[kIndex][i / referenceStride]) {
+							++foundNeighbors;
+						}
+					}
+				}
+				sort(latencies.begin(), latencies.end());
+				double recall = static_cast<double>(foundNeighbors) / (static_cast<double>(numberOfReferenceQueries) * min(k, numberOfPoints));
+
+				timer.reset();
+				nearestNeighbor->findNearestNeighbors(&queries, &resultIndices, k);
+				double batchTime = static_cast<double>(timer.getElapsedTime());
+				double throughput = (batchTime > 0.0) ? numberOfQueries / (batchTime * 1.0e-3) : 0.0;
+
+				nnBenchmark.output << numberOfPoints << " " << implementations[b] << " knn " << k << " " << buildTime << " " << memory
+						<< " " << getPercentile(latencies, 0.5) << " " << getPercentile(latencies, 0.9) << " " << getPercentile(latencies, 0.99)
+						<< " " << latencies.back() << " " << throughput << " " << recall << endl;
+				cout << "    k = " << k << ": latency p50/p90/p99 " << getPercentile(latencies, 0.5) << "/" << getPercentile(latencies, 0.9)
+						<< "/" << getPercentile(latencies, 0.99) << "us, batch: " << throughput << " queries/s, recall: " << recall << endl;
+			}
+
+			/* fixed radius */
+			vector<double> latencies(numberOfQueries);
+			unsigned long long foundNeighbors = 0;
+			for (unsigned int i = 0; i < numberOfQueries; ++i) {
+				query = Point3D(queryPoints->getRawX()[i], queryPoints->getRawY()[i], queryPoints->getRawZ()[i]);
+				double start = getPreciseTime();
+				nearestNeighbor->findNeighborsWithinRadius(&query, &resultIndices, radius);
+				latencies[i] = (getPreciseTime() - start) * 1.0e3;
+				for (unsigned int j = 0; (i % referenceStride == 0) && (j < resultIndices.size()); ++j) {
+					if (squaredDistance(queryPoints, i, dataPoints, resultIndices[j]) <= radius * radius) {
+						++foundNeighbors;
+					}
+				}
+			}
+			sort(latencies.begin(), latencies.end());
+			double recall = (exactNeighborsWithinRadius == 0) ? 1.0 : static_cast<double>(foundNeighbors) / exactNeighborsWithinRadius;
+			nnBenchmark.output << numberOfPoints << " " << implementations[b] << " radius " << radius << " " << buildTime << " " << memory
+					<< " " << getPercentile(latencies, 0.5) << " " << getPercentile(latencies, 0.9) << " " << getPercentile(latencies, 0.99)
+					<< " " << latencies.back() << " " << 0 << " " << recall << endl;
+			cout << "    radius = " << radius << ": latency p50/p90/p99 " << getPercentile(latencies, 0.5) << "/"
+					<< getPercentile(latencies, 0.9) << "/" << getPercentile(latencies, 0.99) << "us, recall: " << recall << endl;
+		}
+	}
+
+	return 0;
+}
+
+/* EOF */
@@ -0,0 +1,134 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstdio>
+#include <algorithm>
+#include <iterator>
+#include <boost/thread.hpp>
+
+#include "brics_3d/core/PointCloud3D.h"
+#include "brics_3d/core/AsciiPointParser.h"
+#include "brics_3d/util/Timer.h"
+#include "brics_3d/util/Benchmark.h"
+
+using namespace std;
+using namespace brics_3d;
+
+/*
+ * Compares the throughput of the line by line stringstream based parsing (as formerly used by
+ * PointCloud3D::readFromTxtFile) with the chunked AsciiPointParser for a varying number of threads.
+ */
+int main(int argc, char **argv) {
+
+	string filename = "pointCloudLoading_benchmark_data.txt";
+	int numberOfPoints = 2000000;
+	bool generateData = true;
+
+	if (argc == 2) {
+		filename = argv[1];
+		generateData = false;
+	} else if (argc > 2) {
+		cout << "Usage: " << argv[0] << " [<filename>]" << endl;
+		return -1;
+	}
+
+	if (generateData) {
+		cout << "Generating " << numberOfPoints << " random points in " << filename << endl;
+		unsigned int seed = 0; // make sure, seed is always the same.
+		std::srand(seed);
+		ofstream outputFile(filename.c_str());
+		outputFile.precision(7);
+		for (int i = 0; i < numberOfPoints; ++i) {
+			outputFile << (std::rand() / static_cast<double>(RAND_MAX) - 0.5) * 100.0 << " "
+					<< (std::rand() / static_cast<double>(RAND_MAX) - 0.5) * 100.0 << " "
+					<< (std::rand() / static_cast<double>(RAND_MAX) - 0.5) * 100.0 << endl;
+		}
+		outputFile.close();
+	}
+
+	/* load the raw text once, so the disk is not part of the parser measurements */
+	ifstream inputFile(filename.c_str(), ios::in | ios::binary);
+	if (!inputFile.is_open()) {
+		cout << "Cannot open " << filename << endl;
+		return -1;
+	}
+	string text((istreambuf_iterator<char>(inputFile)), istreambuf_iterator<char>());
+	inputFile.close();
+	double megaBytes = text.size() / (1024.0 * 1024.0);
+
+	Timer timer;
+	long double elapsedTime;
+	Benchmark benchmark("pointCloudLoading_benchmark");
+	benchmark.output << "# file: " << filename << " (" << megaBytes << " MB)" << endl;
+	benchmark.output << "# method\t threads\t points\t time[ms]\t throughput[MB/s]" << endl;
+
+	/* reference: line by line with stringstream and Point3D::operator>> */
+	{
+		PointCloud3D pointCloud;
+		stringstream textStream(text);
+		string line;
+		timer.reset();
+		while (getline(textStream, line)) {
+			Point3D tmpPoint;
+			stringstream lineStream(line);
+			lineStream >> tmpPoint;
+			pointCloud.addPoint(tmpPoint);
+		}
+		elapsedTime = timer.getElapsedTime();
+		benchmark.output << "stringstream\t 1\t " << pointCloud.getSize() << "\t " << elapsedTime << "\t " << megaBytes / (elapsedTime / 1000.0) << endl;
+		cout << "stringstream: " << pointCloud.getSize() << " points in " << elapsedTime << " ms" << endl;
+	}
+
+	/* chunked parser */
+	unsigned int maxThreads = std::max(1u, boost::thread::hardware_concurrency());
+	for (unsigned int threads = 1; threads <= maxThreads; threads *= 2) {
+		PointCloud3DStorage storage;
+		AsciiPointParser parser;
+		parser.setNumberOfThreads(threads);
+		timer.reset();
+		parser.parse(text.data(), text.size(), &storage);
+		elapsedTime = timer.getElapsedTime();
+		benchmark.output << "AsciiPointParser\t " << threads << "\t " << storage.getSize() << "\t " << elapsedTime << "\t " << megaBytes / (elapsedTime / 1000.0) << endl;
+		cout << "AsciiPointParser (" << threads << " threads): " << storage.getSize() << " points in " << elapsedTime << " ms" << endl;
+	}
+
+	/* complete file loading */
+	{
+		PointCloud3D pointCloud;
+		timer.reset();
+		pointCloud.readFromTxtFile(filename);
+		elapsedTime = timer.getElapsedTime();
+		benchmark.output << "readFromTxtFile\t " << maxThreads << "\t " << pointCloud.getSize() << "\t " << elapsedTime << "\t " << megaBytes / (elapsedTime / 1000.0) << endl;
+		cout << "readFromTxtFile: " << pointCloud.getSize() << " points in " << elapsedTime << " ms" << endl;
+	}
+
+	if (generateData) {
+		std::remove(filename.c_str());
+	}
+	cout << "Done." << endl;
+	return 0;
+}
+
+/* EOF */
@@ -407,13 +407,21 @@ void icp6D_QUAT::maxEigenVector(double Q[4][4], double ev[4])
   double c[4];
   // find the coeffs for the characteristic eqn.
   characteristicPol(Q, c);
-  // find roots
-  ferrari(c[0], c[1], c[2], c[3], rts);
+  // find roots (only the first nroots entries of rts are set)
+  int nroots = ferrari(c[0], c[1], c[2], c[3], rts);
+  if (nroots < 1) {
+    cerr << "maxEigenVector():" << endl;
+    cerr << "no real root found!" << endl;
+    cerr << "return identity quaternion" << endl;
+    ev[0] = 1.0;
+    ev[1] = ev[2] = ev[3] = 0.0;
+    return;
+  }
   // find maximum root = maximum eigenvalue
   double l = rts[0];
-  if (rts[1] > l) l = rts[1];
-  if (rts[2] > l) l = rts[2];
-  if (rts[3] > l) l = rts[3];
+  for (int i = 1; i < nroots; i++) {
+    if (rts[i] > l) l = rts[i];
+  }
 
   // create the Q - l*I matrix
   N[0][0]=Q[0][0]-l;N[0][1]=Q[0][1] ;N[0][2]=Q[0][2]; N[0][3]=Q[0][3];
@@ -299,7 +299,7 @@ EXPORTED int flann_radius_search(FLANN_INDEX index_ptr,
 
         int count_nn = resultSet.size();
 
-        for (int i=0;i<count_nn;++i) {
+        for (int i=0;i<count_nn && i<max_nn;++i) {
         	indices[i] = neighbors[i];
         	dists[i] = distances[i];
         }
@@ -49,6 +49,9 @@ void DepthImageToPointCloudTransformation::transformDepthImageToPointCloud(IplIm
 		return;
 	}
 
+	/* at most one point per pixel */
+	pointCloud->reserve(pointCloud->getSize() + depthImage->width * depthImage->height);
+
 	/* loop over all pixels and add those who are above a certain threshold */
 	for (int row = 0; row < depthImage->height; ++row) {
 		for (int col = 0; col < depthImage->width; ++col) {
@@ -21,6 +21,7 @@
 #include "Centroid3D.h"
 #include "brics_3d/core/Logger.h"
 #include "brics_3d/core/HomogeneousMatrix44.h"
+#include "brics_3d/core/BatchTransformation.h"
 #include <limits>
 
 namespace brics_3d {
@@ -176,31 +177,38 @@ void BoundingBox3DExtractor::computeOrientedBoundingBox(IPoint3DIterator::IPoint
 	*inverseRotation = *(resultTransform);
 	inverseRotation->inverse();
 
-	for (inputPointCloud->begin(); !inputPointCloud->end(); inputPointCloud->next()) {
-		Point3D tmpPoint(inputPointCloud->getX(), inputPointCloud->getY(), inputPointCloud->getZ());
-		tmpPoint.homogeneousTransformation(inverseRotation); // move _all_ points to new frame
-		Point3D* currentPoint = &tmpPoint;
-
-		/* adjust lower bound if necessary */
-		if (currentPoint->getX() <= lowerBound.getX()) {
-			lowerBound.setX(currentPoint->getX());
-		}
-		if (currentPoint->getY() <= lowerBound.getY()) {
-			lowerBound.setY(currentPoint->getY());
-		}
-		if (currentPoint->getZ() <= lowerBound.getZ()) {
-			lowerBound.setZ(currentPoint->getZ());
-		}
-
-		/* adjust upper bound if necessary */
-		if ( currentPoint->getX() >= upperBound.getX()) {
-			upperBound.setX(currentPoint->getX());
-		}
-		if	(currentPoint->getY() >= upperBound.getY()) {
-			upperBound.setY(currentPoint->getY());
-		}
-		if	(currentPoint->getZ() >= upperBound.getZ()) {
-			upperBound.setZ(currentPoint->getZ());
+	Coordinate x[IPoint3DIterator::defaultBlockSize];
+	Coordinate y[IPoint3DIterator::defaultBlockSize];
+	Coordinate z[IPoint3DIterator::defaultBlockSize];
+	unsigned int blockSize;
+	BatchTransformation batchTransformation;
+	inputPointCloud->begin();
+	while ((blockSize = inputPointCloud->getNextBlock(x, y, z, IPoint3DIterator::defaultBlockSize)) > 0) {
+		batchTransformation.transform(inverseRotation, x, y, z, x, y, z, blockSize); // move _all_ points to new frame
+
+		for (unsigned int i = 0; i < blockSize; ++i) {
+
+			/* adjust lower bound if necessary */
+			if (x[i] <= lowerBound.getX()) {
+				lowerBound.setX(x[i]);
+			}
+			if (y[i] <= lowerBound.getY()) {
+				lowerBound.setY(y[i]);
+			}
+			if (z[i] <= lowerBound.getZ()) {
+				lowerBound.setZ(z[i]);
+			}
+
+			/* adjust upper bound if necessary */
+			if (x[i] >= upperBound.getX()) {
+				upperBound.setX(x[i]);
+			}
+			if (y[i] >= upperBound.getY()) {
+				upperBound.setY(y[i]);
+			}
+			if (z[i] >= upperBound.getZ()) {
+				upperBound.setZ(z[i]);
+			}
 		}
 	}
 	delete inverseRotation;
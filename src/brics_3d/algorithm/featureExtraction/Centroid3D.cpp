@@ -80,17 +80,24 @@ Eigen::Vector3d Centroid3D::computeCentroid(IPoint3DIterator::IPoint3DIteratorPt
 	centroid[1] = 0;
 	centroid[2] = 0;
 
-	for (inCloud->begin(); !inCloud->end(); inCloud->next()) {
-		tempX = inCloud->getX();
-		tempY = inCloud->getY();
-		tempZ = inCloud->getZ();
-
-		if(!std::isnan(tempX) && !std::isinf(tempX) && !std::isnan(tempY) && !std::isinf(tempY) &&
-				!std::isnan(tempZ) && !std::isinf(tempZ) ) {
-			centroid[0] = centroid[0] + tempX;
-			centroid[1] = centroid[1] + tempY;
-			centroid[2] = centroid[2] + tempZ;
-			count++;
+	Coordinate x[IPoint3DIterator::defaultBlockSize];
+	Coordinate y[IPoint3DIterator::defaultBlockSize];
+	Coordinate z[IPoint3DIterator::defaultBlockSize];
+	unsigned int blockSize;
+	inCloud->begin();
+	while ((blockSize = inCloud->getNextBlock(x, y, z, IPoint3DIterator::defaultBlockSize)) > 0) {
+		for (unsigned int i = 0; i < blockSize; ++i) {
+			tempX = x[i];
+			tempY = y[i];
+			tempZ = z[i];
+
+			if(!std::isnan(tempX) && !std::isinf(tempX) && !std::isnan(tempY) && !std::isinf(tempY) &&
+					!std::isnan(tempZ) && !std::isinf(tempZ) ) {
+				centroid[0] = centroid[0] + tempX;
+				centroid[1] = centroid[1] + tempY;
+				centroid[2] = centroid[2] + tempZ;
+				count++;
+			}
 		}
 	}
 
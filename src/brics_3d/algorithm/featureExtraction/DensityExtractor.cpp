@@ -55,8 +55,13 @@ Density DensityExtractor::computeDensity(IPoint3DIterator::IPoint3DIteratorPtr i
 		result.density = 0.0;
 
 		/* Number of points */
-		for (inputPointCloud->begin(); !inputPointCloud->end(); inputPointCloud->next()) {
-			result.numberOfPoints++;
+		Coordinate x[IPoint3DIterator::defaultBlockSize];
+		Coordinate y[IPoint3DIterator::defaultBlockSize];
+		Coordinate z[IPoint3DIterator::defaultBlockSize];
+		unsigned int blockSize;
+		inputPointCloud->begin();
+		while ((blockSize = inputPointCloud->getNextBlock(x, y, z, IPoint3DIterator::defaultBlockSize)) > 0) {
+			result.numberOfPoints += static_cast<int>(blockSize);
 		}
 
 		/* Volume */
@@ -22,6 +22,7 @@
 #define BRICS_3D_NORMALESTIMATION_H_
 
 #include <Eigen/Dense>
+#include <algorithm>
 
 #include "brics_3d/core/HomogeneousMatrix44.h" // for eigen declarations
 #include "brics_3d/core/PointCloud3D.h"
@@ -398,10 +399,28 @@ public:
 //		std::vector<Point3D>* points;
 //		points = inputPointCloud->getPointCloud();
 
+		// The neighbors are queried in batches. Each block needs blockSize * k_neighbours indices.
+		const unsigned int blockSize = 65536;
+		std::vector<int> blockIndices;
+		unsigned int blockBegin = 0;
+		unsigned int blockEnd = 0;
+
 		for (size_t idx = 0; idx < this->inputPointCloud->getSize(); ++idx)
 		{
 
-			nnSearchMethod->findNearestNeighbors(&(*inputPointCloud->getPointCloud())[idx], &nn_indices, k_neighbours);
+			if (idx >= blockEnd) {
+				blockBegin = static_cast<unsigned int>(idx);
+				blockEnd = std::min(blockBegin + blockSize, this->inputPointCloud->getSize());
+				nnSearchMethod->findNearestNeighbors(this->inputPointCloud, blockBegin, blockEnd, &blockIndices, k_neighbours);
+			}
+
+			nn_indices.clear();
+			for (int j = 0; j < k_neighbours; ++j) {
+				int neighborIndex = blockIndices[(idx - blockBegin) * k_neighbours + j];
+				if (neighborIndex >= 0) { // -1 marks neighbors that exceed the maximum distance
+					nn_indices.push_back(neighborIndex);
+				}
+			}
 
 			if (nn_indices.size()==0)
 			{
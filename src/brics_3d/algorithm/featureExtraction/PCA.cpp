@@ -94,23 +94,30 @@ void PCA::computePrincipleComponents(IPoint3DIterator::IPoint3DIteratorPtr input
 	/*** compute covariance matrix  ***/
 	covariance.setZero ();
 	int pointCount  = 0;
-	for (inputPointCloud->begin(); !inputPointCloud->end(); inputPointCloud->next()) {
-		Eigen::Vector4d pt;
-		pt[0] = inputPointCloud->getX() - centroid[0];
-		pt[1] = inputPointCloud->getY() - centroid[1];
-		pt[2] = inputPointCloud->getZ() - centroid[2];
-		pt[3] = 1.0; //homogeneous point
-
-		covariance (1, 1) += pt.y () * pt.y (); //the non X parts
-		covariance (1, 2) += pt.y () * pt.z ();
-		covariance (2, 2) += pt.z () * pt.z ();
-
-		pt *= pt.x ();
-		covariance (0, 0) += pt.x (); //the X related parts
-		covariance (0, 1) += pt.y ();
-		covariance (0, 2) += pt.z ();
-
-		pointCount++;
+	Coordinate x[IPoint3DIterator::defaultBlockSize];
+	Coordinate y[IPoint3DIterator::defaultBlockSize];
+	Coordinate z[IPoint3DIterator::defaultBlockSize];
+	unsigned int blockSize;
+	inputPointCloud->begin();
+	while ((blockSize = inputPointCloud->getNextBlock(x, y, z, IPoint3DIterator::defaultBlockSize)) > 0) {
+		for (unsigned int i = 0; i < blockSize; ++i) {
+			Eigen::Vector4d pt;
+			pt[0] = x[i] - centroid[0];
+			pt[1] = y[i] - centroid[1];
+			pt[2] = z[i] - centroid[2];
+			pt[3] = 1.0; //homogeneous point
+
+			covariance (1, 1) += pt.y () * pt.y (); //the non X parts
+			covariance (1, 2) += pt.y () * pt.z ();
+			covariance (2, 2) += pt.z () * pt.z ();
+
+			pt *= pt.x ();
+			covariance (0, 0) += pt.x (); //the X related parts
+			covariance (0, 1) += pt.y ();
+			covariance (0, 2) += pt.z ();
+
+			pointCount++;
+		}
 	}
 
 	//copy upper triangle to lower triangle as it is symmetric
@@ -38,16 +38,15 @@ void Octree::filter(PointCloud3D* originalPointCloud, PointCloud3D* resultPointC
 	assert(originalPointCloud != 0);
 	assert(resultPointCloud != 0);
 
-	resultPointCloud->getPointCloud()->clear();
+	resultPointCloud->clear();
 
 	if(originalPointCloud->getSize() == 0) {
 		return; //Nothing to do here..
 	}
 
-	if (voxelSize <=0) {
-		for (int i = 0; i < static_cast<int>(originalPointCloud->getSize()); ++i) { //just copy data
-			resultPointCloud->addPoint((*originalPointCloud->getPointCloud())[i]);
-		}
+	const PointCloud3DStorage* storage = originalPointCloud->getStorage();
+	if (voxelSize <=0) { //just copy data
+		resultPointCloud->addPoints(storage->getRawX(), storage->getRawY(), storage->getRawZ(), storage->getSize());
 		return;
 	}
 
@@ -55,20 +54,20 @@ void Octree::filter(PointCloud3D* originalPointCloud, PointCloud3D* resultPointC
 	double** tmpPointCloudPoints = new double*[originalPointCloud->getSize()];
 	for (unsigned int i = 0; i < originalPointCloud->getSize(); i++) {
 		tmpPointCloudPoints[i] = new double[3];
-		tmpPointCloudPoints[i][0] = (*originalPointCloud->getPointCloud())[i].getX();
-		tmpPointCloudPoints[i][1] = (*originalPointCloud->getPointCloud())[i].getY();
-		tmpPointCloudPoints[i][2] = (*originalPointCloud->getPointCloud())[i].getZ();
+		tmpPointCloudPoints[i][0] = storage->getRawX()[i];
+		tmpPointCloudPoints[i][1] = storage->getRawY()[i];
+		tmpPointCloudPoints[i][2] = storage->getRawZ()[i];
 	}
 
 	/* create octree */
 	OctTree *octree = new OctTree(tmpPointCloudPoints, originalPointCloud->getSize(), this->voxelSize);
 
 	/* process results */
-	resultPointCloud->getPointCloud()->clear();
 	vector<double*> center;
 	center.clear();
 	octree->GetOctTreeCenter(center);
 
+	resultPointCloud->reserve(static_cast<unsigned int>(center.size()));
 	for (int i = 0; i < static_cast<int>(center.size()); ++i) {
 		Point3D tmpPoint = Point3D();
 		tmpPoint.setX(center[i][0]);
@@ -96,12 +95,11 @@ void Octree::partitionPointCloud(PointCloud3D* pointCloud, std::vector<PointClou
 	unsigned int totalPointsCount = 0; //for plausibility check
 
 	pointCloudCells->clear();
+	const PointCloud3DStorage* storage = pointCloud->getStorage();
 	if (voxelSize <=0) {
 		PointCloud3D* tmpPointCloud = new PointCloud3D();
-		for (int i = 0; i < static_cast<int>(pointCloud->getSize()); ++i) { //just copy data
-			tmpPointCloud->addPoint((*pointCloud->getPointCloud())[i]);
-			totalPointsCount++;
-		}
+		tmpPointCloud->addPoints(storage->getRawX(), storage->getRawY(), storage->getRawZ(), storage->getSize()); //just copy data
+		totalPointsCount += tmpPointCloud->getSize();
 		pointCloudCells->push_back(tmpPointCloud);
 		assert (pointCloud->getSize() == totalPointsCount); //plausibility check
 		return;
@@ -111,9 +109,9 @@ void Octree::partitionPointCloud(PointCloud3D* pointCloud, std::vector<PointClou
 	double** tmpPointCloudPoints = new double*[pointCloud->getSize()];
 	for (unsigned int i = 0; i < pointCloud->getSize(); i++) {
 		tmpPointCloudPoints[i] = new double[3];
-		tmpPointCloudPoints[i][0] = (*pointCloud->getPointCloud())[i].getX();
-		tmpPointCloudPoints[i][1] = (*pointCloud->getPointCloud())[i].getY();
-		tmpPointCloudPoints[i][2] = (*pointCloud->getPointCloud())[i].getZ();
+		tmpPointCloudPoints[i][0] = storage->getRawX()[i];
+		tmpPointCloudPoints[i][1] = storage->getRawY()[i];
+		tmpPointCloudPoints[i][2] = storage->getRawZ()[i];
 	}
 
 	/* create octree */
@@ -126,13 +124,13 @@ void Octree::partitionPointCloud(PointCloud3D* pointCloud, std::vector<PointClou
 
 	for (unsigned int i = 0; i < partition.size(); ++i) { // each partition/cell
 		PointCloud3D* tmpPointCloud = new PointCloud3D();
-		for (unsigned int j = 0; j < partition[i].size(); ++j) { // each point in a partition/cell
+		const vector<double*>& tmpResultPoints = partition[i];
+		tmpPointCloud->reserve(static_cast<unsigned int>(tmpResultPoints.size()));
+		for (unsigned int j = 0; j < tmpResultPoints.size(); ++j) { // each point in a partition/cell
 			Point3D tmpPoint = Point3D();
-			vector<double*> tmpResultPoint;
-			tmpResultPoint = partition[i];
-			tmpPoint.setX(tmpResultPoint[j][0]);
-			tmpPoint.setY(tmpResultPoint[j][1]);
-			tmpPoint.setZ(tmpResultPoint[j][2]);
+			tmpPoint.setX(tmpResultPoints[j][0]);
+			tmpPoint.setY(tmpResultPoints[j][1]);
+			tmpPoint.setZ(tmpResultPoints[j][2]);
 			tmpPointCloud->addPoint(tmpPoint);
 			totalPointsCount++;
 		}
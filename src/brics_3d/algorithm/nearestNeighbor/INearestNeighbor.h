@@ -83,6 +83,21 @@ public:
 	 */
 	virtual void findNearestNeighbors(vector<double>* query, std::vector<int>* resultIndices, unsigned int k = 1) = 0;
 
+	/**
+	 * @brief Find all neighbors of the query within a fixed radius.
+	 *
+	 * @param[in] query Vector that will be queried to the data.
+	 * Please make sure that it has the dame dimensionality as the data, set with setData(). Otherwise an
+	 * exception is thrown.
+	 * @param[out] resultIndices Returns the indices of all data points within the radius, sorted by increasing distance.
+	 * @param[in] radius Search radius. Points with a distance equal to the radius are included.
+	 * @param[in] maxResults Maximal number of returned neighbors. In case more points are within the radius, only the
+	 * closest ones are returned. 0 means no limit.
+	 *
+	 * <b>NOTE:</b> setData() must be invoked before.
+	 */
+	virtual void findNeighborsWithinRadius(vector<double>* query, std::vector<int>* resultIndices, double radius, unsigned int maxResults = 0) = 0;
+
 };
 
 }  // namespace brics_3d
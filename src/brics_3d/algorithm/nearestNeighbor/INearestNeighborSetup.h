@@ -21,8 +21,36 @@
 #define BRICS_3D_INEARESTNEIGHBORSETUP_H_
 
 
+#include <cmath>
+
 namespace brics_3d {
 
+/**
+ * @ingroup nearestNeighbor
+ * @brief Measure for the distances returned by nearest neighbor queries.
+ */
+namespace neighborDistance {
+	enum Type {
+		euclidean,       ///< Euclidean distance
+		squaredEuclidean ///< Squared Euclidean distance. Avoids a square root per neighbor.
+	};
+
+	/**
+	 * @brief Check a neighbor against a maximum distance and convert its distance to the requested measure.
+	 *
+	 * @param squaredDistance Squared Euclidean distance of the neighbor.
+	 * @param maxDistance Maximum distance. Values below 0.0 accept every neighbor.
+	 * @param distanceType Requested distance measure.
+	 * @param[out] resultDistance Distance in the requested measure.
+	 * @return False if the neighbor exceeds the maximum distance.
+	 */
+	inline bool isWithinMaxDistance(double squaredDistance, double maxDistance, Type distanceType, double& resultDistance) {
+		double distance = std::sqrt(squaredDistance);
+		resultDistance = (distanceType == squaredEuclidean) ? squaredDistance : distance;
+		return (distance <= maxDistance || maxDistance < 0.0); //if max distance is < 0 then the distance should have no influence
+	}
+}  // namespace neighborDistance
+
 /**
  * @ingroup nearestNeighbor
  * @brief Abstract interface for to configure the Nearest Neighbor search algorithm.
@@ -33,7 +61,9 @@ public:
 	/**
 	 * @brief Standard constructor.
 	 */
-	INearestNeighborSetup(){};
+	INearestNeighborSetup(){
+		numberOfThreads = 0;
+	};
 
 	/**
 	 * @brief Standard destructor.
@@ -71,8 +101,41 @@ public:
         this->maxDistance = maxDistance;
     }
 
+    /**
+     * @brief Get the maximal number of threads for batched queries.
+     * @return Returns the number of threads. 0 means one thread per hardware core.
+     */
+    unsigned int getNumberOfThreads() const
+    {
+        return numberOfThreads;
+    }
+
+    /**
+     * @brief Set the maximal number of threads for batched queries.
+     *
+     * Implementations that do not support concurrent queries on their search structure ignore this value.
+     * @param numberOfThreads Number of threads. 0 means one thread per hardware core.
+     */
+    void setNumberOfThreads(unsigned int numberOfThreads)
+    {
+        this->numberOfThreads = numberOfThreads;
+    }
+
 protected:
 
+    /**
+     * @brief Check a neighbor against the maximum distance and convert its distance to the requested measure.
+     *
+     * @param squaredDistance Squared Euclidean distance of the neighbor, as computed by the search structures.
+     * @param distanceType Requested distance measure.
+     * @param[out] resultDistance Distance in the requested measure.
+     * @return False if the neighbor exceeds the maximum distance.
+     */
+    bool isWithinMaxDistance(double squaredDistance, neighborDistance::Type distanceType, double& resultDistance) const
+    {
+        return neighborDistance::isWithinMaxDistance(squaredDistance, maxDistance, distanceType, resultDistance);
+    }
+
     /// Dimension of data sets search space e.g. 3 for 3D points, etc.
 	int dimension;
 
@@ -82,6 +145,9 @@ protected:
 	 * If this value is below 0.0 than it is neglected in the search queries.
 	 */
 	double maxDistance;
+
+	/// Maximal number of threads for batched queries. 0 means one thread per hardware core.
+	unsigned int numberOfThreads;
 };
 
 }
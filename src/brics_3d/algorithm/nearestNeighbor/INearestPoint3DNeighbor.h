@@ -21,6 +21,7 @@
 #define BRICS_3D_INEARESTPOINT3DNEIGHBOR_H_
 
 #include "brics_3d/core/PointCloud3D.h"
+#include "INearestNeighborSetup.h"
 #include <vector>
 
 using std::vector;
@@ -66,6 +67,90 @@ public:
 	 * <b>NOTE:</b> setData() must be invoked before.
 	 */
 	virtual void findNearestNeighbors(Point3D* query, std::vector<int>* resultIndices, unsigned int k = 1) = 0; //TODO typo: findNearestNeighbors
+
+	/**
+	 * @brief Find the nearest neighbors for every point of a query point cloud.
+	 *
+	 * The results are stored in a flat matrix with k entries per query point: the neighbors of query point i are
+	 * at the indices [i*k, (i+1)*k) of resultIndices, sorted by increasing distance. Neighbors that exceed the
+	 * maximum distance are set to -1.
+	 *
+	 * Depending on the implementation the queries are processed by several threads.
+	 *
+	 * @param[in] queries Point cloud with the query points.
+	 * @param[out] resultIndices Flat result matrix. It will be resized to queries->getSize() * k entries.
+	 * @param[in] k Sets how many nearest neighbors will be searched.
+	 *
+	 * <b>NOTE:</b> setData() must be invoked before.
+	 */
+	virtual void findNearestNeighbors(PointCloud3D* queries, std::vector<int>* resultIndices, unsigned int k = 1) = 0;
+
+	/**
+	 * @brief Find the nearest neighbors for the query points with the indices [begin, end).
+	 *
+	 * Same as above, but only a range of the query point cloud is processed. The neighbors of query point
+	 * begin + i are at the indices [i*k, (i+1)*k) of resultIndices.
+	 *
+	 * @param[in] queries Point cloud with the query points.
+	 * @param[in] begin Index of the first query point.
+	 * @param[in] end Index behind the last query point.
+	 * @param[out] resultIndices Flat result matrix. It will be resized to (end - begin) * k entries.
+	 * @param[in] k Sets how many nearest neighbors will be searched.
+	 */
+	virtual void findNearestNeighbors(PointCloud3D* queries, unsigned int begin, unsigned int end, std::vector<int>* resultIndices, unsigned int k = 1) = 0;
+
+	/**
+	 * @brief Find all neighbors of the query within a fixed radius.
+	 *
+	 * In contrast to findNearestNeighbors() the number of neighbors is not known in advance. The maximum distance
+	 * of INearestNeighborSetup has no influence on this query.
+	 *
+	 * @param[in] query Point that will be queried to the data.
+	 * @param[out] resultIndices Returns the indices of all data points within the radius, sorted by increasing distance.
+	 * @param[in] radius Search radius. Points with a distance equal to the radius are included.
+	 * @param[in] maxResults Maximal number of returned neighbors. In case more points are within the radius, only the
+	 * closest ones are returned. 0 means no limit.
+	 *
+	 * <b>NOTE:</b> setData() must be invoked before.
+	 */
+	virtual void findNeighborsWithinRadius(Point3D* query, std::vector<int>* resultIndices, double radius, unsigned int maxResults = 0) = 0;
+
+	/**
+	 * @brief Find the nearest neighbors of the query and their distances.
+	 *
+	 * Same as findNearestNeighbors(Point3D*, std::vector<int>*, unsigned int), but the distances that are computed
+	 * by the search anyway are returned as well, so callers do not need a second pass over the neighbors.
+	 *
+	 * @param[in] query Point that will be queried to the data.
+	 * @param[out] resultIndices Returns the indices of the $k$ nearest neighbors, sorted by increasing distance.
+	 * @param[out] resultDistances Returns the distance of each neighbor in resultIndices.
+	 * @param[in] k Sets how many nearest neighbors will be searched.
+	 * @param[in] distanceType Measure of the returned distances.
+	 */
+	virtual void findNearestNeighbors(Point3D* query, std::vector<int>* resultIndices, std::vector<double>* resultDistances,
+			unsigned int k = 1, neighborDistance::Type distanceType = neighborDistance::euclidean) = 0;
+
+	/**
+	 * @brief Batched query for the query points [begin, end) that returns the neighbors and their distances.
+	 *
+	 * resultDistances is a flat matrix with the same layout as resultIndices. Entries of neighbors that exceed the
+	 * maximum distance are set to -1 in both matrices.
+	 */
+	virtual void findNearestNeighbors(PointCloud3D* queries, unsigned int begin, unsigned int end, std::vector<int>* resultIndices,
+			std::vector<double>* resultDistances, unsigned int k = 1, neighborDistance::Type distanceType = neighborDistance::euclidean) = 0;
+
+	/**
+	 * @brief Fixed radius search that returns the neighbors and their distances.
+	 *
+	 * @param[in] query Point that will be queried to the data.
+	 * @param[out] resultIndices Returns the indices of all data points within the radius, sorted by increasing distance.
+	 * @param[out] resultDistances Returns the distance of each neighbor in resultIndices.
+	 * @param[in] radius Search radius. It is always a Euclidean distance.
+	 * @param[in] maxResults Maximal number of returned neighbors. 0 means no limit.
+	 * @param[in] distanceType Measure of the returned distances.
+	 */
+	virtual void findNeighborsWithinRadius(Point3D* query, std::vector<int>* resultIndices, std::vector<double>* resultDistances,
+			double radius, unsigned int maxResults = 0, neighborDistance::Type distanceType = neighborDistance::euclidean) = 0;
 };
 
 }  // namespace brics_3d
@@ -20,6 +20,7 @@
 #include "NearestNeighborANN.h"
 #include <assert.h>
 #include <stdexcept>
+#include <algorithm>
 
 using std::runtime_error;
 
@@ -28,7 +29,6 @@ namespace brics_3d {
 NearestNeighborANN::NearestNeighborANN() {
 	this->dimension = -1;
 	this->maxDistance = -1; //default = disable
-	k = 1;
 	eps	= 0;
 	maxPts = 1000;
 
@@ -95,10 +95,14 @@ void NearestNeighborANN::setData(PointCloud3D* data) {
 	int nPts = static_cast<int>(data->getSize());									// read data points
 
 	/* fill in the data int the ANN specific representation */
-	for (int i = 0; i < static_cast<int>(data->getSize()); ++i) {
-		dataPoints[i][0] = static_cast<ANNcoord>( (*data->getPointCloud())[i].getX() );
-		dataPoints[i][1] = static_cast<ANNcoord>( (*data->getPointCloud())[i].getY() );
-		dataPoints[i][2] = static_cast<ANNcoord>( (*data->getPointCloud())[i].getZ() );
+	const PointCloud3DStorage* storage = data->getStorage();
+	const Coordinate* x = storage->getRawX();
+	const Coordinate* y = storage->getRawY();
+	const Coordinate* z = storage->getRawZ();
+	for (int i = 0; i < nPts; ++i) {
+		dataPoints[i][0] = static_cast<ANNcoord>(x[i]);
+		dataPoints[i][1] = static_cast<ANNcoord>(y[i]);
+		dataPoints[i][2] = static_cast<ANNcoord>(z[i]);
 	}
 
 	kdTree = new ANNkd_tree(					// build search structure
@@ -121,95 +125,202 @@ void NearestNeighborANN::findNearestNeighbors(vector<double>* query, std::vector
 	if (static_cast<int>(query->size()) != dimension) {
 		throw runtime_error("Mismatch of query and data dimension.");
 	}
+
+	std::vector<ANNcoord> queryData(dimension);
+	for (int i = 0; i < dimension; ++i) {
+		queryData[i] = static_cast<ANNcoord>( (*query)[i] );
+	}
+	searchNearest(&queryData[0], k, resultIndices, 0, neighborDistance::euclidean);
+}
+
+void NearestNeighborANN::findNearestNeighbors(Point3D* query, std::vector<int>* resultIndices, unsigned int k) {
+	findNearestNeighbors(query, resultIndices, 0, k);
+}
+
+void NearestNeighborANN::findNearestNeighbors(Point3D* query, std::vector<int>* resultIndices, std::vector<double>* resultDistances, unsigned int k, neighborDistance::Type distanceType) {
+	assert (query != 0);
+	assert (resultIndices != 0);
+	assert (dimension == 3);
+
+	ANNcoord queryData[3];
+	queryData[0] = static_cast<ANNcoord>( query->getX() );
+	queryData[1] = static_cast<ANNcoord>( query->getY() );
+	queryData[2] = static_cast<ANNcoord>( query->getZ() );
+	searchNearest(queryData, k, resultIndices, resultDistances, distanceType);
+}
+
+void NearestNeighborANN::searchNearest(ANNpoint query, unsigned int k, std::vector<int>* resultIndices, std::vector<double>* resultDistances, neighborDistance::Type distanceType) {
 	if (static_cast<int>(k) > kdTree->nPoints()) {
 		throw runtime_error("Number of neighbors k is bigger than the amount of data points.");
 	}
 
-	this->k = static_cast<int>(k);
 	resultIndices->clear();
-
-	nnIndex = new ANNidx[k];					// allocate near neigh indices
-	distances = new ANNdist[k];					// allocate near neighbor distances
-	queryPoint = annAllocPt(dimension);			// allocate query point
-
-	for (int i = 0; i < dimension; ++i) {
-		queryPoint[i] = static_cast<ANNcoord>( (*query)[i] );
+	if (resultDistances != 0) {
+		resultDistances->clear();
+	}
+	if (k == 0) {
+		return;
 	}
 
+	nnIndex.resize(k);
+	distances.resize(k);
 	kdTree->annkSearch(						// search
-			queryPoint,						// query point
-			this->k,							// number of near neighbors
-			nnIndex,						// nearest neighbors (returned)
-			distances,						// distance (returned)
+			query,							// query point
+			static_cast<int>(k),			// number of near neighbors
+			&nnIndex[0],					// nearest neighbors (returned)
+			&distances[0],					// squared distance (returned)
 			eps);							// error bound
 
-	brics_3d::Coordinate resultDistance; //distance has same data-type as Coordinate, although the meaning is different TODO: global distance typedef?
-	int resultIndex;
-	for (int i = 0; i < this->k; i++) {
-		resultDistance = static_cast<brics_3d::Coordinate>(sqrt(distances[i]));	//unsquare distance
-		resultIndex = nnIndex[i];
-		if (resultDistance <= maxDistance || maxDistance < 0.0) { //if max distance is < 0 then the distance should have no influence
-			resultIndices->push_back(resultIndex);
+	double resultDistance;
+	for (unsigned int i = 0; i < k; i++) {
+		if (isWithinMaxDistance(distances[i], distanceType, resultDistance)) {
+			resultIndices->push_back(nnIndex[i]);
+			if (resultDistances != 0) {
+				resultDistances->push_back(resultDistance);
+			}
 		}
 	}
+}
 
-	annDeallocPt(queryPoint);					// clean things up
-    delete [] nnIndex;
-    delete [] distances;
+void NearestNeighborANN::findNearestNeighbors(PointCloud3D* queries, std::vector<int>* resultIndices, unsigned int k) {
+	assert (queries != 0);
+	findNearestNeighbors(queries, 0, queries->getSize(), resultIndices, 0, k);
+}
 
+void NearestNeighborANN::findNearestNeighbors(PointCloud3D* queries, unsigned int begin, unsigned int end, std::vector<int>* resultIndices, unsigned int k) {
+	findNearestNeighbors(queries, begin, end, resultIndices, 0, k);
 }
 
-void NearestNeighborANN::findNearestNeighbors(Point3D* query, std::vector<int>* resultIndices, unsigned int k) {
-	assert (query != 0);
+void NearestNeighborANN::findNearestNeighbors(PointCloud3D* queries, unsigned int begin, unsigned int end, std::vector<int>* resultIndices,
+		std::vector<double>* resultDistances, unsigned int k, neighborDistance::Type distanceType) {
+	assert (queries != 0);
 	assert (resultIndices != 0);
 	assert (dimension == 3);
+	assert (begin <= end);
+	assert (end <= queries->getSize());
 
 	if (static_cast<int>(k) > kdTree->nPoints()) {
 		throw runtime_error("Number of neighbors k is bigger than the amount of data points.");
 	}
 
-	this->k = static_cast<int>(k);
-	resultIndices->clear();
-
-	nnIndex = new ANNidx[k];					// allocate near neigh indices
-	distances = new ANNdist[k];					// allocate near neighbor distances
-	queryPoint = annAllocPt(dimension);			// allocate query point
-
-	queryPoint[0] = static_cast<ANNcoord>( query->getX() );
-	queryPoint[1] = static_cast<ANNcoord>( query->getY() );
-	queryPoint[2] = static_cast<ANNcoord>( query->getZ() );
+	resultIndices->resize((end - begin) * k);
+	if (resultDistances != 0) {
+		resultDistances->resize((end - begin) * k);
+	}
+	if (begin == end || k == 0) {
+		return;
+	}
 
-	kdTree->annkSearch(						// search
-			queryPoint,						// query point
-			this->k,							// number of near neighbors
-			nnIndex,						// nearest neighbors (returned)
-			distances,						// distance (returned)
-			eps);							// error bound
+	/*
+	 * ANN keeps the state of a search in global variables, so the queries can not
+	 * be processed concurrently. At least the buffers are allocated only once per batch.
+	 */
+	searchRange(queries->getStorage(), k, begin, end, &(*resultIndices)[0], (resultDistances != 0) ? &(*resultDistances)[0] : 0, distanceType);
+}
 
-//	std::cout << "\tNN:\tIndex\tDistance\n";
-//	for (int i = 0; i < k; i++) {			// print summary
-//		distances[i] = sqrt(distances[i]);			// unsquare distance
-//		std::cout << "\t" << i << "\t" << nnIndex[i] << "\t" << distances[i] << "\n";
-//	}
+void NearestNeighborANN::searchRange(const PointCloud3DStorage* queries, unsigned int k, unsigned int begin, unsigned int end,
+		int* resultIndices, double* resultDistances, neighborDistance::Type distanceType) {
+	const Coordinate* x = queries->getRawX();
+	const Coordinate* y = queries->getRawY();
+	const Coordinate* z = queries->getRawZ();
+
+	nnIndex.resize(k);
+	distances.resize(k);
+	ANNcoord query[3];
+	double resultDistance;
+
+	for (unsigned int i = begin; i < end; ++i) {
+		query[0] = static_cast<ANNcoord>(x[i]);
+		query[1] = static_cast<ANNcoord>(y[i]);
+		query[2] = static_cast<ANNcoord>(z[i]);
+
+		kdTree->annkSearch(query, static_cast<int>(k), &nnIndex[0], &distances[0], eps);
+
+		for (unsigned int j = 0; j < k; ++j) {
+			if (isWithinMaxDistance(distances[j], distanceType, resultDistance)) {
+				resultIndices[j] = nnIndex[j];
+			} else {
+				resultIndices[j] = -1;
+				resultDistance = -1.0;
+			}
+			if (resultDistances != 0) {
+				resultDistances[j] = resultDistance;
+			}
+		}
+		resultIndices += k;
+		if (resultDistances != 0) {
+			resultDistances += k;
+		}
+	}
+}
 
-	brics_3d::Coordinate resultDistance; //distance has same data-type as Coordinate, although the meaning is different TODO: global distance typedef?
-	int resultIndex;
-	for (int i = 0; i < this->k; i++) {
-		resultDistance = static_cast<brics_3d::Coordinate>(sqrt(distances[i]));	//unsquare distance
-		resultIndex = nnIndex[i];
+void NearestNeighborANN::findNeighborsWithinRadius(vector<double>* query, std::vector<int>* resultIndices, double radius, unsigned int maxResults) {
+	assert (query != 0);
+	assert (resultIndices != 0);
 
-		if (resultDistance <= maxDistance || maxDistance < 0.0) { //if max distance is < 0 then the distance should have no influence
-			resultIndices->push_back(resultIndex);
+	if (static_cast<int>(query->size()) != dimension) {
+		throw runtime_error("Mismatch of query and data dimension.");
+	}
 
-		}
+	std::vector<ANNcoord> queryData(dimension);
+	for (int i = 0; i < dimension; ++i) {
+		queryData[i] = static_cast<ANNcoord>( (*query)[i] );
 	}
+	searchRadius(&queryData[0], radius, maxResults, resultIndices, 0, neighborDistance::euclidean);
+}
 
+void NearestNeighborANN::findNeighborsWithinRadius(Point3D* query, std::vector<int>* resultIndices, double radius, unsigned int maxResults) {
+	findNeighborsWithinRadius(query, resultIndices, 0, radius, maxResults);
+}
 
+void NearestNeighborANN::findNeighborsWithinRadius(Point3D* query, std::vector<int>* resultIndices, std::vector<double>* resultDistances,
+		double radius, unsigned int maxResults, neighborDistance::Type distanceType) {
+	assert (query != 0);
+	assert (resultIndices != 0);
+	assert (dimension == 3);
 
-	annDeallocPt(queryPoint);					// clean things up
-    delete [] nnIndex;
-    delete [] distances;
+	ANNcoord queryData[3];
+	queryData[0] = static_cast<ANNcoord>( query->getX() );
+	queryData[1] = static_cast<ANNcoord>( query->getY() );
+	queryData[2] = static_cast<ANNcoord>( query->getZ() );
+	searchRadius(queryData, radius, maxResults, resultIndices, resultDistances, distanceType);
+}
 
+void NearestNeighborANN::searchRadius(ANNpoint query, double radius, unsigned int maxResults, std::vector<int>* resultIndices,
+		std::vector<double>* resultDistances, neighborDistance::Type distanceType) {
+	resultIndices->clear();
+	if (resultDistances != 0) {
+		resultDistances->clear();
+	}
+	if (radius < 0.0) {
+		return;
+	}
+	ANNdist squaredRadius = static_cast<ANNdist>(radius * radius);
+
+	/* ANN needs the number of neighbors in advance, so count them first unless the result is limited anyway */
+	int numberOfNeighbors;
+	if (maxResults > 0) {
+		numberOfNeighbors = std::min(static_cast<int>(maxResults), kdTree->nPoints());
+	} else {
+		numberOfNeighbors = kdTree->annkFRSearch(query, squaredRadius, 0, 0, 0, eps);
+	}
+	if (numberOfNeighbors == 0) {
+		return;
+	}
+
+	nnIndex.resize(numberOfNeighbors);
+	distances.resize(numberOfNeighbors);
+	int pointsInRange = kdTree->annkFRSearch(query, squaredRadius, numberOfNeighbors, &nnIndex[0], &distances[0], eps);
+
+	/* sorted by increasing distance, missing neighbors are marked with ANN_NULL_IDX */
+	numberOfNeighbors = std::min(numberOfNeighbors, pointsInRange);
+	resultIndices->assign(nnIndex.begin(), nnIndex.begin() + numberOfNeighbors);
+	if (resultDistances != 0) {
+		resultDistances->resize(numberOfNeighbors);
+		for (int i = 0; i < numberOfNeighbors; ++i) {
+			(*resultDistances)[i] = (distanceType == neighborDistance::squaredEuclidean) ? distances[i] : std::sqrt(distances[i]);
+		}
+	}
 }
 
 }
@@ -56,11 +56,38 @@ public:
 	void findNearestNeighbors(vector<float>* query, std::vector<int>* resultIndices, unsigned int k = 1);
 	void findNearestNeighbors(vector<double>* query, std::vector<int>* resultIndices, unsigned int k = 1);
 	void findNearestNeighbors(Point3D* query, std::vector<int>* resultIndices, unsigned int k = 1);
+	void findNearestNeighbors(PointCloud3D* queries, std::vector<int>* resultIndices, unsigned int k = 1);
+	void findNearestNeighbors(PointCloud3D* queries, unsigned int begin, unsigned int end, std::vector<int>* resultIndices, unsigned int k = 1);
+
+	void findNeighborsWithinRadius(vector<double>* query, std::vector<int>* resultIndices, double radius, unsigned int maxResults = 0);
+	void findNeighborsWithinRadius(Point3D* query, std::vector<int>* resultIndices, double radius, unsigned int maxResults = 0);
+
+	void findNearestNeighbors(Point3D* query, std::vector<int>* resultIndices, std::vector<double>* resultDistances,
+			unsigned int k = 1, neighborDistance::Type distanceType = neighborDistance::euclidean);
+	void findNearestNeighbors(PointCloud3D* queries, unsigned int begin, unsigned int end, std::vector<int>* resultIndices,
+			std::vector<double>* resultDistances, unsigned int k = 1, neighborDistance::Type distanceType = neighborDistance::euclidean);
+	void findNeighborsWithinRadius(Point3D* query, std::vector<int>* resultIndices, std::vector<double>* resultDistances,
+			double radius, unsigned int maxResults = 0, neighborDistance::Type distanceType = neighborDistance::euclidean);
 
 private:
 
-	/// number of nearest neighbors
-	int k;
+	/**
+	 * @brief k nearest neighbor search for a query point with the dimension of the data.
+	 * @param resultDistances Optional, might be 0.
+	 */
+	void searchNearest(ANNpoint query, unsigned int k, std::vector<int>* resultIndices, std::vector<double>* resultDistances, neighborDistance::Type distanceType);
+
+	/**
+	 * @brief Search the neighbors for the query points [begin, end) and store them in a flat result matrix.
+	 * @param resultDistances Optional, might be 0.
+	 */
+	void searchRange(const PointCloud3DStorage* queries, unsigned int k, unsigned int begin, unsigned int end, int* resultIndices, double* resultDistances, neighborDistance::Type distanceType);
+
+	/**
+	 * @brief Fixed radius search for a query point with the dimension of the data.
+	 * @param resultDistances Optional, might be 0.
+	 */
+	void searchRadius(ANNpoint query, double radius, unsigned int maxResults, std::vector<int>* resultIndices, std::vector<double>* resultDistances, neighborDistance::Type distanceType);
 
 	/// error bound
 	double eps;
@@ -71,14 +98,11 @@ private:
 	/// data points
 	ANNpointArray dataPoints;
 
-	/// query point
-	ANNpoint queryPoint;
-
-	/// near neighbor indices
-	ANNidxArray nnIndex;
+	/// near neighbor indices (reused between queries)
+	std::vector<ANNidx> nnIndex;
 
-	/// near neighbor distances
-	ANNdistArray distances;
+	/// near neighbor distances (reused between queries)
+	std::vector<ANNdist> distances;
 
 	/// search structure
 	ANNkd_tree* kdTree;
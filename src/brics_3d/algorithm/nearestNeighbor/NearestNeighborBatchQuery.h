@@ -0,0 +1,174 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#ifndef BRICS_3D_NEARESTNEIGHBORBATCHQUERY_H_
+#define BRICS_3D_NEARESTNEIGHBORBATCHQUERY_H_
+
+#include "INearestNeighborSetup.h"
+#include "brics_3d/core/PointCloud3DStorage.h"
+#include "brics_3d/core/ParallelRange.h"
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+
+namespace brics_3d {
+
+/**
+ * @ingroup nearestNeighbor
+ * @brief Insert a neighbor into a list of at most k neighbors, sorted by increasing squared distance.
+ */
+inline void insertNeighbor(std::vector<std::pair<double, int> >& neighbors, unsigned int k, double squaredDistance, int index) {
+	if (neighbors.size() < k) {
+		neighbors.push_back(std::make_pair(squaredDistance, index));
+	} else if (squaredDistance < neighbors.back().first) {
+		neighbors.back() = std::make_pair(squaredDistance, index);
+	} else {
+		return;
+	}
+	for (unsigned int i = static_cast<unsigned int>(neighbors.size()) - 1; i > 0 && neighbors[i - 1].first > neighbors[i].first; --i) {
+		std::swap(neighbors[i - 1], neighbors[i]);
+	}
+}
+
+/**
+ * @ingroup nearestNeighbor
+ * @brief Sort the neighbors of a radius search by increasing distance and copy at most maxResults of them.
+ *
+ * @param neighbors Pairs of squared distance and index. They are sorted in place.
+ * @param maxResults Maximal number of results. 0 means all neighbors.
+ * @param resultIndices The indices of the neighbors. Previous content is replaced.
+ * @param resultDistances The distances of the neighbors in the requested measure. Optional, might be 0.
+ * @param distanceType Requested distance measure.
+ */
+inline void copyRadiusNeighbors(std::vector<std::pair<double, int> >& neighbors, unsigned int maxResults,
+		std::vector<int>* resultIndices, std::vector<double>* resultDistances, neighborDistance::Type distanceType) {
+
+	if (maxResults > 0 && maxResults < neighbors.size()) {
+		std::partial_sort(neighbors.begin(), neighbors.begin() + maxResults, neighbors.end());
+		neighbors.resize(maxResults);
+	} else {
+		std::sort(neighbors.begin(), neighbors.end());
+	}
+
+	resultIndices->resize(neighbors.size());
+	if (resultDistances != 0) {
+		resultDistances->resize(neighbors.size());
+	}
+	for (unsigned int i = 0; i < neighbors.size(); ++i) {
+		(*resultIndices)[i] = neighbors[i].second;
+		if (resultDistances != 0) {
+			(*resultDistances)[i] = (distanceType == neighborDistance::squaredEuclidean) ? neighbors[i].first : std::sqrt(neighbors[i].first);
+		}
+	}
+}
+
+/// Type of the member function of a backend that returns the k nearest neighbors of one query for runBatchQuery().
+template <typename Backend>
+struct NeighborSearchMethod {
+	typedef void (Backend::*Type)(const double query[3], unsigned int k, double maxSquaredDistance,
+			std::vector<std::pair<double, int> >& neighbors) const;
+};
+
+/// Searches a block of queries and writes the neighbors to its rows of the flat result matrices.
+template <typename NeighborSearch>
+struct BatchQueryBlock {
+	NeighborSearch search;
+	const PointCloud3DStorage* queries;
+	unsigned int batchBegin;
+	unsigned int k;
+	double maxDistance;
+	neighborDistance::Type distanceType;
+	int* result;
+	double* distances;
+
+	void operator()(unsigned int /*block*/, unsigned int begin, unsigned int end) const {
+		NeighborSearch blockSearch = search; // the search functor may keep scratch buffers
+		const Coordinate* x = queries->getRawX();
+		const Coordinate* y = queries->getRawY();
+		const Coordinate* z = queries->getRawZ();
+		int* blockResult = result + (begin - batchBegin) * k;
+		double* blockDistances = (distances != 0) ? distances + (begin - batchBegin) * k : 0;
+
+		std::vector<std::pair<double, int> > neighbors;
+		neighbors.reserve(k);
+		double resultDistance;
+		for (unsigned int i = begin; i < end; ++i) {
+			double query[3] = {x[i], y[i], z[i]};
+			blockSearch(query, neighbors);
+
+			/* missing neighbors are marked with -1 */
+			for (unsigned int j = 0; j < k; ++j) {
+				if (j < neighbors.size() && neighborDistance::isWithinMaxDistance(neighbors[j].first, maxDistance, distanceType, resultDistance)) {
+					blockResult[j] = neighbors[j].second;
+				} else {
+					blockResult[j] = -1;
+					resultDistance = -1.0;
+				}
+				if (blockDistances != 0) {
+					blockDistances[j] = resultDistance;
+				}
+			}
+			blockResult += k;
+			if (blockDistances != 0) {
+				blockDistances += k;
+			}
+		}
+	}
+};
+
+/**
+ * @ingroup nearestNeighbor
+ * @brief Distributes a batch of k nearest neighbor queries over several threads.
+ *
+ * The query range [begin, end) is split into contiguous blocks with forEachRange(), one block per thread. Every
+ * query of a block is answered by <code>search(query, neighbors)</code>, which returns at most k pairs of squared
+ * distance and index, sorted by increasing distance. Each block works on its own copy of the search functor, so the
+ * functor can keep scratch buffers. The neighbors are written to the rows of the flat result matrices with k entries
+ * per query. Missing neighbors and neighbors beyond maxDistance are stored as index -1 with distance -1.0.
+ *
+ * Only backends that allow concurrent queries on the same search structure should use more than one thread.
+ *
+ * @param search Functor with the signature <code>void (const double query[3], std::vector<std::pair<double, int> >& neighbors)</code>.
+ * @param queries The query points.
+ * @param begin Index of the first query.
+ * @param end Index behind the last query.
+ * @param k Number of result entries per query.
+ * @param maxDistance Maximum distance of a neighbor. Values below 0.0 accept every neighbor.
+ * @param distanceType Measure of the returned distances.
+ * @param result Flat index matrix with (end - begin) * k entries.
+ * @param distances Flat distance matrix with (end - begin) * k entries. Optional, might be 0.
+ * @param numberOfThreads Maximal number of threads. 0 means one thread per hardware core.
+ * @param minimalQueriesPerThread Minimal number of queries for an additional thread.
+ */
+template <typename NeighborSearch>
+void runBatchQuery(NeighborSearch search, const PointCloud3DStorage* queries, unsigned int begin, unsigned int end, unsigned int k,
+		double maxDistance, neighborDistance::Type distanceType, int* result, double* distances,
+		unsigned int numberOfThreads, unsigned int minimalQueriesPerThread = 1024) {
+
+	BatchQueryBlock<NeighborSearch> block = {search, queries, begin, k, maxDistance, distanceType, result, distances};
+	forEachRange(block, begin, end, numberOfThreads, minimalQueriesPerThread);
+}
+
+}
+
+#endif /* BRICS_3D_NEARESTNEIGHBORBATCHQUERY_H_ */
+
+/* EOF */
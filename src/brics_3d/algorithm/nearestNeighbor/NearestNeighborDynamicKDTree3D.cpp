@@ -0,0 +1,318 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#include "NearestNeighborDynamicKDTree3D.h"
+#include "NearestNeighborBatchQuery.h"
+
+#include <assert.h>
+#include <cmath>
+#include <stdexcept>
+#include <algorithm>
+
+using std::runtime_error;
+
+namespace brics_3d {
+
+NearestNeighborDynamicKDTree3D::NearestNeighborDynamicKDTree3D() {
+	this->dimension = -1;
+	this->maxDistance = -1; //default = disable
+	numberOfPoints = 0;
+}
+
+NearestNeighborDynamicKDTree3D::~NearestNeighborDynamicKDTree3D() {
+
+}
+
+void NearestNeighborDynamicKDTree3D::setData(PointCloud3D* data) {
+	assert (data != 0);
+	setData(data->getStorage());
+}
+
+void NearestNeighborDynamicKDTree3D::setData(const PointCloud3DStorage* data) {
+	subtrees.clear();
+	removed.clear();
+	numberOfPoints = 0;
+	addPoints(data);
+}
+
+unsigned int NearestNeighborDynamicKDTree3D::addPoints(PointCloud3D* points) {
+	assert (points != 0);
+	return addPoints(points->getStorage());
+}
+
+unsigned int NearestNeighborDynamicKDTree3D::addPoints(const PointCloud3DStorage* points) {
+	assert (points != 0);
+	this->dimension = 3;
+
+	unsigned int firstIndex = static_cast<unsigned int>(removed.size());
+	unsigned int count = points->getSize();
+	if (count == 0) {
+		return firstIndex;
+	}
+
+	Subtree subtree;
+	subtree.points.addPoints(points->getRawX(), points->getRawY(), points->getRawZ(), count);
+	subtree.indices.resize(count);
+	for (unsigned int i = 0; i < count; ++i) {
+		subtree.indices[i] = firstIndex + i;
+	}
+	subtree.firstIndex = firstIndex;
+	subtree.removedCount = 0;
+	rebuild(subtree);
+
+	removed.resize(firstIndex + count, 0);
+	numberOfPoints += count;
+	subtrees.push_back(subtree);
+	mergeSubtrees();
+
+	return firstIndex;
+}
+
+void NearestNeighborDynamicKDTree3D::removePoints(const std::vector<int>& indices) {
+	for (unsigned int i = 0; i < indices.size(); ++i) {
+		if (indices[i] < 0 || indices[i] >= static_cast<int>(removed.size())) {
+			throw runtime_error("Index of the point to be removed is not part of the nearest neighbor index.");
+		}
+	}
+
+	for (unsigned int i = 0; i < indices.size(); ++i) {
+		if (removed[indices[i]]) {
+			continue;
+		}
+		removed[indices[i]] = 1;
+		subtrees[findSubtree(indices[i])].removedCount++;
+		numberOfPoints--;
+	}
+
+	/* compact the sub-trees where the majority of points is removed */
+	std::vector<Subtree>::iterator subtree = subtrees.begin();
+	while (subtree != subtrees.end()) {
+		if (subtree->getLiveSize() == 0) {
+			subtree = subtrees.erase(subtree);
+			continue;
+		}
+		if (subtree->removedCount * 2 > subtree->indices.size()) {
+			rebuild(*subtree);
+		}
+		++subtree;
+	}
+	mergeSubtrees();
+}
+
+void NearestNeighborDynamicKDTree3D::rebuild(Subtree& subtree) const {
+	if (subtree.removedCount > 0) {
+		PointCloud3DStorage livePoints;
+		std::vector<int> liveIndices;
+		livePoints.reserve(subtree.getLiveSize());
+		liveIndices.reserve(subtree.getLiveSize());
+		const PointCloud3DStorage& points = subtree.points;
+		for (unsigned int i = 0; i < subtree.indices.size(); ++i) {
+			if (!removed[subtree.indices[i]]) {
+				livePoints.addPoint(points.getRawX()[i], points.getRawY()[i], points.getRawZ()[i]);
+				liveIndices.push_back(subtree.indices[i]);
+			}
+		}
+		subtree.points.swap(livePoints);
+		subtree.indices.swap(liveIndices);
+		subtree.removedCount = 0;
+	}
+
+	subtree.tree.reset(new NearestNeighborKDTree3D());
+	subtree.tree->setData(&subtree.points);
+}
+
+void NearestNeighborDynamicKDTree3D::mergeSubtrees() {
+	while (subtrees.size() >= 2) {
+		Subtree& previous = subtrees[subtrees.size() - 2];
+		Subtree& last = subtrees.back();
+		if (previous.getLiveSize() > 2 * last.getLiveSize()) {
+			break;
+		}
+
+		/* the removed points are dropped by the rebuild */
+		const PointCloud3DStorage& points = last.points;
+		previous.points.addPoints(points.getRawX(), points.getRawY(), points.getRawZ(), points.getSize());
+		previous.indices.insert(previous.indices.end(), last.indices.begin(), last.indices.end());
+		previous.removedCount += last.removedCount;
+		subtrees.pop_back();
+		rebuild(subtrees.back());
+	}
+}
+
+unsigned int NearestNeighborDynamicKDTree3D::findSubtree(unsigned int index) const {
+	unsigned int lower = 0;
+	unsigned int upper = static_cast<unsigned int>(subtrees.size());
+	while (upper - lower > 1) { // last sub-tree with firstIndex <= index
+		unsigned int middle = (lower + upper) / 2;
+		if (subtrees[middle].firstIndex <= index) {
+			lower = middle;
+		} else {
+			upper = middle;
+		}
+	}
+	return lower;
+}
+
+void NearestNeighborDynamicKDTree3D::searchNearest(const double query[3], unsigned int k, double maxSquaredDistance,
+		std::vector<std::pair<double, int> >& neighbors) const {
+	neighbors.clear();
+	std::vector<std::pair<double, int> > subtreeNeighbors;
+	for (unsigned int s = 0; s < subtrees.size(); ++s) {
+		const Subtree& subtree = subtrees[s];
+
+		/* only neighbors closer than the k-th one of the previous sub-trees are of interest */
+		double bound = (neighbors.size() == k) ? neighbors.back().first : maxSquaredDistance;
+
+		/* enough candidates to get k neighbors that are not removed */
+		subtree.tree->findNearestNeighbors(query, k + subtree.removedCount, bound, &subtreeNeighbors);
+		for (unsigned int i = 0; i < subtreeNeighbors.size(); ++i) {
+			int index = subtree.indices[subtreeNeighbors[i].second];
+			if (!removed[index]) {
+				insertNeighbor(neighbors, k, subtreeNeighbors[i].first, index);
+			}
+		}
+	}
+}
+
+void NearestNeighborDynamicKDTree3D::searchRadius(Point3D* query, double radius, unsigned int maxResults, std::vector<std::pair<double, int> >& neighbors) const {
+	neighbors.clear();
+	std::vector<int> subtreeIndices;
+	std::vector<double> subtreeDistances;
+	for (unsigned int s = 0; s < subtrees.size(); ++s) {
+		const Subtree& subtree = subtrees[s];
+		unsigned int subtreeMaxResults = (maxResults == 0) ? 0 : maxResults + subtree.removedCount;
+		subtree.tree->findNeighborsWithinRadius(query, &subtreeIndices, &subtreeDistances, radius, subtreeMaxResults, neighborDistance::squaredEuclidean);
+		for (unsigned int i = 0; i < subtreeIndices.size(); ++i) {
+			int index = subtree.indices[subtreeIndices[i]];
+			if (!removed[index]) {
+				neighbors.push_back(std::make_pair(subtreeDistances[i], index));
+			}
+		}
+	}
+}
+
+void NearestNeighborDynamicKDTree3D::findNearestNeighbors(Point3D* query, std::vector<int>* resultIndices, unsigned int k) {
+	findNearestNeighbors(query, resultIndices, 0, k);
+}
+
+void NearestNeighborDynamicKDTree3D::findNearestNeighbors(Point3D* query, std::vector<int>* resultIndices, std::vector<double>* resultDistances,
+		unsigned int k, neighborDistance::Type distanceType) {
+	assert (query != 0);
+	assert (resultIndices != 0);
+
+	if (k > numberOfPoints) {
+		throw runtime_error("Number of neighbors k is bigger than the amount of data points.");
+	}
+	if (k == 0) {
+		resultIndices->clear();
+		if (resultDistances != 0) {
+			resultDistances->clear();
+		}
+		return;
+	}
+
+	/* the maximum distance bounds the search; the small margin compensates the single precision of the sub-trees */
+	double maxSquaredDistance = (maxDistance < 0.0) ? -1.0 : maxDistance * maxDistance * (1.0 + 1e-5);
+	double queryData[3] = {query->getX(), query->getY(), query->getZ()};
+	std::vector<std::pair<double, int> > neighbors;
+	searchNearest(queryData, k, maxSquaredDistance, neighbors);
+
+	resultIndices->clear();
+	if (resultDistances != 0) {
+		resultDistances->clear();
+	}
+	double resultDistance;
+	for (unsigned int i = 0; i < neighbors.size(); ++i) {
+		if (isWithinMaxDistance(neighbors[i].first, distanceType, resultDistance)) {
+			resultIndices->push_back(neighbors[i].second);
+			if (resultDistances != 0) {
+				resultDistances->push_back(resultDistance);
+			}
+		}
+	}
+}
+
+void NearestNeighborDynamicKDTree3D::findNearestNeighbors(PointCloud3D* queries, std::vector<int>* resultIndices, unsigned int k) {
+	assert (queries != 0);
+	findNearestNeighbors(queries, 0, queries->getSize(), resultIndices, 0, k);
+}
+
+void NearestNeighborDynamicKDTree3D::findNearestNeighbors(PointCloud3D* queries, unsigned int begin, unsigned int end, std::vector<int>* resultIndices, unsigned int k) {
+	findNearestNeighbors(queries, begin, end, resultIndices, 0, k);
+}
+
+void NearestNeighborDynamicKDTree3D::findNearestNeighbors(PointCloud3D* queries, unsigned int begin, unsigned int end, std::vector<int>* resultIndices,
+		std::vector<double>* resultDistances, unsigned int k, neighborDistance::Type distanceType) {
+	assert (queries != 0);
+	assert (resultIndices != 0);
+	assert (begin <= end);
+	assert (end <= queries->getSize());
+
+	if (k > numberOfPoints) {
+		throw runtime_error("Number of neighbors k is bigger than the amount of data points.");
+	}
+
+	resultIndices->resize((end - begin) * k);
+	if (resultDistances != 0) {
+		resultDistances->resize((end - begin) * k);
+	}
+	if (begin == end || k == 0) {
+		return;
+	}
+
+	/* queries only read the sub-trees; the small margin compensates the single precision of the sub-trees */
+	double maxSquaredDistance = (maxDistance < 0.0) ? -1.0 : maxDistance * maxDistance * (1.0 + 1e-5);
+	runBatchQuery(boost::bind(&NearestNeighborDynamicKDTree3D::searchNearest, this, _1, k, maxSquaredDistance, _2), queries->getStorage(),
+			begin, end, k, maxDistance, distanceType, &(*resultIndices)[0], (resultDistances != 0) ? &(*resultDistances)[0] : 0, numberOfThreads);
+}
+
+void NearestNeighborDynamicKDTree3D::findNeighborsWithinRadius(Point3D* query, std::vector<int>* resultIndices, double radius, unsigned int maxResults) {
+	findNeighborsWithinRadius(query, resultIndices, 0, radius, maxResults);
+}
+
+void NearestNeighborDynamicKDTree3D::findNeighborsWithinRadius(Point3D* query, std::vector<int>* resultIndices, std::vector<double>* resultDistances,
+		double radius, unsigned int maxResults, neighborDistance::Type distanceType) {
+	assert (query != 0);
+	assert (resultIndices != 0);
+
+	std::vector<std::pair<double, int> > neighbors;
+	searchRadius(query, radius, maxResults, neighbors);
+	copyRadiusNeighbors(neighbors, maxResults, resultIndices, resultDistances, distanceType);
+}
+
+unsigned int NearestNeighborDynamicKDTree3D::getSize() const {
+	return numberOfPoints;
+}
+
+unsigned int NearestNeighborDynamicKDTree3D::getNumberOfIndices() const {
+	return static_cast<unsigned int>(removed.size());
+}
+
+bool NearestNeighborDynamicKDTree3D::isRemoved(int index) const {
+	assert (index >= 0 && index < static_cast<int>(removed.size()));
+	return removed[index] != 0;
+}
+
+unsigned int NearestNeighborDynamicKDTree3D::getNumberOfSubtrees() const {
+	return static_cast<unsigned int>(subtrees.size());
+}
+
+}
+
+/* EOF */
@@ -0,0 +1,189 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#ifndef BRICS_3D_NEARESTNEIGHBORDYNAMICKDTREE3D_H_
+#define BRICS_3D_NEARESTNEIGHBORDYNAMICKDTREE3D_H_
+
+#include "brics_3d/algorithm/nearestNeighbor/INearestPoint3DNeighbor.h"
+#include "brics_3d/algorithm/nearestNeighbor/INearestNeighborSetup.h"
+#include "brics_3d/algorithm/nearestNeighbor/NearestNeighborKDTree3D.h"
+
+#include <boost/shared_ptr.hpp>
+
+namespace brics_3d {
+
+/**
+ * @ingroup nearestNeighbor
+ * @brief Nearest neighbor search for 3D points that supports appending and removing points.
+ *
+ * setData() of the other search structures rebuilds the whole index. This one keeps the points in a set of
+ * independent sub-trees (NearestNeighborKDTree3D) instead (log-structured, also known as the logarithmic method):
+ * - addPoints() builds a new sub-tree for the appended points only. Afterwards the newest sub-trees are merged as long
+ *   as a sub-tree is not more than twice as large as its successor. Thus there are at most O(log n) sub-trees and
+ *   each point takes part in O(log n) rebuilds on average.
+ * - removePoints() only marks the points as removed. A sub-tree is rebuilt without its removed points as soon as
+ *   these are the majority of the sub-tree.
+ *
+ * The cost of an update is therefore amortized proportional to the number of changed points, not to the size of
+ * the whole index. A query searches all sub-trees and merges the results.
+ *
+ * Each point gets a stable index in the order of insertion: setData() assigns the indices 0 to n-1, the points of
+ * each following addPoints() get the next consecutive indices. Indices of removed points are never reused. All
+ * queries return these indices. Note that the indices equal the ones of the point cloud only until points are
+ * removed or appended.
+ *
+ * Queries do not modify the structure, so batched queries are processed by several threads
+ * (see setNumberOfThreads()). Updates must not run concurrently with queries.
+ */
+class NearestNeighborDynamicKDTree3D : public INearestPoint3DNeighbor, public INearestNeighborSetup {
+public:
+
+	/**
+	 * @brief Standard constructor
+	 */
+	NearestNeighborDynamicKDTree3D();
+
+	/**
+	 * @brief Standard destructor
+	 */
+	virtual ~NearestNeighborDynamicKDTree3D();
+
+	/**
+	 * @brief Replace all points of the index. The points get the indices 0 to n-1.
+	 */
+	void setData(PointCloud3D* data);
+
+	/**
+	 * @brief Replace all points of the index by coordinate arrays.
+	 */
+	void setData(const PointCloud3DStorage* data);
+
+	/**
+	 * @brief Append points to the index.
+	 * @param points The new points.
+	 * @return Index of the first appended point. The others have the consecutive indices.
+	 */
+	unsigned int addPoints(PointCloud3D* points);
+
+	/**
+	 * @brief Append points given as coordinate arrays to the index.
+	 * @param points The new points.
+	 * @return Index of the first appended point. The others have the consecutive indices.
+	 */
+	unsigned int addPoints(const PointCloud3DStorage* points);
+
+	/**
+	 * @brief Remove points from the index.
+	 *
+	 * Indices of points that have already been removed are ignored.
+	 * @param indices Indices of the points as returned by the queries.
+	 * @throws runtime_error If an index has never been assigned to a point.
+	 */
+	void removePoints(const std::vector<int>& indices);
+
+	void findNearestNeighbors(Point3D* query, std::vector<int>* resultIndices, unsigned int k = 1);
+	void findNearestNeighbors(PointCloud3D* queries, std::vector<int>* resultIndices, unsigned int k = 1);
+	void findNearestNeighbors(PointCloud3D* queries, unsigned int begin, unsigned int end, std::vector<int>* resultIndices, unsigned int k = 1);
+	void findNeighborsWithinRadius(Point3D* query, std::vector<int>* resultIndices, double radius, unsigned int maxResults = 0);
+
+	void findNearestNeighbors(Point3D* query, std::vector<int>* resultIndices, std::vector<double>* resultDistances,
+			unsigned int k = 1, neighborDistance::Type distanceType = neighborDistance::euclidean);
+	void findNearestNeighbors(PointCloud3D* queries, unsigned int begin, unsigned int end, std::vector<int>* resultIndices,
+			std::vector<double>* resultDistances, unsigned int k = 1, neighborDistance::Type distanceType = neighborDistance::euclidean);
+	void findNeighborsWithinRadius(Point3D* query, std::vector<int>* resultIndices, std::vector<double>* resultDistances,
+			double radius, unsigned int maxResults = 0, neighborDistance::Type distanceType = neighborDistance::euclidean);
+
+	/**
+	 * @brief Number of points in the index, without the removed ones.
+	 */
+	unsigned int getSize() const;
+
+	/**
+	 * @brief Number of indices that have been assigned so far, i.e. the index the next appended point will get.
+	 */
+	unsigned int getNumberOfIndices() const;
+
+	/**
+	 * @brief Check if the point with the given index has been removed.
+	 */
+	bool isRemoved(int index) const;
+
+	/**
+	 * @brief Number of sub-trees that are searched by each query.
+	 */
+	unsigned int getNumberOfSubtrees() const;
+
+private:
+
+	/// Independent k-d tree for the points of a contiguous range of indices.
+	struct Subtree {
+		/// Search structure for the points
+		boost::shared_ptr<NearestNeighborKDTree3D> tree;
+
+		/// Coordinates of the points, required to merge or compact the sub-tree
+		PointCloud3DStorage points;
+
+		/// Index of each point of the sub-tree
+		std::vector<int> indices;
+
+		/// First index of the range covered by the sub-tree
+		unsigned int firstIndex;
+
+		/// Number of points of the sub-tree that have been removed
+		unsigned int removedCount;
+
+		/// Number of points that have not been removed
+		inline unsigned int getLiveSize() const {
+			return static_cast<unsigned int>(indices.size()) - removedCount;
+		}
+	};
+
+	/// (Re-)build the tree of a sub-tree from its points, without the removed ones.
+	void rebuild(Subtree& subtree) const;
+
+	/// Merge the newest sub-trees as long as a sub-tree is at most twice as large as its successor.
+	void mergeSubtrees();
+
+	/// Index of the sub-tree that covers an index
+	unsigned int findSubtree(unsigned int index) const;
+
+	/**
+	 * @brief k nearest neighbors of all sub-trees as (squared distance, index) pairs sorted by increasing distance.
+	 * @param maxSquaredDistance Only neighbors within this squared distance are considered. Negative values disable the bound.
+	 */
+	void searchNearest(const double query[3], unsigned int k, double maxSquaredDistance, std::vector<std::pair<double, int> >& neighbors) const;
+
+	/// Neighbors within the radius of all sub-trees as unsorted (squared distance, index) pairs.
+	void searchRadius(Point3D* query, double radius, unsigned int maxResults, std::vector<std::pair<double, int> >& neighbors) const;
+
+	/// Sub-trees ordered by their index ranges, the oldest and largest first
+	std::vector<Subtree> subtrees;
+
+	/// Removal flag of each index that has been assigned so far
+	std::vector<char> removed;
+
+	/// Number of points that have not been removed
+	unsigned int numberOfPoints;
+};
+
+}
+
+#endif /* BRICS_3D_NEARESTNEIGHBORDYNAMICKDTREE3D_H_ */
+
+/* EOF */
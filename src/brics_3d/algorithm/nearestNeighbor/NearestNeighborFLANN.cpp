@@ -22,6 +22,7 @@
 #include <assert.h>
 #include <stdexcept>
 #include <cmath>
+#include <algorithm>
 
 using std::runtime_error;
 
@@ -45,7 +46,10 @@ NearestNeighborFLANN::NearestNeighborFLANN() {
 }
 
 NearestNeighborFLANN::~NearestNeighborFLANN() {
-	flann_free_index(index_id, &parameters);
+	if (index_id != 0) {
+		flann_free_index(index_id, &parameters);
+	}
+	delete[] dataMatrix;
 }
 
 void NearestNeighborFLANN::setData(vector<vector<float> >* data) {
@@ -58,6 +62,7 @@ void NearestNeighborFLANN::setData(vector<vector<double> >* data) {
 	if (index_id != 0) { // clean up if previous versions exist
 		flann_free_index(index_id, &parameters);
 	}
+	delete[] dataMatrix;
 
 	dimension = (*data)[0].size();
 	rows = data->size();
@@ -84,6 +89,7 @@ void NearestNeighborFLANN::setData(PointCloud3D* data) {
 	if (index_id != 0) { // clean up if previous versions exist
 		flann_free_index(index_id, &parameters);
 	}
+	delete[] dataMatrix;
 
 	dimension = 3; //we work with a 3D points...
 	rows = data->getSize();
@@ -92,11 +98,47 @@ void NearestNeighborFLANN::setData(PointCloud3D* data) {
 	dataMatrix = new float[rows * cols];
 
 	// convert data
+	const PointCloud3DStorage* storage = data->getStorage();
+	const Coordinate* x = storage->getRawX();
+	const Coordinate* y = storage->getRawY();
+	const Coordinate* z = storage->getRawZ();
+	int matrixIndex = 0;
+	for (int rowIndex = 0; rowIndex < rows; ++rowIndex) {
+		dataMatrix[matrixIndex + 0] = static_cast<float> (x[rowIndex]);
+		dataMatrix[matrixIndex + 1] = static_cast<float> (y[rowIndex]);
+		dataMatrix[matrixIndex + 2] = static_cast<float> (z[rowIndex]);
+		matrixIndex += 3;
+	}
+
+	// create underlying data structure
+	index_id = flann_build_index(dataMatrix, rows, cols, &speedup, &parameters);
+
+}
+
+void NearestNeighborFLANN::setData(PointCloud3DF* data) {
+	assert(data != 0);
+
+	if (index_id != 0) { // clean up if previous versions exist
+		flann_free_index(index_id, &parameters);
+	}
+	delete[] dataMatrix;
+
+	dimension = 3; //we work with a 3D points...
+	rows = data->getSize();
+	cols = dimension;
+
+	dataMatrix = new float[rows * cols];
+
+	// interleave data
+	const PointCloud3DStorageF* storage = data->getStorage();
+	const float* x = storage->getRawX();
+	const float* y = storage->getRawY();
+	const float* z = storage->getRawZ();
 	int matrixIndex = 0;
 	for (int rowIndex = 0; rowIndex < rows; ++rowIndex) {
-		dataMatrix[matrixIndex + 0] = static_cast<float> ((*data->getPointCloud())[rowIndex].getX());
-		dataMatrix[matrixIndex + 1] = static_cast<float> ((*data->getPointCloud())[rowIndex].getY());
-		dataMatrix[matrixIndex + 2] = static_cast<float> ((*data->getPointCloud())[rowIndex].getZ());
+		dataMatrix[matrixIndex + 0] = x[rowIndex];
+		dataMatrix[matrixIndex + 1] = y[rowIndex];
+		dataMatrix[matrixIndex + 2] = z[rowIndex];
 		matrixIndex += 3;
 	}
 
@@ -117,73 +159,193 @@ void NearestNeighborFLANN::findNearestNeighbors(vector<double>* query, std::vect
 	if (static_cast<int>(query->size()) != dimension) {
 		throw runtime_error("Mismatch of query and data dimension.");
 	}
+
+	std::vector<float> queryData(dimension); //TODO: is there also a double version?!?
+	for (int i = 0; i < dimension; ++i) {
+		queryData[i] = static_cast<float>( (*query)[i] );
+	}
+	searchNearest(&queryData[0], k, resultIndices, 0, neighborDistance::euclidean);
+}
+
+void NearestNeighborFLANN::findNearestNeighbors(Point3D* query, std::vector<int>* resultIndices, unsigned int k) {
+	findNearestNeighbors(query, resultIndices, 0, k);
+}
+
+void NearestNeighborFLANN::findNearestNeighbors(Point3D* query, std::vector<int>* resultIndices, std::vector<double>* resultDistances, unsigned int k, neighborDistance::Type distanceType) {
+	assert (query != 0);
+	assert (resultIndices != 0);
+	assert (dimension == 3);
+
+	float queryData[3];
+	queryData[0] = static_cast<float> (query->getX());
+	queryData[1] = static_cast<float> (query->getY());
+	queryData[2] = static_cast<float> (query->getZ());
+	searchNearest(queryData, k, resultIndices, resultDistances, distanceType);
+}
+
+void NearestNeighborFLANN::searchNearest(float* query, unsigned int k, std::vector<int>* resultIndices, std::vector<double>* resultDistances, neighborDistance::Type distanceType) {
 	if (static_cast<int>(k) > this->rows) {
 		throw runtime_error("Number of neighbors k is bigger than the amount of data points.");
 	}
 
 	resultIndices->clear();
+	if (resultDistances != 0) {
+		resultDistances->clear();
+	}
+	if (k == 0) {
+		return;
+	}
+
 	int nn = static_cast<int>(k);
 	int tcount = 1;
-	int* result = new int[nn];
-	float* dists = new float[nn];
-
-	float* queryData = new float[dimension]; //TODO: is there also a double version?!?
-	for (int i = 0; i < dimension; ++i) {
-		queryData[i] = static_cast<float>( (*query)[i] );
-	}
+	std::vector<int> result(nn);
+	std::vector<float> dists(nn);
 
-	flann_find_nearest_neighbors_index(index_id, queryData, tcount, result, dists, nn, parameters.checks, &parameters);
+	flann_find_nearest_neighbors_index(index_id, query, tcount, &result[0], &dists[0], nn, parameters.checks, &parameters);
 
-	brics_3d::Coordinate resultDistance; //distance has same data-type as Coordinate, although the meaning is different TODO: global distance typedef?
-	int resultIndex;
+	double resultDistance;
 	for (int i = 0; i < nn; i++) {
-		resultDistance = static_cast<brics_3d::Coordinate>(sqrt(dists[i])); //seems to return squared distance (although documentation does not suggest)
-		resultIndex = result[i];
-		if (resultDistance <= maxDistance || maxDistance < 0.0) { //if max distance is < 0 then the distance should have no influence
-			resultIndices->push_back(resultIndex);
+		if (isWithinMaxDistance(dists[i], distanceType, resultDistance)) { //seems to return squared distance (although documentation does not suggest)
+			resultIndices->push_back(result[i]);
+			if (resultDistances != 0) {
+				resultDistances->push_back(resultDistance);
+			}
 		}
 	}
+}
 
-	delete[] queryData;
-	delete[] dists;
-	delete[] result;
+void NearestNeighborFLANN::findNearestNeighbors(PointCloud3D* queries, std::vector<int>* resultIndices, unsigned int k) {
+	assert (queries != 0);
+	findNearestNeighbors(queries, 0, queries->getSize(), resultIndices, 0, k);
 }
 
-void NearestNeighborFLANN::findNearestNeighbors(Point3D* query, std::vector<int>* resultIndices, unsigned int k) {
-	assert (query != 0);
+void NearestNeighborFLANN::findNearestNeighbors(PointCloud3D* queries, unsigned int begin, unsigned int end, std::vector<int>* resultIndices, unsigned int k) {
+	findNearestNeighbors(queries, begin, end, resultIndices, 0, k);
+}
+
+void NearestNeighborFLANN::findNearestNeighbors(PointCloud3D* queries, unsigned int begin, unsigned int end, std::vector<int>* resultIndices,
+		std::vector<double>* resultDistances, unsigned int k, neighborDistance::Type distanceType) {
+	assert (queries != 0);
 	assert (resultIndices != 0);
 	assert (dimension == 3);
+	assert (begin <= end);
+	assert (end <= queries->getSize());
 
 	if (static_cast<int>(k) > this->rows) {
 		throw runtime_error("Number of neighbors k is bigger than the amount of data points.");
 	}
 
-	resultIndices->clear();
+	resultIndices->resize((end - begin) * k);
+	if (resultDistances != 0) {
+		resultDistances->resize((end - begin) * k);
+	}
+	if (begin == end || k == 0) {
+		return;
+	}
+
+	/*
+	 * The FLANN index marks visited points within the index itself, so it can not be queried
+	 * concurrently. Instead all queries are passed to FLANN with a single call.
+	 */
+	int tcount = static_cast<int>(end - begin);
 	int nn = static_cast<int>(k);
-	int tcount = 1;
-	int* result = new int[nn];
-	float* dists = new float[nn];
+	std::vector<float> queryData(tcount * 3);
+	std::vector<float> dists(tcount * nn);
+
+	const PointCloud3DStorage* storage = queries->getStorage();
+	const Coordinate* x = storage->getRawX();
+	const Coordinate* y = storage->getRawY();
+	const Coordinate* z = storage->getRawZ();
+	for (int i = 0; i < tcount; ++i) {
+		queryData[3 * i + 0] = static_cast<float> (x[begin + i]);
+		queryData[3 * i + 1] = static_cast<float> (y[begin + i]);
+		queryData[3 * i + 2] = static_cast<float> (z[begin + i]);
+	}
+
+	int* result = &(*resultIndices)[0];
+	flann_find_nearest_neighbors_index(index_id, &queryData[0], tcount, result, &dists[0], nn, parameters.checks, &parameters);
+
+	double resultDistance;
+	for (int i = 0; i < tcount * nn; ++i) {
+		if (!isWithinMaxDistance(dists[i], distanceType, resultDistance)) {
+			result[i] = -1;
+			resultDistance = -1.0;
+		}
+		if (resultDistances != 0) {
+			(*resultDistances)[i] = resultDistance;
+		}
+	}
+}
+
+void NearestNeighborFLANN::findNeighborsWithinRadius(vector<double>* query, std::vector<int>* resultIndices, double radius, unsigned int maxResults) {
+	assert (query != 0);
+	assert (resultIndices != 0);
 
-	float* queryData = new float[dimension];
+	if (static_cast<int>(query->size()) != dimension) {
+		throw runtime_error("Mismatch of query and data dimension.");
+	}
+
+	std::vector<float> queryData(dimension);
+	for (int i = 0; i < dimension; ++i) {
+		queryData[i] = static_cast<float>( (*query)[i] );
+	}
+	searchRadius(&queryData[0], radius, maxResults, resultIndices, 0, neighborDistance::euclidean);
+}
+
+void NearestNeighborFLANN::findNeighborsWithinRadius(Point3D* query, std::vector<int>* resultIndices, double radius, unsigned int maxResults) {
+	findNeighborsWithinRadius(query, resultIndices, 0, radius, maxResults);
+}
+
+void NearestNeighborFLANN::findNeighborsWithinRadius(Point3D* query, std::vector<int>* resultIndices, std::vector<double>* resultDistances,
+		double radius, unsigned int maxResults, neighborDistance::Type distanceType) {
+	assert (query != 0);
+	assert (resultIndices != 0);
+	assert (dimension == 3);
+
+	float queryData[3];
 	queryData[0] = static_cast<float> (query->getX());
 	queryData[1] = static_cast<float> (query->getY());
 	queryData[2] = static_cast<float> (query->getZ());
+	searchRadius(queryData, radius, maxResults, resultIndices, resultDistances, distanceType);
+}
 
-	flann_find_nearest_neighbors_index(index_id, queryData, tcount, result, dists, nn, parameters.checks, &parameters);
+void NearestNeighborFLANN::searchRadius(float* query, double radius, unsigned int maxResults, std::vector<int>* resultIndices,
+		std::vector<double>* resultDistances, neighborDistance::Type distanceType) {
+	resultIndices->clear();
+	if (resultDistances != 0) {
+		resultDistances->clear();
+	}
+	if (radius < 0.0 || rows <= 0) {
+		return;
+	}
+	float squaredRadius = static_cast<float>(radius * radius); // FLANN works with squared distances
 
-	brics_3d::Coordinate resultDistance; //distance has same data-type as Coordinate, although the meaning is different TODO: global distance typedef?
-	int resultIndex;
-	for (int i = 0; i < nn; i++) {
-		resultDistance = static_cast<brics_3d::Coordinate>(sqrt(dists[i])); //seems to return squared distance (although documentation does not suggest)
-		resultIndex = result[i];
-		if (resultDistance <= maxDistance || maxDistance < 0.0) { //if max distance is < 0 then the distance should have no influence
-			resultIndices->push_back(resultIndex);
-		}
+	/* FLANN returns the total number of points in range, so the buffers can be enlarged for a second run if required */
+	const int defaultBufferSize = 64;
+	int bufferSize = (maxResults > 0) ? std::min(static_cast<int>(maxResults), rows) : std::min(defaultBufferSize, rows);
+	std::vector<int> indices(bufferSize);
+	std::vector<float> dists(bufferSize);
+
+	int pointsInRange = flann_radius_search(index_id, query, &indices[0], &dists[0], bufferSize, squaredRadius, parameters.checks, &parameters);
+	if (pointsInRange < 0) {
+		throw runtime_error("FLANN radius search failed.");
+	}
+	if (maxResults == 0 && pointsInRange > bufferSize) {
+		bufferSize = pointsInRange;
+		indices.resize(bufferSize);
+		dists.resize(bufferSize);
+		pointsInRange = flann_radius_search(index_id, query, &indices[0], &dists[0], bufferSize, squaredRadius, parameters.checks, &parameters);
 	}
 
-	delete[] queryData;
-	delete[] dists;
-	delete[] result;
+	/* results are sorted by increasing distance */
+	int numberOfNeighbors = std::min(pointsInRange, bufferSize);
+	resultIndices->assign(indices.begin(), indices.begin() + numberOfNeighbors);
+	if (resultDistances != 0) {
+		resultDistances->resize(numberOfNeighbors);
+		for (int i = 0; i < numberOfNeighbors; ++i) {
+			(*resultDistances)[i] = (distanceType == neighborDistance::squaredEuclidean) ? dists[i] : std::sqrt(static_cast<double>(dists[i]));
+		}
+	}
 }
 
 FLANNParameters NearestNeighborFLANN::getParameters() const {
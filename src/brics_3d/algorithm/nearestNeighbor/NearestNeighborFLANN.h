@@ -23,6 +23,7 @@
 #include "brics_3d/algorithm/nearestNeighbor/INearestNeighbor.h"
 #include "brics_3d/algorithm/nearestNeighbor/INearestPoint3DNeighbor.h"
 #include "brics_3d/algorithm/nearestNeighbor/INearestNeighborSetup.h"
+#include "brics_3d/core/PointCloud3DF.h"
 #include "flann/src/cpp/flann.h"
 
 namespace brics_3d {
@@ -49,9 +50,33 @@ public:
 	void setData(vector< vector<double> >* data);
 	void setData(PointCloud3D* data);
 
+	/**
+	 * @brief Set the data of a single precision point cloud.
+	 * As FLANN works internally with float values no conversion of the coordinates is needed.
+	 */
+	void setData(PointCloud3DF* data);
+
 	void findNearestNeighbors(vector<float>* query, std::vector<int>* resultIndices, unsigned int k = 1);
 	void findNearestNeighbors(vector<double>* query, std::vector<int>* resultIndices, unsigned int k = 1);
 	void findNearestNeighbors(Point3D* query, std::vector<int>* resultIndices, unsigned int k = 1);
+	void findNearestNeighbors(PointCloud3D* queries, std::vector<int>* resultIndices, unsigned int k = 1);
+	void findNearestNeighbors(PointCloud3D* queries, unsigned int begin, unsigned int end, std::vector<int>* resultIndices, unsigned int k = 1);
+
+	/**
+	 * @brief Fixed radius search.
+	 *
+	 * Like the k nearest neighbor search the result is approximate: only the number of leafs set by the "checks"
+	 * parameter are visited, so points within the radius might be missing.
+	 */
+	void findNeighborsWithinRadius(vector<double>* query, std::vector<int>* resultIndices, double radius, unsigned int maxResults = 0);
+	void findNeighborsWithinRadius(Point3D* query, std::vector<int>* resultIndices, double radius, unsigned int maxResults = 0);
+
+	void findNearestNeighbors(Point3D* query, std::vector<int>* resultIndices, std::vector<double>* resultDistances,
+			unsigned int k = 1, neighborDistance::Type distanceType = neighborDistance::euclidean);
+	void findNearestNeighbors(PointCloud3D* queries, unsigned int begin, unsigned int end, std::vector<int>* resultIndices,
+			std::vector<double>* resultDistances, unsigned int k = 1, neighborDistance::Type distanceType = neighborDistance::euclidean);
+	void findNeighborsWithinRadius(Point3D* query, std::vector<int>* resultIndices, std::vector<double>* resultDistances,
+			double radius, unsigned int maxResults = 0, neighborDistance::Type distanceType = neighborDistance::euclidean);
 
 	FLANNParameters getParameters() const;
 
@@ -65,6 +90,18 @@ public:
 
 private:
 
+	/**
+	 * @brief k nearest neighbor search for a query with the dimension of the data.
+	 * @param resultDistances Optional, might be 0.
+	 */
+	void searchNearest(float* query, unsigned int k, std::vector<int>* resultIndices, std::vector<double>* resultDistances, neighborDistance::Type distanceType);
+
+	/**
+	 * @brief Fixed radius search for a query with the dimension of the data.
+	 * @param resultDistances Optional, might be 0.
+	 */
+	void searchRadius(float* query, double radius, unsigned int maxResults, std::vector<int>* resultIndices, std::vector<double>* resultDistances, neighborDistance::Type distanceType);
+
 	/// Matrix in major-row representation
 	float* dataMatrix;
 
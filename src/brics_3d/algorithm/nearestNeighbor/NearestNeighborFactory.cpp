@@ -0,0 +1,169 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#include "NearestNeighborFactory.h"
+#include "brics_3d/util/ConfigurationFileHandler.h"
+#include "brics_3d/algorithm/nearestNeighbor/NearestNeighborANN.h"
+#include "brics_3d/algorithm/nearestNeighbor/NearestNeighborFLANN.h"
+#include "brics_3d/algorithm/nearestNeighbor/NearestNeighborSTANN.h"
+#include "brics_3d/algorithm/nearestNeighbor/NearestNeighborKDTree3D.h"
+#include "brics_3d/algorithm/nearestNeighbor/NearestNeighborVoxelGrid.h"
+#include "brics_3d/algorithm/nearestNeighbor/NearestNeighborDynamicKDTree3D.h"
+
+#include <fstream>
+#include <sstream>
+
+using std::endl;
+using std::string;
+
+namespace brics_3d {
+
+NearestNeighborConfiguration::NearestNeighborConfiguration() {
+	implementation = "NearestNeighborKDTree3D";
+	flannAlgorithm = "KDTREE";
+	trees = 8;
+	checks = 32;
+	branching = 32;
+	voxelSize = 0.0;
+}
+
+std::string NearestNeighborConfiguration::toString() const {
+	std::stringstream description;
+	description << implementation;
+	if (implementation.compare("NearestNeighborFLANN") == 0) {
+		description << " (" << flannAlgorithm;
+		if (flannAlgorithm.compare("KDTREE") == 0) {
+			description << ", trees = " << trees;
+		} else if (flannAlgorithm.compare("KMEANS") == 0) {
+			description << ", branching = " << branching;
+		}
+		description << ", checks = " << checks << ")";
+	} else if (implementation.compare("NearestNeighborVoxelGrid") == 0) {
+		description << " (voxelSize = " << voxelSize << ")";
+	}
+	return description.str();
+}
+
+NearestNeighborFactory::NearestNeighborFactory() {
+
+}
+
+NearestNeighborFactory::~NearestNeighborFactory() {
+
+}
+
+INearestPoint3DNeighborPtr NearestNeighborFactory::createNearestNeighbor() {
+	return INearestPoint3DNeighborPtr(new NearestNeighborKDTree3D());
+}
+
+INearestPoint3DNeighborPtr NearestNeighborFactory::createNearestNeighbor(const NearestNeighborConfiguration& configuration) {
+	const string& implementation = configuration.implementation;
+
+	if (implementation.compare("NearestNeighborKDTree3D") == 0) {
+		return INearestPoint3DNeighborPtr(new NearestNeighborKDTree3D());
+
+	} else if (implementation.compare("NearestNeighborANN") == 0) {
+		return INearestPoint3DNeighborPtr(new NearestNeighborANN());
+
+	} else if (implementation.compare("NearestNeighborSTANN") == 0) {
+		return INearestPoint3DNeighborPtr(new NearestNeighborSTANN());
+
+	} else if (implementation.compare("NearestNeighborVoxelGrid") == 0) {
+		return INearestPoint3DNeighborPtr(new NearestNeighborVoxelGrid(configuration.voxelSize));
+
+	} else if (implementation.compare("NearestNeighborDynamicKDTree3D") == 0) {
+		return INearestPoint3DNeighborPtr(new NearestNeighborDynamicKDTree3D());
+
+	} else if (implementation.compare("NearestNeighborFLANN") == 0) {
+		NearestNeighborFLANN* flann = new NearestNeighborFLANN();
+		FLANNParameters parameters = flann->getParameters();
+		if (configuration.flannAlgorithm.compare("KDTREE") == 0) {
+			parameters.algorithm = KDTREE;
+		} else if (configuration.flannAlgorithm.compare("KMEANS") == 0) {
+			parameters.algorithm = KMEANS;
+		} else if (configuration.flannAlgorithm.compare("LINEAR") == 0) {
+			parameters.algorithm = LINEAR;
+		} else {
+			LOG(WARNING) << "FLANN algorithm " << configuration.flannAlgorithm << " not found. Factory will provide default algorithm: KDTREE";
+		}
+		parameters.trees = configuration.trees;
+		parameters.checks = configuration.checks;
+		parameters.branching = configuration.branching;
+		flann->setParameters(parameters);
+		return INearestPoint3DNeighborPtr(flann);
+	}
+
+	LOG(WARNING) << "Nearest neighbor implementation " << implementation << " not found. Factory will provide default configuration: NearestNeighborKDTree3D";
+	return createNearestNeighbor();
+}
+
+INearestPoint3DNeighborPtr NearestNeighborFactory::createNearestNeighbor(std::string configurationFile) {
+	if (((configurationFile.compare("")) == 0) || (configurationFile.compare("default") == 0)) {
+		return createNearestNeighbor();
+	}
+
+	NearestNeighborConfiguration configuration;
+	if (!readConfiguration(configurationFile, &configuration)) {
+		LOG(WARNING) << "Errors during parsing configuration file. Factory will provide default configuration.";
+		return createNearestNeighbor();
+	}
+	LOG(INFO) << "Nearest neighbor configuration: " << configuration.toString();
+
+	return createNearestNeighbor(configuration);
+}
+
+bool NearestNeighborFactory::readConfiguration(std::string configurationFile, NearestNeighborConfiguration* configuration) {
+	assert(configuration != 0);
+	ConfigurationFileHandler configReader(configurationFile);
+	if (configReader.getErrorsOccured()) {
+		return false;
+	}
+
+	if (!configReader.getAttribute("NearestNeighbor", "implementation", &configuration->implementation)) {
+		return false;
+	}
+	configReader.getAttribute("NearestNeighbor", "algorithm", &configuration->flannAlgorithm);
+	configReader.getAttribute("NearestNeighbor", "trees", &configuration->trees);
+	configReader.getAttribute("NearestNeighbor", "checks", &configuration->checks);
+	configReader.getAttribute("NearestNeighbor", "branching", &configuration->branching);
+	configReader.getAttribute("NearestNeighbor", "voxelSize", &configuration->voxelSize);
+	return true;
+}
+
+bool NearestNeighborFactory::writeConfiguration(std::string configurationFile, const NearestNeighborConfiguration& configuration) {
+	std::ofstream outputFile(configurationFile.c_str());
+	if (!outputFile.is_open()) {
+		LOG(ERROR) << "Cannot write the configuration file " << configurationFile;
+		return false;
+	}
+	outputFile.precision(17);
+	outputFile << "<!DOCTYPE dummy>" << endl;
+	outputFile << "<BRICS_3D-Configuration>" << endl << endl;
+	outputFile << "  <NearestNeighbor implementation=\"" << configuration.implementation << "\" algorithm=\""
+			<< configuration.flannAlgorithm << "\" trees=\"" << configuration.trees << "\" checks=\"" << configuration.checks
+			<< "\" branching=\"" << configuration.branching << "\" voxelSize=\"" << configuration.voxelSize
+			<< "\"></NearestNeighbor>" << endl << endl;
+	outputFile << "</BRICS_3D-Configuration>" << endl;
+	outputFile.close();
+	return !outputFile.fail();
+}
+
+}
+
+/* EOF */
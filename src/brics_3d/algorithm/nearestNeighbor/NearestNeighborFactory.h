@@ -0,0 +1,145 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#ifndef BRICS_3D_NEARESTNEIGHBORFACTORY_H_
+#define BRICS_3D_NEARESTNEIGHBORFACTORY_H_
+
+#include "brics_3d/core/Logger.h"
+#include "brics_3d/algorithm/nearestNeighbor/INearestPoint3DNeighbor.h"
+#include <string>
+
+#include <boost/shared_ptr.hpp>
+
+namespace brics_3d {
+
+typedef boost::shared_ptr<INearestPoint3DNeighbor> INearestPoint3DNeighborPtr;
+
+/**
+ * @ingroup nearestNeighbor
+ * @brief Backend and parameters of a nearest neighbor search, as used by the NearestNeighborFactory.
+ */
+struct NearestNeighborConfiguration {
+
+	/**
+	 * @brief Standard constructor. Sets up the default configuration: NearestNeighborKDTree3D.
+	 */
+	NearestNeighborConfiguration();
+
+	/**
+	 * @brief Class name of the implementation: NearestNeighborANN, NearestNeighborFLANN, NearestNeighborSTANN,
+	 * NearestNeighborKDTree3D, NearestNeighborVoxelGrid or NearestNeighborDynamicKDTree3D.
+	 */
+	std::string implementation;
+
+	/// FLANN only: search structure, KDTREE, KMEANS or LINEAR
+	std::string flannAlgorithm;
+
+	/// FLANN only: number of randomized k-d trees
+	int trees;
+
+	/// FLANN only: number of leafs that are checked by a query. Higher values increase accuracy and query time.
+	int checks;
+
+	/// FLANN only: branching factor of the k-means tree
+	int branching;
+
+	/// NearestNeighborVoxelGrid only: edge length of a voxel, 0 for an estimated size
+	double voxelSize;
+
+	/// Human readable description, e.g. for log messages
+	std::string toString() const;
+};
+
+/**
+ * @ingroup nearestNeighbor
+ * @brief Nearest neighbor search factory that can be configured with a XML file
+ *
+ * The configuration files can be generated by the NearestNeighborTuner, so the result of a tuning run can be
+ * cached and reused for similar data.
+ */
+class NearestNeighborFactory {
+public:
+
+	/**
+	 * @brief Standard constructor
+	 */
+	NearestNeighborFactory();
+
+	/**
+	 * @brief Standard destructor
+	 */
+	virtual ~NearestNeighborFactory();
+
+	/**
+	 * @brief Factory method the returns a nearest neighbor search in the standard configuration.
+	 */
+	INearestPoint3DNeighborPtr createNearestNeighbor();
+
+	/**
+	 * @brief Factory method the returns a nearest neighbor search with the given backend and parameters.
+	 *
+	 * An unknown implementation will be handled as warning and the default configuration is chosen.
+	 */
+	INearestPoint3DNeighborPtr createNearestNeighbor(const NearestNeighborConfiguration& configuration);
+
+	/**
+	 * @brief Factory method the returns a nearest neighbor search configured by an XML file
+	 *
+	 * Wrong parameters descriptions in the XML file will be handled as warnings and the default parameter is chosen.
+	 *
+	 * @param configurationFile Path to the XML configuration file
+	 * @return Returns an instance of the abstract nearest neighbor interface
+	 *
+	 * <br><b>Example XML file:</b><br>
+	 * <code>
+	 * <!DOCTYPE dummy> <br>
+	 * <BRICS_3D-Configuration> <br> <br>
+	 *
+	 * &nbsp;&nbsp;<NearestNeighbor implementation="NearestNeighborFLANN" algorithm="KDTREE" trees="4" checks="64"
+	 * branching="32" voxelSize="0"></NearestNeighbor> <br> <br>
+	 *
+	 * </BRICS_3D-Configuration>
+	 * </code>
+	 * <br><br>
+	 * <b>NOTE1:</b> The configuration file parser bases on the Xerces library (see ConfigurationFileHandler).
+	 * If it is not installed the default configuration is chosen.<br>
+	 */
+	INearestPoint3DNeighborPtr createNearestNeighbor(std::string configurationFile);
+
+	/**
+	 * @brief Read a configuration from an XML file as described for createNearestNeighbor().
+	 * @param[in] configurationFile Path to the XML configuration file
+	 * @param[out] configuration Parameters that are missing in the file keep their values.
+	 * @return True if the file has been parsed and contains an implementation.
+	 */
+	bool readConfiguration(std::string configurationFile, NearestNeighborConfiguration* configuration);
+
+	/**
+	 * @brief Write a configuration into an XML file that can be used with createNearestNeighbor().
+	 * @return False if the file could not be written.
+	 */
+	bool writeConfiguration(std::string configurationFile, const NearestNeighborConfiguration& configuration);
+
+};
+
+}
+
+#endif /* BRICS_3D_NEARESTNEIGHBORFACTORY_H_ */
+
+/* EOF */
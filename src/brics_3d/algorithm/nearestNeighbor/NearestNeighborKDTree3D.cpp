@@ -0,0 +1,859 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#include "NearestNeighborKDTree3D.h"
+#include "NearestNeighborBatchQuery.h"
+#include "brics_3d/core/Logger.h"
+
+#include <assert.h>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+using std::runtime_error;
+
+namespace brics_3d {
+
+namespace {
+
+/// Width of the SIMD leaf scan. Leafs are padded to a multiple of this value.
+const unsigned int scanWidth = 4;
+
+/// Relative coordinate of padding entries. Its squared distance overflows to infinity, so it never becomes a neighbor.
+const float paddingCoordinate = 1e20f;
+
+/// Identifies the files written by NearestNeighborKDTree3D::save()
+const char fileMagic[8] = {'B', 'R', 'I', 'C', 'S', 'K', 'D', '3'};
+
+/// Has to be incremented with every change of the file layout
+const boost::uint32_t fileVersion = 1;
+
+/// Written as is, so a file from a host with a different byte order is detected
+const boost::uint32_t fileByteOrder = 0x01020304;
+
+/// Alignment of the arrays within a file
+const unsigned long fileAlignment = 16;
+
+/// Header of a saved tree. It is followed by the arrays, see FileLayout.
+struct FileHeader {
+	char magic[8];
+	boost::uint32_t version;
+	boost::uint32_t byteOrder;
+	boost::uint32_t coordinateSize;
+	boost::uint32_t nodeSize;
+	boost::uint32_t numberOfPoints;
+	boost::uint32_t numberOfNodes;
+	boost::uint32_t numberOfLeafEntries;
+	boost::uint32_t numberOfLeafs;
+	boost::uint32_t maxLeafSize;
+	boost::uint32_t reserved;
+	boost::uint64_t dataHash;
+};
+
+/// Byte offsets of the arrays of a saved tree
+struct FileLayout {
+	enum Section {
+		nodes,
+		leafCenters,
+		leafX,
+		leafY,
+		leafZ,
+		leafIndices,
+		x,
+		y,
+		z,
+		numberOfSections
+	};
+
+	/// The sizes are computed with 64 bit, so the counts of a corrupt header cannot overflow.
+	explicit FileLayout(const FileHeader& header) {
+		const boost::uint64_t numberOfNodes = header.numberOfNodes;
+		const boost::uint64_t numberOfLeafs = header.numberOfLeafs;
+		const boost::uint64_t numberOfLeafEntries = header.numberOfLeafEntries;
+		const boost::uint64_t numberOfPoints = header.numberOfPoints;
+		boost::uint64_t sizes[numberOfSections] = {
+				numberOfNodes * header.nodeSize,
+				3 * numberOfLeafs * sizeof(double),
+				numberOfLeafEntries * sizeof(float),
+				numberOfLeafEntries * sizeof(float),
+				numberOfLeafEntries * sizeof(float),
+				numberOfLeafEntries * sizeof(int),
+				numberOfPoints * header.coordinateSize,
+				numberOfPoints * header.coordinateSize,
+				numberOfPoints * header.coordinateSize};
+		boost::uint64_t offset = sizeof(FileHeader);
+		for (int i = 0; i < numberOfSections; ++i) {
+			offset = (offset + fileAlignment - 1) / fileAlignment * fileAlignment;
+			offsets[i] = offset;
+			offset += sizes[i];
+		}
+		size = offset;
+	}
+
+	boost::uint64_t offsets[numberOfSections];
+	boost::uint64_t size;
+};
+
+/// FNV-1a hash of an array, processed in words of 64 bit.
+inline boost::uint64_t hashArray(const void* data, unsigned long size, boost::uint64_t hash) {
+	const boost::uint64_t prime = 0x100000001B3ULL;
+	const char* bytes = static_cast<const char*>(data);
+	unsigned long i = 0;
+	for (; i + sizeof(boost::uint64_t) <= size; i += sizeof(boost::uint64_t)) {
+		boost::uint64_t word;
+		memcpy(&word, bytes + i, sizeof(word));
+		hash = (hash ^ word) * prime;
+	}
+	for (; i < size; ++i) {
+		hash = (hash ^ static_cast<unsigned char>(bytes[i])) * prime;
+	}
+	return hash;
+}
+
+/// Write an array at its offset of the file layout.
+inline void writeSection(std::ofstream& outputFile, unsigned long offset, const void* data, unsigned long size) {
+	static const char padding[fileAlignment] = {0};
+	unsigned long position = static_cast<unsigned long>(outputFile.tellp());
+	assert (position <= offset && offset - position < fileAlignment);
+	outputFile.write(padding, offset - position);
+	if (size > 0) {
+		outputFile.write(static_cast<const char*>(data), size);
+	}
+}
+
+/// Orders point indices by one of their coordinates.
+struct CoordinateLess {
+	CoordinateLess(const Coordinate* coordinates) : coordinates(coordinates) {}
+	bool operator()(unsigned int a, unsigned int b) const {
+		return coordinates[a] < coordinates[b];
+	}
+	const Coordinate* coordinates;
+};
+
+/*
+ * Squared distances of the query to all entries of a leaf. Every entry that is within
+ * candidates.threshold() is offered to the candidates.
+ */
+template <typename Candidates>
+inline void offerEntry(float squaredDistance, int index, const Coordinate* const points[3], const double query[3], Candidates& candidates) {
+	if (candidates.exactRadius >= 0.0) { // recompute with the original coordinates, compared as in isWithinMaxDistance()
+		double dx = points[0][index] - query[0];
+		double dy = points[1][index] - query[1];
+		double dz = points[2][index] - query[2];
+		double exactSquaredDistance = dx * dx + dy * dy + dz * dz;
+		if (std::sqrt(exactSquaredDistance) > candidates.exactRadius) {
+			return;
+		}
+		squaredDistance = static_cast<float>(exactSquaredDistance);
+	}
+	candidates.insert(squaredDistance, index);
+}
+
+template <typename Candidates>
+inline void scanLeaf(const float* x, const float* y, const float* z, const int* indices, unsigned int begin, unsigned int end,
+		const double center[3], const Coordinate* const points[3], const double query[3], Candidates& candidates) {
+	float queryX = static_cast<float>(query[0] - center[0]);
+	float queryY = static_cast<float>(query[1] - center[1]);
+	float queryZ = static_cast<float>(query[2] - center[2]);
+#ifdef __SSE__
+	__m128 qx = _mm_set1_ps(queryX);
+	__m128 qy = _mm_set1_ps(queryY);
+	__m128 qz = _mm_set1_ps(queryZ);
+	float squaredDistances[scanWidth];
+
+	for (unsigned int i = begin; i < end; i += scanWidth) {
+		__m128 dx = _mm_sub_ps(_mm_loadu_ps(x + i), qx);
+		__m128 dy = _mm_sub_ps(_mm_loadu_ps(y + i), qy);
+		__m128 dz = _mm_sub_ps(_mm_loadu_ps(z + i), qz);
+		__m128 squaredDistance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+		int mask = _mm_movemask_ps(_mm_cmple_ps(squaredDistance, _mm_set1_ps(candidates.threshold())));
+		if (mask == 0) {
+			continue;
+		}
+		_mm_storeu_ps(squaredDistances, squaredDistance);
+		for (unsigned int j = 0; j < scanWidth; ++j) {
+			if (mask & (1 << j)) {
+				offerEntry(squaredDistances[j], indices[i + j], points, query, candidates);
+			}
+		}
+	}
+#else
+	for (unsigned int i = begin; i < end; ++i) {
+		float dx = x[i] - queryX;
+		float dy = y[i] - queryY;
+		float dz = z[i] - queryZ;
+		float squaredDistance = dx * dx + dy * dy + dz * dz;
+		if (squaredDistance <= candidates.threshold()) {
+			offerEntry(squaredDistance, indices[i], points, query, candidates);
+		}
+	}
+#endif
+}
+
+}
+
+/**
+ * Result set of a query. For k > 0 the k closest entries are kept sorted by increasing squared
+ * distance, for k = 0 all offered entries are collected (fixed radius search).
+ *
+ * With an exact radius (>= 0) entries that pass the single precision bound are checked again with
+ * their distance in double precision.
+ */
+struct NearestNeighborKDTree3D::Candidates {
+
+	void reset(unsigned int k, float bound, double exactRadius = -1.0) {
+		this->k = k;
+		this->bound = bound;
+		this->exactRadius = exactRadius;
+		count = 0;
+		squaredDistances.resize(k);
+		indices.resize(k);
+	}
+
+	/// Squared distance an entry must not exceed to be inserted.
+	inline float threshold() const {
+		return (k == 0 || count < k) ? bound : squaredDistances[k - 1];
+	}
+
+	inline void insert(float squaredDistance, int index) {
+		if (k == 0) {
+			squaredDistances.push_back(squaredDistance);
+			indices.push_back(index);
+			count++;
+			return;
+		}
+
+		unsigned int position;
+		if (count < k) {
+			position = count++;
+		} else if (squaredDistance < squaredDistances[k - 1]) {
+			position = k - 1;
+		} else {
+			return;
+		}
+		while (position > 0 && squaredDistances[position - 1] > squaredDistance) {
+			squaredDistances[position] = squaredDistances[position - 1];
+			indices[position] = indices[position - 1];
+			position--;
+		}
+		squaredDistances[position] = squaredDistance;
+		indices[position] = index;
+	}
+
+	unsigned int k;
+	float bound;
+	double exactRadius;
+	unsigned int count;
+	std::vector<float> squaredDistances;
+	std::vector<int> indices;
+};
+
+NearestNeighborKDTree3D::NearestNeighborKDTree3D() {
+	this->dimension = -1;
+	this->maxDistance = -1; //default = disable
+	numberOfPoints = 0;
+	maxLeafSize = 16;
+	useOwnArrays();
+}
+
+NearestNeighborKDTree3D::~NearestNeighborKDTree3D() {
+
+}
+
+void NearestNeighborKDTree3D::setData(vector<vector<float> >* data) {
+	assert(data != 0);
+	assert(data->size() >= 1); // at least one element!
+	if ((*data)[0].size() != 3) {
+		throw runtime_error("NearestNeighborKDTree3D only supports data with 3 dimensions.");
+	}
+
+	std::vector<Coordinate> x(data->size()), y(data->size()), z(data->size());
+	for (unsigned int i = 0; i < data->size(); ++i) {
+		x[i] = (*data)[i][0];
+		y[i] = (*data)[i][1];
+		z[i] = (*data)[i][2];
+	}
+	build(&x[0], &y[0], &z[0], static_cast<unsigned int>(data->size()));
+}
+
+void NearestNeighborKDTree3D::setData(vector<vector<double> >* data) {
+	assert(data != 0);
+	assert(data->size() >= 1); // at least one element!
+	if ((*data)[0].size() != 3) {
+		throw runtime_error("NearestNeighborKDTree3D only supports data with 3 dimensions.");
+	}
+
+	std::vector<Coordinate> x(data->size()), y(data->size()), z(data->size());
+	for (unsigned int i = 0; i < data->size(); ++i) {
+		x[i] = (*data)[i][0];
+		y[i] = (*data)[i][1];
+		z[i] = (*data)[i][2];
+	}
+	build(&x[0], &y[0], &z[0], static_cast<unsigned int>(data->size()));
+}
+
+void NearestNeighborKDTree3D::setData(PointCloud3D* data) {
+	assert(data != 0);
+	setData(data->getStorage());
+}
+
+void NearestNeighborKDTree3D::setData(const PointCloud3DStorage* data) {
+	assert(data != 0);
+	build(data->getRawX(), data->getRawY(), data->getRawZ(), data->getSize());
+}
+
+void NearestNeighborKDTree3D::build(const Coordinate* x, const Coordinate* y, const Coordinate* z, unsigned int size) {
+	dimension = 3;
+	numberOfPoints = size;
+	nodes.clear();
+	leafX.clear();
+	leafY.clear();
+	leafZ.clear();
+	leafIndices.clear();
+	leafCenters.clear();
+	pointX.clear();
+	pointY.clear();
+	pointZ.clear();
+	if (size == 0) {
+		useOwnArrays();
+		return;
+	}
+
+	std::vector<unsigned int> indices(size);
+	for (unsigned int i = 0; i < size; ++i) {
+		indices[i] = i;
+	}
+
+	unsigned int estimatedLeafs = 2 * size / maxLeafSize + 1;
+	nodes.reserve(2 * estimatedLeafs);
+	leafX.reserve(size + scanWidth * estimatedLeafs);
+	leafY.reserve(size + scanWidth * estimatedLeafs);
+	leafZ.reserve(size + scanWidth * estimatedLeafs);
+	leafIndices.reserve(size + scanWidth * estimatedLeafs);
+	leafCenters.reserve(3 * estimatedLeafs);
+
+	const Coordinate* coordinates[3] = {x, y, z};
+	buildNode(&indices[0], 0, size, coordinates);
+	pointX.assign(x, x + size);
+	pointY.assign(y, y + size);
+	pointZ.assign(z, z + size);
+	useOwnArrays();
+}
+
+void NearestNeighborKDTree3D::useOwnArrays() {
+	mappedFile.reset();
+	storedX = pointX.empty() ? 0 : &pointX[0];
+	storedY = pointY.empty() ? 0 : &pointY[0];
+	storedZ = pointZ.empty() ? 0 : &pointZ[0];
+	numberOfNodes = static_cast<unsigned int>(nodes.size());
+	nodeArray = nodes.empty() ? 0 : &nodes[0];
+	leafXArray = leafX.empty() ? 0 : &leafX[0];
+	leafYArray = leafY.empty() ? 0 : &leafY[0];
+	leafZArray = leafZ.empty() ? 0 : &leafZ[0];
+	leafIndexArray = leafIndices.empty() ? 0 : &leafIndices[0];
+	leafCenterArray = leafCenters.empty() ? 0 : &leafCenters[0];
+}
+
+unsigned int NearestNeighborKDTree3D::buildNode(unsigned int* indices, unsigned int begin, unsigned int end, const Coordinate* coordinates[3]) {
+	unsigned int nodeIndex = static_cast<unsigned int>(nodes.size());
+	nodes.push_back(Node());
+
+	/* bounding box */
+	double minimum[3];
+	double maximum[3];
+	for (int d = 0; d < 3; ++d) {
+		minimum[d] = coordinates[d][indices[begin]];
+		maximum[d] = minimum[d];
+	}
+	for (unsigned int i = begin + 1; i < end; ++i) {
+		for (int d = 0; d < 3; ++d) {
+			double value = coordinates[d][indices[i]];
+			minimum[d] = std::min(minimum[d], value);
+			maximum[d] = std::max(maximum[d], value);
+		}
+	}
+	int splitDimension = 0;
+	for (int d = 1; d < 3; ++d) {
+		if (maximum[d] - minimum[d] > maximum[splitDimension] - minimum[splitDimension]) {
+			splitDimension = d;
+		}
+	}
+
+	if (end - begin <= maxLeafSize || maximum[splitDimension] <= minimum[splitDimension]) {
+		double center[3];
+		for (int d = 0; d < 3; ++d) {
+			center[d] = 0.5 * (minimum[d] + maximum[d]);
+			leafCenters.push_back(center[d]);
+		}
+
+		Node& leaf = nodes[nodeIndex];
+		leaf.splitDimension = -1;
+		leaf.splitValue = 0.0;
+		leaf.child = static_cast<unsigned int>(leafCenters.size() / 3 - 1);
+		leaf.begin = static_cast<unsigned int>(leafIndices.size());
+		for (unsigned int i = begin; i < end; ++i) {
+			leafX.push_back(static_cast<float>(coordinates[0][indices[i]] - center[0]));
+			leafY.push_back(static_cast<float>(coordinates[1][indices[i]] - center[1]));
+			leafZ.push_back(static_cast<float>(coordinates[2][indices[i]] - center[2]));
+			leafIndices.push_back(static_cast<int>(indices[i]));
+		}
+		while (leafIndices.size() % scanWidth != 0) {
+			leafX.push_back(paddingCoordinate);
+			leafY.push_back(paddingCoordinate);
+			leafZ.push_back(paddingCoordinate);
+			leafIndices.push_back(-1);
+		}
+		leaf.end = static_cast<unsigned int>(leafIndices.size());
+		return nodeIndex;
+	}
+
+	/* median split along the largest extent */
+	unsigned int middle = begin + (end - begin) / 2;
+	std::nth_element(indices + begin, indices + middle, indices + end, CoordinateLess(coordinates[splitDimension]));
+	double splitValue = coordinates[splitDimension][indices[middle]];
+
+	buildNode(indices, begin, middle, coordinates);
+	unsigned int rightChild = buildNode(indices, middle, end, coordinates);
+
+	Node& node = nodes[nodeIndex]; // the children might have reallocated the nodes
+	node.splitDimension = splitDimension;
+	node.splitValue = splitValue;
+	node.child = rightChild;
+	node.begin = 0;
+	node.end = 0;
+	return nodeIndex;
+}
+
+/*
+ * The offsets hold the distance of the query to the cell of the current node per dimension, so
+ * minimalSquaredDistance is a lower bound for all points of the cell (incremental distance
+ * computation as in ANN). Used for the k nearest neighbors as well as for the fixed radius search,
+ * only the threshold of the candidates differs.
+ */
+void NearestNeighborKDTree3D::searchNode(unsigned int nodeIndex, const double query[3], double offsets[3], double minimalSquaredDistance, Candidates& candidates) const {
+	const Node& node = nodeArray[nodeIndex];
+
+	if (node.splitDimension < 0) {
+		const double* center = &leafCenterArray[3 * node.child];
+		const Coordinate* const points[3] = {storedX, storedY, storedZ};
+		scanLeaf(leafXArray, leafYArray, leafZArray, leafIndexArray, node.begin, node.end, center, points, query, candidates);
+		return;
+	}
+
+	int d = node.splitDimension;
+	double difference = query[d] - node.splitValue;
+	unsigned int nearChild = (difference <= 0.0) ? nodeIndex + 1 : node.child;
+	unsigned int farChild = (difference <= 0.0) ? node.child : nodeIndex + 1;
+
+	searchNode(nearChild, query, offsets, minimalSquaredDistance, candidates);
+
+	double oldOffset = offsets[d];
+	double farSquaredDistance = minimalSquaredDistance - oldOffset * oldOffset + difference * difference;
+	if (farSquaredDistance <= candidates.threshold()) {
+		offsets[d] = difference;
+		searchNode(farChild, query, offsets, farSquaredDistance, candidates);
+		offsets[d] = oldOffset;
+	}
+}
+
+void NearestNeighborKDTree3D::searchNearest(const double query[3], unsigned int k, double maxSquaredDistance, Candidates& candidates,
+		double exactRadius) const {
+	candidates.reset(k, (maxSquaredDistance < 0.0) ? FLT_MAX : static_cast<float>(maxSquaredDistance), exactRadius);
+	if (numberOfNodes == 0) {
+		return;
+	}
+	double offsets[3] = {0.0, 0.0, 0.0};
+	searchNode(0, query, offsets, 0.0, candidates);
+}
+
+void NearestNeighborKDTree3D::searchNearest(const double query[3], unsigned int k, std::vector<int>* resultIndices, std::vector<double>* resultDistances,
+		neighborDistance::Type distanceType) const {
+	if (k > numberOfPoints) {
+		throw runtime_error("Number of neighbors k is bigger than the amount of data points.");
+	}
+
+	resultIndices->clear();
+	if (resultDistances != 0) {
+		resultDistances->clear();
+	}
+	if (k == 0) {
+		return;
+	}
+
+	/* the maximum distance bounds the search; the small margin compensates the single precision of the leafs */
+	double maxSquaredDistance = (maxDistance < 0.0) ? -1.0 : maxDistance * maxDistance * (1.0 + 1e-5);
+	Candidates candidates;
+	searchNearest(query, k, maxSquaredDistance, candidates);
+
+	double resultDistance;
+	for (unsigned int i = 0; i < candidates.count; ++i) {
+		if (isWithinMaxDistance(candidates.squaredDistances[i], distanceType, resultDistance)) {
+			resultIndices->push_back(candidates.indices[i]);
+			if (resultDistances != 0) {
+				resultDistances->push_back(resultDistance);
+			}
+		}
+	}
+}
+
+void NearestNeighborKDTree3D::findNearestNeighbors(const double query[3], unsigned int k, double maxSquaredDistance,
+		std::vector<std::pair<double, int> >* neighbors) const {
+	assert (neighbors != 0);
+	searchNearest(query, k, maxSquaredDistance, *neighbors);
+}
+
+void NearestNeighborKDTree3D::searchNearest(const double query[3], unsigned int k, double maxSquaredDistance,
+		std::vector<std::pair<double, int> >& neighbors) const {
+	Candidates candidates;
+	searchNearest(query, std::min(k, numberOfPoints), maxSquaredDistance, candidates);
+	neighbors.resize(candidates.count);
+	for (unsigned int i = 0; i < candidates.count; ++i) {
+		neighbors[i] = std::make_pair(static_cast<double>(candidates.squaredDistances[i]), candidates.indices[i]);
+	}
+}
+
+void NearestNeighborKDTree3D::searchRadius(const double query[3], double radius, unsigned int maxResults, std::vector<int>* resultIndices,
+		std::vector<double>* resultDistances, neighborDistance::Type distanceType) const {
+	resultIndices->clear();
+	if (resultDistances != 0) {
+		resultDistances->clear();
+	}
+	if (radius < 0.0 || numberOfPoints == 0) {
+		return;
+	}
+
+	/* the margin compensates the single precision of the leafs, the candidates are then checked in double precision */
+	double searchBound = radius * radius * (1.0 + 1e-5);
+	Candidates candidates;
+	if (maxResults > 0) {
+		searchNearest(query, std::min(maxResults, numberOfPoints), searchBound, candidates, radius);
+	} else {
+		candidates.reset(0, static_cast<float>(searchBound), radius);
+		double offsets[3] = {0.0, 0.0, 0.0};
+		searchNode(0, query, offsets, 0.0, candidates);
+
+		/* sorted by increasing distance */
+		std::vector<std::pair<float, int> > sortedCandidates(candidates.count);
+		for (unsigned int i = 0; i < candidates.count; ++i) {
+			sortedCandidates[i] = std::make_pair(candidates.squaredDistances[i], candidates.indices[i]);
+		}
+		std::sort(sortedCandidates.begin(), sortedCandidates.end());
+		for (unsigned int i = 0; i < candidates.count; ++i) {
+			candidates.squaredDistances[i] = sortedCandidates[i].first;
+			candidates.indices[i] = sortedCandidates[i].second;
+		}
+	}
+
+	resultIndices->assign(candidates.indices.begin(), candidates.indices.begin() + candidates.count);
+	if (resultDistances != 0) {
+		resultDistances->resize(candidates.count);
+		for (unsigned int i = 0; i < candidates.count; ++i) {
+			double squaredDistance = candidates.squaredDistances[i];
+			(*resultDistances)[i] = (distanceType == neighborDistance::squaredEuclidean) ? squaredDistance : std::sqrt(squaredDistance);
+		}
+	}
+}
+
+void NearestNeighborKDTree3D::findNearestNeighbors(vector<float>* query, std::vector<int>* resultIndices, unsigned int k) {
+	assert (query != 0);
+	assert (resultIndices != 0);
+
+	if (static_cast<int>(query->size()) != 3) {
+		throw runtime_error("Mismatch of query and data dimension.");
+	}
+
+	double queryData[3] = {(*query)[0], (*query)[1], (*query)[2]};
+	searchNearest(queryData, k, resultIndices, 0, neighborDistance::euclidean);
+}
+
+void NearestNeighborKDTree3D::findNearestNeighbors(vector<double>* query, std::vector<int>* resultIndices, unsigned int k) {
+	assert (query != 0);
+	assert (resultIndices != 0);
+
+	if (static_cast<int>(query->size()) != 3) {
+		throw runtime_error("Mismatch of query and data dimension.");
+	}
+
+	double queryData[3] = {(*query)[0], (*query)[1], (*query)[2]};
+	searchNearest(queryData, k, resultIndices, 0, neighborDistance::euclidean);
+}
+
+void NearestNeighborKDTree3D::findNearestNeighbors(Point3D* query, std::vector<int>* resultIndices, unsigned int k) {
+	findNearestNeighbors(query, resultIndices, 0, k);
+}
+
+void NearestNeighborKDTree3D::findNearestNeighbors(Point3D* query, std::vector<int>* resultIndices, std::vector<double>* resultDistances,
+		unsigned int k, neighborDistance::Type distanceType) {
+	assert (query != 0);
+	assert (resultIndices != 0);
+
+	double queryData[3] = {query->getX(), query->getY(), query->getZ()};
+	searchNearest(queryData, k, resultIndices, resultDistances, distanceType);
+}
+
+void NearestNeighborKDTree3D::findNearestNeighbors(PointCloud3D* queries, std::vector<int>* resultIndices, unsigned int k) {
+	assert (queries != 0);
+	findNearestNeighbors(queries, 0, queries->getSize(), resultIndices, 0, k);
+}
+
+void NearestNeighborKDTree3D::findNearestNeighbors(PointCloud3D* queries, unsigned int begin, unsigned int end, std::vector<int>* resultIndices, unsigned int k) {
+	findNearestNeighbors(queries, begin, end, resultIndices, 0, k);
+}
+
+void NearestNeighborKDTree3D::findNearestNeighbors(PointCloud3D* queries, unsigned int begin, unsigned int end, std::vector<int>* resultIndices,
+		std::vector<double>* resultDistances, unsigned int k, neighborDistance::Type distanceType) {
+	assert (queries != 0);
+	assert (resultIndices != 0);
+	assert (begin <= end);
+	assert (end <= queries->getSize());
+
+	if (k > numberOfPoints) {
+		throw runtime_error("Number of neighbors k is bigger than the amount of data points.");
+	}
+
+	resultIndices->resize((end - begin) * k);
+	if (resultDistances != 0) {
+		resultDistances->resize((end - begin) * k);
+	}
+	if (begin == end || k == 0) {
+		return;
+	}
+
+	/* queries only read the tree; the small margin compensates the single precision of the leafs */
+	double maxSquaredDistance = (maxDistance < 0.0) ? -1.0 : maxDistance * maxDistance * (1.0 + 1e-5);
+	NeighborSearchMethod<NearestNeighborKDTree3D>::Type search = &NearestNeighborKDTree3D::searchNearest;
+	runBatchQuery(boost::bind(search, this, _1, k, maxSquaredDistance, _2), queries->getStorage(), begin, end, k, maxDistance, distanceType,
+			&(*resultIndices)[0], (resultDistances != 0) ? &(*resultDistances)[0] : 0, numberOfThreads);
+}
+
+void NearestNeighborKDTree3D::findNeighborsWithinRadius(vector<double>* query, std::vector<int>* resultIndices, double radius, unsigned int maxResults) {
+	assert (query != 0);
+	assert (resultIndices != 0);
+
+	if (static_cast<int>(query->size()) != 3) {
+		throw runtime_error("Mismatch of query and data dimension.");
+	}
+
+	double queryData[3] = {(*query)[0], (*query)[1], (*query)[2]};
+	searchRadius(queryData, radius, maxResults, resultIndices, 0, neighborDistance::euclidean);
+}
+
+void NearestNeighborKDTree3D::findNeighborsWithinRadius(Point3D* query, std::vector<int>* resultIndices, double radius, unsigned int maxResults) {
+	findNeighborsWithinRadius(query, resultIndices, 0, radius, maxResults);
+}
+
+void NearestNeighborKDTree3D::findNeighborsWithinRadius(Point3D* query, std::vector<int>* resultIndices, std::vector<double>* resultDistances,
+		double radius, unsigned int maxResults, neighborDistance::Type distanceType) {
+	assert (query != 0);
+	assert (resultIndices != 0);
+
+	double queryData[3] = {query->getX(), query->getY(), query->getZ()};
+	searchRadius(queryData, radius, maxResults, resultIndices, resultDistances, distanceType);
+}
+
+unsigned int NearestNeighborKDTree3D::getMaxLeafSize() const {
+	return maxLeafSize;
+}
+
+void NearestNeighborKDTree3D::setMaxLeafSize(unsigned int maxLeafSize) {
+	this->maxLeafSize = std::max(scanWidth, (maxLeafSize + scanWidth - 1) / scanWidth * scanWidth);
+}
+
+unsigned int NearestNeighborKDTree3D::getSize() const {
+	return numberOfPoints;
+}
+
+bool NearestNeighborKDTree3D::save(std::string filename, const PointCloud3DStorage* data) const {
+	assert (data != 0);
+	if (data->getSize() != numberOfPoints) {
+		LOG(ERROR) << "Cannot save the k-d tree: the data has " << data->getSize() << " points, but the tree has " << numberOfPoints;
+		return false;
+	}
+
+	FileHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, fileMagic, sizeof(fileMagic));
+	header.version = fileVersion;
+	header.byteOrder = fileByteOrder;
+	header.coordinateSize = sizeof(Coordinate);
+	header.nodeSize = sizeof(Node);
+	header.numberOfPoints = numberOfPoints;
+	header.numberOfNodes = numberOfNodes;
+	header.numberOfLeafEntries = (numberOfNodes == 0) ? 0 : nodeArray[numberOfNodes - 1].end; // the last node is always a leaf
+	header.numberOfLeafs = (numberOfNodes == 0) ? 0 : nodeArray[numberOfNodes - 1].child + 1;
+	header.maxLeafSize = maxLeafSize;
+	header.dataHash = getDataHash(data);
+	FileLayout layout(header);
+
+	/* written to a temporary file that replaces the old one, so processes that have mapped it are not affected */
+	std::string temporaryFilename = filename + ".tmp";
+	std::ofstream outputFile(temporaryFilename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!outputFile.is_open()) {
+		LOG(ERROR) << "Cannot open " << temporaryFilename << " to save the k-d tree.";
+		return false;
+	}
+	unsigned long pointsSize = numberOfPoints * sizeof(Coordinate);
+	outputFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	writeSection(outputFile, layout.offsets[FileLayout::nodes], nodeArray, numberOfNodes * sizeof(Node));
+	writeSection(outputFile, layout.offsets[FileLayout::leafCenters], leafCenterArray, 3 * header.numberOfLeafs * sizeof(double));
+	writeSection(outputFile, layout.offsets[FileLayout::leafX], leafXArray, header.numberOfLeafEntries * sizeof(float));
+	writeSection(outputFile, layout.offsets[FileLayout::leafY], leafYArray, header.numberOfLeafEntries * sizeof(float));
+	writeSection(outputFile, layout.offsets[FileLayout::leafZ], leafZArray, header.numberOfLeafEntries * sizeof(float));
+	writeSection(outputFile, layout.offsets[FileLayout::leafIndices], leafIndexArray, header.numberOfLeafEntries * sizeof(int));
+	writeSection(outputFile, layout.offsets[FileLayout::x], data->getRawX(), pointsSize);
+	writeSection(outputFile, layout.offsets[FileLayout::y], data->getRawY(), pointsSize);
+	writeSection(outputFile, layout.offsets[FileLayout::z], data->getRawZ(), pointsSize);
+	outputFile.close();
+
+	if (outputFile.fail()) {
+		LOG(ERROR) << "Cannot write the k-d tree to " << temporaryFilename;
+		std::remove(temporaryFilename.c_str());
+		return false;
+	}
+#ifdef WIN32
+	std::remove(filename.c_str()); // rename does not replace existing files
+#endif
+	if (std::rename(temporaryFilename.c_str(), filename.c_str()) != 0) {
+		LOG(ERROR) << "Cannot replace " << filename << " by the saved k-d tree.";
+		std::remove(temporaryFilename.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool NearestNeighborKDTree3D::load(std::string filename, const PointCloud3DStorage* sourceData) {
+	boost::shared_ptr<MappedFile> file(new MappedFile());
+	if (!file->open(filename, MappedFile::randomAccess)) {
+		LOG(ERROR) << "Cannot open the k-d tree file " << filename;
+		return false;
+	}
+
+	FileHeader header;
+	if (file->size < sizeof(header)) {
+		LOG(ERROR) << filename << " is not a k-d tree file.";
+		return false;
+	}
+	memcpy(&header, file->data, sizeof(header));
+	if (memcmp(header.magic, fileMagic, sizeof(fileMagic)) != 0) {
+		LOG(ERROR) << filename << " is not a k-d tree file.";
+		return false;
+	}
+	if (header.version != fileVersion || header.byteOrder != fileByteOrder ||
+			header.coordinateSize != sizeof(Coordinate) || header.nodeSize != sizeof(Node)) {
+		LOG(ERROR) << "The k-d tree file " << filename << " has been written by an incompatible version or platform (file format version "
+				<< header.version << ", expected " << fileVersion << ").";
+		return false;
+	}
+	FileLayout layout(header);
+	if (file->size < layout.size) {
+		LOG(ERROR) << "The k-d tree file " << filename << " is truncated.";
+		return false;
+	}
+	if (!isValidTree(reinterpret_cast<const Node*>(file->data + layout.offsets[FileLayout::nodes]),
+			reinterpret_cast<const int*>(file->data + layout.offsets[FileLayout::leafIndices]),
+			header.numberOfNodes, header.numberOfLeafs, header.numberOfLeafEntries, header.numberOfPoints)) {
+		LOG(ERROR) << "The k-d tree file " << filename << " is corrupt.";
+		return false;
+	}
+	if (sourceData != 0 && (sourceData->getSize() != header.numberOfPoints || getDataHash(sourceData) != header.dataHash)) {
+		LOG(ERROR) << "The k-d tree file " << filename << " does not belong to the given data.";
+		return false;
+	}
+
+	/* the tree is searched in place */
+	nodes.clear();
+	leafX.clear();
+	leafY.clear();
+	leafZ.clear();
+	leafIndices.clear();
+	leafCenters.clear();
+	pointX.clear();
+	pointY.clear();
+	pointZ.clear();
+	const char* data = file->data;
+	mappedFile = file;
+	dimension = 3;
+	numberOfPoints = header.numberOfPoints;
+	maxLeafSize = header.maxLeafSize;
+	numberOfNodes = header.numberOfNodes;
+	nodeArray = reinterpret_cast<const Node*>(data + layout.offsets[FileLayout::nodes]);
+	leafCenterArray = reinterpret_cast<const double*>(data + layout.offsets[FileLayout::leafCenters]);
+	leafXArray = reinterpret_cast<const float*>(data + layout.offsets[FileLayout::leafX]);
+	leafYArray = reinterpret_cast<const float*>(data + layout.offsets[FileLayout::leafY]);
+	leafZArray = reinterpret_cast<const float*>(data + layout.offsets[FileLayout::leafZ]);
+	leafIndexArray = reinterpret_cast<const int*>(data + layout.offsets[FileLayout::leafIndices]);
+	storedX = reinterpret_cast<const Coordinate*>(data + layout.offsets[FileLayout::x]);
+	storedY = reinterpret_cast<const Coordinate*>(data + layout.offsets[FileLayout::y]);
+	storedZ = reinterpret_cast<const Coordinate*>(data + layout.offsets[FileLayout::z]);
+	return true;
+}
+
+bool NearestNeighborKDTree3D::getStoredData(PointCloud3DStorage* data) const {
+	assert (data != 0);
+	if (!mappedFile) {
+		return false;
+	}
+	data->clear();
+	data->addPoints(storedX, storedY, storedZ, numberOfPoints);
+	return true;
+}
+
+bool NearestNeighborKDTree3D::isValidTree(const Node* treeNodes, const int* treeLeafIndices, unsigned int numberOfNodes, unsigned int numberOfLeafs,
+		unsigned int numberOfLeafEntries, unsigned int numberOfPoints) {
+	for (unsigned int i = 0; i < numberOfNodes; ++i) {
+		const Node& node = treeNodes[i];
+		if (node.splitDimension < 0) { // leaf
+			if (node.splitDimension != -1 || node.child >= numberOfLeafs || node.begin > node.end || node.end > numberOfLeafEntries ||
+					node.begin % scanWidth != 0 || node.end % scanWidth != 0) {
+				return false;
+			}
+		} else if (node.splitDimension > 2 || i + 1 >= numberOfNodes || node.child <= i + 1 || node.child >= numberOfNodes) {
+			return false; // children always follow their parent, so the search terminates
+		}
+	}
+	for (unsigned int i = 0; i < numberOfLeafEntries; ++i) {
+		if (treeLeafIndices[i] < -1 || (treeLeafIndices[i] >= 0 && static_cast<unsigned int>(treeLeafIndices[i]) >= numberOfPoints)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+boost::uint64_t NearestNeighborKDTree3D::getDataHash(const PointCloud3DStorage* data) {
+	assert (data != 0);
+	boost::uint64_t hash = 0xCBF29CE484222325ULL; // FNV offset basis
+	boost::uint64_t size = data->getSize();
+	hash = hashArray(&size, sizeof(size), hash);
+	hash = hashArray(data->getRawX(), data->getSize() * sizeof(Coordinate), hash);
+	hash = hashArray(data->getRawY(), data->getSize() * sizeof(Coordinate), hash);
+	hash = hashArray(data->getRawZ(), data->getSize() * sizeof(Coordinate), hash);
+	return hash;
+}
+
+}
+
+/* EOF */
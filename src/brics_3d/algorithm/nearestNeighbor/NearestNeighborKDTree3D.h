@@ -0,0 +1,272 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#ifndef BRICS_3D_NEARESTNEIGHBORKDTREE3D_H_
+#define BRICS_3D_NEARESTNEIGHBORKDTREE3D_H_
+
+#include "brics_3d/algorithm/nearestNeighbor/INearestNeighbor.h"
+#include "brics_3d/algorithm/nearestNeighbor/INearestPoint3DNeighbor.h"
+#include "brics_3d/algorithm/nearestNeighbor/INearestNeighborSetup.h"
+#include "brics_3d/core/MappedFile.h"
+
+#include <string>
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+
+namespace brics_3d {
+
+/**
+ * @ingroup nearestNeighbor
+ * @brief Native k-d tree for 3D points.
+ *
+ * In contrast to the wrappers for ANN, FLANN and STANN this implementation is specialized for 3 dimensions.
+ * The tree is built directly from the coordinate arrays of the PointCloud3DStorage. The points of each leaf
+ * (bucket) are stored contiguously as single precision arrays (one per coordinate), relative to the center of the
+ * leaf to keep the precision of the coordinates. A leaf is scanned with SSE instructions, i.e. four points at a time.
+ *
+ * The search is exact. The returned distances have single precision, relative to the size of a leaf. The tree
+ * keeps a copy of the original coordinates, so the fixed radius search decides about points close to the radius
+ * with double precision like the other backends.
+ *
+ * Queries do not modify the tree, so batched queries are processed by several threads (see setNumberOfThreads()).
+ * The generic INearestNeighbor interface only accepts data with 3 dimensions, otherwise an exception is thrown.
+ *
+ * A built tree can be saved to a file together with its points. load() maps such a file into memory and searches
+ * it in place, so e.g. the index of a static map is available at startup without rebuilding it.
+ */
+class NearestNeighborKDTree3D : public INearestNeighbor, public INearestPoint3DNeighbor, public INearestNeighborSetup {
+public:
+
+	/**
+	 * @brief Standard constructor
+	 */
+	NearestNeighborKDTree3D();
+
+	/**
+	 * @brief Standard destructor
+	 */
+	virtual ~NearestNeighborKDTree3D();
+
+	void setData(vector< vector<float> >* data);
+	void setData(vector< vector<double> >* data);
+	void setData(PointCloud3D* data);
+
+	/**
+	 * @brief Build the tree directly from coordinate arrays.
+	 */
+	void setData(const PointCloud3DStorage* data);
+
+	void findNearestNeighbors(vector<float>* query, std::vector<int>* resultIndices, unsigned int k = 1);
+	void findNearestNeighbors(vector<double>* query, std::vector<int>* resultIndices, unsigned int k = 1);
+	void findNearestNeighbors(Point3D* query, std::vector<int>* resultIndices, unsigned int k = 1);
+	void findNearestNeighbors(PointCloud3D* queries, std::vector<int>* resultIndices, unsigned int k = 1);
+	void findNearestNeighbors(PointCloud3D* queries, unsigned int begin, unsigned int end, std::vector<int>* resultIndices, unsigned int k = 1);
+
+	void findNeighborsWithinRadius(vector<double>* query, std::vector<int>* resultIndices, double radius, unsigned int maxResults = 0);
+	void findNeighborsWithinRadius(Point3D* query, std::vector<int>* resultIndices, double radius, unsigned int maxResults = 0);
+
+	void findNearestNeighbors(Point3D* query, std::vector<int>* resultIndices, std::vector<double>* resultDistances,
+			unsigned int k = 1, neighborDistance::Type distanceType = neighborDistance::euclidean);
+	void findNearestNeighbors(PointCloud3D* queries, unsigned int begin, unsigned int end, std::vector<int>* resultIndices,
+			std::vector<double>* resultDistances, unsigned int k = 1, neighborDistance::Type distanceType = neighborDistance::euclidean);
+	void findNeighborsWithinRadius(Point3D* query, std::vector<int>* resultIndices, std::vector<double>* resultDistances,
+			double radius, unsigned int maxResults = 0, neighborDistance::Type distanceType = neighborDistance::euclidean);
+
+	/**
+	 * @brief k nearest neighbors closer than a bound.
+	 *
+	 * Lower level query to combine the results of several trees: the bound (e.g. the k-th distance found so far in
+	 * other trees) prunes the search. The maximum distance of the setup is not applied. It does not modify the tree.
+	 *
+	 * @param query Coordinates of the query point.
+	 * @param k Number of neighbors. At most getSize() neighbors are returned.
+	 * @param maxSquaredDistance Only neighbors with a squared distance <= this value are returned. Negative values disable the bound.
+	 * @param[out] neighbors (squared distance, index) pairs sorted by increasing distance.
+	 */
+	void findNearestNeighbors(const double query[3], unsigned int k, double maxSquaredDistance, std::vector<std::pair<double, int> >* neighbors) const;
+
+	/**
+	 * @brief Get the maximal number of points per leaf.
+	 */
+	unsigned int getMaxLeafSize() const;
+
+	/**
+	 * @brief Set the maximal number of points per leaf.
+	 *
+	 * Takes effect with the next invocation of setData(). Values are rounded up to a multiple of 4, the width of
+	 * the SIMD leaf scan. Leafs with identical points might exceed this size. Default is 16.
+	 */
+	void setMaxLeafSize(unsigned int maxLeafSize);
+
+	/**
+	 * @brief Number of points in the tree.
+	 */
+	unsigned int getSize() const;
+
+	/**
+	 * @brief Save the tree together with the points it has been built from.
+	 *
+	 * The file can be reloaded by load() without rebuilding the tree. It stores the arrays in the memory layout of
+	 * the host, so it is only valid for the same byte order, the same brics_3d::Coordinate type and the same file
+	 * format version. An existing file is replaced as a whole, so trees that have loaded it keep their version.
+	 * @param filename Name of the file.
+	 * @param data The points that have been passed to setData().
+	 * @return False if the file could not be written or the number of points does not match the tree.
+	 */
+	bool save(std::string filename, const PointCloud3DStorage* data) const;
+
+	/**
+	 * @brief Load a tree that has been stored by save().
+	 *
+	 * The file is memory mapped and searched in place: nothing is rebuilt or copied, pages are only read on demand
+	 * and they are shared with other processes that load the same file. Hence the file must not be modified in place
+	 * while it is loaded. The current tree is only replaced if the file is valid.
+	 * @param filename Name of the file.
+	 * @param sourceData Optional points the tree is expected to refer to. If they differ from the points stored
+	 *        in the file (compared by getDataHash()), the file is rejected.
+	 * @return False if the file could not be read, has an incompatible format or does not match sourceData.
+	 */
+	bool load(std::string filename, const PointCloud3DStorage* sourceData = 0);
+
+	/**
+	 * @brief Copy the points that are stored in the loaded file.
+	 * @param[out] data Gets the points, in the order of the indices returned by the queries.
+	 * @return False if the tree has not been loaded from a file.
+	 */
+	bool getStoredData(PointCloud3DStorage* data) const;
+
+	/**
+	 * @brief 64 bit hash of the number of points and their coordinates, used to match a saved tree with its data.
+	 */
+	static boost::uint64_t getDataHash(const PointCloud3DStorage* data);
+
+private:
+
+	/// Not copyable, the arrays might refer to the own buffers.
+	NearestNeighborKDTree3D(const NearestNeighborKDTree3D&);
+	NearestNeighborKDTree3D& operator=(const NearestNeighborKDTree3D&);
+
+	/// Node of the tree. Inner nodes have the left child at the next index of the node array.
+	struct Node {
+		/// Split dimension 0, 1 or 2 for inner nodes and -1 for leafs.
+		int splitDimension;
+
+		/// Split value for inner nodes. Points of the left child are <= and of the right child >= this value.
+		double splitValue;
+
+		/// Index of the right child for inner nodes and index of the leaf for leafs.
+		unsigned int child;
+
+		/// First entry of a leaf in the leaf arrays.
+		unsigned int begin;
+
+		/// Entry behind the last one of a leaf in the leaf arrays. Always a multiple of 4.
+		unsigned int end;
+	};
+
+	struct Candidates;
+
+	void build(const Coordinate* x, const Coordinate* y, const Coordinate* z, unsigned int size);
+
+	/// Let the arrays that are used by the search refer to the own buffers.
+	void useOwnArrays();
+
+	/// Check that all child, leaf and point indices of a loaded tree are within their arrays.
+	static bool isValidTree(const Node* treeNodes, const int* treeLeafIndices, unsigned int numberOfNodes, unsigned int numberOfLeafs,
+			unsigned int numberOfLeafEntries, unsigned int numberOfPoints);
+
+	unsigned int buildNode(unsigned int* indices, unsigned int begin, unsigned int end, const Coordinate* coordinates[3]);
+
+	/**
+	 * @brief Offer all points of the subtree that might be within the threshold of the candidates.
+	 */
+	void searchNode(unsigned int nodeIndex, const double query[3], double offsets[3], double minimalSquaredDistance, Candidates& candidates) const;
+
+	/**
+	 * @brief k nearest neighbor search. Results are sorted by increasing squared distance.
+	 * @param maxSquaredDistance Only neighbors with a squared distance <= this value are returned. Negative values disable the bound.
+	 * @param exactRadius Additional bound of the distance that is checked in double precision. Negative values disable the bound.
+	 */
+	void searchNearest(const double query[3], unsigned int k, double maxSquaredDistance, Candidates& candidates,
+			double exactRadius = -1.0) const;
+
+	void searchNearest(const double query[3], unsigned int k, std::vector<int>* resultIndices, std::vector<double>* resultDistances,
+			neighborDistance::Type distanceType) const;
+	void searchRadius(const double query[3], double radius, unsigned int maxResults, std::vector<int>* resultIndices,
+			std::vector<double>* resultDistances, neighborDistance::Type distanceType) const;
+
+	/// k nearest neighbors as (squared distance, index) pairs sorted by increasing distance. Used for batched queries.
+	void searchNearest(const double query[3], unsigned int k, double maxSquaredDistance, std::vector<std::pair<double, int> >& neighbors) const;
+
+	/// Nodes of the tree. The root is the first node.
+	std::vector<Node> nodes;
+
+	/// x coordinates of all leafs relative to the leaf centers
+	std::vector<float> leafX;
+
+	/// y coordinates of all leafs relative to the leaf centers
+	std::vector<float> leafY;
+
+	/// z coordinates of all leafs relative to the leaf centers
+	std::vector<float> leafZ;
+
+	/// Original point index of each leaf entry. -1 for padding entries.
+	std::vector<int> leafIndices;
+
+	/// Center of each leaf (3 values per leaf)
+	std::vector<double> leafCenters;
+
+	/// Nodes as used by the search, either the own buffer or the mapped file
+	const Node* nodeArray;
+
+	/// Number of nodes
+	unsigned int numberOfNodes;
+
+	/// Leaf arrays as used by the search, either the own buffers or the mapped file
+	const float* leafXArray;
+	const float* leafYArray;
+	const float* leafZArray;
+	const int* leafIndexArray;
+	const double* leafCenterArray;
+
+	/// File the arrays are mapped from, if the tree has been loaded
+	boost::shared_ptr<MappedFile> mappedFile;
+
+	/// Original coordinates of the points, indexed by point index
+	std::vector<Coordinate> pointX;
+	std::vector<Coordinate> pointY;
+	std::vector<Coordinate> pointZ;
+
+	/// Original coordinates as used by the search, either the own copy or the mapped file
+	const Coordinate* storedX;
+	const Coordinate* storedY;
+	const Coordinate* storedZ;
+
+	/// Number of points in the tree
+	unsigned int numberOfPoints;
+
+	/// Maximal number of points per leaf
+	unsigned int maxLeafSize;
+};
+
+}
+
+#endif /* BRICS_3D_NEARESTNEIGHBORKDTREE3D_H_ */
+
+/* EOF */
@@ -18,9 +18,11 @@
 ******************************************************************************/
 
 #include "NearestNeighborSTANN.h"
+#include "NearestNeighborBatchQuery.h"
 #include <assert.h>
 #include <cmath>
 #include <stdexcept>
+#include <algorithm>
 
 using std::cout;
 using std::endl;
@@ -28,6 +30,70 @@ using std::runtime_error;
 
 namespace brics_3d {
 
+namespace {
+
+/*
+ * STANN has no fixed radius search, so k nearest neighbor searches with a growing k are
+ * performed until the k-th neighbor is outside of the radius or no more points are left.
+ */
+template <typename Handle, typename Point>
+void searchRadiusIncrementally(Handle* handle, const Point& query, unsigned int numberOfPoints, double radius,
+		unsigned int maxResults, std::vector<int>* resultIndices, std::vector<double>* resultDistances, neighborDistance::Type distanceType) {
+
+	resultIndices->clear();
+	if (resultDistances != 0) {
+		resultDistances->clear();
+	}
+	if (radius < 0.0 || numberOfPoints == 0) {
+		return;
+	}
+	double squaredRadius = radius * radius;
+	unsigned int limit = (maxResults > 0) ? std::min(maxResults, numberOfPoints) : numberOfPoints;
+	unsigned int k = std::min(16u, limit);
+
+	vector<long unsigned int> indices;
+	vector<double> squaredDistances;
+	while (true) {
+		indices.clear();
+		squaredDistances.clear();
+		handle->ksearch(query, k, indices, squaredDistances);
+		if (k == limit || squaredDistances[k - 1] > squaredRadius) {
+			break;
+		}
+		k = std::min(2 * k, limit);
+	}
+
+	/* results are sorted by increasing distance */
+	for (unsigned int i = 0; i < k && squaredDistances[i] <= squaredRadius; ++i) {
+		resultIndices->push_back(static_cast<int>(indices[i]));
+		if (resultDistances != 0) {
+			resultDistances->push_back((distanceType == neighborDistance::squaredEuclidean) ? squaredDistances[i] : std::sqrt(squaredDistances[i]));
+		}
+	}
+}
+
+/// k nearest neighbor search of STANN for runBatchQuery(). Every copy has its own scratch buffers.
+struct STANNPoint3DSearch {
+	sfcnn<STANNPoint3D, STANNPoint3DDimension, double>* handle;
+	unsigned int k;
+	vector<long unsigned int> indices;
+	vector<double> squaredDistances;
+
+	void operator()(const double query[3], std::vector<std::pair<double, int> >& neighbors) {
+		indices.clear();
+		squaredDistances.clear();
+		handle->ksearch(STANNPoint3D(query[0], query[1], query[2]), k, indices, squaredDistances);
+		assert(static_cast<unsigned int>(indices.size()) == k);
+
+		neighbors.resize(k);
+		for (unsigned int i = 0; i < k; ++i) { // STANN returns squared distances
+			neighbors[i] = std::make_pair(squaredDistances[i], static_cast<int>(indices[i]));
+		}
+	}
+};
+
+}
+
 NearestNeighborSTANN::NearestNeighborSTANN() {
 	this->dimension = -1;
 	this->maxDistance = -1; //default = disable
@@ -103,15 +169,14 @@ void NearestNeighborSTANN::setData(PointCloud3D* data) {
 		points3D->clear();
 	}
 
-	double tmpX = 0.0;
-	double tmpY = 0.0;
-	double tmpZ = 0.0;
+	const PointCloud3DStorage* storage = data->getStorage();
+	const Coordinate* x = storage->getRawX();
+	const Coordinate* y = storage->getRawY();
+	const Coordinate* z = storage->getRawZ();
+	points3D->reserve(storage->getSize());
 
-	for (int i = 0; i < static_cast<int>(data->getSize()); ++i) {
-		tmpX = (*data->getPointCloud())[i].getX();
-		tmpY = (*data->getPointCloud())[i].getY();
-		tmpZ = (*data->getPointCloud())[i].getZ();
-		STANNPoint3D tmpPoint(tmpX, tmpY, tmpZ);
+	for (int i = 0; i < static_cast<int>(storage->getSize()); ++i) {
+		STANNPoint3D tmpPoint(x[i], y[i], z[i]);
 		points3D->push_back(tmpPoint);
 //		cout << tmpPoint;
 	}
@@ -150,19 +215,20 @@ void NearestNeighborSTANN::findNearestNeighbors(vector<double>* query, std::vect
 	assert( static_cast<unsigned int>(squaredResultDistances->size()) == static_cast<unsigned int>(k));
 	assert( static_cast<unsigned int>(squaredResultDistances->size()) > 0);
 
-	brics_3d::Coordinate resultDistance; //distance has same data-type as Coordinate, although the meaning is different
-	int resultIndex;
+	double resultDistance;
 	for (int i = 0; i < static_cast<int>(k); i++) {
-		resultDistance = static_cast<brics_3d::Coordinate>(sqrt((*squaredResultDistances)[i])); //seems to return squared distance (although documentation does not suggest)
-		resultIndex = static_cast<int>((*(this->resultIndices))[i]);
-		if (resultDistance <= maxDistance || maxDistance < 0.0) { //if max distance is < 0 then the distance should have no influence
-			resultIndices->push_back(resultIndex);
+		if (isWithinMaxDistance((*squaredResultDistances)[i], neighborDistance::euclidean, resultDistance)) {
+			resultIndices->push_back(static_cast<int>((*(this->resultIndices))[i]));
 		}
 	}
 
 }
 
 void NearestNeighborSTANN::findNearestNeighbors(Point3D* query, std::vector<int>* resultIndices, unsigned int k) {
+	findNearestNeighbors(query, resultIndices, 0, k);
+}
+
+void NearestNeighborSTANN::findNearestNeighbors(Point3D* query, std::vector<int>* resultIndices, std::vector<double>* resultDistances, unsigned int k, neighborDistance::Type distanceType) {
 	assert (query != 0);
 	assert (resultIndices != 0);
 	assert (STANNPoint3DDimension == 3);
@@ -172,31 +238,99 @@ void NearestNeighborSTANN::findNearestNeighbors(Point3D* query, std::vector<int>
 	}
 
 	resultIndices->clear();
-	double tmpX = (*query).getX();
-	double tmpY = (*query).getY();
-	double tmpZ = (*query).getZ();
-
+	if (resultDistances != 0) {
+		resultDistances->clear();
+	}
+	if (k == 0) {
+		return;
+	}
 
-	STANNPoint3D queryPoint(tmpX, tmpY, tmpZ);
+	STANNPoint3D queryPoint(query->getX(), query->getY(), query->getZ());
 	this->resultIndices->clear();
 	squaredResultDistances->clear();
 	nearestPoint3DNeigborHandle->ksearch(queryPoint, k, *(this->resultIndices), *squaredResultDistances);
 	assert( static_cast<unsigned int>(this->resultIndices->size()) == static_cast<unsigned int>(k));
-	assert( static_cast<unsigned int>(this->resultIndices->size()) > 0);
 	assert( static_cast<unsigned int>(squaredResultDistances->size()) == static_cast<unsigned int>(k));
-	assert( static_cast<unsigned int>(squaredResultDistances->size()) > 0);
 
-	brics_3d::Coordinate resultDistance; //distance has same data-type as Coordinate, although the meaning is different
-	int resultIndex;
+	double resultDistance;
 	for (int i = 0; i < static_cast<int>(k); i++) {
-		resultDistance = static_cast<brics_3d::Coordinate>(sqrt((*squaredResultDistances)[i])); //seems to return squared distance (although documentation does not suggest)
-		resultIndex = static_cast<int>((*(this->resultIndices))[i]);
-		if (resultDistance <= maxDistance || maxDistance < 0.0) { //if max distance is < 0 then the distance should have no influence
-			resultIndices->push_back(resultIndex);
+		if (isWithinMaxDistance((*squaredResultDistances)[i], distanceType, resultDistance)) { // STANN returns squared distances
+			resultIndices->push_back(static_cast<int>((*(this->resultIndices))[i]));
+			if (resultDistances != 0) {
+				resultDistances->push_back(resultDistance);
+			}
 		}
 	}
 }
 
+void NearestNeighborSTANN::findNeighborsWithinRadius(vector<double>* query, std::vector<int>* resultIndices, double radius, unsigned int maxResults) {
+	assert (query != 0);
+	assert (resultIndices != 0);
+
+	if (static_cast<int>(query->size()) != dimension) {
+		throw runtime_error("Mismatch of query and data dimension.");
+	}
+
+	STANNPoint queryPoint;
+	for (int i = 0; i < dimension; ++i) {
+		queryPoint[i] = (*query)[i];
+	}
+	searchRadiusIncrementally(nearestNeigborHandle, queryPoint, static_cast<unsigned int>(points->size()), radius, maxResults,
+			resultIndices, 0, neighborDistance::euclidean);
+}
+
+void NearestNeighborSTANN::findNeighborsWithinRadius(Point3D* query, std::vector<int>* resultIndices, double radius, unsigned int maxResults) {
+	findNeighborsWithinRadius(query, resultIndices, 0, radius, maxResults);
+}
+
+void NearestNeighborSTANN::findNeighborsWithinRadius(Point3D* query, std::vector<int>* resultIndices, std::vector<double>* resultDistances,
+		double radius, unsigned int maxResults, neighborDistance::Type distanceType) {
+	assert (query != 0);
+	assert (resultIndices != 0);
+	assert (STANNPoint3DDimension == 3);
+
+	STANNPoint3D queryPoint(query->getX(), query->getY(), query->getZ());
+	searchRadiusIncrementally(nearestPoint3DNeigborHandle, queryPoint, static_cast<unsigned int>(points3D->size()), radius, maxResults,
+			resultIndices, resultDistances, distanceType);
+}
+
+void NearestNeighborSTANN::findNearestNeighbors(PointCloud3D* queries, std::vector<int>* resultIndices, unsigned int k) {
+	assert (queries != 0);
+	findNearestNeighbors(queries, 0, queries->getSize(), resultIndices, 0, k);
+}
+
+void NearestNeighborSTANN::findNearestNeighbors(PointCloud3D* queries, unsigned int begin, unsigned int end, std::vector<int>* resultIndices, unsigned int k) {
+	findNearestNeighbors(queries, begin, end, resultIndices, 0, k);
+}
+
+void NearestNeighborSTANN::findNearestNeighbors(PointCloud3D* queries, unsigned int begin, unsigned int end, std::vector<int>* resultIndices,
+		std::vector<double>* resultDistances, unsigned int k, neighborDistance::Type distanceType) {
+	assert (queries != 0);
+	assert (resultIndices != 0);
+	assert (STANNPoint3DDimension == 3);
+	assert (begin <= end);
+	assert (end <= queries->getSize());
+
+	if (static_cast<unsigned int>(k) > this->points3D->size()) {
+		throw runtime_error("Number of neighbors k is bigger than the amount of data points.");
+	}
+
+	resultIndices->resize((end - begin) * k);
+	if (resultDistances != 0) {
+		resultDistances->resize((end - begin) * k);
+	}
+	if (begin == end || k == 0) {
+		return;
+	}
+
+	/* the ksearch() function of STANN is thread-safe */
+	STANNPoint3DSearch search;
+	search.handle = nearestPoint3DNeigborHandle;
+	search.k = k;
+	runBatchQuery(search, queries->getStorage(), begin, end, k, maxDistance, distanceType,
+			&(*resultIndices)[0], (resultDistances != 0) ? &(*resultDistances)[0] : 0, numberOfThreads);
+}
+
 }
 
 /* EOF */
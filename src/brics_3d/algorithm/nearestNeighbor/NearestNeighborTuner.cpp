@@ -0,0 +1,322 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#include "NearestNeighborTuner.h"
+#include "brics_3d/algorithm/nearestNeighbor/NearestNeighborFLANN.h"
+#include "brics_3d/util/Timer.h"
+
+#include <assert.h>
+#include <stdexcept>
+#include <algorithm>
+
+namespace brics_3d {
+
+namespace {
+
+/// Two FLANN configurations that only differ in the number of checks can share the same index.
+bool sharesIndex(const NearestNeighborConfiguration& first, const NearestNeighborConfiguration& second) {
+	return (first.implementation.compare("NearestNeighborFLANN") == 0) && (second.implementation.compare("NearestNeighborFLANN") == 0) &&
+			(first.flannAlgorithm.compare(second.flannAlgorithm) == 0) && (first.trees == second.trees) &&
+			(first.branching == second.branching);
+}
+
+/// Squared distance between the query i and the data point j
+inline double squaredDistance(const PointCloud3DStorage* queries, unsigned int i, const PointCloud3DStorage* data, int j) {
+	double dx = queries->getRawX()[i] - data->getRawX()[j];
+	double dy = queries->getRawY()[i] - data->getRawY()[j];
+	double dz = queries->getRawZ()[i] - data->getRawZ()[j];
+	return dx * dx + dy * dy + dz * dz;
+}
+
+/// Maximal number of queries for which the exact neighbors are determined by a brute force scan
+const unsigned int maxReferenceQueries = 1000;
+
+/*
+ * Exact reference for the query i by a brute force scan in double precision, so it does not depend on any of the
+ * measured backends. Returns the squared distance of the k-th nearest neighbor, or the number of points within
+ * the radius if it is > 0.
+ */
+double bruteForceReference(const PointCloud3DStorage* queries, unsigned int i, const PointCloud3DStorage* data, unsigned int k,
+		double radius, std::vector<double>& squaredDistances) {
+	unsigned int size = data->getSize();
+	if (radius > 0.0) {
+		unsigned int count = 0;
+		for (unsigned int j = 0; j < size; ++j) {
+			if (squaredDistance(queries, i, data, j) <= radius * radius) {
+				++count;
+			}
+		}
+		return count;
+	}
+	squaredDistances.resize(size);
+	for (unsigned int j = 0; j < size; ++j) {
+		squaredDistances[j] = squaredDistance(queries, i, data, j);
+	}
+	std::nth_element(squaredDistances.begin(), squaredDistances.begin() + (k - 1), squaredDistances.end());
+	return squaredDistances[k - 1];
+}
+
+}
+
+NearestNeighborTuner::NearestNeighborTuner() {
+	this->recallTarget = 0.95;
+	this->k = 1;
+	this->radius = 0.0;
+	this->buildTimeWeight = 1.0;
+	this->numberOfQueries = 10000;
+}
+
+NearestNeighborTuner::~NearestNeighborTuner() {
+
+}
+
+bool NearestNeighborTuner::tune(PointCloud3D* data, PointCloud3D* queries, NearestNeighborConfiguration* bestConfiguration) {
+	assert(data != 0);
+	assert(bestConfiguration != 0);
+	results.clear();
+	if (data->getSize() == 0) {
+		LOG(ERROR) << "NearestNeighborTuner: Cannot tune without data.";
+		return false;
+	}
+
+	/* take evenly distributed points of the data as workload */
+	PointCloud3D sampledQueries;
+	if (queries == 0) {
+		unsigned int sampleSize = std::min(numberOfQueries, data->getSize());
+		std::vector<int> sampleIndices(sampleSize);
+		for (unsigned int i = 0; i < sampleSize; ++i) {
+			sampleIndices[i] = static_cast<int>((static_cast<unsigned long long>(i) * data->getSize()) / sampleSize);
+		}
+		sampledQueries.addPoints(data, sampleIndices);
+		queries = &sampledQueries;
+	}
+	const PointCloud3DStorage* dataPoints = data->getStorage();
+	const PointCloud3DStorage* queryPoints = queries->getStorage();
+	unsigned int querySize = queryPoints->getSize();
+	unsigned int effectiveK = std::min(k, data->getSize());
+
+	/* exact results of (a subset of) the queries as reference */
+	unsigned int referenceSize = std::min(querySize, maxReferenceQueries);
+	std::vector<unsigned int> referenceQueries(referenceSize);
+	std::vector<double> maxSquaredDistances(referenceSize);
+	std::vector<double> squaredDistances;
+	unsigned long long totalExactNeighbors = 0;
+	for (unsigned int r = 0; r < referenceSize; ++r) {
+		referenceQueries[r] = static_cast<unsigned int>((static_cast<unsigned long long>(r) * querySize) / referenceSize);
+		if (radius > 0.0) {
+			totalExactNeighbors += static_cast<unsigned long long>(bruteForceReference(queryPoints, referenceQueries[r], dataPoints, effectiveK,
+					radius, squaredDistances));
+			maxSquaredDistances[r] = radius * radius;
+		} else {
+			maxSquaredDistances[r] = bruteForceReference(queryPoints, referenceQueries[r], dataPoints, effectiveK, 0.0, squaredDistances);
+			totalExactNeighbors += effectiveK;
+		}
+	}
+	std::vector<int> resultIndices;
+	Point3D query;
+
+	std::vector<NearestNeighborConfiguration> candidateConfigurations = candidates;
+	if (candidateConfigurations.empty()) {
+		getDefaultCandidates(candidateConfigurations);
+	}
+
+	NearestNeighborFactory factory;
+	INearestPoint3DNeighborPtr nearestNeighbor;
+	NearestNeighborConfiguration previousConfiguration;
+	double previousBuildTime = 0.0;
+	Timer timer;
+	for (unsigned int c = 0; c < candidateConfigurations.size(); ++c) {
+		const NearestNeighborConfiguration& configuration = candidateConfigurations[c];
+		NearestNeighborTuningResult result;
+		result.configuration = configuration;
+
+		try {
+			/* build the index, FLANN indices are reused if only the number of checks changes */
+			if (nearestNeighbor && sharesIndex(configuration, previousConfiguration)) {
+				boost::shared_ptr<NearestNeighborFLANN> flann = boost::dynamic_pointer_cast<NearestNeighborFLANN>(nearestNeighbor);
+				FLANNParameters parameters = flann->getParameters();
+				parameters.checks = configuration.checks;
+				flann->setParameters(parameters);
+				result.buildTime = previousBuildTime;
+			} else {
+				nearestNeighbor.reset(); // free the previous index first
+				nearestNeighbor = factory.createNearestNeighbor(configuration);
+				timer.reset();
+				nearestNeighbor->setData(data);
+				result.buildTime = static_cast<double>(timer.getElapsedTime());
+			}
+			previousConfiguration = configuration;
+			previousBuildTime = result.buildTime;
+
+			/* run the workload */
+			unsigned long long foundNeighbors = 0;
+			if (radius > 0.0) {
+				std::vector<std::vector<int> > radiusResults(querySize);
+				timer.reset();
+				for (unsigned int i = 0; i < querySize; ++i) {
+					query.setX(queryPoints->getRawX()[i]);
+					query.setY(queryPoints->getRawY()[i]);
+					query.setZ(queryPoints->getRawZ()[i]);
+					nearestNeighbor->findNeighborsWithinRadius(&query, &radiusResults[i], radius);
+				}
+				result.queryTime = static_cast<double>(timer.getElapsedTime());
+				for (unsigned int r = 0; r < referenceSize; ++r) {
+					unsigned int i = referenceQueries[r];
+					for (unsigned int j = 0; j < radiusResults[i].size(); ++j) {
+						if (squaredDistance(queryPoints, i, dataPoints, radiusResults[i][j]) <= maxSquaredDistances[r]) {
+							++foundNeighbors;
+						}
+					}
+				}
+			} else {
+				timer.reset();
+				nearestNeighbor->findNearestNeighbors(queries, &resultIndices, effectiveK);
+				result.queryTime = static_cast<double>(timer.getElapsedTime());
+				for (unsigned int r = 0; r < referenceSize; ++r) {
+					unsigned int i = referenceQueries[r];
+					for (unsigned int j = 0; j < effectiveK; ++j) {
+						int neighborIndex = resultIndices[i * effectiveK + j];
+						/* neighbors at the same distance as the exact k-th neighbor are equally valid */
+						if ((neighborIndex >= 0) && (squaredDistance(queryPoints, i, dataPoints, neighborIndex) <= maxSquaredDistances[r])) {
+							++foundNeighbors;
+						}
+					}
+				}
+			}
+			result.recall = (totalExactNeighbors == 0) ? 1.0 : std::min(1.0, static_cast<double>(foundNeighbors) / totalExactNeighbors);
+
+		} catch (std::exception& e) {
+			LOG(WARNING) << "NearestNeighborTuner: " << configuration.toString() << " failed: " << e.what();
+			nearestNeighbor.reset();
+			continue;
+		}
+
+		result.cost = result.queryTime + buildTimeWeight * result.buildTime;
+		LOG(INFO) << "NearestNeighborTuner: " << configuration.toString() << " build: " << result.buildTime << "ms, queries: "
+				<< result.queryTime << "ms, recall: " << result.recall;
+		results.push_back(result);
+	}
+
+	/* fastest candidate that reaches the target, otherwise the most accurate one */
+	int bestIndex = -1;
+	int mostAccurateIndex = -1;
+	for (unsigned int i = 0; i < results.size(); ++i) {
+		if ((results[i].recall >= recallTarget) && ((bestIndex < 0) || (results[i].cost < results[bestIndex].cost))) {
+			bestIndex = i;
+		}
+		if ((mostAccurateIndex < 0) || (results[i].recall > results[mostAccurateIndex].recall)) {
+			mostAccurateIndex = i;
+		}
+	}
+
+	if (bestIndex >= 0) {
+		*bestConfiguration = results[bestIndex].configuration;
+		LOG(INFO) << "NearestNeighborTuner: Selected " << bestConfiguration->toString();
+		return true;
+	}
+	if (mostAccurateIndex >= 0) {
+		*bestConfiguration = results[mostAccurateIndex].configuration;
+		LOG(WARNING) << "NearestNeighborTuner: No candidate reaches the recall target " << recallTarget << ". Selected the most accurate one: "
+				<< bestConfiguration->toString();
+	}
+	return false;
+}
+
+const std::vector<NearestNeighborTuningResult>& NearestNeighborTuner::getResults() const {
+	return results;
+}
+
+void NearestNeighborTuner::getDefaultCandidates(std::vector<NearestNeighborConfiguration>& candidates) const {
+	candidates.clear();
+	NearestNeighborConfiguration configuration;
+
+	/* exact search structures */
+	configuration.implementation = "NearestNeighborKDTree3D";
+	candidates.push_back(configuration);
+	configuration.implementation = "NearestNeighborANN";
+	candidates.push_back(configuration);
+	configuration.implementation = "NearestNeighborSTANN";
+	candidates.push_back(configuration);
+	configuration.implementation = "NearestNeighborVoxelGrid";
+	configuration.voxelSize = radius; // 0 for k nearest neighbors, i.e. estimated from the data
+	candidates.push_back(configuration);
+	configuration.voxelSize = 0.0;
+
+	/* approximate search with increasing accuracy */
+	const int trees[] = {1, 4, 8};
+	const int checks[] = {16, 32, 64, 128, 256};
+	configuration.implementation = "NearestNeighborFLANN";
+	configuration.flannAlgorithm = "KDTREE";
+	for (unsigned int t = 0; t < sizeof(trees) / sizeof(trees[0]); ++t) {
+		for (unsigned int c = 0; c < sizeof(checks) / sizeof(checks[0]); ++c) {
+			configuration.trees = trees[t];
+			configuration.checks = checks[c];
+			candidates.push_back(configuration);
+		}
+	}
+}
+
+void NearestNeighborTuner::setCandidates(const std::vector<NearestNeighborConfiguration>& candidates) {
+	this->candidates = candidates;
+}
+
+double NearestNeighborTuner::getRecallTarget() const {
+	return recallTarget;
+}
+
+void NearestNeighborTuner::setRecallTarget(double recallTarget) {
+	this->recallTarget = recallTarget;
+}
+
+unsigned int NearestNeighborTuner::getK() const {
+	return k;
+}
+
+void NearestNeighborTuner::setK(unsigned int k) {
+	assert(k > 0);
+	this->k = k;
+}
+
+double NearestNeighborTuner::getRadius() const {
+	return radius;
+}
+
+void NearestNeighborTuner::setRadius(double radius) {
+	this->radius = radius;
+}
+
+double NearestNeighborTuner::getBuildTimeWeight() const {
+	return buildTimeWeight;
+}
+
+void NearestNeighborTuner::setBuildTimeWeight(double buildTimeWeight) {
+	this->buildTimeWeight = buildTimeWeight;
+}
+
+unsigned int NearestNeighborTuner::getNumberOfQueries() const {
+	return numberOfQueries;
+}
+
+void NearestNeighborTuner::setNumberOfQueries(unsigned int numberOfQueries) {
+	this->numberOfQueries = numberOfQueries;
+}
+
+}
+
+/* EOF */
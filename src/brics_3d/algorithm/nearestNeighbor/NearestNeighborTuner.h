@@ -0,0 +1,174 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#ifndef BRICS_3D_NEARESTNEIGHBORTUNER_H_
+#define BRICS_3D_NEARESTNEIGHBORTUNER_H_
+
+#include "brics_3d/algorithm/nearestNeighbor/NearestNeighborFactory.h"
+
+#include <vector>
+
+namespace brics_3d {
+
+/**
+ * @ingroup nearestNeighbor
+ * @brief Measured performance of one candidate configuration of the NearestNeighborTuner.
+ */
+struct NearestNeighborTuningResult {
+
+	/// The measured backend and parameters
+	NearestNeighborConfiguration configuration;
+
+	/// Time for setData() in [ms]
+	double buildTime;
+
+	/// Time for all queries of the workload in [ms]
+	double queryTime;
+
+	/// Fraction of the exact neighbors that have been found, in [0, 1]
+	double recall;
+
+	/// Value that is minimized by the tuner: queryTime + buildTimeWeight * buildTime
+	double cost;
+};
+
+/**
+ * @ingroup nearestNeighbor
+ * @brief Selects the fastest nearest neighbor backend and parameters for a workload.
+ *
+ * The best backend depends on the size and distribution of the data, the number of neighbors and the required
+ * accuracy. The tuner builds each candidate configuration (see getDefaultCandidates()) on a representative point
+ * cloud, runs the query workload and compares the results to a brute force search over (up to 1000 of) the queries,
+ * so the reference does not depend on any of the candidates. The fastest candidate that reaches the recall target
+ * wins. The workload is either a k nearest neighbor search (default) or a fixed radius search,
+ * see setRadius().
+ *
+ * Tuning takes some time, so the result should be cached and reused for similar data:
+ *  @code
+ *	NearestNeighborFactory factory;
+ *	NearestNeighborConfiguration configuration;
+ *	if (!factory.readConfiguration("nearestNeighbor.xml", &configuration)) {
+ *		NearestNeighborTuner tuner;
+ *		tuner.setRecallTarget(0.95);
+ *		tuner.tune(&representativeCloud, 0, &configuration);
+ *		factory.writeConfiguration("nearestNeighbor.xml", configuration);
+ *	}
+ *	INearestPoint3DNeighborPtr nearestNeighbor = factory.createNearestNeighbor(configuration);
+ * @endcode
+ */
+class NearestNeighborTuner {
+public:
+
+	/**
+	 * @brief Standard constructor
+	 */
+	NearestNeighborTuner();
+
+	/**
+	 * @brief Standard destructor
+	 */
+	virtual ~NearestNeighborTuner();
+
+	/**
+	 * @brief Measure all candidates and select the fastest one that reaches the recall target.
+	 *
+	 * @param[in] data Representative data for setData().
+	 * @param[in] queries Representative query points. If 0, a subset of the data is used (see setNumberOfQueries()).
+	 * @param[out] bestConfiguration The selected configuration. If no candidate reaches the recall target,
+	 *             it is the one with the highest recall.
+	 * @return True if a candidate reaches the recall target.
+	 */
+	bool tune(PointCloud3D* data, PointCloud3D* queries, NearestNeighborConfiguration* bestConfiguration);
+
+	/**
+	 * @brief Get the measurements of all candidates of the last invocation of tune().
+	 */
+	const std::vector<NearestNeighborTuningResult>& getResults() const;
+
+	/**
+	 * @brief Get the default candidates for the current workload: the exact backends and a range of FLANN parameters.
+	 */
+	void getDefaultCandidates(std::vector<NearestNeighborConfiguration>& candidates) const;
+
+	/**
+	 * @brief Set the candidate configurations. If empty (default), getDefaultCandidates() is used.
+	 */
+	void setCandidates(const std::vector<NearestNeighborConfiguration>& candidates);
+
+	double getRecallTarget() const;
+
+	/**
+	 * @brief Set the minimal fraction of the exact neighbors that has to be found. Default is 0.95.
+	 */
+	void setRecallTarget(double recallTarget);
+
+	unsigned int getK() const;
+
+	/**
+	 * @brief Set the number of nearest neighbors of the workload. Default is 1.
+	 */
+	void setK(unsigned int k);
+
+	double getRadius() const;
+
+	/**
+	 * @brief Set the radius of a fixed radius search workload. Default is 0, i.e. k nearest neighbor search.
+	 */
+	void setRadius(double radius);
+
+	double getBuildTimeWeight() const;
+
+	/**
+	 * @brief Set the weight of the build time with respect to the query time of the workload. Default is 1, i.e.
+	 * the index is built once for the workload. Use 0 if the index is built once and queried for a long time.
+	 */
+	void setBuildTimeWeight(double buildTimeWeight);
+
+	unsigned int getNumberOfQueries() const;
+
+	/**
+	 * @brief Set the number of query points that are taken from the data, if no queries are passed to tune().
+	 * Default is 10000.
+	 */
+	void setNumberOfQueries(unsigned int numberOfQueries);
+
+private:
+
+	/// Candidates set by the user
+	std::vector<NearestNeighborConfiguration> candidates;
+
+	/// Measurements of the last tuning run
+	std::vector<NearestNeighborTuningResult> results;
+
+	double recallTarget;
+
+	unsigned int k;
+
+	double radius;
+
+	double buildTimeWeight;
+
+	unsigned int numberOfQueries;
+};
+
+}
+
+#endif /* BRICS_3D_NEARESTNEIGHBORTUNER_H_ */
+
+/* EOF */
@@ -0,0 +1,562 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#include "NearestNeighborVoxelGrid.h"
+#include "NearestNeighborBatchQuery.h"
+#include "brics_3d/core/Logger.h"
+
+#include <assert.h>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+
+using std::runtime_error;
+
+namespace brics_3d {
+
+namespace {
+
+/// Bits per dimension of a voxel key
+const unsigned int keyBits = 21;
+
+/// Maximal number of voxels per dimension
+const unsigned int maxGridSize = (1u << keyBits) - 1;
+
+/// Voxel indices of queries are clamped to this range, so far away queries do not overflow.
+const double maxVoxelIndex = 1 << 30;
+
+typedef std::pair<boost::uint64_t, unsigned int> KeyEntry;
+
+inline boost::uint64_t encodeKey(boost::uint64_t ix, boost::uint64_t iy, boost::uint64_t iz) {
+	return ix | (iy << keyBits) | (iz << (2 * keyBits));
+}
+
+inline void decodeKey(boost::uint64_t key, unsigned int& ix, unsigned int& iy, unsigned int& iz) {
+	const boost::uint64_t mask = (1u << keyBits) - 1;
+	ix = static_cast<unsigned int>(key & mask);
+	iy = static_cast<unsigned int>((key >> keyBits) & mask);
+	iz = static_cast<unsigned int>((key >> (2 * keyBits)) & mask);
+}
+
+/// Input of the parallel key computation.
+struct KeyComputation {
+	const Coordinate* coordinates[3];
+	double origin[3];
+	double inverseVoxelSize;
+	unsigned int gridSize[3];
+	KeyEntry* entries;
+};
+
+/// Compute the voxel keys of the points [begin, end) and sort them.
+void computeKeys(KeyComputation computation, unsigned int /*range*/, unsigned int begin, unsigned int end) {
+	for (unsigned int i = begin; i < end; ++i) {
+		boost::uint64_t index[3];
+		for (int d = 0; d < 3; ++d) {
+			unsigned int voxel = static_cast<unsigned int>((computation.coordinates[d][i] - computation.origin[d]) * computation.inverseVoxelSize);
+			index[d] = std::min(voxel, computation.gridSize[d] - 1);
+		}
+		computation.entries[i] = KeyEntry(encodeKey(index[0], index[1], index[2]), i);
+	}
+	std::sort(computation.entries + begin, computation.entries + end);
+}
+
+/// Merge the sorted ranges 2 * i and 2 * i + 1 for all pairs i in [firstPair, endPair).
+void mergeKeys(KeyEntry* entries, const std::vector<unsigned int>* boundaries, unsigned int /*range*/, unsigned int firstPair, unsigned int endPair) {
+	for (unsigned int i = 2 * firstPair; i < 2 * endPair; i += 2) {
+		std::inplace_merge(entries + (*boundaries)[i], entries + (*boundaries)[i + 1], entries + (*boundaries)[i + 2]);
+	}
+}
+
+/// Input of the parallel reordering of the points.
+struct PointCopy {
+	const Coordinate* coordinates[3];
+	const KeyEntry* entries;
+	Coordinate* sorted[3];
+	int* sortedIndices;
+};
+
+void copyPoints(PointCopy copy, unsigned int /*range*/, unsigned int begin, unsigned int end) {
+	for (unsigned int i = begin; i < end; ++i) {
+		unsigned int index = copy.entries[i].second;
+		for (int d = 0; d < 3; ++d) {
+			copy.sorted[d][i] = copy.coordinates[d][index];
+		}
+		copy.sortedIndices[i] = static_cast<int>(index);
+	}
+}
+
+/// Squared distance of a coordinate to the interval [lower, lower + size].
+inline double squaredSlabDistance(double coordinate, double lower, double size) {
+	double distance = std::max(0.0, std::max(lower - coordinate, coordinate - (lower + size)));
+	return distance * distance;
+}
+
+}
+
+NearestNeighborVoxelGrid::NearestNeighborVoxelGrid() {
+	this->dimension = -1;
+	this->maxDistance = -1; //default = disable
+	this->voxelSize = 0.0; // automatic
+	effectiveVoxelSize = 0.0;
+	numberOfPoints = 0;
+	numberOfVoxels = 0;
+	hashBits = 0;
+	for (int d = 0; d < 3; ++d) {
+		origin[d] = 0.0;
+		gridSize[d] = 0;
+	}
+}
+
+NearestNeighborVoxelGrid::NearestNeighborVoxelGrid(double voxelSize) {
+	this->dimension = -1;
+	this->maxDistance = -1; //default = disable
+	setVoxelSize(voxelSize);
+	effectiveVoxelSize = 0.0;
+	numberOfPoints = 0;
+	numberOfVoxels = 0;
+	hashBits = 0;
+	for (int d = 0; d < 3; ++d) {
+		origin[d] = 0.0;
+		gridSize[d] = 0;
+	}
+}
+
+NearestNeighborVoxelGrid::~NearestNeighborVoxelGrid() {
+
+}
+
+void NearestNeighborVoxelGrid::setData(PointCloud3D* data) {
+	assert(data != 0);
+	setData(data->getStorage());
+}
+
+void NearestNeighborVoxelGrid::setData(const PointCloud3DStorage* data) {
+	assert(data != 0);
+	build(data->getRawX(), data->getRawY(), data->getRawZ(), data->getSize());
+}
+
+void NearestNeighborVoxelGrid::build(const Coordinate* x, const Coordinate* y, const Coordinate* z, unsigned int size) {
+	const unsigned int minimalPointsPerThread = 65536;
+
+	dimension = 3;
+	numberOfPoints = size;
+	numberOfVoxels = 0;
+	voxels.clear();
+	sortedX.clear();
+	sortedY.clear();
+	sortedZ.clear();
+	sortedIndices.clear();
+	if (size == 0) {
+		return;
+	}
+
+	/* bounding box */
+	const Coordinate* coordinates[3] = {x, y, z};
+	double maximum[3];
+	for (int d = 0; d < 3; ++d) {
+		origin[d] = coordinates[d][0];
+		maximum[d] = coordinates[d][0];
+	}
+	for (unsigned int i = 1; i < size; ++i) {
+		for (int d = 0; d < 3; ++d) {
+			origin[d] = std::min(origin[d], static_cast<double>(coordinates[d][i]));
+			maximum[d] = std::max(maximum[d], static_cast<double>(coordinates[d][i]));
+		}
+	}
+	double maxExtent = std::max(maximum[0] - origin[0], std::max(maximum[1] - origin[1], maximum[2] - origin[2]));
+
+	/* voxel size */
+	effectiveVoxelSize = voxelSize;
+	if (effectiveVoxelSize <= 0.0) { // a few points per voxel, thin dimensions (e.g. a plane) do not count
+		double volume = 1.0;
+		for (int d = 0; d < 3; ++d) {
+			volume *= std::max(maximum[d] - origin[d], 0.001 * maxExtent);
+		}
+		effectiveVoxelSize = std::pow(volume * 4.0 / size, 1.0 / 3.0);
+		if (effectiveVoxelSize <= 0.0) { // all points are identical
+			effectiveVoxelSize = 1.0;
+		}
+	}
+	if (maxExtent / effectiveVoxelSize >= maxGridSize - 1) {
+		effectiveVoxelSize = maxExtent / (maxGridSize - 2);
+		LOG(WARNING) << "NearestNeighborVoxelGrid: voxel size is too small for the extent of the data. Using " << effectiveVoxelSize << " instead.";
+	}
+	for (int d = 0; d < 3; ++d) {
+		gridSize[d] = static_cast<unsigned int>((maximum[d] - origin[d]) / effectiveVoxelSize) + 1;
+	}
+
+	/* sort the points by their voxel keys: sort ranges in parallel, then merge them pairwise */
+	std::vector<KeyEntry> entries(size);
+	KeyComputation computation;
+	for (int d = 0; d < 3; ++d) {
+		computation.coordinates[d] = coordinates[d];
+		computation.origin[d] = origin[d];
+		computation.gridSize[d] = gridSize[d];
+	}
+	computation.inverseVoxelSize = 1.0 / effectiveVoxelSize;
+	computation.entries = &entries[0];
+
+	std::vector<unsigned int> boundaries;
+	splitRange(0u, size, numberOfThreads, minimalPointsPerThread, &boundaries);
+	forEachRange(boost::bind(&computeKeys, computation, _1, _2, _3), boundaries);
+
+	while (boundaries.size() > 2) {
+		unsigned int numberOfPairs = static_cast<unsigned int>((boundaries.size() - 1) / 2);
+		forEachRange(boost::bind(&mergeKeys, &entries[0], &boundaries, _1, _2, _3), 0u, numberOfPairs, numberOfPairs, 1u);
+
+		std::vector<unsigned int> mergedBoundaries;
+		unsigned int i = 0;
+		for (; i + 2 < boundaries.size(); i += 2) {
+			mergedBoundaries.push_back(boundaries[i]);
+		}
+		if (i + 1 < boundaries.size()) { // odd number of ranges: the last one stays as it is
+			mergedBoundaries.push_back(boundaries[i]);
+		}
+		mergedBoundaries.push_back(size);
+		boundaries.swap(mergedBoundaries);
+	}
+
+	/* copy the points in voxel order */
+	sortedX.resize(size);
+	sortedY.resize(size);
+	sortedZ.resize(size);
+	sortedIndices.resize(size);
+	PointCopy copy;
+	for (int d = 0; d < 3; ++d) {
+		copy.coordinates[d] = coordinates[d];
+	}
+	copy.entries = &entries[0];
+	copy.sorted[0] = &sortedX[0];
+	copy.sorted[1] = &sortedY[0];
+	copy.sorted[2] = &sortedZ[0];
+	copy.sortedIndices = &sortedIndices[0];
+	forEachRange(boost::bind(&copyPoints, copy, _1, _2, _3), 0u, size, numberOfThreads, minimalPointsPerThread);
+
+	/* hash table of the occupied voxels with a load factor <= 0.5 */
+	for (unsigned int i = 0; i < size; ++i) {
+		if (i == 0 || entries[i].first != entries[i - 1].first) {
+			numberOfVoxels++;
+		}
+	}
+	hashBits = 1;
+	while ((1u << hashBits) < 2 * numberOfVoxels) {
+		hashBits++;
+	}
+	Voxel emptyVoxel;
+	emptyVoxel.key = 0;
+	emptyVoxel.begin = 0;
+	emptyVoxel.end = 0; // marks an empty slot
+	voxels.assign(1u << hashBits, emptyVoxel);
+
+	unsigned int begin = 0;
+	for (unsigned int i = 1; i <= size; ++i) {
+		if (i == size || entries[i].first != entries[begin].first) {
+			boost::uint64_t key = entries[begin].first;
+			unsigned int slot = static_cast<unsigned int>((key * 0x9E3779B97F4A7C15ULL) >> (64 - hashBits));
+			while (voxels[slot].end != 0) {
+				slot = (slot + 1) & ((1u << hashBits) - 1);
+			}
+			voxels[slot].key = key;
+			voxels[slot].begin = begin;
+			voxels[slot].end = i;
+			begin = i;
+		}
+	}
+}
+
+const NearestNeighborVoxelGrid::Voxel* NearestNeighborVoxelGrid::findVoxel(unsigned int ix, unsigned int iy, unsigned int iz) const {
+	boost::uint64_t key = encodeKey(ix, iy, iz);
+	unsigned int slot = static_cast<unsigned int>((key * 0x9E3779B97F4A7C15ULL) >> (64 - hashBits));
+	while (voxels[slot].end != 0) {
+		if (voxels[slot].key == key) {
+			return &voxels[slot];
+		}
+		slot = (slot + 1) & ((1u << hashBits) - 1);
+	}
+	return 0;
+}
+
+double NearestNeighborVoxelGrid::voxelIndex(double coordinate, int dimension) const {
+	double index = std::floor((coordinate - origin[dimension]) * (1.0 / effectiveVoxelSize)); // same computation as for the keys
+	return std::max(-maxVoxelIndex, std::min(maxVoxelIndex, index));
+}
+
+/*
+ * The voxels are inspected in shells (with respect to the Chebyshev distance of the voxel indices)
+ * around the voxel of the query. All points behind shell R are at least R * voxelSize away, so the
+ * search stops as soon as the k-th neighbor is closer.
+ */
+void NearestNeighborVoxelGrid::searchNearest(const double query[3], unsigned int k, double maxSquaredDistance,
+		std::vector<std::pair<double, int> >& neighbors) const {
+	neighbors.clear();
+	if (numberOfPoints == 0 || k == 0) {
+		return;
+	}
+
+	int center[3];
+	int firstShell = 0;
+	int lastShell = 0;
+	for (int d = 0; d < 3; ++d) {
+		center[d] = static_cast<int>(voxelIndex(query[d], d));
+		int last = static_cast<int>(gridSize[d]) - 1;
+		if (center[d] < 0) {
+			firstShell = std::max(firstShell, -center[d]);
+		} else if (center[d] > last) {
+			firstShell = std::max(firstShell, center[d] - last);
+		}
+		lastShell = std::max(lastShell, std::max(center[d], last - center[d]));
+	}
+
+	double bound = (maxSquaredDistance < 0.0) ? std::numeric_limits<double>::max() : maxSquaredDistance;
+	for (int shell = firstShell; shell <= lastShell; ++shell) {
+		double shellDistance = (shell - 1) * effectiveVoxelSize; // lower bound for all points of this and all further shells
+		if (shell > 0 && shellDistance * shellDistance > ((neighbors.size() < k) ? bound : neighbors.back().first)) {
+			break;
+		}
+
+		int minimum[3];
+		int maximum[3];
+		for (int d = 0; d < 3; ++d) {
+			minimum[d] = std::max(center[d] - shell, 0);
+			maximum[d] = std::min(center[d] + shell, static_cast<int>(gridSize[d]) - 1);
+		}
+		for (int ix = minimum[0]; ix <= maximum[0]; ++ix) {
+			for (int iy = minimum[1]; iy <= maximum[1]; ++iy) {
+				bool isOnShell = (std::abs(ix - center[0]) == shell || std::abs(iy - center[1]) == shell);
+				int zStep = isOnShell ? 1 : 2 * shell;
+				for (int iz = center[2] - shell; iz <= center[2] + shell; iz += zStep) {
+					if (iz < minimum[2] || iz > maximum[2]) {
+						continue;
+					}
+					const Voxel* voxel = findVoxel(ix, iy, iz);
+					if (voxel == 0) {
+						continue;
+					}
+					for (unsigned int i = voxel->begin; i < voxel->end; ++i) {
+						double dx = sortedX[i] - query[0];
+						double dy = sortedY[i] - query[1];
+						double dz = sortedZ[i] - query[2];
+						double squaredDistance = dx * dx + dy * dy + dz * dz;
+						if (squaredDistance <= bound) {
+							insertNeighbor(neighbors, k, squaredDistance, sortedIndices[i]);
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+void NearestNeighborVoxelGrid::searchNearest(const double query[3], unsigned int k, std::vector<int>* resultIndices, std::vector<double>* resultDistances,
+		neighborDistance::Type distanceType) const {
+	if (k > numberOfPoints) {
+		throw runtime_error("Number of neighbors k is bigger than the amount of data points.");
+	}
+
+	resultIndices->clear();
+	if (resultDistances != 0) {
+		resultDistances->clear();
+	}
+
+	std::vector<std::pair<double, int> > neighbors;
+	searchNearest(query, k, (maxDistance < 0.0) ? -1.0 : maxDistance * maxDistance, neighbors);
+
+	double resultDistance;
+	for (unsigned int i = 0; i < neighbors.size(); ++i) {
+		if (isWithinMaxDistance(neighbors[i].first, distanceType, resultDistance)) {
+			resultIndices->push_back(neighbors[i].second);
+			if (resultDistances != 0) {
+				resultDistances->push_back(resultDistance);
+			}
+		}
+	}
+}
+
+void NearestNeighborVoxelGrid::searchRadius(const double query[3], double radius, unsigned int maxResults, std::vector<int>* resultIndices,
+		std::vector<double>* resultDistances, neighborDistance::Type distanceType) const {
+	resultIndices->clear();
+	if (resultDistances != 0) {
+		resultDistances->clear();
+	}
+	if (radius < 0.0 || numberOfPoints == 0) {
+		return;
+	}
+
+	/* range of voxels that intersect the bounding box of the sphere */
+	unsigned int minimum[3];
+	unsigned int maximum[3];
+	double numberOfBoxVoxels = 1.0;
+	for (int d = 0; d < 3; ++d) {
+		double lower = std::max(voxelIndex(query[d] - radius, d), 0.0);
+		double upper = std::min(voxelIndex(query[d] + radius, d), static_cast<double>(gridSize[d]) - 1.0);
+		if (lower > upper) { // sphere is outside of the grid
+			return;
+		}
+		minimum[d] = static_cast<unsigned int>(lower);
+		maximum[d] = static_cast<unsigned int>(upper);
+		numberOfBoxVoxels *= upper - lower + 1.0;
+	}
+
+	std::vector<std::pair<double, int> > neighbors;
+	double squaredRadius = radius * radius;
+	if (numberOfBoxVoxels <= voxels.size()) {
+
+		/* voxels in the corners of the box are skipped if their distance to the query exceeds the radius */
+		for (unsigned int iz = minimum[2]; iz <= maximum[2]; ++iz) {
+			double zDistance = squaredSlabDistance(query[2], origin[2] + iz * effectiveVoxelSize, effectiveVoxelSize);
+			for (unsigned int iy = minimum[1]; iy <= maximum[1]; ++iy) {
+				double yzDistance = zDistance + squaredSlabDistance(query[1], origin[1] + iy * effectiveVoxelSize, effectiveVoxelSize);
+				if (yzDistance > squaredRadius) {
+					continue;
+				}
+				for (unsigned int ix = minimum[0]; ix <= maximum[0]; ++ix) {
+					if (yzDistance + squaredSlabDistance(query[0], origin[0] + ix * effectiveVoxelSize, effectiveVoxelSize) > squaredRadius) {
+						continue;
+					}
+					const Voxel* voxel = findVoxel(ix, iy, iz);
+					if (voxel == 0) {
+						continue;
+					}
+					for (unsigned int i = voxel->begin; i < voxel->end; ++i) {
+						double dx = sortedX[i] - query[0];
+						double dy = sortedY[i] - query[1];
+						double dz = sortedZ[i] - query[2];
+						double squaredDistance = dx * dx + dy * dy + dz * dz;
+						if (squaredDistance <= squaredRadius) {
+							neighbors.push_back(std::make_pair(squaredDistance, sortedIndices[i]));
+						}
+					}
+				}
+			}
+		}
+	} else { // large radius: cheaper to check all occupied voxels than all voxels of the box
+		for (unsigned int slot = 0; slot < voxels.size(); ++slot) {
+			const Voxel& voxel = voxels[slot];
+			unsigned int index[3];
+			decodeKey(voxel.key, index[0], index[1], index[2]);
+			if (voxel.end == 0 ||
+					index[0] < minimum[0] || index[0] > maximum[0] ||
+					index[1] < minimum[1] || index[1] > maximum[1] ||
+					index[2] < minimum[2] || index[2] > maximum[2]) {
+				continue;
+			}
+			for (unsigned int i = voxel.begin; i < voxel.end; ++i) {
+				double dx = sortedX[i] - query[0];
+				double dy = sortedY[i] - query[1];
+				double dz = sortedZ[i] - query[2];
+				double squaredDistance = dx * dx + dy * dy + dz * dz;
+				if (squaredDistance <= squaredRadius) {
+					neighbors.push_back(std::make_pair(squaredDistance, sortedIndices[i]));
+				}
+			}
+		}
+	}
+
+	copyRadiusNeighbors(neighbors, maxResults, resultIndices, resultDistances, distanceType);
+}
+
+void NearestNeighborVoxelGrid::findNearestNeighbors(Point3D* query, std::vector<int>* resultIndices, unsigned int k) {
+	findNearestNeighbors(query, resultIndices, 0, k);
+}
+
+void NearestNeighborVoxelGrid::findNearestNeighbors(Point3D* query, std::vector<int>* resultIndices, std::vector<double>* resultDistances,
+		unsigned int k, neighborDistance::Type distanceType) {
+	assert (query != 0);
+	assert (resultIndices != 0);
+
+	double queryData[3] = {query->getX(), query->getY(), query->getZ()};
+	searchNearest(queryData, k, resultIndices, resultDistances, distanceType);
+}
+
+void NearestNeighborVoxelGrid::findNearestNeighbors(PointCloud3D* queries, std::vector<int>* resultIndices, unsigned int k) {
+	assert (queries != 0);
+	findNearestNeighbors(queries, 0, queries->getSize(), resultIndices, 0, k);
+}
+
+void NearestNeighborVoxelGrid::findNearestNeighbors(PointCloud3D* queries, unsigned int begin, unsigned int end, std::vector<int>* resultIndices, unsigned int k) {
+	findNearestNeighbors(queries, begin, end, resultIndices, 0, k);
+}
+
+void NearestNeighborVoxelGrid::findNearestNeighbors(PointCloud3D* queries, unsigned int begin, unsigned int end, std::vector<int>* resultIndices,
+		std::vector<double>* resultDistances, unsigned int k, neighborDistance::Type distanceType) {
+	assert (queries != 0);
+	assert (resultIndices != 0);
+	assert (begin <= end);
+	assert (end <= queries->getSize());
+
+	if (k > numberOfPoints) {
+		throw runtime_error("Number of neighbors k is bigger than the amount of data points.");
+	}
+
+	resultIndices->resize((end - begin) * k);
+	if (resultDistances != 0) {
+		resultDistances->resize((end - begin) * k);
+	}
+	if (begin == end || k == 0) {
+		return;
+	}
+
+	/* queries only read the grid */
+	double maxSquaredDistance = (maxDistance < 0.0) ? -1.0 : maxDistance * maxDistance;
+	NeighborSearchMethod<NearestNeighborVoxelGrid>::Type search = &NearestNeighborVoxelGrid::searchNearest;
+	runBatchQuery(boost::bind(search, this, _1, k, maxSquaredDistance, _2), queries->getStorage(), begin, end, k, maxDistance, distanceType,
+			&(*resultIndices)[0], (resultDistances != 0) ? &(*resultDistances)[0] : 0, numberOfThreads);
+}
+
+void NearestNeighborVoxelGrid::findNeighborsWithinRadius(Point3D* query, std::vector<int>* resultIndices, double radius, unsigned int maxResults) {
+	findNeighborsWithinRadius(query, resultIndices, 0, radius, maxResults);
+}
+
+void NearestNeighborVoxelGrid::findNeighborsWithinRadius(Point3D* query, std::vector<int>* resultIndices, std::vector<double>* resultDistances,
+		double radius, unsigned int maxResults, neighborDistance::Type distanceType) {
+	assert (query != 0);
+	assert (resultIndices != 0);
+
+	double queryData[3] = {query->getX(), query->getY(), query->getZ()};
+	searchRadius(queryData, radius, maxResults, resultIndices, resultDistances, distanceType);
+}
+
+void NearestNeighborVoxelGrid::setVoxelSize(double voxelSize) {
+	if (voxelSize < 0.0) {
+		throw runtime_error("ERROR: voxelSize for NearestNeighborVoxelGrid cannot be less than 0.");
+	}
+	this->voxelSize = voxelSize;
+}
+
+double NearestNeighborVoxelGrid::getVoxelSize() const {
+	return voxelSize;
+}
+
+double NearestNeighborVoxelGrid::getEffectiveVoxelSize() const {
+	return effectiveVoxelSize;
+}
+
+unsigned int NearestNeighborVoxelGrid::getNumberOfVoxels() const {
+	return numberOfVoxels;
+}
+
+unsigned int NearestNeighborVoxelGrid::getSize() const {
+	return numberOfPoints;
+}
+
+}
+
+/* EOF */
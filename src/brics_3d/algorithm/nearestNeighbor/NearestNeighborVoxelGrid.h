@@ -0,0 +1,185 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#ifndef BRICS_3D_NEARESTNEIGHBORVOXELGRID_H_
+#define BRICS_3D_NEARESTNEIGHBORVOXELGRID_H_
+
+#include "brics_3d/algorithm/nearestNeighbor/INearestPoint3DNeighbor.h"
+#include "brics_3d/algorithm/nearestNeighbor/INearestNeighborSetup.h"
+
+#include <boost/cstdint.hpp>
+
+namespace brics_3d {
+
+/**
+ * @ingroup nearestNeighbor
+ * @brief Nearest neighbor search with a spatial hash of uniform voxel cells.
+ *
+ * The bounding box of the data is divided into cubic voxels of the size set by setVoxelSize() (the same concept as
+ * the voxel size of the Octree, but here it is the full edge length of a voxel). Only occupied voxels are stored in
+ * a hash table, each one refers to a contiguous range of points, so the lookup of the candidates is O(1) per voxel.
+ *
+ * This search structure is intended for fixed radius queries at a known scale (e.g. Euclidean clustering, outlier
+ * removal or normal estimation). Best performance is achieved with a voxel size close to the search radius, then
+ * a radius query visits at most 3x3x3 voxels. The k nearest neighbor search inspects shells of voxels around the
+ * query until the k-th neighbor is closer than the next shell.
+ *
+ * The search is exact and works with double precision. Construction (key computation, sorting and copying of the
+ * points) is distributed over several threads, see setNumberOfThreads(). Queries do not modify the structure,
+ * so batched queries are processed concurrently as well.
+ */
+class NearestNeighborVoxelGrid : public INearestPoint3DNeighbor, public INearestNeighborSetup {
+public:
+
+	/**
+	 * @brief Standard constructor
+	 */
+	NearestNeighborVoxelGrid();
+
+	/**
+	 * @brief Constructor that sets the voxel size.
+	 * @param voxelSize Edge length of a voxel, e.g. the radius of the intended queries.
+	 */
+	NearestNeighborVoxelGrid(double voxelSize);
+
+	/**
+	 * @brief Standard destructor
+	 */
+	virtual ~NearestNeighborVoxelGrid();
+
+	void setData(PointCloud3D* data);
+
+	/**
+	 * @brief Build the grid directly from coordinate arrays.
+	 */
+	void setData(const PointCloud3DStorage* data);
+
+	void findNearestNeighbors(Point3D* query, std::vector<int>* resultIndices, unsigned int k = 1);
+	void findNearestNeighbors(PointCloud3D* queries, std::vector<int>* resultIndices, unsigned int k = 1);
+	void findNearestNeighbors(PointCloud3D* queries, unsigned int begin, unsigned int end, std::vector<int>* resultIndices, unsigned int k = 1);
+	void findNeighborsWithinRadius(Point3D* query, std::vector<int>* resultIndices, double radius, unsigned int maxResults = 0);
+
+	void findNearestNeighbors(Point3D* query, std::vector<int>* resultIndices, std::vector<double>* resultDistances,
+			unsigned int k = 1, neighborDistance::Type distanceType = neighborDistance::euclidean);
+	void findNearestNeighbors(PointCloud3D* queries, unsigned int begin, unsigned int end, std::vector<int>* resultIndices,
+			std::vector<double>* resultDistances, unsigned int k = 1, neighborDistance::Type distanceType = neighborDistance::euclidean);
+	void findNeighborsWithinRadius(Point3D* query, std::vector<int>* resultIndices, std::vector<double>* resultDistances,
+			double radius, unsigned int maxResults = 0, neighborDistance::Type distanceType = neighborDistance::euclidean);
+
+	/**
+	 * @brief Set the edge length of a voxel.
+	 *
+	 * Takes effect with the next invocation of setData(). If the value is 0 the voxel size is estimated from the
+	 * bounding box and the number of points, such that a voxel holds a few points on average. If the data extends
+	 * over more than 2^21 voxels per dimension, the voxel size is enlarged accordingly.
+	 *
+	 * @param voxelSize The new voxel size. Must not be less than 0.
+	 */
+	void setVoxelSize(double voxelSize);
+
+	/**
+	 * @brief Get the voxel size as set by setVoxelSize().
+	 */
+	double getVoxelSize() const;
+
+	/**
+	 * @brief Get the voxel size that is actually used by the current data.
+	 */
+	double getEffectiveVoxelSize() const;
+
+	/**
+	 * @brief Number of occupied voxels.
+	 */
+	unsigned int getNumberOfVoxels() const;
+
+	/**
+	 * @brief Number of points in the grid.
+	 */
+	unsigned int getSize() const;
+
+private:
+
+	/// Occupied voxel: points [begin, end) of the sorted point arrays.
+	struct Voxel {
+		boost::uint64_t key;
+		unsigned int begin;
+		unsigned int end;
+	};
+
+	void build(const Coordinate* x, const Coordinate* y, const Coordinate* z, unsigned int size);
+
+	/// Returns 0 if the voxel is not occupied.
+	const Voxel* findVoxel(unsigned int ix, unsigned int iy, unsigned int iz) const;
+
+	/// Voxel index of a coordinate. Might be outside of the grid.
+	double voxelIndex(double coordinate, int dimension) const;
+
+	void searchNearest(const double query[3], unsigned int k, std::vector<int>* resultIndices, std::vector<double>* resultDistances,
+			neighborDistance::Type distanceType) const;
+	void searchRadius(const double query[3], double radius, unsigned int maxResults, std::vector<int>* resultIndices,
+			std::vector<double>* resultDistances, neighborDistance::Type distanceType) const;
+
+	/**
+	 * @brief k nearest neighbors as (squared distance, index) pairs sorted by increasing distance.
+	 * @param maxSquaredDistance Only neighbors within this squared distance are considered. Negative values disable the bound.
+	 */
+	void searchNearest(const double query[3], unsigned int k, double maxSquaredDistance, std::vector<std::pair<double, int> >& neighbors) const;
+
+	/// Open addressing hash table of the occupied voxels
+	std::vector<Voxel> voxels;
+
+	/// Number of bits of the hash table size
+	unsigned int hashBits;
+
+	/// Number of occupied voxels
+	unsigned int numberOfVoxels;
+
+	/// x coordinates sorted by voxel
+	std::vector<Coordinate> sortedX;
+
+	/// y coordinates sorted by voxel
+	std::vector<Coordinate> sortedY;
+
+	/// z coordinates sorted by voxel
+	std::vector<Coordinate> sortedZ;
+
+	/// Original point index of the sorted points
+	std::vector<int> sortedIndices;
+
+	/// Minimum of the bounding box, i.e. the corner of the voxel (0, 0, 0)
+	double origin[3];
+
+	/// Number of voxels per dimension
+	unsigned int gridSize[3];
+
+	/// Voxel size as requested by the user
+	double voxelSize;
+
+	/// Voxel size of the current data
+	double effectiveVoxelSize;
+
+	/// Number of points in the grid
+	unsigned int numberOfPoints;
+};
+
+}
+
+#endif /* BRICS_3D_NEARESTNEIGHBORVOXELGRID_H_ */
+
+/* EOF */
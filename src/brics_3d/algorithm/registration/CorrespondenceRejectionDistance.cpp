@@ -0,0 +1,64 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#include "CorrespondenceRejectionDistance.h"
+
+#include <stdexcept>
+
+namespace brics_3d {
+
+CorrespondenceRejectionDistance::CorrespondenceRejectionDistance(double maxDistance) {
+	setMaxDistance(maxDistance);
+}
+
+CorrespondenceRejectionDistance::~CorrespondenceRejectionDistance() {
+
+}
+
+void CorrespondenceRejectionDistance::rejectCorrespondences(PointCloud3D* model, PointCloud3D* data,
+		std::vector<CorrespondenceIndexPair>* indexPairs, std::vector<double>* weights) {
+	assert(model != 0);
+	assert(data != 0);
+	assert(indexPairs != 0);
+	assert(weights != 0);
+
+	std::vector<double> squaredDistances;
+	computeSquaredDistances(model, data, *indexPairs, &squaredDistances);
+	double maxSquaredDistance = maxDistance * maxDistance;
+	std::vector<char> keep(indexPairs->size());
+	for (unsigned int i = 0; i < indexPairs->size(); ++i) {
+		keep[i] = (squaredDistances[i] <= maxSquaredDistance);
+	}
+	removeRejected(keep, indexPairs, weights);
+}
+
+double CorrespondenceRejectionDistance::getMaxDistance() const {
+	return maxDistance;
+}
+
+void CorrespondenceRejectionDistance::setMaxDistance(double maxDistance) {
+	if (maxDistance <= 0.0) {
+		throw std::runtime_error("ERROR: maxDistance for the correspondence rejection must be greater than 0.");
+	}
+	this->maxDistance = maxDistance;
+}
+
+}
+
+/* EOF */
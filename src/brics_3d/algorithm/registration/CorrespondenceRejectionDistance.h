@@ -0,0 +1,72 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#ifndef BRICS_3D_CORRESPONDENCEREJECTIONDISTANCE_H_
+#define BRICS_3D_CORRESPONDENCEREJECTIONDISTANCE_H_
+
+#include "ICorrespondenceRejection.h"
+
+namespace brics_3d {
+
+/**
+ * @ingroup registration
+ * @brief Rejects correspondences whose points are farther apart than a fixed distance.
+ *
+ * In contrast to IPointCorrespondence::setMaxCorrespondenceDistance() this works with any correspondence search and
+ * can be combined with the other rejection stages.
+ */
+class CorrespondenceRejectionDistance : public ICorrespondenceRejection {
+public:
+
+	/**
+	 * @brief Standard constructor
+	 * @param maxDistance Maximal distance of corresponding points. Must be greater than 0.
+	 */
+	CorrespondenceRejectionDistance(double maxDistance = 1.0);
+
+	/**
+	 * @brief Standard destructor
+	 */
+	virtual ~CorrespondenceRejectionDistance();
+
+	void rejectCorrespondences(PointCloud3D* model, PointCloud3D* data, std::vector<CorrespondenceIndexPair>* indexPairs,
+			std::vector<double>* weights);
+
+	/**
+	 * @brief Get the maximal distance of corresponding points.
+	 */
+	double getMaxDistance() const;
+
+	/**
+	 * @brief Set the maximal distance of corresponding points.
+	 * @param maxDistance Must be greater than 0.
+	 */
+	void setMaxDistance(double maxDistance);
+
+private:
+
+	/// Maximal distance of corresponding points
+	double maxDistance;
+};
+
+}
+
+#endif /* BRICS_3D_CORRESPONDENCEREJECTIONDISTANCE_H_ */
+
+/* EOF */
@@ -0,0 +1,93 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#include "CorrespondenceRejectionNormal.h"
+#include "brics_3d/core/Logger.h"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace brics_3d {
+
+CorrespondenceRejectionNormal::CorrespondenceRejectionNormal(double maxAngle) {
+	setMaxAngle(maxAngle);
+}
+
+CorrespondenceRejectionNormal::~CorrespondenceRejectionNormal() {
+
+}
+
+void CorrespondenceRejectionNormal::rejectCorrespondences(PointCloud3D* model, PointCloud3D* data,
+		std::vector<CorrespondenceIndexPair>* indexPairs, std::vector<double>* weights) {
+	assert(model != 0);
+	assert(data != 0);
+	assert(indexPairs != 0);
+	assert(weights != 0);
+
+	if (indexPairs->empty()) {
+		return;
+	}
+	const Coordinate* modelNormal = modelNormals.getNormals(model);
+	const Coordinate* dataNormal = dataNormals.getNormals(data);
+	if (modelNormal == 0 || dataNormal == 0) {
+		LOG(WARNING) << "No normals available. Correspondences are not checked for compatible normals.";
+		return;
+	}
+
+	/* |cos| of the angle, normals might be degenerated (zero or NaN) */
+	double minCosine = std::cos(maxAngle);
+	std::vector<char> keep(indexPairs->size());
+	for (unsigned int i = 0; i < indexPairs->size(); ++i) {
+		const Coordinate* m = modelNormal + 3 * (*indexPairs)[i].firstIndex;
+		const Coordinate* d = dataNormal + 3 * (*indexPairs)[i].secondIndex;
+		double dot = m[0] * d[0] + m[1] * d[1] + m[2] * d[2];
+		double norms = std::sqrt((m[0] * m[0] + m[1] * m[1] + m[2] * m[2]) * (d[0] * d[0] + d[1] * d[1] + d[2] * d[2]));
+		keep[i] = (std::abs(dot) >= minCosine * norms) && (norms > 0.0);
+	}
+	removeRejected(keep, indexPairs, weights);
+}
+
+void CorrespondenceRejectionNormal::prepareData(PointCloud3D* data) {
+	assert(data != 0);
+	dataNormals.addNormalChannel(data);
+}
+
+double CorrespondenceRejectionNormal::getMaxAngle() const {
+	return maxAngle;
+}
+
+void CorrespondenceRejectionNormal::setMaxAngle(double maxAngle) {
+	if (maxAngle < 0.0 || maxAngle > M_PI_2) {
+		throw std::runtime_error("ERROR: maxAngle for the correspondence rejection must be in [0, pi/2].");
+	}
+	this->maxAngle = maxAngle;
+}
+
+int CorrespondenceRejectionNormal::getNumberOfNormalNeighbors() const {
+	return modelNormals.getNumberOfNeighbors();
+}
+
+void CorrespondenceRejectionNormal::setNumberOfNormalNeighbors(int numberOfNormalNeighbors) {
+	modelNormals.setNumberOfNeighbors(numberOfNormalNeighbors);
+	dataNormals.setNumberOfNeighbors(numberOfNormalNeighbors);
+}
+
+}
+
+/* EOF */
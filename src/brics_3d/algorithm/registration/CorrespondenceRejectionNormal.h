@@ -0,0 +1,98 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#ifndef BRICS_3D_CORRESPONDENCEREJECTIONNORMAL_H_
+#define BRICS_3D_CORRESPONDENCEREJECTIONNORMAL_H_
+
+#include "ICorrespondenceRejection.h"
+#include "NormalCache.h"
+
+namespace brics_3d {
+
+/**
+ * @ingroup registration
+ * @brief Rejects correspondences with incompatible surface normals.
+ *
+ * A pair is rejected if the angle between the normals of its points exceeds a threshold, e.g. points on the two
+ * sides of a thin wall or on perpendicular surfaces near an edge. The orientation of the normals is ignored, as
+ * estimated normals are not consistently oriented.
+ *
+ * The normals of both point clouds are provided by a NormalCache. As the data is transformed in every ICP iteration,
+ * its normals are estimated once in prepareData() and attached as PointCloud3D::normalChannel, which is rotated
+ * along with the points.
+ * Without normals no pair is rejected, pairs with a degenerated normal (zero or NaN) are always rejected.
+ */
+class CorrespondenceRejectionNormal : public ICorrespondenceRejection {
+public:
+
+	/**
+	 * @brief Standard constructor
+	 * @param maxAngle Maximal angle between the normals of corresponding points in radians, in [0, pi/2].
+	 */
+	CorrespondenceRejectionNormal(double maxAngle = 0.785398163397);
+
+	/**
+	 * @brief Standard destructor
+	 */
+	virtual ~CorrespondenceRejectionNormal();
+
+	void rejectCorrespondences(PointCloud3D* model, PointCloud3D* data, std::vector<CorrespondenceIndexPair>* indexPairs,
+			std::vector<double>* weights);
+
+	void prepareData(PointCloud3D* data);
+
+	/**
+	 * @brief Get the maximal angle between the normals of corresponding points in radians.
+	 */
+	double getMaxAngle() const;
+
+	/**
+	 * @brief Set the maximal angle between the normals of corresponding points.
+	 * @param maxAngle Angle in radians, in [0, pi/2].
+	 */
+	void setMaxAngle(double maxAngle);
+
+	/**
+	 * @brief Get the number of neighbors that define the plane of a point, if the normals have to be estimated.
+	 */
+	int getNumberOfNormalNeighbors() const;
+
+	/**
+	 * @brief Set the number of neighbors that define the plane of a point, if the normals have to be estimated.
+	 * @param numberOfNormalNeighbors At least 3. Default is 10.
+	 */
+	void setNumberOfNormalNeighbors(int numberOfNormalNeighbors);
+
+private:
+
+	/// Maximal angle between the normals
+	double maxAngle;
+
+	/// Normals of the model
+	NormalCache modelNormals;
+
+	/// Normals of the data
+	NormalCache dataNormals;
+};
+
+}
+
+#endif /* BRICS_3D_CORRESPONDENCEREJECTIONNORMAL_H_ */
+
+/* EOF */
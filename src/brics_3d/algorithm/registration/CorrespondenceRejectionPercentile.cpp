@@ -0,0 +1,86 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#include "CorrespondenceRejectionPercentile.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace brics_3d {
+
+CorrespondenceRejectionPercentile::CorrespondenceRejectionPercentile(double percentile, double factor) {
+	setPercentile(percentile);
+	setFactor(factor);
+}
+
+CorrespondenceRejectionPercentile::~CorrespondenceRejectionPercentile() {
+
+}
+
+void CorrespondenceRejectionPercentile::rejectCorrespondences(PointCloud3D* model, PointCloud3D* data,
+		std::vector<CorrespondenceIndexPair>* indexPairs, std::vector<double>* weights) {
+	assert(model != 0);
+	assert(data != 0);
+	assert(indexPairs != 0);
+	assert(weights != 0);
+
+	if (indexPairs->empty()) {
+		return;
+	}
+	std::vector<double> squaredDistances;
+	computeSquaredDistances(model, data, *indexPairs, &squaredDistances);
+
+	/* squared distances preserve the order, so the threshold is scaled by the squared factor */
+	std::vector<double> sortedDistances(squaredDistances);
+	unsigned int rank = static_cast<unsigned int>(percentile * (sortedDistances.size() - 1) + 0.5);
+	std::nth_element(sortedDistances.begin(), sortedDistances.begin() + rank, sortedDistances.end());
+	double maxSquaredDistance = factor * factor * sortedDistances[rank];
+
+	std::vector<char> keep(indexPairs->size());
+	for (unsigned int i = 0; i < indexPairs->size(); ++i) {
+		keep[i] = (squaredDistances[i] <= maxSquaredDistance);
+	}
+	removeRejected(keep, indexPairs, weights);
+}
+
+double CorrespondenceRejectionPercentile::getPercentile() const {
+	return percentile;
+}
+
+void CorrespondenceRejectionPercentile::setPercentile(double percentile) {
+	if (percentile <= 0.0 || percentile > 1.0) {
+		throw std::runtime_error("ERROR: percentile for the correspondence rejection must be in (0, 1].");
+	}
+	this->percentile = percentile;
+}
+
+double CorrespondenceRejectionPercentile::getFactor() const {
+	return factor;
+}
+
+void CorrespondenceRejectionPercentile::setFactor(double factor) {
+	if (factor < 1.0) {
+		throw std::runtime_error("ERROR: factor for the correspondence rejection cannot be less than 1.");
+	}
+	this->factor = factor;
+}
+
+}
+
+/* EOF */
@@ -0,0 +1,89 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#ifndef BRICS_3D_CORRESPONDENCEREJECTIONPERCENTILE_H_
+#define BRICS_3D_CORRESPONDENCEREJECTIONPERCENTILE_H_
+
+#include "ICorrespondenceRejection.h"
+
+namespace brics_3d {
+
+/**
+ * @ingroup registration
+ * @brief Rejects correspondences relative to the distribution of the correspondence distances.
+ *
+ * A pair is rejected if its distance exceeds factor * d_p, where d_p is the distance at the given percentile of
+ * all correspondences of the current iteration. The threshold adapts to the progress of the registration:
+ * - percentile 0.5 and a factor of about 3 reject outliers relative to the median distance.
+ * - a factor of 1 keeps the closest pairs only, e.g. 0.9 for a trimmed ICP with about 90% overlap.
+ */
+class CorrespondenceRejectionPercentile : public ICorrespondenceRejection {
+public:
+
+	/**
+	 * @brief Standard constructor
+	 * @param percentile Percentile of the distances in (0, 1].
+	 * @param factor Factor for the distance at the percentile. Must be at least 1.
+	 */
+	CorrespondenceRejectionPercentile(double percentile = 0.5, double factor = 3.0);
+
+	/**
+	 * @brief Standard destructor
+	 */
+	virtual ~CorrespondenceRejectionPercentile();
+
+	void rejectCorrespondences(PointCloud3D* model, PointCloud3D* data, std::vector<CorrespondenceIndexPair>* indexPairs,
+			std::vector<double>* weights);
+
+	/**
+	 * @brief Get the percentile of the distances that defines the threshold.
+	 */
+	double getPercentile() const;
+
+	/**
+	 * @brief Set the percentile of the distances that defines the threshold.
+	 * @param percentile In (0, 1].
+	 */
+	void setPercentile(double percentile);
+
+	/**
+	 * @brief Get the factor for the distance at the percentile.
+	 */
+	double getFactor() const;
+
+	/**
+	 * @brief Set the factor for the distance at the percentile.
+	 * @param factor At least 1.
+	 */
+	void setFactor(double factor);
+
+private:
+
+	/// Percentile of the distances
+	double percentile;
+
+	/// Factor for the distance at the percentile
+	double factor;
+};
+
+}
+
+#endif /* BRICS_3D_CORRESPONDENCEREJECTIONPERCENTILE_H_ */
+
+/* EOF */
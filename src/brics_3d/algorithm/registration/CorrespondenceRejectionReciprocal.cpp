@@ -0,0 +1,63 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#include "CorrespondenceRejectionReciprocal.h"
+
+namespace brics_3d {
+
+CorrespondenceRejectionReciprocal::CorrespondenceRejectionReciprocal() {
+
+}
+
+CorrespondenceRejectionReciprocal::~CorrespondenceRejectionReciprocal() {
+
+}
+
+void CorrespondenceRejectionReciprocal::rejectCorrespondences(PointCloud3D* model, PointCloud3D* data,
+		std::vector<CorrespondenceIndexPair>* indexPairs, std::vector<double>* weights) {
+	assert(model != 0);
+	assert(data != 0);
+	assert(indexPairs != 0);
+	assert(weights != 0);
+
+	if (indexPairs->empty()) {
+		return;
+	}
+
+	/* search the nearest data point of each matched model point */
+	std::vector<int> modelIndices(indexPairs->size());
+	for (unsigned int i = 0; i < indexPairs->size(); ++i) {
+		modelIndices[i] = (*indexPairs)[i].firstIndex;
+	}
+	PointCloud3D queries;
+	queries.addPoints(model, modelIndices);
+	dataSearch.setData(data->getStorage());
+	std::vector<int> reverseIndices;
+	dataSearch.findNearestNeighbors(&queries, &reverseIndices, 1);
+
+	std::vector<char> keep(indexPairs->size());
+	for (unsigned int i = 0; i < indexPairs->size(); ++i) {
+		keep[i] = (reverseIndices[i] == static_cast<int>((*indexPairs)[i].secondIndex));
+	}
+	removeRejected(keep, indexPairs, weights);
+}
+
+}
+
+/* EOF */
@@ -0,0 +1,64 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#ifndef BRICS_3D_CORRESPONDENCEREJECTIONRECIPROCAL_H_
+#define BRICS_3D_CORRESPONDENCEREJECTIONRECIPROCAL_H_
+
+#include "ICorrespondenceRejection.h"
+#include "brics_3d/algorithm/nearestNeighbor/NearestNeighborKDTree3D.h"
+
+namespace brics_3d {
+
+/**
+ * @ingroup registration
+ * @brief Keeps only reciprocal correspondences.
+ *
+ * A pair is kept if the data point is also the nearest neighbor of the model point, i.e. if the correspondence
+ * is found in both directions. This rejects pairs at the borders of partially overlapping point clouds, where
+ * many data points are assigned to the same model point.
+ *
+ * The search structure for the data is rebuilt in every iteration, as the data is transformed.
+ */
+class CorrespondenceRejectionReciprocal : public ICorrespondenceRejection {
+public:
+
+	/**
+	 * @brief Standard constructor
+	 */
+	CorrespondenceRejectionReciprocal();
+
+	/**
+	 * @brief Standard destructor
+	 */
+	virtual ~CorrespondenceRejectionReciprocal();
+
+	void rejectCorrespondences(PointCloud3D* model, PointCloud3D* data, std::vector<CorrespondenceIndexPair>* indexPairs,
+			std::vector<double>* weights);
+
+private:
+
+	/// Search structure for the data
+	NearestNeighborKDTree3D dataSearch;
+};
+
+}
+
+#endif /* BRICS_3D_CORRESPONDENCEREJECTIONRECIPROCAL_H_ */
+
+/* EOF */
@@ -0,0 +1,122 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#include "CorrespondenceRejectionRobustKernel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace brics_3d {
+
+CorrespondenceRejectionRobustKernel::CorrespondenceRejectionRobustKernel(robustKernel::Type kernel, double tuningConstant) {
+	setKernel(kernel);
+	setTuningConstant(tuningConstant);
+	this->scale = 0.0;
+}
+
+CorrespondenceRejectionRobustKernel::~CorrespondenceRejectionRobustKernel() {
+
+}
+
+void CorrespondenceRejectionRobustKernel::rejectCorrespondences(PointCloud3D* model, PointCloud3D* data,
+		std::vector<CorrespondenceIndexPair>* indexPairs, std::vector<double>* weights) {
+	assert(model != 0);
+	assert(data != 0);
+	assert(indexPairs != 0);
+	assert(weights != 0);
+
+	if (indexPairs->empty()) {
+		return;
+	}
+	std::vector<double> distances;
+	computeSquaredDistances(model, data, *indexPairs, &distances);
+	for (unsigned int i = 0; i < distances.size(); ++i) {
+		distances[i] = std::sqrt(distances[i]);
+	}
+
+	double currentScale = scale;
+	if (currentScale <= 0.0) { // median absolute deviation, scaled to the standard deviation of a normal distribution
+		std::vector<double> sortedDistances(distances);
+		std::vector<double>::iterator median = sortedDistances.begin() + sortedDistances.size() / 2;
+		std::nth_element(sortedDistances.begin(), median, sortedDistances.end());
+		currentScale = 1.4826 * (*median);
+	}
+	double constant = tuningConstant;
+	if (constant <= 0.0) {
+		constant = (kernel == robustKernel::huber) ? 1.345 : 4.685;
+	}
+	double threshold = constant * currentScale;
+	if (!(threshold > 0.0)) { // all pairs (nearly) coincide
+		return;
+	}
+
+	std::vector<char> keep(indexPairs->size(), 1);
+	for (unsigned int i = 0; i < indexPairs->size(); ++i) {
+		double distance = distances[i];
+		if (kernel == robustKernel::huber) {
+			if (distance > threshold) {
+				(*weights)[i] *= threshold / distance;
+			}
+		} else {
+			if (distance < threshold) {
+				double ratio = distance / threshold;
+				double factor = 1.0 - ratio * ratio;
+				(*weights)[i] *= factor * factor;
+			} else {
+				keep[i] = 0;
+			}
+		}
+	}
+	removeRejected(keep, indexPairs, weights);
+}
+
+robustKernel::Type CorrespondenceRejectionRobustKernel::getKernel() const {
+	return kernel;
+}
+
+void CorrespondenceRejectionRobustKernel::setKernel(robustKernel::Type kernel) {
+	this->kernel = kernel;
+}
+
+double CorrespondenceRejectionRobustKernel::getTuningConstant() const {
+	return tuningConstant;
+}
+
+void CorrespondenceRejectionRobustKernel::setTuningConstant(double tuningConstant) {
+	if (tuningConstant < 0.0) {
+		throw std::runtime_error("ERROR: tuningConstant for the robust kernel cannot be less than 0.");
+	}
+	this->tuningConstant = tuningConstant;
+}
+
+double CorrespondenceRejectionRobustKernel::getScale() const {
+	return scale;
+}
+
+void CorrespondenceRejectionRobustKernel::setScale(double scale) {
+	if (scale < 0.0) {
+		throw std::runtime_error("ERROR: scale for the robust kernel cannot be less than 0.");
+	}
+	this->scale = scale;
+}
+
+}
+
+/* EOF */
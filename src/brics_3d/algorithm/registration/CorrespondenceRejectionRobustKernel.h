@@ -0,0 +1,114 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#ifndef BRICS_3D_CORRESPONDENCEREJECTIONROBUSTKERNEL_H_
+#define BRICS_3D_CORRESPONDENCEREJECTIONROBUSTKERNEL_H_
+
+#include "ICorrespondenceRejection.h"
+
+namespace brics_3d {
+
+namespace robustKernel {
+	enum Type {
+		huber, ///< Weight 1 up to the threshold, then decreasing with 1/distance. Never rejects.
+		tukey  ///< Smoothly decreasing weight (Tukey's biweight). Pairs beyond the threshold are rejected.
+	};
+}  // namespace robustKernel
+
+/**
+ * @ingroup registration
+ * @brief Weights correspondences with a robust kernel (M-estimator).
+ *
+ * Instead of a hard threshold, pairs with large distances get a small weight, so outliers have less influence on
+ * the estimated transformation. The threshold of the kernel is tuningConstant * scale:
+ * - huber: w = 1 for r <= threshold, otherwise threshold / r
+ * - tukey: w = (1 - (r / threshold)^2)^2 for r < threshold, otherwise the pair is rejected
+ *
+ * If no scale is set, it is estimated robustly in every iteration as 1.4826 * median distance. The weights are
+ * multiplied with the existing ones. Only estimators that support weights make use of them
+ * (see IRigidTransformationEstimation).
+ */
+class CorrespondenceRejectionRobustKernel : public ICorrespondenceRejection {
+public:
+
+	/**
+	 * @brief Standard constructor
+	 * @param kernel The robust kernel.
+	 * @param tuningConstant Threshold in units of the scale. If it is 0 the common value for the kernel is used:
+	 *        1.345 for huber and 4.685 for tukey.
+	 */
+	CorrespondenceRejectionRobustKernel(robustKernel::Type kernel = robustKernel::huber, double tuningConstant = 0.0);
+
+	/**
+	 * @brief Standard destructor
+	 */
+	virtual ~CorrespondenceRejectionRobustKernel();
+
+	void rejectCorrespondences(PointCloud3D* model, PointCloud3D* data, std::vector<CorrespondenceIndexPair>* indexPairs,
+			std::vector<double>* weights);
+
+	/**
+	 * @brief Get the robust kernel.
+	 */
+	robustKernel::Type getKernel() const;
+
+	/**
+	 * @brief Set the robust kernel.
+	 */
+	void setKernel(robustKernel::Type kernel);
+
+	/**
+	 * @brief Get the threshold in units of the scale.
+	 */
+	double getTuningConstant() const;
+
+	/**
+	 * @brief Set the threshold in units of the scale.
+	 * @param tuningConstant Must be greater than 0, or 0 for the common value of the kernel.
+	 */
+	void setTuningConstant(double tuningConstant);
+
+	/**
+	 * @brief Get the scale of the distances.
+	 */
+	double getScale() const;
+
+	/**
+	 * @brief Set the scale of the distances, e.g. the expected noise level.
+	 * @param scale Must not be less than 0. 0 means that the scale is estimated from the median distance. Default is 0.
+	 */
+	void setScale(double scale);
+
+private:
+
+	/// The robust kernel
+	robustKernel::Type kernel;
+
+	/// Threshold in units of the scale
+	double tuningConstant;
+
+	/// Scale of the distances. 0 for an estimated scale.
+	double scale;
+};
+
+}
+
+#endif /* BRICS_3D_CORRESPONDENCEREJECTIONROBUSTKERNEL_H_ */
+
+/* EOF */
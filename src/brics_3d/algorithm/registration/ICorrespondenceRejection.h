@@ -0,0 +1,120 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#ifndef BRICS_3D_ICORRESPONDENCEREJECTION_H_
+#define BRICS_3D_ICORRESPONDENCEREJECTION_H_
+
+#include "brics_3d/core/PointCloud3D.h"
+#include "brics_3d/core/CorrespondenceIndexPair.h"
+
+#include <vector>
+#include <assert.h>
+
+namespace brics_3d {
+
+/**
+ * @ingroup registration
+ * @brief Abstract interface for a stage between the correspondence search and the transformation estimation.
+ *
+ * An implementation inspects the correspondences of one ICP iteration and either rejects pairs, e.g. outliers or
+ * pairs of non-overlapping parts, or modifies their weights. Several stages can be chained
+ * (see IIterativeClosestPointSetup::addCorrespondenceRejection()); the resulting weights are passed to
+ * IRigidTransformationEstimation.
+ */
+class ICorrespondenceRejection {
+public:
+
+	/**
+	 * @brief Standard constructor
+	 */
+	ICorrespondenceRejection(){};
+
+	/**
+	 * @brief Standard destructor
+	 */
+	virtual ~ICorrespondenceRejection(){};
+
+	/**
+	 * @brief Reject or re-weight correspondences.
+	 *
+	 * Rejected pairs are removed from indexPairs together with their weights, the order of the remaining ones is kept.
+	 *
+	 * @param[in] model The model point cloud. The first indices refer to it.
+	 * @param[in] data The data point cloud. The second indices refer to it.
+	 * @param[in,out] indexPairs The correspondences as established by IPointCorrespondence.
+	 * @param[in,out] weights Weight of each correspondence, same size as indexPairs.
+	 */
+	virtual void rejectCorrespondences(PointCloud3D* model, PointCloud3D* data, std::vector<CorrespondenceIndexPair>* indexPairs,
+			std::vector<double>* weights) = 0;
+
+	/**
+	 * @brief Prepare the data before the ICP iterations on it start.
+	 *
+	 * Allows to attach per point attributes as channels, e.g. normals, that are transformed along with the points
+	 * instead of being recomputed in every iteration. Channels that are added here are removed again after the
+	 * iterations. The default does nothing.
+	 *
+	 * @param[in,out] data The data point cloud.
+	 */
+	virtual void prepareData(PointCloud3D* data) {};
+
+protected:
+
+	/**
+	 * @brief Compute the squared Euclidean distance of each correspondence.
+	 */
+	static void computeSquaredDistances(PointCloud3D* model, PointCloud3D* data, const std::vector<CorrespondenceIndexPair>& indexPairs,
+			std::vector<double>* squaredDistances) {
+		const PointCloud3DStorage* modelStorage = model->getStorage();
+		const PointCloud3DStorage* dataStorage = data->getStorage();
+		squaredDistances->resize(indexPairs.size());
+		for (unsigned int i = 0; i < indexPairs.size(); ++i) {
+			unsigned int first = indexPairs[i].firstIndex;
+			unsigned int second = indexPairs[i].secondIndex;
+			double dx = modelStorage->getRawX()[first] - dataStorage->getRawX()[second];
+			double dy = modelStorage->getRawY()[first] - dataStorage->getRawY()[second];
+			double dz = modelStorage->getRawZ()[first] - dataStorage->getRawZ()[second];
+			(*squaredDistances)[i] = dx * dx + dy * dy + dz * dz;
+		}
+	}
+
+	/**
+	 * @brief Remove the pairs and weights that are not marked to be kept.
+	 */
+	static void removeRejected(const std::vector<char>& keep, std::vector<CorrespondenceIndexPair>* indexPairs, std::vector<double>* weights) {
+		assert(keep.size() == indexPairs->size());
+		assert(weights->size() == indexPairs->size());
+		unsigned int kept = 0;
+		for (unsigned int i = 0; i < keep.size(); ++i) {
+			if (keep[i]) {
+				(*indexPairs)[kept] = (*indexPairs)[i];
+				(*weights)[kept] = (*weights)[i];
+				kept++;
+			}
+		}
+		indexPairs->resize(kept);
+		weights->resize(kept);
+	}
+};
+
+}
+
+#endif /* BRICS_3D_ICORRESPONDENCEREJECTION_H_ */
+
+/* EOF */
@@ -22,6 +22,7 @@
 
 #include "brics_3d/algorithm/registration/IPointCorrespondence.h"
 #include "brics_3d/algorithm/registration/IRigidTransformationEstimation.h"
+#include "brics_3d/algorithm/registration/ICorrespondenceRejection.h"
 
 namespace brics_3d {
 
@@ -89,6 +90,54 @@ public:
 	 * @return Read-only pointer to transformation estimator
 	 */
 	virtual IRigidTransformationEstimation* getEstimator() const = 0;
+
+	/**
+	 * @brief Append a stage that rejects or weights the correspondences before the transformation estimation
+	 *
+	 * The stages are applied in the order they have been added. The ICP takes the ownership of the stage.
+	 * @param[in] rejection Pointer to the rejection or weighting stage
+	 */
+	virtual void addCorrespondenceRejection(ICorrespondenceRejection* rejection) = 0;
+
+	/**
+	 * @brief Get the stages that reject or weight the correspondences
+	 * @return The stages in the order they are applied
+	 */
+	virtual const std::vector<ICorrespondenceRejection*>& getCorrespondenceRejections() const = 0;
+
+	/**
+	 * @brief Remove and delete all stages that reject or weight the correspondences
+	 */
+	virtual void clearCorrespondenceRejections() = 0;
+
+	/**
+	 * @brief Get the number of resolution levels for coarse-to-fine matching
+	 * @return The number of resolution levels. 1 means that only the full resolution is used.
+	 */
+	virtual int getNumberOfResolutionLevels() const = 0;
+
+	/**
+	 * @brief Set the number of resolution levels for coarse-to-fine matching
+	 *
+	 * With more than one level both point clouds are downsampled with an Octree. The matching starts with the coarsest
+	 * level (see setCoarsestVoxelSize()), each following level halves the voxel size and the last one uses the full
+	 * resolution. Every level runs until convergence or the maximum amount of iterations.
+	 *
+	 * @param numberOfResolutionLevels The number of resolution levels. Must be at least 1.
+	 */
+	virtual void setNumberOfResolutionLevels(int numberOfResolutionLevels) = 0;
+
+	/**
+	 * @brief Get the voxel size of the coarsest resolution level
+	 * @return The voxel size of the coarsest resolution level
+	 */
+	virtual double getCoarsestVoxelSize() const = 0;
+
+	/**
+	 * @brief Set the voxel size of the coarsest resolution level
+	 * @param coarsestVoxelSize The voxel size of the coarsest resolution level. If it is 0, only the full resolution is used.
+	 */
+	virtual void setCoarsestVoxelSize(double coarsestVoxelSize) = 0;
 };
 
 }
@@ -0,0 +1,113 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#include "IPointCorrespondence.h"
+
+#include <algorithm>
+
+namespace brics_3d {
+
+namespace {
+
+/// A point of a point cloud together with its index, ordered by its coordinates.
+struct IndexedPoint {
+	Coordinate x;
+	Coordinate y;
+	Coordinate z;
+	unsigned int index;
+
+	bool operator<(const IndexedPoint& other) const {
+		if (x != other.x) {
+			return x < other.x;
+		}
+		if (y != other.y) {
+			return y < other.y;
+		}
+		return z < other.z;
+	}
+};
+
+/// Sort the points of a point cloud by their coordinates.
+void sortPoints(PointCloud3D* pointCloud, std::vector<IndexedPoint>* sortedPoints) {
+	const PointCloud3DStorage* storage = pointCloud->getStorage();
+	sortedPoints->resize(storage->getSize());
+	for (unsigned int i = 0; i < storage->getSize(); ++i) {
+		IndexedPoint& point = (*sortedPoints)[i];
+		point.x = storage->getRawX()[i];
+		point.y = storage->getRawY()[i];
+		point.z = storage->getRawZ()[i];
+		point.index = i;
+	}
+	std::sort(sortedPoints->begin(), sortedPoints->end());
+}
+
+/// Index of a point with exactly the same coordinates. Returns false if there is none.
+bool findIndex(const std::vector<IndexedPoint>& sortedPoints, const Point3D& point, unsigned int& index) {
+	IndexedPoint key;
+	key.x = point.getX();
+	key.y = point.getY();
+	key.z = point.getZ();
+	std::vector<IndexedPoint>::const_iterator match = std::lower_bound(sortedPoints.begin(), sortedPoints.end(), key);
+	if (match == sortedPoints.end() || key < *match) {
+		return false;
+	}
+	index = match->index;
+	return true;
+}
+
+bool compareSecondIndex(const CorrespondenceIndexPair& first, const CorrespondenceIndexPair& second) {
+	return first.secondIndex < second.secondIndex;
+}
+
+}
+
+void IPointCorrespondence::createNearestNeighborCorrespondence(PointCloud3D* pointCloud1, PointCloud3D* pointCloud2,
+		std::vector<CorrespondenceIndexPair>* resultIndexPairs) {
+	std::vector<CorrespondencePoint3DPair> pointPairs;
+	createNearestNeighborCorrespondence(pointCloud1, pointCloud2, &pointPairs);
+
+	/* the point pairs are copies of the points, so their indices are found by exact coordinates */
+	std::vector<IndexedPoint> sortedPoints1;
+	std::vector<IndexedPoint> sortedPoints2;
+	sortPoints(pointCloud1, &sortedPoints1);
+	sortPoints(pointCloud2, &sortedPoints2);
+
+	resultIndexPairs->clear();
+	resultIndexPairs->reserve(pointPairs.size());
+	unsigned int firstIndex;
+	unsigned int secondIndex;
+	for (unsigned int i = 0; i < pointPairs.size(); ++i) {
+		if (findIndex(sortedPoints1, pointPairs[i].firstPoint, firstIndex) && findIndex(sortedPoints2, pointPairs[i].secondPoint, secondIndex)) {
+			resultIndexPairs->push_back(CorrespondenceIndexPair(firstIndex, secondIndex));
+		}
+	}
+	std::stable_sort(resultIndexPairs->begin(), resultIndexPairs->end(), compareSecondIndex);
+}
+
+double IPointCorrespondence::getMaxCorrespondenceDistance() const {
+	return -1.0;
+}
+
+void IPointCorrespondence::setMaxCorrespondenceDistance(double maxCorrespondenceDistance) {
+
+}
+
+}
+
+/* EOF */
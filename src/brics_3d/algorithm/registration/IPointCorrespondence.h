@@ -21,7 +21,7 @@
 #define BRICS_3D_IPOINTCORRESPONDENCE_H_
 
 #include "brics_3d/core/PointCloud3D.h"
-//#include "brics_3d/core/CorrespondenceIndexPair.h"
+#include "brics_3d/core/CorrespondenceIndexPair.h"
 #include "brics_3d/core/CorrespondencePoint3DPair.h"
 
 #include <vector>
@@ -53,6 +53,35 @@ public:
 	 */
 	virtual void createNearestNeighborCorrespondence(PointCloud3D* pointCloud1, PointCloud3D* pointCloud2, std::vector<CorrespondencePoint3DPair>* resultPointPairs) = 0;
 
+	/**
+	 * @brief Establishes a point to point correspondence with nearest neighborhood search, represented by indices
+	 *
+	 * The default implementation invokes the point pair variant and looks up the indices of the resulting points.
+	 * Implementations should override it if they can provide the indices directly.
+	 *
+	 * @param[in] pointCloud1 Pointer to first point cloud
+	 * @param[in] pointCloud2 Pointer to second point cloud
+	 * @param[out] resultIndexPairs Pointer where to store the resulting correspondences. The first index refers to pointCloud1,
+	 * the second one to pointCloud2. The pairs are ordered by the second index. If no correspondences are found, this vector will be empty.
+	 */
+	virtual void createNearestNeighborCorrespondence(PointCloud3D* pointCloud1, PointCloud3D* pointCloud2, std::vector<CorrespondenceIndexPair>* resultIndexPairs);
+
+	/**
+	 * @brief Get the maximal distance between corresponding points
+	 *
+	 * The default implementation has no limit and returns -1.
+	 * @return Points that are further apart do not correspond. A negative value means that there is no limit.
+	 */
+	virtual double getMaxCorrespondenceDistance() const;
+
+	/**
+	 * @brief Set the maximal distance between corresponding points
+	 *
+	 * The default implementation ignores the value.
+	 * @param maxCorrespondenceDistance Points that are further apart do not correspond. A negative value means that there is no limit.
+	 */
+	virtual void setMaxCorrespondenceDistance(double maxCorrespondenceDistance);
+
 };
 
 }
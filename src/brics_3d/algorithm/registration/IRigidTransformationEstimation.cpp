@@ -0,0 +1,39 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#include "IRigidTransformationEstimation.h"
+#include "PointCorrespondenceBatch.h"
+
+namespace brics_3d {
+
+double IRigidTransformationEstimation::estimateTransformation(PointCloud3D* model, PointCloud3D* data,
+		std::vector<CorrespondenceIndexPair>* indexPairs, IHomogeneousMatrix44* resultTransformation) {
+	std::vector<CorrespondencePoint3DPair> pointPairs;
+	convertCorrespondences(model->getStorage(), data->getStorage(), *indexPairs, &pointPairs, 0);
+	return estimateTransformation(&pointPairs, resultTransformation);
+}
+
+double IRigidTransformationEstimation::estimateTransformation(PointCloud3D* model, PointCloud3D* data,
+		std::vector<CorrespondenceIndexPair>* indexPairs, const std::vector<double>* weights, IHomogeneousMatrix44* resultTransformation) {
+	return estimateTransformation(model, data, indexPairs, resultTransformation);
+}
+
+}
+
+/* EOF */
@@ -23,6 +23,7 @@
 #include "brics_3d/core/PointCloud3D.h"
 #include "brics_3d/core/IHomogeneousMatrix44.h"
 #include "brics_3d/core/CorrespondencePoint3DPair.h"
+#include "brics_3d/core/CorrespondenceIndexPair.h"
 
 #include <vector>
 
@@ -60,6 +61,38 @@ public:
 	 */
 	virtual double estimateTransformation(std::vector<CorrespondencePoint3DPair>* pointPairs, IHomogeneousMatrix44* resultTransformation) = 0;
 
+	/**
+	 * @brief Estimates the rigid transformation between two point clouds with correspondences given by indices.
+	 *
+	 * This variant gives access to the whole model, e.g. to per point attributes like normals. The default
+	 * implementation resolves the indices to point pairs and invokes the point pair variant.
+	 *
+	 * @param[in] model The model point cloud. The first indices refer to it.
+	 * @param[in] data The data point cloud. The second indices refer to it.
+	 * @param[in] indexPairs Pointer to the correspondences as established by IPointCorrespondence
+	 * @param[out] resultTransformation Pointer to resulting rigid transformation that moves the data towards the model
+	 * @return Returns the RMS error of the correspondences
+	 */
+	virtual double estimateTransformation(PointCloud3D* model, PointCloud3D* data, std::vector<CorrespondenceIndexPair>* indexPairs,
+			IHomogeneousMatrix44* resultTransformation);
+
+	/**
+	 * @brief Estimates the rigid transformation between two point clouds with weighted correspondences.
+	 *
+	 * Each correspondence contributes to the error function according to its weight, e.g. as computed by an
+	 * ICorrespondenceRejection. The default implementation ignores the weights and invokes the unweighted variant,
+	 * so estimators that do not support weights still work with the pairs that have not been rejected.
+	 *
+	 * @param[in] model The model point cloud. The first indices refer to it.
+	 * @param[in] data The data point cloud. The second indices refer to it.
+	 * @param[in] indexPairs Pointer to the correspondences as established by IPointCorrespondence
+	 * @param[in] weights Non negative weight of each correspondence. 0 means that all correspondences have the same weight.
+	 * @param[out] resultTransformation Pointer to resulting rigid transformation that moves the data towards the model
+	 * @return Returns the (weighted) RMS error of the correspondences
+	 */
+	virtual double estimateTransformation(PointCloud3D* model, PointCloud3D* data, std::vector<CorrespondenceIndexPair>* indexPairs,
+			const std::vector<double>* weights, IHomogeneousMatrix44* resultTransformation);
+
 };
 
 }
@@ -18,7 +18,11 @@
 ******************************************************************************/
 
 #include "IterativeClosestPoint.h"
+#include "PointCorrespondenceKDTree.h"
 #include "brics_3d/core/HomogeneousMatrix44.h" //TODO? now it depends  on implementation of HomogeneousMatrix44
+#include "brics_3d/core/RigidTransform.h"
+#include "brics_3d/algorithm/filtering/Octree.h"
+#include <algorithm>
 #include <cmath>
 #include <assert.h>
 #include <stdexcept>
@@ -34,6 +38,11 @@ IterativeClosestPoint::IterativeClosestPoint() {
 	this->estimator = 0;
 	this->convergenceThreshold = 0.00001;
 	this->maxIterations = 20;
+	this->numberOfResolutionLevels = 1;
+	this->coarsestVoxelSize = 0.0;
+	this->pyramidModel = 0;
+	this->pyramidModelRevision = 0;
+	this->pyramidVoxelSize = 0.0;
 
 	/* initial values fir stateful interface */
 	this->model = 0;
@@ -47,6 +56,11 @@ IterativeClosestPoint::IterativeClosestPoint(IPointCorrespondence *assigner, IRi
 	this->estimator = estimator;
 	this->convergenceThreshold = convergenceThreshold;
 	this->maxIterations = maxIterations;
+	this->numberOfResolutionLevels = 1;
+	this->coarsestVoxelSize = 0.0;
+	this->pyramidModel = 0;
+	this->pyramidModelRevision = 0;
+	this->pyramidVoxelSize = 0.0;
 
 	/* initial values for stateful interface */
 	this->model = 0;
@@ -58,6 +72,7 @@ IterativeClosestPoint::IterativeClosestPoint(IPointCorrespondence *assigner, IRi
 IterativeClosestPoint::~IterativeClosestPoint() {
 	delete this->assigner;
 	delete this->estimator;
+	clearCorrespondenceRejections();
 
 	if (this->intermadiateTransformation != 0) { // might be unused
 		delete this->intermadiateTransformation;
@@ -79,25 +94,113 @@ void IterativeClosestPoint::match(PointCloud3D* model, PointCloud3D* data, IHomo
 	assert(model != 0); // check input parameters
 	assert(data != 0);
 
+	RigidTransform accumulatedTransformation(*resultTransformation);
+	RigidTransform appliedToData; // by the coarse levels, to restore the data if the final level fails
+	IHomogeneousMatrix44* levelTransformation = new HomogeneousMatrix44();
+	double error = 0.0;
+	int totalIterations = 0;
+
+	/* coarse-to-fine: converge on the downsampled point clouds first */
+	if (numberOfResolutionLevels > 1 && coarsestVoxelSize > 0.0) {
+		updateModelPyramid(model);
+		double maxCorrespondenceDistance = assigner->getMaxCorrespondenceDistance();
+		Octree downsampler;
+		PointCloud3D levelData;
+
+		for (int level = 0; level < numberOfResolutionLevels - 1; ++level) {
+			PointCloud3D* levelModel = modelPyramid[level].get();
+			downsampler.setVoxelSize(getVoxelSize(level));
+			downsampler.filter(data, &levelData);
+			if (levelModel->getSize() < 3 || levelData.getSize() < 3) {
+				LOG(INFO) << "ICP skips resolution level " << level << " as it has too few points.";
+				continue;
+			}
+			double levelDistance = maxCorrespondenceDistance;
+			if (level > 0) { // the preceding level is already aligned up to its resolution
+				levelDistance = 3.0 * getVoxelSize(level - 1);
+				if (maxCorrespondenceDistance >= 0.0 && maxCorrespondenceDistance < levelDistance) {
+					levelDistance = maxCorrespondenceDistance;
+				}
+			}
+			IPointCorrespondence* levelAssigner = levelAssigners[level].get();
+			levelAssigner->setMaxCorrespondenceDistance(levelDistance);
+
+			RigidTransform().toMatrix(levelTransformation);
+			iterate(levelAssigner, levelModel, &levelData, levelTransformation); // a failed level leaves the identity
+			totalIterations += icpresultIterations;
+			accumulatedTransformation *= RigidTransform(*levelTransformation);
+			appliedToData = RigidTransform(*levelTransformation) * appliedToData;
+			data->homogeneousTransformation(levelTransformation);
+		}
+
+		double finalDistance = 3.0 * getVoxelSize(numberOfResolutionLevels - 2);
+		if (maxCorrespondenceDistance >= 0.0 && maxCorrespondenceDistance < finalDistance) {
+			finalDistance = maxCorrespondenceDistance;
+		}
+		assigner->setMaxCorrespondenceDistance(finalDistance);
+		RigidTransform().toMatrix(levelTransformation);
+		error = iterate(assigner, model, data, levelTransformation);
+		assigner->setMaxCorrespondenceDistance(maxCorrespondenceDistance);
+	} else {
+		error = iterate(assigner, model, data, levelTransformation);
+	}
+	totalIterations += icpresultIterations;
+	if (error < 0.0) {
+		LOG(WARNING) << "ICP failed as there are not enough correspondences. The transformation is left unchanged.";
+		appliedToData.inverse().toMatrix(levelTransformation);
+		data->homogeneousTransformation(levelTransformation);
+	} else {
+		accumulatedTransformation *= RigidTransform(*levelTransformation);
+		accumulatedTransformation.toMatrix(resultTransformation);
+	}
+
+	LOG(DEBUG) << "RMS Error is: " << error; //DBG output
+	icpResultError = error;//benchmark only
+	icpresultIterations = totalIterations;//benchmark only
+	delete levelTransformation;
+}
+
+double IterativeClosestPoint::iterate(IPointCorrespondence* assigner, PointCloud3D* model, PointCloud3D* data, IHomogeneousMatrix44* accumulatedTransformation) {
 	double error = 0.0;
 	double previousError = 0.0;
 	double previousPreviousError = 0.0;
 
 	IHomogeneousMatrix44* tmpResultTransformation = new HomogeneousMatrix44();
-	std::vector<CorrespondencePoint3DPair>* pointPairs = new std::vector<CorrespondencePoint3DPair>();
+	RigidTransform accumulated(*accumulatedTransformation);
+	RigidTransform appliedToData; // to restore the data on failure
+	std::vector<CorrespondenceIndexPair>* indexPairs = new std::vector<CorrespondenceIndexPair>();
+
+	/* attach data attributes once, they are transformed along with the points */
+	std::vector<std::string> dataChannels;
+	data->getStorage()->getChannelNames(dataChannels);
+	for (unsigned int i = 0; i < rejections.size(); ++i) {
+		rejections[i]->prepareData(data);
+	}
 
 	/* perform generic ICP */
+	icpresultIterations = maxIterations;
 	for (int i = 0; i < maxIterations; ++i) {
 		previousPreviousError = previousError;
 		previousError = error;
 
 		/* find closest points */
-		assigner->createNearestNeighborCorrespondence(model, data, pointPairs);
+		assigner->createNearestNeighborCorrespondence(model, data, indexPairs);
 
 		/* estimate transformation */
-		error = estimator->estimateTransformation(pointPairs, tmpResultTransformation);
+		error = estimateTransformation(model, data, indexPairs, tmpResultTransformation);
+		if (indexPairs->size() < 3) {
+			LOG(WARNING) << "ICP stopped after " << i << " iterations as there are not enough correspondences.";
+			appliedToData.inverse().toMatrix(tmpResultTransformation);
+			data->homogeneousTransformation(tmpResultTransformation);
+			icpresultIterations = i;//benchmark only
+			removeAddedChannels(data, dataChannels);
+			delete indexPairs;
+			delete tmpResultTransformation;
+			return -1.0;
+		}
 //		cout << "Estimated transformation: " << endl  << *tmpResultTransformation; //DBG output
-		*resultTransformation = *((*resultTransformation) * (*tmpResultTransformation)); // accumulate transformations
+		accumulated *= RigidTransform(*tmpResultTransformation); // accumulate transformations
+		appliedToData = RigidTransform(*tmpResultTransformation) * appliedToData;
 
 		/* perform transformation on data point cloud */
 		data->homogeneousTransformation(tmpResultTransformation);
@@ -111,13 +214,68 @@ void IterativeClosestPoint::match(PointCloud3D* model, PointCloud3D* data, IHomo
 		}
 	}
 
-	LOG(DEBUG) << "RMS Error is: " << error; //DBG output
-	icpResultError = error;//benchmark only
-	delete pointPairs;
+	accumulated.toMatrix(accumulatedTransformation);
+	removeAddedChannels(data, dataChannels);
+	delete indexPairs;
 	delete tmpResultTransformation;
+	return error;
+}
+
+double IterativeClosestPoint::estimateTransformation(PointCloud3D* model, PointCloud3D* data,
+		std::vector<CorrespondenceIndexPair>* indexPairs, IHomogeneousMatrix44* transformation) {
+
+	/* reject and weight correspondences */
+	std::vector<double>* pairWeights = 0;
+	if (!rejections.empty()) {
+		weights.assign(indexPairs->size(), 1.0);
+		for (unsigned int i = 0; i < rejections.size(); ++i) {
+			rejections[i]->rejectCorrespondences(model, data, indexPairs, &weights);
+		}
+		pairWeights = &weights;
+	}
+
+	if (indexPairs->size() < 3) {
+		RigidTransform().toMatrix(transformation);
+		return -1.0;
+	}
+	return estimator->estimateTransformation(model, data, indexPairs, pairWeights, transformation);
+}
 
+void IterativeClosestPoint::removeAddedChannels(PointCloud3D* data, const std::vector<std::string>& channelNames) {
+	std::vector<std::string> currentChannelNames;
+	data->getStorage()->getChannelNames(currentChannelNames);
+	for (unsigned int i = 0; i < currentChannelNames.size(); ++i) {
+		if (std::find(channelNames.begin(), channelNames.end(), currentChannelNames[i]) == channelNames.end()) {
+			data->getMutableStorage()->removeChannel(currentChannelNames[i]);
+		}
+	}
 }
 
+void IterativeClosestPoint::updateModelPyramid(PointCloud3D* model) {
+	unsigned long revision = model->getStorage()->getRevision();
+	if (model == pyramidModel && revision == pyramidModelRevision && coarsestVoxelSize == pyramidVoxelSize
+			&& static_cast<int>(modelPyramid.size()) == numberOfResolutionLevels - 1) {
+		return;
+	}
+
+	Octree downsampler;
+	modelPyramid.clear();
+	levelAssigners.clear();
+	for (int level = 0; level < numberOfResolutionLevels - 1; ++level) {
+		boost::shared_ptr<PointCloud3D> levelModel(new PointCloud3D());
+		downsampler.setVoxelSize(getVoxelSize(level));
+		downsampler.filter(model, levelModel.get());
+		modelPyramid.push_back(levelModel);
+		levelAssigners.push_back(boost::shared_ptr<IPointCorrespondence>(new PointCorrespondenceKDTree()));
+	}
+	pyramidModel = model;
+	pyramidModelRevision = model->getStorage()->getRevision();
+	pyramidVoxelSize = coarsestVoxelSize;
+}
+
+double IterativeClosestPoint::getVoxelSize(int level) const {
+	return coarsestVoxelSize / static_cast<double>(1 << level);
+}
 
 IPointCorrespondence* IterativeClosestPoint::getAssigner() const
 {
@@ -136,6 +294,22 @@ int IterativeClosestPoint::getMaxIterations() const {
 	return maxIterations;
 }
 
+void IterativeClosestPoint::addCorrespondenceRejection(ICorrespondenceRejection* rejection) {
+	assert(rejection != 0);
+	rejections.push_back(rejection);
+}
+
+const std::vector<ICorrespondenceRejection*>& IterativeClosestPoint::getCorrespondenceRejections() const {
+	return rejections;
+}
+
+void IterativeClosestPoint::clearCorrespondenceRejections() {
+	for (unsigned int i = 0; i < rejections.size(); ++i) {
+		delete rejections[i];
+	}
+	rejections.clear();
+}
+
 void IterativeClosestPoint::setAssigner(IPointCorrespondence* assigner)
 {
 	this->assigner = assigner;
@@ -163,6 +337,28 @@ void IterativeClosestPoint::setMaxIterations(int maxIterations)
 }
 
 
+int IterativeClosestPoint::getNumberOfResolutionLevels() const {
+	return numberOfResolutionLevels;
+}
+
+void IterativeClosestPoint::setNumberOfResolutionLevels(int numberOfResolutionLevels) {
+	if (numberOfResolutionLevels < 1) {
+		throw runtime_error("ERROR: numberOfResolutionLevels for ICP cannot be less than 1.");
+	}
+	this->numberOfResolutionLevels = numberOfResolutionLevels;
+}
+
+double IterativeClosestPoint::getCoarsestVoxelSize() const {
+	return coarsestVoxelSize;
+}
+
+void IterativeClosestPoint::setCoarsestVoxelSize(double coarsestVoxelSize) {
+	if (coarsestVoxelSize < 0.0) {
+		throw runtime_error("ERROR: coarsestVoxelSize for ICP cannot be less than 0.");
+	}
+	this->coarsestVoxelSize = coarsestVoxelSize;
+}
+
 void IterativeClosestPoint::setData(PointCloud3D* data) {
 	this->data = data;
 }
@@ -192,24 +388,26 @@ double IterativeClosestPoint::performNextIteration() {
 	if (this->resultTransformation == 0) { // do only once
 			this->resultTransformation = new HomogeneousMatrix44();
 	}
-	std::vector<CorrespondencePoint3DPair>* pointPairs = new std::vector<CorrespondencePoint3DPair>();
+	std::vector<CorrespondenceIndexPair>* indexPairs = new std::vector<CorrespondenceIndexPair>();
 
 	/*
 	 * perform one ICP iteration:
 	 */
 
 	/* find closest points */
-	assigner->createNearestNeighborCorrespondence(this->model, this->data, pointPairs);
+	assigner->createNearestNeighborCorrespondence(this->model, this->data, indexPairs);
 
 	/* estimate transformation */
-	error = estimator->estimateTransformation(pointPairs, this->intermadiateTransformation);
+	error = estimateTransformation(this->model, this->data, indexPairs, this->intermadiateTransformation);
 	//cout << "Estimated transformation: " << endl  << *tmpResultTransformation; //DBG output
-	*(this->resultTransformation) = *((*(this->resultTransformation)) * (*(this->intermadiateTransformation))); // accumulate transformations
+	RigidTransform accumulatedTransformation(*(this->resultTransformation));
+	accumulatedTransformation *= RigidTransform(*(this->intermadiateTransformation)); // accumulate transformations
+	accumulatedTransformation.toMatrix(this->resultTransformation);
 
 	/* perform transformation on data point cloud */
 	this->data->homogeneousTransformation(this->intermadiateTransformation);
 
-	delete pointPairs;
+	delete indexPairs;
 	return error;
 }
 
@@ -27,6 +27,10 @@
 #include "brics_3d/algorithm/registration/IPointCorrespondence.h"
 #include "brics_3d/algorithm/registration/IRigidTransformationEstimation.h"
 
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
 namespace brics_3d {
 
 /**
@@ -36,6 +40,19 @@ namespace brics_3d {
  * This class serves a generic implementation of the Iterative Closest Point Algorithm.
  * It follows the "strategy" software design pattern (except that context and strategy are implemented in the same class).
  * That means the actual point correspondence and the rigid transformation estimation algorithms are exchangeable during runtime.
+ * Optional stages between both steps reject or weight the correspondences (see addCorrespondenceRejection()).
+ * They may attach channels to the data once per resolution level (see ICorrespondenceRejection::prepareData()),
+ * which are removed again at the end of the level.
+ *
+ * match() optionally works coarse-to-fine (see setNumberOfResolutionLevels()): It converges on downsampled versions of
+ * both point clouds first and refines the result on the finer levels. After the first level the maximal correspondence
+ * distance of the assigner is reduced to three times the voxel size of the preceding level. The downsampled model is kept
+ * for successive matches against the same, unmodified model. The downsampled levels are searched with a
+ * PointCorrespondenceKDTree per level, so the k-d tree of every level and the search structure of the assigner, which
+ * is only used for the full resolution, are built once per model rather than at every level of every match.
+ *
+ * If less than 3 correspondences are left, the registration fails: icpResultError is -1 and the result transformation
+ * and the data are left unchanged. A failing coarse level is skipped.
  */
 class IterativeClosestPoint : public IIterativeClosestPoint, public IIterativeClosestPointSetup, public IIterativeClosestPointDetailed {
 public:
@@ -72,6 +89,13 @@ public:
     IPointCorrespondence* getAssigner() const;
 
 	IRigidTransformationEstimation* getEstimator() const;
+	void addCorrespondenceRejection(ICorrespondenceRejection* rejection);
+	const std::vector<ICorrespondenceRejection*>& getCorrespondenceRejections() const;
+	void clearCorrespondenceRejections();
+	int getNumberOfResolutionLevels() const;
+	void setNumberOfResolutionLevels(int numberOfResolutionLevels);
+	double getCoarsestVoxelSize() const;
+	void setCoarsestVoxelSize(double coarsestVoxelSize);
 
 	void setData(PointCloud3D* data);
 
@@ -91,6 +115,34 @@ public:
 
 private:
 
+	/**
+	 * @brief Perform ICP iterations until convergence at a single resolution.
+	 * @param[in] assigner The point correspondence strategy for this resolution
+	 * @param[in] model The model
+	 * @param[in,out] data The data. Will be transformed.
+	 * @param[in,out] accumulatedTransformation The estimated transformations will be accumulated to this one.
+	 * @return The error of the last iteration. -1 if less than 3 correspondences are left in any iteration, then
+	 *         the data and the accumulated transformation are left unchanged.
+	 */
+	double iterate(IPointCorrespondence* assigner, PointCloud3D* model, PointCloud3D* data, IHomogeneousMatrix44* accumulatedTransformation);
+
+	/**
+	 * @brief Apply the rejection stages to the correspondences and estimate the transformation.
+	 * @return The error as returned by the estimator. -1 if less than 3 correspondences are left, then the
+	 *         transformation is the identity.
+	 */
+	double estimateTransformation(PointCloud3D* model, PointCloud3D* data, std::vector<CorrespondenceIndexPair>* indexPairs,
+			IHomogeneousMatrix44* transformation);
+
+	/// Remove the channels of the data that are not in channelNames, i.e. those added by ICorrespondenceRejection::prepareData().
+	static void removeAddedChannels(PointCloud3D* data, const std::vector<std::string>& channelNames);
+
+	/// Downsample the model for all resolution levels, unless this has been done for the same model and configuration.
+	void updateModelPyramid(PointCloud3D* model);
+
+	/// Voxel size of a resolution level
+	double getVoxelSize(int level) const;
+
 	///Pointer to point-to-point assigner strategy
 	IPointCorrespondence* assigner;
 
@@ -100,9 +152,36 @@ private:
 	/// Defines the maximum amount of iterations for matching process
 	int maxIterations;
 
+	/// Stages that reject or weight the correspondences
+	std::vector<ICorrespondenceRejection*> rejections;
+
+	/// Weights of the correspondences of the current iteration
+	std::vector<double> weights;
+
 	/// The threshold to define convergence.
 	double convergenceThreshold;
 
+	/// Number of resolution levels for coarse-to-fine matching
+	int numberOfResolutionLevels;
+
+	/// Voxel size of the coarsest resolution level
+	double coarsestVoxelSize;
+
+	/// Downsampled model, one point cloud for each level except the full resolution
+	std::vector<boost::shared_ptr<PointCloud3D> > modelPyramid;
+
+	/// Correspondence search for each downsampled model. Keeps the k-d tree of its level between the matches.
+	std::vector<boost::shared_ptr<IPointCorrespondence> > levelAssigners;
+
+	/// Model the pyramid has been created for
+	PointCloud3D* pyramidModel;
+
+	/// Revision of the model storage the pyramid has been created for
+	unsigned long pyramidModelRevision;
+
+	/// Voxel size of the coarsest level of the pyramid
+	double pyramidVoxelSize;
+
 	///Pointer to the model for the stateful interface (IIterativeClosestPointDetailed)
 	PointCloud3D* model;
 
@@ -26,6 +26,7 @@
 #include "brics_3d/algorithm/registration/RigidTransformationEstimationAPX.h"
 #include "brics_3d/algorithm/registration/RigidTransformationEstimationQUAT.h"
 #include "brics_3d/algorithm/registration/RigidTransformationEstimationORTHO.h"
+#include "brics_3d/algorithm/registration/RigidTransformationEstimationPointToPlane.h"
 
 
 #include <iostream>
@@ -122,6 +123,10 @@ IIterativeClosestPointPtr IterativeClosestPointFactory::createIterativeClosestPo
 				estimator = new RigidTransformationEstimationORTHO();
 				summary << "#  Subalgorithm: " << subalgorithm << endl;
 
+			} else if (subalgorithm.compare("RigidTransformationEstimationPointToPlane") == 0) {
+				estimator = new RigidTransformationEstimationPointToPlane();
+				summary << "#  Subalgorithm: " << subalgorithm << endl;
+
 //			} else if (...) {	//add more implementation here
 
 			} else {
@@ -168,9 +173,21 @@ IIterativeClosestPointPtr IterativeClosestPointFactory::createIterativeClosestPo
 		icpConfigurator->setConvergenceThreshold(convergenceThreshold);
 	}
 
+	int resolutionLevels;
+	if (configReader.getAttribute("IterativeClosestPoint", "resolutionLevels", &resolutionLevels)) {
+		icpConfigurator->setNumberOfResolutionLevels(resolutionLevels);
+	}
+
+	double coarsestVoxelSize;
+	if (configReader.getAttribute("IterativeClosestPoint", "coarsestVoxelSize", &coarsestVoxelSize)) {
+		icpConfigurator->setCoarsestVoxelSize(coarsestVoxelSize);
+	}
+
 	summary << "#" << endl << "# Parameters:" << endl;
 	summary << "#  maxIterations = " << icpConfigurator->getMaxIterations() << endl;
 	summary << "#  convergenceThreshold = " << icpConfigurator->getConvergenceThreshold() << endl;
+	summary << "#  resolutionLevels = " << icpConfigurator->getNumberOfResolutionLevels() << endl;
+	summary << "#  coarsestVoxelSize = " << icpConfigurator->getCoarsestVoxelSize() << endl;
 	summary << "#" << endl << "###########################################################" << endl;
 
 	LOG(INFO) << "Summary: " << std::endl << summary.str();
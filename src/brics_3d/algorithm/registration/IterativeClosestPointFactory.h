@@ -77,6 +77,12 @@ public:
      * </BRICS_3D-Configuration>
 	 * </code>
 	 * <br><br>
+	 * Available RigidTransformationEstimation implementations: RigidTransformationEstimationSVD, RigidTransformationEstimationAPX,
+	 * RigidTransformationEstimationHELIX, RigidTransformationEstimationQUAT, RigidTransformationEstimationORTHO and
+	 * RigidTransformationEstimationPointToPlane.<br><br>
+	 * The optional attributes <code>resolutionLevels</code> and <code>coarsestVoxelSize</code> of the IterativeClosestPoint
+	 * element enable the coarse-to-fine matching (see IIterativeClosestPointSetup::setNumberOfResolutionLevels()),
+	 * e.g. <code>resolutionLevels="3" coarsestVoxelSize="0.1"</code>.<br><br>
 	 * <b>NOTE1:</b> The current implementation of the <code>ConfigurationFileHandlerTest</code> configuration file parser bases on the Xerces library.
 	 * If it is not installed the default configuration is choosen.<br>
 	 */
@@ -0,0 +1,108 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#include "NormalCache.h"
+#include "brics_3d/core/Logger.h"
+#include "brics_3d/algorithm/featureExtraction/NormalEstimation.h"
+#include "brics_3d/algorithm/nearestNeighbor/NearestNeighborKDTree3D.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace brics_3d {
+
+NormalCache::NormalCache() {
+	this->pointCloud = 0;
+	this->revision = 0;
+	this->numberOfNeighbors = 10;
+}
+
+NormalCache::~NormalCache() {
+
+}
+
+const Coordinate* NormalCache::getNormals(PointCloud3D* pointCloud) {
+	const PointCloud3DStorage* storage = pointCloud->getStorage();
+	if (storage->hasChannel(PointCloud3D::normalChannel) && storage->getChannelWidth(PointCloud3D::normalChannel) == 3) {
+		return storage->getRawChannel(PointCloud3D::normalChannel);
+	}
+
+	unsigned long currentRevision = storage->getRevision();
+	if (pointCloud == this->pointCloud && currentRevision == revision) {
+		return estimatedNormals.empty() ? 0 : &estimatedNormals[0];
+	}
+
+	/* estimate on a copy, as the estimation accesses the points via getPointCloud() and would invalidate the storage */
+	PointCloud3D pointCloudCopy(*pointCloud);
+	NormalSet3D normalSet;
+	NearestNeighborKDTree3D nearestNeighborSearch;
+	NormalEstimation normalEstimation;
+	normalEstimation.setInputCloud(&pointCloudCopy);
+	normalEstimation.setSearchMethod(&nearestNeighborSearch);
+	normalEstimation.setkneighbours(numberOfNeighbors);
+	normalEstimation.computeFeature(&normalSet);
+
+	this->pointCloud = pointCloud;
+	revision = currentRevision;
+	estimatedNormals.clear();
+	if (normalSet.getSize() != storage->getSize()) {
+		LOG(WARNING) << "Normal estimation failed for " << storage->getSize() - normalSet.getSize() << " points.";
+		return 0;
+	}
+	estimatedNormals.resize(3 * normalSet.getSize());
+	for (unsigned int i = 0; i < normalSet.getSize(); ++i) {
+		const Normal3D& normal = (*normalSet.getNormals())[i];
+		estimatedNormals[3 * i] = normal.getX();
+		estimatedNormals[3 * i + 1] = normal.getY();
+		estimatedNormals[3 * i + 2] = normal.getZ();
+	}
+	return estimatedNormals.empty() ? 0 : &estimatedNormals[0];
+}
+
+bool NormalCache::addNormalChannel(PointCloud3D* pointCloud) {
+	const PointCloud3DStorage* storage = pointCloud->getStorage();
+	if (storage->hasChannel(PointCloud3D::normalChannel) || pointCloud->containsDecoratedPoints()) {
+		return false;
+	}
+	const Coordinate* normals = getNormals(pointCloud);
+	if (normals == 0) {
+		return false;
+	}
+
+	PointCloud3DStorage* mutableStorage = pointCloud->getMutableStorage();
+	mutableStorage->addChannel(PointCloud3D::normalChannel, 3);
+	std::copy(normals, normals + 3 * mutableStorage->getSize(), mutableStorage->getRawChannel(PointCloud3D::normalChannel));
+	return true;
+}
+
+int NormalCache::getNumberOfNeighbors() const {
+	return numberOfNeighbors;
+}
+
+void NormalCache::setNumberOfNeighbors(int numberOfNeighbors) {
+	if (numberOfNeighbors < 3) {
+		throw std::runtime_error("ERROR: numberOfNeighbors for the normal estimation cannot be less than 3.");
+	}
+	this->numberOfNeighbors = numberOfNeighbors;
+	this->pointCloud = 0; // estimate again
+}
+
+}
+
+/* EOF */
@@ -0,0 +1,98 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#ifndef BRICS_3D_NORMALCACHE_H_
+#define BRICS_3D_NORMALCACHE_H_
+
+#include "brics_3d/core/PointCloud3D.h"
+
+#include <vector>
+
+namespace brics_3d {
+
+/**
+ * @ingroup registration
+ * @brief Provides the normals of a point cloud for the registration algorithms.
+ *
+ * The normals are taken from the PointCloud3D::normalChannel, if available. Otherwise they are estimated with
+ * NormalEstimation (see setNumberOfNeighbors()). The estimated normals are kept until another point cloud or a
+ * modified one is passed (see PointCloud3DStorage::getRevision()).
+ *
+ * Note that a point cloud that is transformed in every ICP iteration, like the data, invalidates the estimated
+ * normals each time. Normals in the normal channel are rotated along with the points instead, so the normals of
+ * such a point cloud should be attached once with addNormalChannel().
+ */
+class NormalCache {
+public:
+
+	/**
+	 * @brief Standard constructor
+	 */
+	NormalCache();
+
+	/**
+	 * @brief Standard destructor
+	 */
+	virtual ~NormalCache();
+
+	/**
+	 * @brief Get the normals of a point cloud.
+	 * @param pointCloud The point cloud.
+	 * @return The normals as x, y and z per point. Returns 0 if no normals are available.
+	 */
+	const Coordinate* getNormals(PointCloud3D* pointCloud);
+
+	/**
+	 * @brief Estimate the normals of a point cloud and add them as its PointCloud3D::normalChannel.
+	 * @param pointCloud The point cloud.
+	 * @return False if the point cloud already has normals, contains decorated points or the estimation fails.
+	 */
+	bool addNormalChannel(PointCloud3D* pointCloud);
+
+	/**
+	 * @brief Get the number of neighbors that define the plane of a point, if the normals have to be estimated.
+	 */
+	int getNumberOfNeighbors() const;
+
+	/**
+	 * @brief Set the number of neighbors that define the plane of a point, if the normals have to be estimated.
+	 * @param numberOfNeighbors At least 3. Default is 10.
+	 */
+	void setNumberOfNeighbors(int numberOfNeighbors);
+
+private:
+
+	/// Estimated normals, x, y and z per point
+	std::vector<Coordinate> estimatedNormals;
+
+	/// Point cloud the normals have been estimated for. 0 if there is none.
+	PointCloud3D* pointCloud;
+
+	/// Revision of the storage the normals have been estimated for
+	unsigned long revision;
+
+	/// Number of neighbors for the normal estimation
+	int numberOfNeighbors;
+};
+
+}
+
+#endif /* BRICS_3D_NORMALCACHE_H_ */
+
+/* EOF */
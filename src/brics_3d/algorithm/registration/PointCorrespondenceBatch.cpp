@@ -0,0 +1,63 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#include "PointCorrespondenceBatch.h"
+
+namespace brics_3d {
+
+/// Copy the points of the index pairs [begin, end).
+static void convertRange(const PointCloud3DStorage* model, const PointCloud3DStorage* data,
+		const std::vector<CorrespondenceIndexPair>* indexPairs, std::vector<CorrespondencePoint3DPair>* resultPointPairs,
+		unsigned int /*block*/, unsigned int begin, unsigned int end) {
+
+	const Coordinate* x1 = model->getRawX();
+	const Coordinate* y1 = model->getRawY();
+	const Coordinate* z1 = model->getRawZ();
+	const Coordinate* x2 = data->getRawX();
+	const Coordinate* y2 = data->getRawY();
+	const Coordinate* z2 = data->getRawZ();
+	for (unsigned int i = begin; i < end; ++i) {
+		unsigned int first = (*indexPairs)[i].firstIndex;
+		unsigned int second = (*indexPairs)[i].secondIndex;
+		CorrespondencePoint3DPair& pair = (*resultPointPairs)[i];
+		pair.firstPoint.setX(x1[first]);
+		pair.firstPoint.setY(y1[first]);
+		pair.firstPoint.setZ(z1[first]);
+		pair.secondPoint.setX(x2[second]);
+		pair.secondPoint.setY(y2[second]);
+		pair.secondPoint.setZ(z2[second]);
+	}
+}
+
+void convertCorrespondences(const PointCloud3DStorage* model, const PointCloud3DStorage* data,
+		const std::vector<CorrespondenceIndexPair>& indexPairs, std::vector<CorrespondencePoint3DPair>* resultPointPairs,
+		unsigned int numberOfThreads) {
+
+	unsigned int size = static_cast<unsigned int>(indexPairs.size());
+	resultPointPairs->clear();
+	resultPointPairs->resize(size);
+
+	const unsigned int minimalPairsPerThread = 16384;
+	forEachRange(boost::bind(&convertRange, model, data, &indexPairs, resultPointPairs, _1, _2, _3), 0u, size,
+			numberOfThreads, minimalPairsPerThread);
+}
+
+}
+
+/* EOF */
@@ -0,0 +1,116 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#ifndef BRICS_3D_POINTCORRESPONDENCEBATCH_H_
+#define BRICS_3D_POINTCORRESPONDENCEBATCH_H_
+
+#include "brics_3d/core/PointCloud3DStorage.h"
+#include "brics_3d/core/CorrespondenceIndexPair.h"
+#include "brics_3d/core/CorrespondencePoint3DPair.h"
+#include "brics_3d/core/ParallelRange.h"
+
+#include <vector>
+
+namespace brics_3d {
+
+/// Forwards a block of data points to a range search together with the result buffer of the block.
+template <typename RangeSearch>
+struct CorrespondenceSearchBlock {
+	RangeSearch rangeSearch;
+	std::vector<std::vector<CorrespondenceIndexPair> >* blockResults;
+
+	void operator()(unsigned int block, unsigned int blockBegin, unsigned int blockEnd) const {
+		rangeSearch(block, blockBegin, blockEnd, &(*blockResults)[block]);
+	}
+};
+
+/**
+ * @ingroup registration
+ * @brief Distributes the correspondence search for the points of a data cloud over several threads.
+ *
+ * The points [0, size) are split into contiguous blocks, one block per thread. Each block is processed by
+ * <code>rangeSearch(block, blockBegin, blockEnd, blockResult)</code>, which appends the correspondences of its points
+ * in increasing order to its own, preallocated result buffer. Afterwards the buffers are concatenated in block order,
+ * so the result does not depend on the number of threads and is the same as the one of a serial search.
+ *
+ * @param rangeSearch Functor with the signature
+ *        <code>void (unsigned int block, unsigned int begin, unsigned int end, std::vector<CorrespondenceIndexPair>* result)</code>.
+ *        block is the number of the block in [0, number of threads).
+ * @param size Number of data points.
+ * @param resultIndexPairs The merged correspondences. Previous content is replaced.
+ * @param numberOfThreads Maximal number of threads. 0 means one thread per hardware core.
+ * @param minimalPointsPerThread Minimal number of points for an additional thread.
+ */
+template <typename RangeSearch>
+void runCorrespondenceSearch(RangeSearch rangeSearch, unsigned int size, std::vector<CorrespondenceIndexPair>* resultIndexPairs,
+		unsigned int numberOfThreads, unsigned int minimalPointsPerThread = 4096) {
+
+	resultIndexPairs->clear();
+	std::vector<unsigned int> boundaries;
+	splitRange(0u, size, numberOfThreads, minimalPointsPerThread, &boundaries);
+	if (boundaries.empty()) {
+		return;
+	}
+	unsigned int numberOfBlocks = static_cast<unsigned int>(boundaries.size() - 1);
+
+	if (numberOfBlocks == 1) {
+		resultIndexPairs->reserve(size);
+		rangeSearch(0u, 0u, size, resultIndexPairs);
+		return;
+	}
+
+	std::vector<std::vector<CorrespondenceIndexPair> > blockResults(numberOfBlocks);
+	for (unsigned int block = 0; block < numberOfBlocks; ++block) {
+		blockResults[block].reserve(boundaries[block + 1] - boundaries[block]);
+	}
+	CorrespondenceSearchBlock<RangeSearch> search = {rangeSearch, &blockResults};
+	forEachRange(search, boundaries);
+
+	/* deterministic merge */
+	unsigned int totalSize = 0;
+	for (unsigned int block = 0; block < numberOfBlocks; ++block) {
+		totalSize += static_cast<unsigned int>(blockResults[block].size());
+	}
+	resultIndexPairs->reserve(totalSize);
+	for (unsigned int block = 0; block < numberOfBlocks; ++block) {
+		resultIndexPairs->insert(resultIndexPairs->end(), blockResults[block].begin(), blockResults[block].end());
+	}
+}
+
+/**
+ * @brief Resolve index correspondences to pairs of points.
+ *
+ * The first index of a pair refers to the model, the second one to the data. The points are copied by several
+ * threads.
+ *
+ * @param model Points referred to by the first indices.
+ * @param data Points referred to by the second indices.
+ * @param indexPairs The correspondences.
+ * @param resultPointPairs The resulting point pairs, in the same order as the index pairs. Previous content is replaced.
+ * @param numberOfThreads Maximal number of threads. 0 means one thread per hardware core.
+ */
+void convertCorrespondences(const PointCloud3DStorage* model, const PointCloud3DStorage* data,
+		const std::vector<CorrespondenceIndexPair>& indexPairs, std::vector<CorrespondencePoint3DPair>* resultPointPairs,
+		unsigned int numberOfThreads);
+
+}
+
+#endif /* BRICS_3D_POINTCORRESPONDENCEBATCH_H_ */
+
+/* EOF */
@@ -18,6 +18,8 @@
 ******************************************************************************/
 
 #include "PointCorrespondenceGenericNN.h"
+#include "PointCorrespondenceBatch.h"
+#include "brics_3d/algorithm/nearestNeighbor/INearestNeighborSetup.h"
 
 #include <assert.h>
 
@@ -25,11 +27,17 @@ namespace brics_3d {
 
 PointCorrespondenceGenericNN::PointCorrespondenceGenericNN() {
 	this->nearestNeighborAlgorithm = 0;
+	this->model = 0;
+	this->modelRevision = 0;
+	this->maxCorrespondenceDistance = -1.0;
 
 }
 
 PointCorrespondenceGenericNN::PointCorrespondenceGenericNN(INearestPoint3DNeighbor* nearestNeighborAlgorithm) {
     this->nearestNeighborAlgorithm = nearestNeighborAlgorithm;
+	this->model = 0;
+	this->modelRevision = 0;
+	this->maxCorrespondenceDistance = -1.0;
 }
 
 PointCorrespondenceGenericNN::~PointCorrespondenceGenericNN() {
@@ -40,37 +48,63 @@ PointCorrespondenceGenericNN::~PointCorrespondenceGenericNN() {
 
 void PointCorrespondenceGenericNN::createNearestNeighborCorrespondence(PointCloud3D* pointCloud1,
 		PointCloud3D* pointCloud2, std::vector<CorrespondencePoint3DPair>* resultPointPairs) {
+	assert(resultPointPairs != 0);
+
+	std::vector<CorrespondenceIndexPair> indexPairs;
+	createNearestNeighborCorrespondence(pointCloud1, pointCloud2, &indexPairs);
+	convertCorrespondences(pointCloud1->getStorage(), pointCloud2->getStorage(), indexPairs, resultPointPairs, getSearchThreads());
+}
+
+/// Collect the correspondences of the data points [begin, end) from the search results.
+static void collectRange(const std::vector<int>* resultIndices, const PointCloud3DStorage* model, const PointCloud3DStorage* data,
+		double maxSquaredDistance, unsigned int block, unsigned int begin, unsigned int end, std::vector<CorrespondenceIndexPair>* result) {
+	for (unsigned int i = begin; i < end; i++) {
+		int resultIndex = (*resultIndices)[i];
+		if (resultIndex < 0) { // -1 if the nearest neighbor exceeds the maximum distance
+			continue;
+		}
+		assert (resultIndex < static_cast<int>(model->getSize())); //plausibility check if result is in range
+
+		if (maxSquaredDistance >= 0.0) {
+			double dx = model->getRawX()[resultIndex] - data->getRawX()[i];
+			double dy = model->getRawY()[resultIndex] - data->getRawY()[i];
+			double dz = model->getRawZ()[resultIndex] - data->getRawZ()[i];
+			if (dx * dx + dy * dy + dz * dz > maxSquaredDistance) {
+				continue;
+			}
+		}
+		result->push_back(CorrespondenceIndexPair(static_cast<unsigned int>(resultIndex), i));
+	}
+}
+
+void PointCorrespondenceGenericNN::createNearestNeighborCorrespondence(PointCloud3D* pointCloud1,
+		PointCloud3D* pointCloud2, std::vector<CorrespondenceIndexPair>* resultIndexPairs) {
 
 	assert(nearestNeighborAlgorithm != 0);  // check if algorithm is set up
 	assert(pointCloud1 != 0);  // check input parameters
 	assert(pointCloud2 != 0);
-	assert(resultPointPairs != 0);
-
-	resultPointPairs->clear();
-
-	/* prepare data */
-	nearestNeighborAlgorithm->setData(pointCloud1);
+	assert(resultIndexPairs != 0);
+
+	/* prepare data (only if the model has changed) */
+	unsigned long revision = pointCloud1->getStorage()->getRevision();
+	if (pointCloud1 != model || revision != modelRevision) {
+		nearestNeighborAlgorithm->setData(pointCloud1);
+		model = pointCloud1;
+		modelRevision = revision;
+	}
 
-	/* search for each point in pointCloud2 */
+	/* search for all points in pointCloud2 with one batch query */
 	vector<int> resultIndices;
-	int resultIndex;
 	int k = 1; //only the nearest neighbor is considered
+	nearestNeighborAlgorithm->findNearestNeighbors(pointCloud2, &resultIndices, k);
 
-	for (unsigned int i = 0; i < pointCloud2->getSize(); i++) {
-
-		nearestNeighborAlgorithm->findNearestNeighbors( &(*pointCloud2->getPointCloud())[i], &resultIndices, k);
-
-		if (resultIndices.size() > 0) {
-			resultIndex = resultIndices[0];
-			assert (resultIndex < static_cast<int>(pointCloud1->getSize())); //plausibility check if result is in range
-
-			Point3D firstPoint = Point3D (&((*pointCloud1->getPointCloud())[resultIndex]));
-			Point3D secondPoint = Point3D (&((*pointCloud2->getPointCloud())[i]));
-
-			CorrespondencePoint3DPair foundPair(firstPoint, secondPoint);
-			resultPointPairs->push_back(foundPair);
-		}
+	double maxSquaredDistance = -1.0;
+	if (maxCorrespondenceDistance >= 0.0) {
+		maxSquaredDistance = maxCorrespondenceDistance * maxCorrespondenceDistance;
 	}
+	runCorrespondenceSearch(boost::bind(&collectRange, &resultIndices, pointCloud1->getStorage(), pointCloud2->getStorage(),
+			maxSquaredDistance, _1, _2, _3, _4),
+			static_cast<unsigned int>(resultIndices.size()), resultIndexPairs, getSearchThreads(), 65536);
 }
 
 INearestPoint3DNeighbor* PointCorrespondenceGenericNN::getNearestNeighborAlgorithm() const {
@@ -79,6 +113,20 @@ INearestPoint3DNeighbor* PointCorrespondenceGenericNN::getNearestNeighborAlgorit
 
 void PointCorrespondenceGenericNN::setNearestNeighborAlgorithm(INearestPoint3DNeighbor* nearestNeighborAlgorithm) {
 	this->nearestNeighborAlgorithm = nearestNeighborAlgorithm;
+	this->model = 0; // the new search structure has not been set up yet
+}
+
+unsigned int PointCorrespondenceGenericNN::getSearchThreads() const {
+	INearestNeighborSetup* setup = dynamic_cast<INearestNeighborSetup*>(nearestNeighborAlgorithm);
+	return (setup != 0) ? setup->getNumberOfThreads() : 1;
+}
+
+double PointCorrespondenceGenericNN::getMaxCorrespondenceDistance() const {
+	return maxCorrespondenceDistance;
+}
+
+void PointCorrespondenceGenericNN::setMaxCorrespondenceDistance(double maxCorrespondenceDistance) {
+	this->maxCorrespondenceDistance = maxCorrespondenceDistance;
 }
 
 }
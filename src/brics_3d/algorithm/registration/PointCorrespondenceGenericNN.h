@@ -28,6 +28,16 @@ namespace brics_3d {
 /**
  * @ingroup registration
  * @brief Implementation of correspondence problem for points using generic nearest neighbor search
+ *
+ * The search structure is only set up with a model (pointCloud1) if another model is passed than in the last
+ * invocation or the revision of its storage has changed (see PointCloud3DStorage::getRevision()). So it is built
+ * once per model and reused across the ICP iterations and successive matches against the same model.
+ *
+ * The nearest neighbors of all data points are determined with one batch query. This class has no thread setting of
+ * its own: the batch query runs in parallel only if the search strategy allows concurrent queries, which is the case
+ * for NearestNeighborKDTree3D, NearestNeighborVoxelGrid, NearestNeighborDynamicKDTree3D and NearestNeighborSTANN (see
+ * INearestNeighborSetup::setNumberOfThreads()). NearestNeighborANN and NearestNeighborFLANN answer a batch serially.
+ * The thread setting of the search strategy is also used to collect the results into correspondences.
  */
 class PointCorrespondenceGenericNN: public brics_3d::IPointCorrespondence {
 public:
@@ -50,6 +60,10 @@ public:
 
 	void createNearestNeighborCorrespondence(PointCloud3D* pointCloud1, PointCloud3D* pointCloud2,
 			std::vector<CorrespondencePoint3DPair>* resultPointPairs);
+
+	void createNearestNeighborCorrespondence(PointCloud3D* pointCloud1, PointCloud3D* pointCloud2,
+			std::vector<CorrespondenceIndexPair>* resultIndexPairs);
+
 	/**
 	 * @brief Get the nearest neighbor search strategy
 	 * @return Returns the nearest neighbor search strategy
@@ -62,10 +76,32 @@ public:
 	 */
 	void setNearestNeighborAlgorithm(INearestPoint3DNeighbor* nearestNeighborAlgorithm);
 
+	/**
+	 * @brief Get the maximal distance between corresponding points.
+	 *
+	 * Applied in addition to the maximal distance of the search strategy. Default is -1, i.e. only the limit of the
+	 * search strategy applies.
+	 */
+	double getMaxCorrespondenceDistance() const;
+
+	void setMaxCorrespondenceDistance(double maxCorrespondenceDistance);
+
 private:
 
+	/// Maximal number of threads of the search strategy. 1 if it cannot be configured.
+	unsigned int getSearchThreads() const;
+
 	/// Internal handle to the nearest neighbor search strategy
 	INearestPoint3DNeighbor* nearestNeighborAlgorithm;
+
+	/// Model the search structure has been set up with. 0 if there is none.
+	PointCloud3D* model;
+
+	/// Revision of the model storage the search structure has been set up with
+	unsigned long modelRevision;
+
+	/// Maximal distance between corresponding points. Negative values disable the limit.
+	double maxCorrespondenceDistance;
 };
 
 }
@@ -18,6 +18,7 @@
 ******************************************************************************/
 
 #include "brics_3d/algorithm/registration/PointCorrespondenceKDTree.h"
+#include "brics_3d/algorithm/registration/PointCorrespondenceBatch.h"
 
 #define MAX_OPENMP_NUM_THREADS 4
 #include "6dslam/src/d2tree.h"
@@ -25,6 +26,8 @@
 #include "6dslam/src/kdc.h"
 
 #include <iostream>
+#include <limits>
+#include <cmath>
 #include <assert.h>
 
 using std::cout;
@@ -32,75 +35,125 @@ using std::endl;
 namespace brics_3d {
 
 PointCorrespondenceKDTree::PointCorrespondenceKDTree() {
-
+	kDTree = 0;
+	modelPoints = 0;
+	modelCoordinates = 0;
+	modelSize = 0;
+	model = 0;
+	modelRevision = 0;
+	numberOfThreads = 0;
+	maxCorrespondenceDistance = sqrt(50.0);
 }
 
 PointCorrespondenceKDTree::~PointCorrespondenceKDTree() {
-
+	clearModel();
 }
 
 void PointCorrespondenceKDTree::createNearestNeighborCorrespondence(PointCloud3D* pointCloud1, PointCloud3D* pointCloud2, std::vector<CorrespondencePoint3DPair>* resultPointPairs) {
-	assert(pointCloud1 != 0);
-	assert(pointCloud2 != 0);
 	assert(resultPointPairs != 0);
 
-	double *centroid_m = new double[3];
-	double *centroid_d = new double[3];
-	double maxMatchingDistance = 50;
+	std::vector<CorrespondenceIndexPair> indexPairs;
+	createNearestNeighborCorrespondence(pointCloud1, pointCloud2, &indexPairs);
+	convertCorrespondences(pointCloud1->getStorage(), pointCloud2->getStorage(), indexPairs, resultPointPairs, numberOfThreads);
+}
 
-	resultPointPairs->clear();
+void PointCorrespondenceKDTree::createNearestNeighborCorrespondence(PointCloud3D* pointCloud1, PointCloud3D* pointCloud2, std::vector<CorrespondenceIndexPair>* resultIndexPairs) {
+	assert(pointCloud1 != 0);
+	assert(pointCloud2 != 0);
+	assert(resultIndexPairs != 0);
 
 	/* prepare data */
-	double** pointCloud1Points = new double*[pointCloud1->getSize()];
-	for (unsigned int i = 0; i < pointCloud1->getSize(); i++) {
-		pointCloud1Points[i] = new double[3];
-		pointCloud1Points[i][0] = (*pointCloud1->getPointCloud())[i].getX();
-		pointCloud1Points[i][1] = (*pointCloud1->getPointCloud())[i].getY();
-		pointCloud1Points[i][2] = (*pointCloud1->getPointCloud())[i].getZ();
+	updateModel(pointCloud1);
+
+	/* the k-d tree has one search slot per thread */
+	unsigned int threads = numberOfThreads;
+	if (threads == 0) {
+		threads = std::max(1u, boost::thread::hardware_concurrency());
 	}
+	threads = std::min(threads, static_cast<unsigned int>(MAX_OPENMP_NUM_THREADS));
+
+	const PointCloud3DStorage* storage2 = pointCloud2->getStorage();
+	runCorrespondenceSearch(boost::bind(&PointCorrespondenceKDTree::searchRange, this, storage2, _1, _2, _3, _4),
+			storage2->getSize(), resultIndexPairs, threads);
+}
 
-	KDtree* kDTree = new KDtree(pointCloud1Points, pointCloud1->getSize());
-//	cout << "k-d tree created" << endl;
+void PointCorrespondenceKDTree::searchRange(const PointCloud3DStorage* data, unsigned int thread, unsigned int begin, unsigned int end,
+		std::vector<CorrespondenceIndexPair>* result) const {
 
-//	unsigned int numpts_target;
-//	KDtree *kd = 0;
-//	kd = new KDtree(Source->points_red, Source->points_red_size);
-//	numpts_target = Target->points_red_size;
+	const Coordinate* x2 = data->getRawX();
+	const Coordinate* y2 = data->getRawY();
+	const Coordinate* z2 = data->getRawZ();
 
-	for (unsigned int i = 0; i < pointCloud2->getSize(); i++) {
-		//if (rnd > 1 && rand(rnd) != 0) continue;  // take about 1/rnd-th of the numbers only
+	/* the k-d tree of 6D SLAM expects a squared distance */
+	double maxMatchingDistance = std::numeric_limits<double>::max();
+	if (maxCorrespondenceDistance >= 0.0) {
+		maxMatchingDistance = maxCorrespondenceDistance * maxCorrespondenceDistance;
+	}
 
+	for (unsigned int i = begin; i < end; i++) {
 		double queryPoint[3];
-		queryPoint[0] = (*pointCloud2->getPointCloud())[i].getX();
-		queryPoint[1] = (*pointCloud2->getPointCloud())[i].getY();
-		queryPoint[2] = (*pointCloud2->getPointCloud())[i].getZ();
+		queryPoint[0] = x2[i];
+		queryPoint[1] = y2[i];
+		queryPoint[2] = z2[i];
 
-		double *closest = kDTree->FindClosest(queryPoint, maxMatchingDistance, 0);
+		double *closest = kDTree->FindClosest(queryPoint, maxMatchingDistance, thread);
 		if (closest) {
-			centroid_m[0] += queryPoint[0];
-			centroid_m[1] += queryPoint[1];
-			centroid_m[2] += queryPoint[2];
-			centroid_d[0] += closest[0];
-			centroid_d[1] += closest[1];
-			centroid_d[2] += closest[2];
-
-			Point3D firstPoint = Point3D (closest[0], closest[1], closest[2]);
-			Point3D secondPoint = Point3D (queryPoint[0], queryPoint[1], queryPoint[2]);
-
-			CorrespondencePoint3DPair foundPair(firstPoint, secondPoint);
-			resultPointPairs->push_back(foundPair);
+			result->push_back(CorrespondenceIndexPair(static_cast<unsigned int>((closest - modelCoordinates) / 3), i));
 		}
 	}
-//	centroid_m[0] /= pairs[thread_num].size();
-//	centroid_m[1] /= pairs[thread_num].size();
-//	centroid_m[2] /= pairs[thread_num].size();
-//	centroid_d[0] /= pairs[thread_num].size();
-//	centroid_d[1] /= pairs[thread_num].size();
-//	centroid_d[2] /= pairs[thread_num].size();
+}
+
+void PointCorrespondenceKDTree::updateModel(PointCloud3D* model) {
+	const PointCloud3DStorage* storage1 = model->getStorage();
+	unsigned long revision = storage1->getRevision();
+	if (kDTree != 0 && model == this->model && revision == modelRevision) {
+		return; // k-d tree is still valid
+	}
+	clearModel();
+
+	const Coordinate* x1 = storage1->getRawX();
+	const Coordinate* y1 = storage1->getRawY();
+	const Coordinate* z1 = storage1->getRawZ();
+	modelSize = storage1->getSize();
+	modelCoordinates = new double[3 * modelSize];
+	modelPoints = new double*[modelSize];
+	for (unsigned int i = 0; i < modelSize; i++) {
+		modelPoints[i] = &modelCoordinates[3 * i];
+		modelPoints[i][0] = x1[i];
+		modelPoints[i][1] = y1[i];
+		modelPoints[i][2] = z1[i];
+	}
 
+	kDTree = new KDtree(modelPoints, modelSize);
+	this->model = model;
+	modelRevision = revision;
+}
+
+void PointCorrespondenceKDTree::clearModel() {
 	delete kDTree;
+	kDTree = 0;
+	delete[] modelPoints;
+	modelPoints = 0;
+	delete[] modelCoordinates;
+	modelCoordinates = 0;
+	modelSize = 0;
+	model = 0;
+}
+
+unsigned int PointCorrespondenceKDTree::getNumberOfThreads() const {
+	return numberOfThreads;
+}
+
+void PointCorrespondenceKDTree::setNumberOfThreads(unsigned int numberOfThreads) {
+	this->numberOfThreads = numberOfThreads;
+}
+
+double PointCorrespondenceKDTree::getMaxCorrespondenceDistance() const {
+	return maxCorrespondenceDistance;
+}
 
-	return;
+void PointCorrespondenceKDTree::setMaxCorrespondenceDistance(double maxCorrespondenceDistance) {
+	this->maxCorrespondenceDistance = maxCorrespondenceDistance;
 }
 
 }
@@ -23,11 +23,21 @@
 
 #include "IPointCorrespondence.h"
 
+class KDtree;
+
 namespace brics_3d {
 
 /**
  * @ingroup registration
  * @brief Implementation of correspondence problem for points using k-d trees.
+ *
+ * The k-d tree of the model (pointCloud1) is kept between the invocations and only rebuilt if another model is passed
+ * or the revision of its storage has changed (see PointCloud3DStorage::getRevision()). Thus the tree is created
+ * once per model, not once per ICP iteration.
+ *
+ * The data points are partitioned into blocks that are searched concurrently (see setNumberOfThreads()). The k-d tree
+ * keeps the state of a search in static per-thread slots, thus at most 4 threads are used and two instances must not
+ * search at the same time.
  */
 class PointCorrespondenceKDTree: public brics_3d::IPointCorrespondence {
 public:
@@ -43,6 +53,64 @@ public:
 	virtual ~PointCorrespondenceKDTree();
 
 	void createNearestNeighborCorrespondence(PointCloud3D* pointCloud1, PointCloud3D* pointCloud2, std::vector<CorrespondencePoint3DPair>* resultPointPairs);
+
+	void createNearestNeighborCorrespondence(PointCloud3D* pointCloud1, PointCloud3D* pointCloud2, std::vector<CorrespondenceIndexPair>* resultIndexPairs);
+
+	/**
+	 * @brief Get the maximal number of threads.
+	 * @return 0 means one thread per hardware core.
+	 */
+	unsigned int getNumberOfThreads() const;
+
+	/**
+	 * @brief Set the maximal number of threads.
+	 * Limited to 4 by the k-d tree.
+	 * @param numberOfThreads 0 means one thread per hardware core. This is the default.
+	 */
+	void setNumberOfThreads(unsigned int numberOfThreads);
+
+	/**
+	 * @brief Get the maximal distance between corresponding points. Default is sqrt(50).
+	 */
+	double getMaxCorrespondenceDistance() const;
+
+	void setMaxCorrespondenceDistance(double maxCorrespondenceDistance);
+
+private:
+
+	/// Search the correspondences for the data points [begin, end) using the search slot of a thread.
+	void searchRange(const PointCloud3DStorage* data, unsigned int thread, unsigned int begin, unsigned int end,
+			std::vector<CorrespondenceIndexPair>* result) const;
+
+	/// Build the k-d tree for a model, unless it is the one of the last invocation.
+	void updateModel(PointCloud3D* model);
+
+	/// Free the k-d tree and the model points.
+	void clearModel();
+
+	/// k-d tree of the current model
+	KDtree* kDTree;
+
+	/// Pointers to the model points as used by the k-d tree
+	double** modelPoints;
+
+	/// Copy of the model coordinates, point by point. Search results are mapped to indices by their offset.
+	double* modelCoordinates;
+
+	/// Number of model points
+	unsigned int modelSize;
+
+	/// Model the k-d tree has been built for
+	PointCloud3D* model;
+
+	/// Revision of the model storage the k-d tree has been built for
+	unsigned long modelRevision;
+
+	/// Maximal number of threads. 0 means one thread per hardware core.
+	unsigned int numberOfThreads;
+
+	/// Maximal distance between corresponding points. Negative values disable the limit.
+	double maxCorrespondenceDistance;
 };
 
 }
@@ -0,0 +1,196 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#include "RigidTransformationEstimationPointToPlane.h"
+#include "brics_3d/core/Logger.h"
+#include "brics_3d/core/HomogeneousMatrix44.h"
+#include "RigidTransformationEstimationSVD.h"
+
+#include <Eigen/Dense>
+#include <Eigen/Geometry>
+#include <cmath>
+#include <stdexcept>
+
+namespace brics_3d {
+
+/// Write a rotation and a translation to a homogeneous matrix.
+static void setTransformation(const Eigen::Matrix3d& rotation, const Eigen::Vector3d& translation, IHomogeneousMatrix44* resultTransformation) {
+	HomogeneousMatrix44 transformation(rotation(0,0), rotation(0,1), rotation(0,2),
+			rotation(1,0), rotation(1,1), rotation(1,2),
+			rotation(2,0), rotation(2,1), rotation(2,2),
+			translation[0], translation[1], translation[2]);
+	const double* matrixData = transformation.getRawData();
+	double* resultRawData = resultTransformation->setRawData();
+	for (int i = 0; i < 16; ++i) {
+		resultRawData[i] = matrixData[i];
+	}
+}
+
+RigidTransformationEstimationPointToPlane::RigidTransformationEstimationPointToPlane() {
+
+}
+
+RigidTransformationEstimationPointToPlane::~RigidTransformationEstimationPointToPlane() {
+
+}
+
+double RigidTransformationEstimationPointToPlane::estimateTransformation(std::vector<CorrespondencePoint3DPair>* pointPairs, IHomogeneousMatrix44* resultTransformation) {
+	assert(pointPairs != 0);
+	assert(resultTransformation != 0);
+
+	/* no normals available: closed form point-to-point solution */
+	unsigned int size = static_cast<unsigned int>(pointPairs->size());
+	if (size < 3) {
+		setTransformation(Eigen::Matrix3d::Identity(), Eigen::Vector3d::Zero(), resultTransformation);
+		return -1.0;
+	}
+	Eigen::Matrix<double, 3, Eigen::Dynamic> modelPoints(3, size);
+	Eigen::Matrix<double, 3, Eigen::Dynamic> dataPoints(3, size);
+	double squaredError = 0.0;
+	for (unsigned int i = 0; i < size; ++i) {
+		const CorrespondencePoint3DPair& pair = (*pointPairs)[i];
+		modelPoints.col(i) << pair.firstPoint.getX(), pair.firstPoint.getY(), pair.firstPoint.getZ();
+		dataPoints.col(i) << pair.secondPoint.getX(), pair.secondPoint.getY(), pair.secondPoint.getZ();
+		squaredError += (modelPoints.col(i) - dataPoints.col(i)).squaredNorm();
+	}
+	Eigen::Matrix4d transformation = Eigen::umeyama(dataPoints, modelPoints, false);
+	setTransformation(transformation.block<3,3>(0,0), transformation.block<3,1>(0,3), resultTransformation);
+
+	return std::sqrt(squaredError / size);
+}
+
+double RigidTransformationEstimationPointToPlane::estimateTransformation(PointCloud3D* model, PointCloud3D* data,
+		std::vector<CorrespondenceIndexPair>* indexPairs, IHomogeneousMatrix44* resultTransformation) {
+	return estimateTransformation(model, data, indexPairs, 0, resultTransformation);
+}
+
+double RigidTransformationEstimationPointToPlane::estimateTransformation(PointCloud3D* model, PointCloud3D* data,
+		std::vector<CorrespondenceIndexPair>* indexPairs, const std::vector<double>* weights, IHomogeneousMatrix44* resultTransformation) {
+	assert(model != 0);
+	assert(data != 0);
+	assert(indexPairs != 0);
+	assert(weights == 0 || weights->size() == indexPairs->size());
+	assert(resultTransformation != 0);
+
+	const Coordinate* normals = modelNormals.getNormals(model);
+	if (normals == 0) {
+		return estimatePointToPoint(model, data, indexPairs, weights, resultTransformation);
+	}
+
+	const PointCloud3DStorage* modelStorage = model->getStorage();
+	const PointCloud3DStorage* dataStorage = data->getStorage();
+	const Coordinate* modelX = modelStorage->getRawX();
+	const Coordinate* modelY = modelStorage->getRawY();
+	const Coordinate* modelZ = modelStorage->getRawZ();
+	const Coordinate* dataX = dataStorage->getRawX();
+	const Coordinate* dataY = dataStorage->getRawY();
+	const Coordinate* dataZ = dataStorage->getRawZ();
+
+	/* rotate around the centroid of the data for a well conditioned system */
+	Eigen::Vector3d centroid = Eigen::Vector3d::Zero();
+	double weightSum = 0.0;
+	for (unsigned int i = 0; i < indexPairs->size(); ++i) {
+		unsigned int second = (*indexPairs)[i].secondIndex;
+		double weight = (weights == 0) ? 1.0 : (*weights)[i];
+		centroid += weight * Eigen::Vector3d(dataX[second], dataY[second], dataZ[second]);
+		weightSum += weight;
+	}
+	if (weightSum > 0.0) {
+		centroid /= weightSum;
+	}
+
+	/*
+	 * Linearized error for a small rotation w and a translation t:
+	 * ((p + w x p + t - q) . n)^2 = ((p x n) . w + n . t - (q - p) . n)^2
+	 * Each term is scaled by the weight of its correspondence.
+	 */
+	Eigen::Matrix<double, 6, 6> normalMatrix = Eigen::Matrix<double, 6, 6>::Zero();
+	Eigen::Matrix<double, 6, 1> rightHandSide = Eigen::Matrix<double, 6, 1>::Zero();
+	Eigen::Matrix<double, 6, 1> row;
+	double squaredError = 0.0;
+	double errorWeightSum = 0.0;
+	unsigned int numberOfPairs = 0;
+	for (unsigned int i = 0; i < indexPairs->size(); ++i) {
+		unsigned int first = (*indexPairs)[i].firstIndex;
+		unsigned int second = (*indexPairs)[i].secondIndex;
+		Eigen::Vector3d normal(normals[3 * first], normals[3 * first + 1], normals[3 * first + 2]);
+		if (!(normal.squaredNorm() > 0.0)) { // also rejects NaN normals of degenerated neighborhoods
+			continue;
+		}
+		Eigen::Vector3d modelPoint(modelX[first], modelY[first], modelZ[first]);
+		Eigen::Vector3d dataPoint = Eigen::Vector3d(dataX[second], dataY[second], dataZ[second]) - centroid;
+		double distance = (modelPoint - centroid - dataPoint).dot(normal);
+		double weight = (weights == 0) ? 1.0 : (*weights)[i];
+
+		row.head<3>() = dataPoint.cross(normal);
+		row.tail<3>() = normal;
+		normalMatrix.selfadjointView<Eigen::Lower>().rankUpdate(row, weight);
+		rightHandSide += row * (weight * distance);
+		squaredError += weight * distance * distance;
+		errorWeightSum += weight;
+		numberOfPairs++;
+	}
+
+	if (numberOfPairs < 6 || !(errorWeightSum > 0.0)) {
+		LOG(WARNING) << "Not enough correspondences with normals for a point-to-plane estimation. Falling back to point-to-point.";
+		return estimatePointToPoint(model, data, indexPairs, weights, resultTransformation);
+	}
+
+	Eigen::Matrix<double, 6, 1> solution = normalMatrix.selfadjointView<Eigen::Lower>().ldlt().solve(rightHandSide);
+	if (!solution.allFinite()) {
+		LOG(WARNING) << "Point-to-plane estimation is degenerated. Falling back to point-to-point.";
+		return estimatePointToPoint(model, data, indexPairs, weights, resultTransformation);
+	}
+
+	/* x' = R (x - c) + c + t */
+	Eigen::Vector3d rotationVector = solution.head<3>();
+	Eigen::Matrix3d rotation = Eigen::Matrix3d::Identity();
+	double angle = rotationVector.norm();
+	if (angle > 0.0) {
+		rotation = Eigen::AngleAxisd(angle, rotationVector / angle).toRotationMatrix();
+	}
+	Eigen::Vector3d translation = centroid + solution.tail<3>() - rotation * centroid;
+	setTransformation(rotation, translation, resultTransformation);
+
+	return std::sqrt(squaredError / errorWeightSum);
+}
+
+double RigidTransformationEstimationPointToPlane::estimatePointToPoint(PointCloud3D* model, PointCloud3D* data,
+		std::vector<CorrespondenceIndexPair>* indexPairs, const std::vector<double>* weights, IHomogeneousMatrix44* resultTransformation) {
+	if (weights == 0) {
+		return IRigidTransformationEstimation::estimateTransformation(model, data, indexPairs, resultTransformation);
+	}
+	RigidTransformationEstimationSVD pointToPointEstimator;
+	return pointToPointEstimator.estimateTransformation(model, data, indexPairs, weights, resultTransformation);
+}
+
+int RigidTransformationEstimationPointToPlane::getNumberOfNormalNeighbors() const {
+	return modelNormals.getNumberOfNeighbors();
+}
+
+void RigidTransformationEstimationPointToPlane::setNumberOfNormalNeighbors(int numberOfNormalNeighbors) {
+	if (numberOfNormalNeighbors < 3) {
+		throw std::runtime_error("ERROR: numberOfNormalNeighbors for the point-to-plane estimation cannot be less than 3.");
+	}
+	modelNormals.setNumberOfNeighbors(numberOfNormalNeighbors);
+}
+
+}
+
+/* EOF */
@@ -0,0 +1,89 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#ifndef BRICS_3D_RIGIDTRANSFORMATIONESTIMATIONPOINTTOPLANE_H_
+#define BRICS_3D_RIGIDTRANSFORMATIONESTIMATIONPOINTTOPLANE_H_
+
+#include "IRigidTransformationEstimation.h"
+#include "NormalCache.h"
+
+namespace brics_3d {
+
+/**
+ * @ingroup registration
+ * @brief Implementation of rigid transformation estimation that minimizes the point-to-plane error.
+ *
+ * Instead of the distance between corresponding points the distance of a data point to the tangent plane of its
+ * model point is minimized. Points may then slide along planar surfaces, so ICP usually converges in far fewer
+ * iterations on structured scenes like rooms or buildings. The error function is linearized for small rotations
+ * and solved as a 6x6 linear system.
+ *
+ * The normals of the model are provided by a NormalCache, i.e. they are taken from its PointCloud3D::normalChannel
+ * or estimated once per model (see setNumberOfNormalNeighbors()).
+ *
+ * Only the variants with index correspondences have access to the normals. The point pair variant falls back to
+ * the point-to-point error. Weighted correspondences fall back to the weighted RigidTransformationEstimationSVD.
+ */
+class RigidTransformationEstimationPointToPlane: public brics_3d::IRigidTransformationEstimation {
+public:
+
+	/**
+	 * Standard constructor
+	 */
+	RigidTransformationEstimationPointToPlane();
+
+	/**
+	 * Standard destructor
+	 */
+	virtual ~RigidTransformationEstimationPointToPlane();
+
+	double estimateTransformation(std::vector<CorrespondencePoint3DPair>* pointPairs, IHomogeneousMatrix44* resultTransformation);
+
+	double estimateTransformation(PointCloud3D* model, PointCloud3D* data, std::vector<CorrespondenceIndexPair>* indexPairs,
+			IHomogeneousMatrix44* resultTransformation);
+
+	double estimateTransformation(PointCloud3D* model, PointCloud3D* data, std::vector<CorrespondenceIndexPair>* indexPairs,
+			const std::vector<double>* weights, IHomogeneousMatrix44* resultTransformation);
+
+	/**
+	 * @brief Get the number of neighbors that define the plane of a model point, if the normals have to be estimated.
+	 */
+	int getNumberOfNormalNeighbors() const;
+
+	/**
+	 * @brief Set the number of neighbors that define the plane of a model point, if the normals have to be estimated.
+	 * @param numberOfNormalNeighbors At least 3. Default is 10.
+	 */
+	void setNumberOfNormalNeighbors(int numberOfNormalNeighbors);
+
+private:
+
+	/// Fall back to the point-to-point error, weighted if weights are given.
+	double estimatePointToPoint(PointCloud3D* model, PointCloud3D* data, std::vector<CorrespondenceIndexPair>* indexPairs,
+			const std::vector<double>* weights, IHomogeneousMatrix44* resultTransformation);
+
+	/// Normals of the model
+	NormalCache modelNormals;
+};
+
+}
+
+#endif /* BRICS_3D_RIGIDTRANSFORMATIONESTIMATIONPOINTTOPLANE_H_ */
+
+/* EOF */
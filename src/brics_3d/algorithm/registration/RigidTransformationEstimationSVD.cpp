@@ -18,7 +18,12 @@
 ******************************************************************************/
 
 #include "RigidTransformationEstimationSVD.h"
+#include "brics_3d/core/HomogeneousMatrix44.h"
 #include <iostream>
+#include <cmath>
+#include <assert.h>
+
+#include <Eigen/Dense>
 
 #define OPENMP_NUM_THREADS 4 //only to make code compilable
 #include "6dslam/src/icp6Dsvd.h"
@@ -102,6 +107,74 @@ double RigidTransformationEstimationSVD::estimateTransformation(std::vector<Corr
 	return resultError;
 }
 
+double RigidTransformationEstimationSVD::estimateTransformation(PointCloud3D* model, PointCloud3D* data,
+		std::vector<CorrespondenceIndexPair>* indexPairs, const std::vector<double>* weights, IHomogeneousMatrix44* resultTransformation) {
+	if (weights == 0) {
+		return IRigidTransformationEstimation::estimateTransformation(model, data, indexPairs, resultTransformation);
+	}
+	assert(weights->size() == indexPairs->size());
+
+	const PointCloud3DStorage* modelStorage = model->getStorage();
+	const PointCloud3DStorage* dataStorage = data->getStorage();
+
+	/* weighted centroids */
+	Eigen::Vector3d modelCentroid = Eigen::Vector3d::Zero();
+	Eigen::Vector3d dataCentroid = Eigen::Vector3d::Zero();
+	double weightSum = 0.0;
+	double squaredError = 0.0;
+	for (unsigned int i = 0; i < indexPairs->size(); ++i) {
+		unsigned int first = (*indexPairs)[i].firstIndex;
+		unsigned int second = (*indexPairs)[i].secondIndex;
+		Eigen::Vector3d modelPoint(modelStorage->getRawX()[first], modelStorage->getRawY()[first], modelStorage->getRawZ()[first]);
+		Eigen::Vector3d dataPoint(dataStorage->getRawX()[second], dataStorage->getRawY()[second], dataStorage->getRawZ()[second]);
+		double weight = (*weights)[i];
+		modelCentroid += weight * modelPoint;
+		dataCentroid += weight * dataPoint;
+		weightSum += weight;
+		squaredError += weight * (modelPoint - dataPoint).squaredNorm();
+	}
+
+	double* resultRawData = resultTransformation->setRawData();
+	if (!(weightSum > 0.0) || indexPairs->size() < 3) { // nothing to align: identity
+		HomogeneousMatrix44 identity;
+		for (int i = 0; i < 16; ++i) {
+			resultRawData[i] = identity.getRawData()[i];
+		}
+		return -1.0;
+	}
+	modelCentroid /= weightSum;
+	dataCentroid /= weightSum;
+
+	/* weighted cross-covariance of the centered points */
+	Eigen::Matrix3d covariance = Eigen::Matrix3d::Zero();
+	for (unsigned int i = 0; i < indexPairs->size(); ++i) {
+		unsigned int first = (*indexPairs)[i].firstIndex;
+		unsigned int second = (*indexPairs)[i].secondIndex;
+		Eigen::Vector3d modelPoint(modelStorage->getRawX()[first], modelStorage->getRawY()[first], modelStorage->getRawZ()[first]);
+		Eigen::Vector3d dataPoint(dataStorage->getRawX()[second], dataStorage->getRawY()[second], dataStorage->getRawZ()[second]);
+		covariance += (*weights)[i] * (dataPoint - dataCentroid) * (modelPoint - modelCentroid).transpose();
+	}
+
+	/* R = V diag(1, 1, det(V U^T)) U^T avoids reflections */
+	Eigen::JacobiSVD<Eigen::Matrix3d> svd(covariance, Eigen::ComputeFullU | Eigen::ComputeFullV);
+	Eigen::Matrix3d correction = Eigen::Matrix3d::Identity();
+	if ((svd.matrixV() * svd.matrixU().transpose()).determinant() < 0.0) {
+		correction(2,2) = -1.0;
+	}
+	Eigen::Matrix3d rotation = svd.matrixV() * correction * svd.matrixU().transpose();
+	Eigen::Vector3d translation = modelCentroid - rotation * dataCentroid;
+
+	HomogeneousMatrix44 transformation(rotation(0,0), rotation(0,1), rotation(0,2),
+			rotation(1,0), rotation(1,1), rotation(1,2),
+			rotation(2,0), rotation(2,1), rotation(2,2),
+			translation[0], translation[1], translation[2]);
+	for (int i = 0; i < 16; ++i) {
+		resultRawData[i] = transformation.getRawData()[i];
+	}
+
+	return std::sqrt(squaredError / weightSum);
+}
+
 }
 
 /* EOF */
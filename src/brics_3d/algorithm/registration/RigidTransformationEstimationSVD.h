@@ -29,6 +29,7 @@ namespace brics_3d {
  * @brief Implementation of rigid transformation estimation between two corresponding point clouds.
  *
  * This implementation bases on a singular value decomposition (SVD) for the ICP error function.
+ * Weighted correspondences are supported as well: then the weighted centroids and cross-covariance are decomposed.
  */
 class RigidTransformationEstimationSVD: public brics_3d::IRigidTransformationEstimation {
 public:
@@ -43,8 +44,13 @@ public:
 	 */
 	virtual ~RigidTransformationEstimationSVD();
 
+	using IRigidTransformationEstimation::estimateTransformation;
+
 	double estimateTransformation(std::vector<CorrespondencePoint3DPair>* pointPairs, IHomogeneousMatrix44* resultTransformation);
 
+	double estimateTransformation(PointCloud3D* model, PointCloud3D* data, std::vector<CorrespondenceIndexPair>* indexPairs,
+			const std::vector<double>* weights, IHomogeneousMatrix44* resultTransformation);
+
 };
 
 }
@@ -34,14 +34,15 @@ EuclideanClustering::~EuclideanClustering() {
 void EuclideanClustering::extractClusters(brics_3d::PointCloud3D *inCloud){
 
 
-	int k = inCloud->getSize();
 	brics_3d::NearestNeighborANN nearestneighborSearch;
 	brics_3d::Point3D querryPoint3D;
 	vector<int> neighborIndices;
 
 	nearestneighborSearch.setData(inCloud);
-	nearestneighborSearch.setMaxDistance(this->clusterTolerance);
-	//	nearestneighborSearch.setMaxDistance(1000);
+	const PointCloud3DStorage* storage = inCloud->getStorage();
+	const Coordinate* x = storage->getRawX();
+	const Coordinate* y = storage->getRawY();
+	const Coordinate* z = storage->getRawZ();
 	// Create a bool vector of processed point indices, and initialize it to false
 	std::vector<bool> processed (inCloud->getSize(), false);
 
@@ -61,10 +62,12 @@ void EuclideanClustering::extractClusters(brics_3d::PointCloud3D *inCloud){
 		while (sq_idx < (int)seed_queue.size ())
 		{
 
-			// Search for sq_idx
-			neighborIndices.clear();
-			querryPoint3D = (*inCloud->getPointCloud())[sq_idx];
-			nearestneighborSearch.findNearestNeighbors(&querryPoint3D, &neighborIndices, k);
+			// Search for seed_queue[sq_idx]
+			int seedIndex = seed_queue[sq_idx];
+			querryPoint3D.setX(x[seedIndex]);
+			querryPoint3D.setY(y[seedIndex]);
+			querryPoint3D.setZ(z[seedIndex]);
+			nearestneighborSearch.findNeighborsWithinRadius(&querryPoint3D, &neighborIndices, this->clusterTolerance);
 
 			//if (!tree->radiusSearch (seed_queue[sq_idx], tolerance, nn_indices, nn_distances))
 			if(neighborIndices.size()==0)
@@ -93,12 +96,7 @@ void EuclideanClustering::extractClusters(brics_3d::PointCloud3D *inCloud){
 
 			seed_queue.erase(std::unique(seed_queue.begin(), seed_queue.end()),seed_queue.end());
 			brics_3d::PointCloud3D *tempPointCloud =  new brics_3d::PointCloud3D();
-
-			for (size_t j = 0; j < seed_queue.size (); ++j) {
-
-				tempPointCloud->addPointPtr((*inCloud->getPointCloud())[seed_queue[j]].clone());
-
-			}
+			tempPointCloud->addPoints(inCloud, seed_queue); // copies the coordinates and attributes at once
 			extractedClusters.push_back(tempPointCloud);
 //			delete tempPointCloud; //?
 		}
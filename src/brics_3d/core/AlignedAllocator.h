@@ -0,0 +1,128 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#ifndef BRICS_3D_ALIGNEDALLOCATOR_H_
+#define BRICS_3D_ALIGNEDALLOCATOR_H_
+
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <stdlib.h>
+#ifdef WIN32
+#include <malloc.h>
+#endif
+
+namespace brics_3d {
+
+/// Alignment in bytes of the coordinate arrays. Sufficient for SSE and AVX loads.
+const std::size_t coordinateAlignment = 32;
+
+/**
+ * @brief Standard allocator that returns memory aligned to a multiple of Alignment bytes.
+ *
+ * Used for the coordinate arrays of PointCloud3DStorageT, so vectorized kernels can use aligned loads and stores.
+ * Alignment has to be a power of two and a multiple of sizeof(void*).
+ */
+template <typename T, std::size_t Alignment = coordinateAlignment>
+class AlignedAllocator {
+public:
+
+	typedef T value_type;
+	typedef T* pointer;
+	typedef const T* const_pointer;
+	typedef T& reference;
+	typedef const T& const_reference;
+	typedef std::size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+
+	template <typename U>
+	struct rebind {
+		typedef AlignedAllocator<U, Alignment> other;
+	};
+
+	AlignedAllocator() {}
+
+	template <typename U>
+	AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+	pointer address(reference value) const {
+		return &value;
+	}
+
+	const_pointer address(const_reference value) const {
+		return &value;
+	}
+
+	pointer allocate(size_type count, const void* = 0) {
+		if (count == 0) {
+			return 0;
+		}
+		if (count > max_size()) {
+			throw std::bad_alloc();
+		}
+		void* memory = 0;
+#ifdef WIN32
+		memory = _aligned_malloc(count * sizeof(T), Alignment);
+#else
+		if (posix_memalign(&memory, Alignment, count * sizeof(T)) != 0) {
+			memory = 0;
+		}
+#endif
+		if (memory == 0) {
+			throw std::bad_alloc();
+		}
+		return static_cast<pointer>(memory);
+	}
+
+	void deallocate(pointer memory, size_type) {
+#ifdef WIN32
+		_aligned_free(memory);
+#else
+		free(memory);
+#endif
+	}
+
+	size_type max_size() const {
+		return std::numeric_limits<size_type>::max() / sizeof(T);
+	}
+
+	void construct(pointer memory, const T& value) {
+		new (memory) T(value);
+	}
+
+	void destroy(pointer memory) {
+		memory->~T();
+	}
+};
+
+template <typename T, typename U, std::size_t Alignment>
+inline bool operator==(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&) {
+	return true;
+}
+
+template <typename T, typename U, std::size_t Alignment>
+inline bool operator!=(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&) {
+	return false;
+}
+
+}
+
+#endif /* BRICS_3D_ALIGNEDALLOCATOR_H_ */
+
+/* EOF */
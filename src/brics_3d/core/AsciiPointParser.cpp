@@ -0,0 +1,307 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#include "AsciiPointParser.h"
+#include "ParallelRange.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <locale.h>
+#ifdef __APPLE__
+#include <xlocale.h>
+#endif
+#include <stdexcept>
+#include <algorithm>
+#include <boost/cstdint.hpp>
+
+namespace brics_3d {
+
+namespace {
+
+/// Exact powers of ten as double.
+const double powersOfTen[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/// Largest integer that is exactly representable as double (2^53).
+const boost::uint64_t maxExactMantissa = 9007199254740992ULL;
+
+inline bool isBlank(char c) {
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline bool isDigit(char c) {
+	return c >= '0' && c <= '9';
+}
+
+/// strtod with the "C" locale, independent of the LC_NUMERIC setting of the application
+inline double strtodClassic(const char* text, char** end) {
+#ifdef WIN32
+	static _locale_t classicLocale = _create_locale(LC_NUMERIC, "C");
+	return _strtod_l(text, end, classicLocale);
+#else
+	static locale_t classicLocale = newlocale(LC_NUMERIC_MASK, "C", static_cast<locale_t>(0));
+	return strtod_l(text, end, classicLocale);
+#endif
+}
+
+/// The points of one chunk.
+template <typename T>
+struct ChunkResult {
+	std::vector<T> x;
+	std::vector<T> y;
+	std::vector<T> z;
+	bool failed;
+};
+
+template <typename T>
+void parseChunk(const char* begin, const char* end, ChunkResult<T>* result) {
+	const char* cursor = begin;
+	double x;
+	double y;
+	double z;
+
+	result->failed = false;
+	unsigned long estimatedPoints = (end - begin) / 24;
+	result->x.reserve(estimatedPoints);
+	result->y.reserve(estimatedPoints);
+	result->z.reserve(estimatedPoints);
+
+	while (cursor < end) {
+		while (cursor < end && isBlank(*cursor)) {
+			++cursor;
+		}
+		if (cursor == end) {
+			break;
+		}
+		if (*cursor == '\n') { // empty line
+			++cursor;
+			continue;
+		}
+
+		if (!AsciiPointParser::parseNumber(cursor, end, x) ||
+				!AsciiPointParser::parseNumber(cursor, end, y) ||
+				!AsciiPointParser::parseNumber(cursor, end, z)) {
+			result->failed = true;
+			return;
+		}
+		result->x.push_back(static_cast<T>(x));
+		result->y.push_back(static_cast<T>(y));
+		result->z.push_back(static_cast<T>(z));
+
+		/* ignore the rest of the line */
+		const char* lineEnd = static_cast<const char*>(memchr(cursor, '\n', end - cursor));
+		cursor = (lineEnd != 0) ? lineEnd + 1 : end;
+	}
+}
+
+/// Parse the chunk [begin, end) of the text into its own result.
+template <typename T>
+void parseChunkRange(const char* data, std::vector<ChunkResult<T> >* results, unsigned int chunk, unsigned long begin, unsigned long end) {
+	parseChunk<T>(data + begin, data + end, &(*results)[chunk]);
+}
+
+template <typename T>
+void parseText(const char* data, unsigned long size, PointCloud3DStorageT<T>* storage, unsigned int numberOfThreads, unsigned long minimalChunkSize) {
+	if (size == 0) {
+		return;
+	}
+
+	/* split at line endings */
+	std::vector<unsigned long> chunkBoundaries;
+	splitRange(0ul, size, numberOfThreads, minimalChunkSize, &chunkBoundaries);
+	unsigned long numberOfChunks = 1;
+	for (; numberOfChunks + 1 < chunkBoundaries.size(); ++numberOfChunks) {
+		unsigned long cursor = std::max(chunkBoundaries[numberOfChunks], chunkBoundaries[numberOfChunks - 1]);
+		const char* lineEnd = static_cast<const char*>(memchr(data + cursor, '\n', size - cursor));
+		if (lineEnd == 0) {
+			break;
+		}
+		chunkBoundaries[numberOfChunks] = (lineEnd + 1) - data;
+	}
+	chunkBoundaries.resize(numberOfChunks + 1);
+	chunkBoundaries.back() = size;
+
+	std::vector<ChunkResult<T> > results(numberOfChunks);
+	forEachRange(boost::bind(&parseChunkRange<T>, data, &results, _1, _2, _3), chunkBoundaries);
+
+	/* concatenate in order */
+	unsigned int numberOfPoints = 0;
+	for (unsigned long i = 0; i < numberOfChunks; ++i) {
+		if (results[i].failed) {
+			throw std::runtime_error("ERROR: cannot read point.");
+		}
+		numberOfPoints += static_cast<unsigned int>(results[i].x.size());
+	}
+
+	unsigned int offset = storage->getSize();
+	storage->resize(offset + numberOfPoints);
+	for (unsigned long i = 0; i < numberOfChunks; ++i) {
+		if (results[i].x.empty()) {
+			continue;
+		}
+		std::copy(results[i].x.begin(), results[i].x.end(), storage->getRawX() + offset);
+		std::copy(results[i].y.begin(), results[i].y.end(), storage->getRawY() + offset);
+		std::copy(results[i].z.begin(), results[i].z.end(), storage->getRawZ() + offset);
+		offset += static_cast<unsigned int>(results[i].x.size());
+	}
+}
+
+}
+
+AsciiPointParser::AsciiPointParser() {
+	numberOfThreads = 0;
+	minimalChunkSize = 1024 * 1024;
+}
+
+AsciiPointParser::~AsciiPointParser() {
+
+}
+
+void AsciiPointParser::parse(const char* data, unsigned long size, PointCloud3DStorage* storage) {
+	parseText<Coordinate>(data, size, storage, numberOfThreads, minimalChunkSize);
+}
+
+#ifndef BRICS_3D_USE_FLOAT_COORDINATES
+void AsciiPointParser::parse(const char* data, unsigned long size, PointCloud3DStorageF* storage) {
+	parseText<float>(data, size, storage, numberOfThreads, minimalChunkSize);
+}
+#endif
+
+bool AsciiPointParser::parseNumber(const char*& cursor, const char* end, double& value) {
+	const char* position = cursor;
+	while (position < end && isBlank(*position)) {
+		++position;
+	}
+	const char* tokenBegin = position;
+
+	bool isNegative = false;
+	if (position < end && (*position == '-' || *position == '+')) {
+		isNegative = (*position == '-');
+		++position;
+	}
+
+	boost::uint64_t mantissa = 0;
+	int significantDigits = 0;
+	int exponent = 0;
+	bool hasDigits = false;
+	bool isExact = true;
+
+	while (position < end && isDigit(*position)) {
+		hasDigits = true;
+		if (significantDigits < 19) {
+			mantissa = mantissa * 10 + (*position - '0');
+			if (mantissa != 0) {
+				++significantDigits;
+			}
+		} else {
+			++exponent; // dropped digit
+			isExact = isExact && (*position == '0');
+		}
+		++position;
+	}
+	if (position < end && *position == '.') {
+		++position;
+		while (position < end && isDigit(*position)) {
+			hasDigits = true;
+			if (significantDigits < 19) {
+				mantissa = mantissa * 10 + (*position - '0');
+				if (mantissa != 0) {
+					++significantDigits;
+				}
+				--exponent;
+			} else {
+				isExact = isExact && (*position == '0');
+			}
+			++position;
+		}
+	}
+	if (hasDigits && position < end && (*position == 'e' || *position == 'E')) {
+		const char* exponentPosition = position + 1;
+		bool isNegativeExponent = false;
+		if (exponentPosition < end && (*exponentPosition == '-' || *exponentPosition == '+')) {
+			isNegativeExponent = (*exponentPosition == '-');
+			++exponentPosition;
+		}
+		if (exponentPosition < end && isDigit(*exponentPosition)) {
+			int explicitExponent = 0;
+			while (exponentPosition < end && isDigit(*exponentPosition)) {
+				if (explicitExponent < 100000) {
+					explicitExponent = explicitExponent * 10 + (*exponentPosition - '0');
+				}
+				++exponentPosition;
+			}
+			exponent += isNegativeExponent ? -explicitExponent : explicitExponent;
+			position = exponentPosition;
+		} else {
+			isExact = false; // malformed exponent, let strtod decide
+		}
+	}
+
+	bool isDelimited = (position == end) || isBlank(*position) || (*position == '\n');
+	if (hasDigits && isDelimited && isExact && mantissa <= maxExactMantissa && exponent >= -22 && exponent <= 22) {
+		/* both operands are exact, so a single operation yields the correctly rounded result */
+		double result = static_cast<double>(mantissa);
+		result = (exponent < 0) ? result / powersOfTen[-exponent] : result * powersOfTen[exponent];
+		value = isNegative ? -result : result;
+		cursor = position;
+		return true;
+	}
+
+	/* fall back to strtod for all other cases */
+	char buffer[64];
+	unsigned int length = 0;
+	const char* tokenEnd = tokenBegin;
+	while (tokenEnd < end && !isBlank(*tokenEnd) && *tokenEnd != '\n' && length < sizeof(buffer) - 1) {
+		buffer[length++] = *tokenEnd++;
+	}
+	if (length == 0) {
+		return false;
+	}
+	buffer[length] = '\0';
+	char* parsedEnd = 0;
+	double result = strtodClassic(buffer, &parsedEnd);
+	if (parsedEnd != buffer + length) {
+		return false;
+	}
+	value = result;
+	cursor = tokenEnd;
+	return true;
+}
+
+unsigned int AsciiPointParser::getNumberOfThreads() const {
+	return numberOfThreads;
+}
+
+void AsciiPointParser::setNumberOfThreads(unsigned int numberOfThreads) {
+	this->numberOfThreads = numberOfThreads;
+}
+
+unsigned long AsciiPointParser::getMinimalChunkSize() const {
+	return minimalChunkSize;
+}
+
+void AsciiPointParser::setMinimalChunkSize(unsigned long minimalChunkSize) {
+	this->minimalChunkSize = minimalChunkSize;
+}
+
+}
+
+/* EOF */
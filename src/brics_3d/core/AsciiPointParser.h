@@ -0,0 +1,101 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#ifndef BRICS_3D_ASCIIPOINTPARSER_H_
+#define BRICS_3D_ASCIIPOINTPARSER_H_
+
+#include "PointCloud3DStorage.h"
+
+namespace brics_3d {
+
+/**
+ * @brief Fast parser for plain text point data with one "x y z" triple per line.
+ *
+ * The text is split into newline aligned chunks that are parsed concurrently. Each chunk is
+ * converted with a non-allocating number parser. The results are appended to the storage in the
+ * order of the text. Further values on a line are ignored, empty lines are skipped.
+ * A line with less than three numbers raises a std::runtime_error.
+ */
+class AsciiPointParser {
+public:
+
+	/**
+	 * @brief Standard constructor
+	 */
+	AsciiPointParser();
+
+	/**
+	 * @brief Standard destructor
+	 */
+	virtual ~AsciiPointParser();
+
+	/**
+	 * @brief Parse a text buffer and append the points to a storage.
+	 * @param data Begin of the text. It does not need to be null terminated.
+	 * @param size Length of the text in bytes.
+	 * @param[out] storage The storage where the points will be appended.
+	 */
+	void parse(const char* data, unsigned long size, PointCloud3DStorage* storage);
+
+#ifndef BRICS_3D_USE_FLOAT_COORDINATES // otherwise PointCloud3DStorage is already the single precision storage
+	/**
+	 * @brief Parse a text buffer and append the points to a single precision storage.
+	 */
+	void parse(const char* data, unsigned long size, PointCloud3DStorageF* storage);
+#endif
+
+	/**
+	 * @brief Parse a single number.
+	 *
+	 * Leading blanks (but no newlines) are skipped. Common decimal numbers are converted without
+	 * any memory allocation or locale dependency; everything else (e.g. more than 19 significant digits or "nan")
+	 * falls back to strtod with the "C" locale on a stack copy of the token, so a comma as decimal separator of the
+	 * application's locale has no effect.
+	 * @param[in,out] cursor Current read position. It will be moved behind the number on success.
+	 * @param end End of the text.
+	 * @param[out] value The parsed number.
+	 * @return True on success, false if there is no number at the current position.
+	 */
+	static bool parseNumber(const char*& cursor, const char* end, double& value);
+
+	/// Number of threads. 0 means that the number of available cores is used. Default is 0.
+	unsigned int getNumberOfThreads() const;
+
+	void setNumberOfThreads(unsigned int numberOfThreads);
+
+	/// Minimal number of bytes per chunk. Small texts are parsed by the calling thread only. Default is 1MB.
+	unsigned long getMinimalChunkSize() const;
+
+	void setMinimalChunkSize(unsigned long minimalChunkSize);
+
+private:
+
+	/// Number of threads. 0 means that the number of available cores is used.
+	unsigned int numberOfThreads;
+
+	/// Minimal number of bytes per chunk.
+	unsigned long minimalChunkSize;
+
+};
+
+}
+
+#endif /* BRICS_3D_ASCIIPOINTPARSER_H_ */
+
+/* EOF */
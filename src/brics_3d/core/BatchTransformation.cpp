@@ -0,0 +1,282 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#include "BatchTransformation.h"
+#include "ParallelRange.h"
+
+#include <cstddef>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace brics_3d {
+
+namespace {
+
+/// Coordinate arrays of a range of points.
+template <typename T>
+struct TransformationRange {
+	const T* matrix;
+	const T* inputX;
+	const T* inputY;
+	const T* inputZ;
+	T* outputX;
+	T* outputY;
+	T* outputZ;
+};
+
+/*
+ * layout:
+ * 0 4 8  12
+ * 1 5 9  13
+ * 2 6 10 14
+ * 3 7 11 15
+ */
+template <typename T>
+inline void transformScalar(const TransformationRange<T>& range, unsigned int begin, unsigned int end) {
+	const T* m = range.matrix;
+	for (unsigned int i = begin; i < end; ++i) {
+		T x = range.inputX[i];
+		T y = range.inputY[i];
+		T z = range.inputZ[i];
+		range.outputX[i] = x * m[0] + y * m[4] + z * m[8] + m[12];
+		range.outputY[i] = x * m[1] + y * m[5] + z * m[9] + m[13];
+		range.outputZ[i] = x * m[2] + y * m[6] + z * m[10] + m[14];
+	}
+}
+
+template <typename T>
+void transformRange(TransformationRange<T> range, unsigned int /*part*/, unsigned int begin, unsigned int end) {
+	transformScalar(range, begin, end);
+}
+
+#ifdef __SSE2__
+
+/// Packed loads and stores. The aligned variant requires 16 byte aligned addresses.
+template <bool isAligned>
+struct Packed {
+	static inline __m128d load(const double* address) { return _mm_loadu_pd(address); }
+	static inline __m128 load(const float* address) { return _mm_loadu_ps(address); }
+	static inline void store(double* address, __m128d value) { _mm_storeu_pd(address, value); }
+	static inline void store(float* address, __m128 value) { _mm_storeu_ps(address, value); }
+};
+
+template <>
+struct Packed<true> {
+	static inline __m128d load(const double* address) { return _mm_load_pd(address); }
+	static inline __m128 load(const float* address) { return _mm_load_ps(address); }
+	static inline void store(double* address, __m128d value) { _mm_store_pd(address, value); }
+	static inline void store(float* address, __m128 value) { _mm_store_ps(address, value); }
+};
+
+/// Check if the element begin of all arrays is 16 byte aligned, as it is for storages (see AlignedAllocator) and ranges of whole vectors.
+template <typename T>
+inline bool isAlignedRange(const TransformationRange<T>& range, unsigned int begin) {
+	const T* arrays[] = {range.inputX, range.inputY, range.inputZ, range.outputX, range.outputY, range.outputZ};
+	for (int i = 0; i < 6; ++i) {
+		if ((reinterpret_cast<std::size_t>(arrays[i] + begin) & 15) != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/*
+ * All values of one vector are loaded before the results are stored, so in place transformation is safe.
+ * The operations are evaluated in the same order as in transformScalar() to get identical results.
+ */
+
+template <bool isAligned>
+void transformPacked(const TransformationRange<double>& range, unsigned int begin, unsigned int end) {
+	const double* m = range.matrix;
+	__m128d m0 = _mm_set1_pd(m[0]), m1 = _mm_set1_pd(m[1]), m2 = _mm_set1_pd(m[2]);
+	__m128d m4 = _mm_set1_pd(m[4]), m5 = _mm_set1_pd(m[5]), m6 = _mm_set1_pd(m[6]);
+	__m128d m8 = _mm_set1_pd(m[8]), m9 = _mm_set1_pd(m[9]), m10 = _mm_set1_pd(m[10]);
+	__m128d m12 = _mm_set1_pd(m[12]), m13 = _mm_set1_pd(m[13]), m14 = _mm_set1_pd(m[14]);
+
+	unsigned int i = begin;
+	for (; i + 2 <= end; i += 2) {
+		__m128d x = Packed<isAligned>::load(range.inputX + i);
+		__m128d y = Packed<isAligned>::load(range.inputY + i);
+		__m128d z = Packed<isAligned>::load(range.inputZ + i);
+		__m128d resultX = _mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(x, m0), _mm_mul_pd(y, m4)), _mm_mul_pd(z, m8)), m12);
+		__m128d resultY = _mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(x, m1), _mm_mul_pd(y, m5)), _mm_mul_pd(z, m9)), m13);
+		__m128d resultZ = _mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(x, m2), _mm_mul_pd(y, m6)), _mm_mul_pd(z, m10)), m14);
+		Packed<isAligned>::store(range.outputX + i, resultX);
+		Packed<isAligned>::store(range.outputY + i, resultY);
+		Packed<isAligned>::store(range.outputZ + i, resultZ);
+	}
+	transformScalar(range, i, end);
+}
+
+template <bool isAligned>
+void transformPacked(const TransformationRange<float>& range, unsigned int begin, unsigned int end) {
+	const float* m = range.matrix;
+	__m128 m0 = _mm_set1_ps(m[0]), m1 = _mm_set1_ps(m[1]), m2 = _mm_set1_ps(m[2]);
+	__m128 m4 = _mm_set1_ps(m[4]), m5 = _mm_set1_ps(m[5]), m6 = _mm_set1_ps(m[6]);
+	__m128 m8 = _mm_set1_ps(m[8]), m9 = _mm_set1_ps(m[9]), m10 = _mm_set1_ps(m[10]);
+	__m128 m12 = _mm_set1_ps(m[12]), m13 = _mm_set1_ps(m[13]), m14 = _mm_set1_ps(m[14]);
+
+	unsigned int i = begin;
+	for (; i + 4 <= end; i += 4) {
+		__m128 x = Packed<isAligned>::load(range.inputX + i);
+		__m128 y = Packed<isAligned>::load(range.inputY + i);
+		__m128 z = Packed<isAligned>::load(range.inputZ + i);
+		__m128 resultX = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m0), _mm_mul_ps(y, m4)), _mm_mul_ps(z, m8)), m12);
+		__m128 resultY = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m1), _mm_mul_ps(y, m5)), _mm_mul_ps(z, m9)), m13);
+		__m128 resultZ = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m2), _mm_mul_ps(y, m6)), _mm_mul_ps(z, m10)), m14);
+		Packed<isAligned>::store(range.outputX + i, resultX);
+		Packed<isAligned>::store(range.outputY + i, resultY);
+		Packed<isAligned>::store(range.outputZ + i, resultZ);
+	}
+	transformScalar(range, i, end);
+}
+
+template <>
+void transformRange<double>(TransformationRange<double> range, unsigned int /*part*/, unsigned int begin, unsigned int end) {
+	if (isAlignedRange(range, begin)) {
+		transformPacked<true>(range, begin, end);
+	} else {
+		transformPacked<false>(range, begin, end);
+	}
+}
+
+template <>
+void transformRange<float>(TransformationRange<float> range, unsigned int /*part*/, unsigned int begin, unsigned int end) {
+	if (isAlignedRange(range, begin)) {
+		transformPacked<true>(range, begin, end);
+	} else {
+		transformPacked<false>(range, begin, end);
+	}
+}
+
+#endif
+
+template <typename T>
+void transformArrays(IHomogeneousMatrix44* transformation, TransformationRange<T> range, unsigned int size,
+		unsigned int numberOfThreads, unsigned int minimalPointsPerThread) {
+
+	if (size == 0) {
+		return;
+	}
+
+	const double* homogenousMatrix = transformation->getRawData();
+	T matrix[16];
+	for (int i = 0; i < 16; ++i) {
+		matrix[i] = static_cast<T>(homogenousMatrix[i]);
+	}
+	range.matrix = matrix;
+
+	const unsigned int vectorSize = 4; // keep the ranges aligned to whole vectors
+	forEachRange(boost::bind(&transformRange<T>, range, _1, _2, _3), 0u, size, numberOfThreads, minimalPointsPerThread, vectorSize);
+}
+
+template <typename T>
+void transformStorage(IHomogeneousMatrix44* transformation, const PointCloud3DStorageT<T>* input, PointCloud3DStorageT<T>* output,
+		unsigned int numberOfThreads, unsigned int minimalPointsPerThread) {
+
+	unsigned int size = input->getSize();
+	if (output != input) {
+		output->resize(size);
+	}
+	if (size == 0) {
+		return;
+	}
+
+	TransformationRange<T> range;
+	range.outputX = output->getRawX(); // first, as write access might detach shared arrays of an in place transformation
+	range.outputY = output->getRawY();
+	range.outputZ = output->getRawZ();
+	range.inputX = input->getRawX();
+	range.inputY = input->getRawY();
+	range.inputZ = input->getRawZ();
+
+	transformArrays<T>(transformation, range, size, numberOfThreads, minimalPointsPerThread);
+}
+
+}
+
+BatchTransformation::BatchTransformation() {
+	numberOfThreads = 0;
+	minimalPointsPerThread = 65536;
+}
+
+BatchTransformation::~BatchTransformation() {
+
+}
+
+void BatchTransformation::transform(IHomogeneousMatrix44* transformation, const PointCloud3DStorage* input, PointCloud3DStorage* output) {
+	transformStorage<Coordinate>(transformation, input, output, numberOfThreads, minimalPointsPerThread);
+}
+
+#ifndef BRICS_3D_USE_FLOAT_COORDINATES
+void BatchTransformation::transform(IHomogeneousMatrix44* transformation, const PointCloud3DStorageF* input, PointCloud3DStorageF* output) {
+	transformStorage<float>(transformation, input, output, numberOfThreads, minimalPointsPerThread);
+}
+#endif
+
+void BatchTransformation::transform(IHomogeneousMatrix44* transformation, const Coordinate* inputX, const Coordinate* inputY, const Coordinate* inputZ,
+		Coordinate* outputX, Coordinate* outputY, Coordinate* outputZ, unsigned int count) {
+	TransformationRange<Coordinate> range;
+	range.inputX = inputX;
+	range.inputY = inputY;
+	range.inputZ = inputZ;
+	range.outputX = outputX;
+	range.outputY = outputY;
+	range.outputZ = outputZ;
+	transformArrays<Coordinate>(transformation, range, count, numberOfThreads, minimalPointsPerThread);
+}
+
+void BatchTransformation::rotate(IHomogeneousMatrix44* transformation, Coordinate* vectors, unsigned int count) {
+	const double* matrix = transformation->getRawData();
+	Coordinate xTemp;
+	Coordinate yTemp;
+	Coordinate zTemp;
+
+	for (unsigned int i = 0; i < count; ++i) {
+		Coordinate* vector = vectors + 3 * i;
+		xTemp = static_cast<Coordinate>(vector[0] * matrix[0] + vector[1] * matrix[4] + vector[2] * matrix[8]);
+		yTemp = static_cast<Coordinate>(vector[0] * matrix[1] + vector[1] * matrix[5] + vector[2] * matrix[9]);
+		zTemp = static_cast<Coordinate>(vector[0] * matrix[2] + vector[1] * matrix[6] + vector[2] * matrix[10]);
+		vector[0] = xTemp;
+		vector[1] = yTemp;
+		vector[2] = zTemp;
+	}
+}
+
+unsigned int BatchTransformation::getNumberOfThreads() const {
+	return numberOfThreads;
+}
+
+void BatchTransformation::setNumberOfThreads(unsigned int numberOfThreads) {
+	this->numberOfThreads = numberOfThreads;
+}
+
+unsigned int BatchTransformation::getMinimalPointsPerThread() const {
+	return minimalPointsPerThread;
+}
+
+void BatchTransformation::setMinimalPointsPerThread(unsigned int minimalPointsPerThread) {
+	this->minimalPointsPerThread = minimalPointsPerThread;
+}
+
+}
+
+/* EOF */
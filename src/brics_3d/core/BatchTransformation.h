@@ -0,0 +1,106 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#ifndef BRICS_3D_BATCHTRANSFORMATION_H_
+#define BRICS_3D_BATCHTRANSFORMATION_H_
+
+#include "PointCloud3DStorage.h"
+#include "IHomogeneousMatrix44.h"
+
+namespace brics_3d {
+
+/**
+ * @brief Applies a homogeneous transformation to all coordinates of a point cloud storage at once.
+ *
+ * The matrix is read only once per call. The coordinate arrays are processed with SSE2 instructions
+ * (if available) and large storages are split into ranges that are transformed by multiple threads.
+ * Input and output may be the same storage (in place transformation), otherwise they must not overlap.
+ */
+class BatchTransformation {
+public:
+
+	/**
+	 * @brief Standard constructor
+	 */
+	BatchTransformation();
+
+	/**
+	 * @brief Standard destructor
+	 */
+	virtual ~BatchTransformation();
+
+	/**
+	 * @brief Transform all points of a storage.
+	 * @param[in] transformation The homogeneous transformation matrix that will be applied.
+	 * @param[in] input The points that will be transformed.
+	 * @param[out] output The transformed points. It will be resized to the size of the input.
+	 */
+	void transform(IHomogeneousMatrix44* transformation, const PointCloud3DStorage* input, PointCloud3DStorage* output);
+
+#ifndef BRICS_3D_USE_FLOAT_COORDINATES // otherwise PointCloud3DStorage is already the single precision storage
+	/**
+	 * @brief Transform all points of a single precision storage.
+	 */
+	void transform(IHomogeneousMatrix44* transformation, const PointCloud3DStorageF* input, PointCloud3DStorageF* output);
+#endif
+
+	/**
+	 * @brief Transform points given as separate coordinate arrays.
+	 * The input arrays may be identical to the output arrays, otherwise they must not overlap.
+	 * @param[in] transformation The homogeneous transformation matrix that will be applied.
+	 * @param[in] inputX Array of x coordinates with count elements. Same for inputY and inputZ.
+	 * @param[out] outputX Array for count transformed x coordinates. Same for outputY and outputZ.
+	 * @param[in] count Number of points.
+	 */
+	void transform(IHomogeneousMatrix44* transformation, const Coordinate* inputX, const Coordinate* inputY, const Coordinate* inputZ,
+			Coordinate* outputX, Coordinate* outputY, Coordinate* outputZ, unsigned int count);
+
+	/**
+	 * @brief Apply only the rotational part of a transformation to a set of vectors, e.g. normals.
+	 * @param[in] transformation The homogeneous transformation matrix. The translation is ignored.
+	 * @param[in,out] vectors The x, y and z values of the vectors, stored vector by vector (e.g. a channel of width 3).
+	 * @param[in] count Number of vectors.
+	 */
+	void rotate(IHomogeneousMatrix44* transformation, Coordinate* vectors, unsigned int count);
+
+	/// Number of threads. 0 means that the number of available cores is used. Default is 0.
+	unsigned int getNumberOfThreads() const;
+
+	void setNumberOfThreads(unsigned int numberOfThreads);
+
+	/// Minimal number of points per thread. Smaller storages are transformed by the calling thread only. Default is 65536.
+	unsigned int getMinimalPointsPerThread() const;
+
+	void setMinimalPointsPerThread(unsigned int minimalPointsPerThread);
+
+private:
+
+	/// Number of threads. 0 means that the number of available cores is used.
+	unsigned int numberOfThreads;
+
+	/// Minimal number of points per thread.
+	unsigned int minimalPointsPerThread;
+
+};
+
+}
+
+#endif /* BRICS_3D_BATCHTRANSFORMATION_H_ */
+
+/* EOF */
@@ -44,6 +44,22 @@ namespace brics_3d {
  *	}
  *	delete it;
  * @endcode
+ *
+ * Algorithms that only need the coordinates should rather fetch them in blocks, as this avoids
+ * the virtual function calls per coordinate:
+ *
+ *  @code
+ *	Coordinate x[IPoint3DIterator::defaultBlockSize];
+ *	Coordinate y[IPoint3DIterator::defaultBlockSize];
+ *	Coordinate z[IPoint3DIterator::defaultBlockSize];
+ *	unsigned int count;
+ *	it->begin();
+ *	while ((count = it->getNextBlock(x, y, z, IPoint3DIterator::defaultBlockSize)) > 0) {
+ *		for (unsigned int i = 0; i < count; ++i) {
+ *			x[i]; // same as it->getX() for the respective point
+ *		}
+ *	}
+ * @endcode
  */
 class IPoint3DIterator {
 public:
@@ -51,6 +67,9 @@ public:
 	typedef boost::shared_ptr<IPoint3DIterator> IPoint3DIteratorPtr;
 	typedef boost::shared_ptr<IPoint3DIterator const> IPoint3DIteratorConstPtr;
 
+	/// Suggested number of points per block for getNextBlock().
+	static const unsigned int defaultBlockSize = 1024;
+
 	/**
 	 * @brief Default constructor.
 	 */
@@ -109,6 +128,27 @@ public:
 	 */
 	virtual Point3D* getRawData() = 0; //not transformed, but might have additional data like color, etc.
 
+	/**
+	 * @brief Copy the (possibly transformed) coordinates of the next points into caller provided buffers.
+	 * The block starts with the current point. Afterwards the iterator points to the first point behind the block.
+	 * The default implementation uses getX(), getY(), getZ() and next(); implementations should provide a faster variant.
+	 * @param[out] x Buffer for at least maxCount x coordinates.
+	 * @param[out] y Buffer for at least maxCount y coordinates.
+	 * @param[out] z Buffer for at least maxCount z coordinates.
+	 * @param[in] maxCount Maximum number of points that will be copied.
+	 * @return Number of copied points. It is smaller than maxCount only if the end has been reached.
+	 */
+	virtual unsigned int getNextBlock(Coordinate* x, Coordinate* y, Coordinate* z, unsigned int maxCount) {
+		unsigned int count = 0;
+		for (; (count < maxCount) && !end(); next()) {
+			x[count] = getX();
+			y[count] = getY();
+			z[count] = getZ();
+			++count;
+		}
+		return count;
+	}
+
 };
 
 }
@@ -0,0 +1,91 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#include "MappedFile.h"
+
+#ifdef WIN32
+#include <fstream>
+#include <iterator>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace brics_3d {
+
+MappedFile::MappedFile() : data(0), size(0) {
+
+}
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+bool MappedFile::open(std::string filename, AccessPattern accessPattern) {
+	close();
+#ifdef WIN32
+	std::ifstream inputFile(filename.c_str(), std::ios::in | std::ios::binary);
+	if (!inputFile.is_open()) {
+		return false;
+	}
+	buffer.assign(std::istreambuf_iterator<char>(inputFile), std::istreambuf_iterator<char>());
+	if (buffer.empty()) {
+		return false;
+	}
+	data = &buffer[0];
+	size = buffer.size();
+#else
+	int fileDescriptor = ::open(filename.c_str(), O_RDONLY);
+	if (fileDescriptor < 0) {
+		return false;
+	}
+	struct stat fileStatus;
+	if (fstat(fileDescriptor, &fileStatus) != 0 || fileStatus.st_size == 0) {
+		::close(fileDescriptor);
+		return false;
+	}
+	void* mapping = mmap(0, fileStatus.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+	::close(fileDescriptor); // the mapping stays valid
+	if (mapping == MAP_FAILED) {
+		return false;
+	}
+	madvise(mapping, fileStatus.st_size, (accessPattern == sequentialAccess) ? MADV_SEQUENTIAL : MADV_RANDOM);
+	data = static_cast<const char*>(mapping);
+	size = static_cast<unsigned long>(fileStatus.st_size);
+#endif
+	return true;
+}
+
+void MappedFile::close() {
+#ifdef WIN32
+	buffer.clear();
+#else
+	if (data != 0) {
+		munmap(const_cast<char*>(data), size);
+	}
+#endif
+	data = 0;
+	size = 0;
+}
+
+}
+
+/* EOF */
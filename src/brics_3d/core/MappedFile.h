@@ -0,0 +1,85 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#ifndef BRICS_3D_MAPPEDFILE_H_
+#define BRICS_3D_MAPPEDFILE_H_
+
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+namespace brics_3d {
+
+/**
+ * @brief Read-only view of a complete file.
+ *
+ * Uses a memory mapping where available, so the pages are only loaded on access and are shared with other
+ * processes that map the same file. On WIN32 the file is read into a buffer instead.
+ * The data starts at a page boundary (or at the alignment of the heap for the buffer).
+ */
+class MappedFile : private boost::noncopyable {
+public:
+
+	/// Expected access to the data, forwarded to the operating system as a hint.
+	enum AccessPattern {
+		sequentialAccess,
+		randomAccess
+	};
+
+	/**
+	 * @brief Standard constructor
+	 */
+	MappedFile();
+
+	/**
+	 * @brief Standard destructor. Unmaps the file.
+	 */
+	virtual ~MappedFile();
+
+	/**
+	 * @brief Map a file. A previously mapped file is unmapped.
+	 * @param filename Name of the file.
+	 * @param accessPattern Expected access to the data.
+	 * @return False if the file cannot be opened or is empty.
+	 */
+	bool open(std::string filename, AccessPattern accessPattern = sequentialAccess);
+
+	/**
+	 * @brief Unmap the file.
+	 */
+	void close();
+
+	/// Begin of the file content or 0 if no file is mapped.
+	const char* data;
+
+	/// Size of the file content in bytes.
+	unsigned long size;
+
+private:
+#ifdef WIN32
+	std::vector<char> buffer;
+#endif
+};
+
+}
+
+#endif /* BRICS_3D_MAPPEDFILE_H_ */
+
+/* EOF */
@@ -0,0 +1,124 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#include "MortonOrder.h"
+
+#include <algorithm>
+#include <assert.h>
+
+namespace brics_3d {
+
+namespace {
+
+/// Insert two zero bits behind each of the lowest 21 bits.
+inline boost::uint64_t spreadBits(boost::uint64_t value) {
+	value &= 0x1FFFFFULL;
+	value = (value | (value << 32)) & 0x1F00000000FFFFULL;
+	value = (value | (value << 16)) & 0x1F0000FF0000FFULL;
+	value = (value | (value << 8)) & 0x100F00F00F00F00FULL;
+	value = (value | (value << 4)) & 0x10C30C30C30C30C3ULL;
+	value = (value | (value << 2)) & 0x1249249249249249ULL;
+	return value;
+}
+
+/// Inverse of spreadBits().
+inline boost::uint32_t compactBits(boost::uint64_t value) {
+	value &= 0x1249249249249249ULL;
+	value = (value | (value >> 2)) & 0x10C30C30C30C30C3ULL;
+	value = (value | (value >> 4)) & 0x100F00F00F00F00FULL;
+	value = (value | (value >> 8)) & 0x1F0000FF0000FFULL;
+	value = (value | (value >> 16)) & 0x1F00000000FFFFULL;
+	value = (value | (value >> 32)) & 0x1FFFFFULL;
+	return static_cast<boost::uint32_t>(value);
+}
+
+}
+
+MortonOrder::MortonOrder() {
+
+}
+
+MortonOrder::~MortonOrder() {
+
+}
+
+boost::uint64_t MortonOrder::encode(boost::uint32_t ix, boost::uint32_t iy, boost::uint32_t iz) {
+	return spreadBits(ix) | (spreadBits(iy) << 1) | (spreadBits(iz) << 2);
+}
+
+void MortonOrder::decode(boost::uint64_t code, boost::uint32_t& ix, boost::uint32_t& iy, boost::uint32_t& iz) {
+	ix = compactBits(code);
+	iy = compactBits(code >> 1);
+	iz = compactBits(code >> 2);
+}
+
+void MortonOrder::computeCodes(const PointCloud3DStorage* data, std::vector<boost::uint64_t>& codes) {
+	assert(data != 0);
+	unsigned int size = data->getSize();
+	codes.resize(size);
+	if (size == 0) {
+		return;
+	}
+	const Coordinate* coordinates[3] = {data->getRawX(), data->getRawY(), data->getRawZ()};
+
+	/* cubic bounding box, so the cells have the same extent in all dimensions */
+	double minimum[3];
+	double maximum[3];
+	for (int d = 0; d < 3; ++d) {
+		minimum[d] = coordinates[d][0];
+		maximum[d] = coordinates[d][0];
+		for (unsigned int i = 1; i < size; ++i) {
+			minimum[d] = std::min(minimum[d], static_cast<double>(coordinates[d][i]));
+			maximum[d] = std::max(maximum[d], static_cast<double>(coordinates[d][i]));
+		}
+	}
+	double extent = std::max(maximum[0] - minimum[0], std::max(maximum[1] - minimum[1], maximum[2] - minimum[2]));
+	const double maximumCell = static_cast<double>((1U << bitsPerDimension) - 1);
+	double scale = (extent > 0.0) ? maximumCell / extent : 0.0;
+
+	for (unsigned int i = 0; i < size; ++i) {
+		boost::uint32_t cell[3];
+		for (int d = 0; d < 3; ++d) {
+			double value = (coordinates[d][i] - minimum[d]) * scale;
+			cell[d] = static_cast<boost::uint32_t>(std::min(value, maximumCell));
+		}
+		codes[i] = encode(cell[0], cell[1], cell[2]);
+	}
+}
+
+void MortonOrder::computeOrder(const PointCloud3DStorage* data, std::vector<unsigned int>& order) {
+	std::vector<boost::uint64_t> codes;
+	computeCodes(data, codes);
+
+	/* the index breaks ties, so equal codes keep their order */
+	std::vector<std::pair<boost::uint64_t, unsigned int> > sortedCodes(codes.size());
+	for (unsigned int i = 0; i < codes.size(); ++i) {
+		sortedCodes[i] = std::make_pair(codes[i], i);
+	}
+	std::sort(sortedCodes.begin(), sortedCodes.end());
+
+	order.resize(codes.size());
+	for (unsigned int i = 0; i < sortedCodes.size(); ++i) {
+		order[i] = sortedCodes[i].second;
+	}
+}
+
+}
+
+/* EOF */
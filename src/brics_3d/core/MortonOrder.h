@@ -0,0 +1,87 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#ifndef BRICS_3D_MORTONORDER_H_
+#define BRICS_3D_MORTONORDER_H_
+
+#include "PointCloud3DStorage.h"
+
+#include <vector>
+#include <boost/cstdint.hpp>
+
+namespace brics_3d {
+
+/**
+ * @brief Order of points along the Morton (Z-order) space filling curve.
+ *
+ * The cubic bounding box of the points is divided into 2^21 cells per dimension. The Morton code of a point
+ * interleaves the bits of its cell indices. Points that are sorted by their codes are close in memory if they are
+ * close in space, which improves the cache locality of neighborhood queries (e.g. nearest neighbor search, normal
+ * estimation or clustering) on data that arrives in scan order.
+ *
+ * Use PointCloud3D::sortByMortonOrder() to reorder a point cloud including its attribute channels.
+ */
+class MortonOrder {
+public:
+
+	/// Number of bits of the cell index per dimension
+	static const unsigned int bitsPerDimension = 21;
+
+	/**
+	 * @brief Standard constructor
+	 */
+	MortonOrder();
+
+	/**
+	 * @brief Standard destructor
+	 */
+	virtual ~MortonOrder();
+
+	/**
+	 * @brief Interleave the bits of the cell indices. The lowest bit of the code is the lowest bit of ix.
+	 * @param ix Cell index in x direction. Only the lowest bitsPerDimension bits are used. Same for iy and iz.
+	 */
+	static boost::uint64_t encode(boost::uint32_t ix, boost::uint32_t iy, boost::uint32_t iz);
+
+	/**
+	 * @brief Get the cell indices of a code, i.e. the inverse of encode().
+	 */
+	static void decode(boost::uint64_t code, boost::uint32_t& ix, boost::uint32_t& iy, boost::uint32_t& iz);
+
+	/**
+	 * @brief Compute the Morton codes of all points.
+	 * @param[in] data The points.
+	 * @param[out] codes The code of each point.
+	 */
+	void computeCodes(const PointCloud3DStorage* data, std::vector<boost::uint64_t>& codes);
+
+	/**
+	 * @brief Compute the order of the points along the Morton curve.
+	 * @param[in] data The points.
+	 * @param[out] order Original index of each point in the new order. Points with the same code keep their
+	 *             relative order. Can be directly passed to PointCloud3DStorage::permute().
+	 */
+	void computeOrder(const PointCloud3DStorage* data, std::vector<unsigned int>& order);
+};
+
+}
+
+#endif /* BRICS_3D_MORTONORDER_H_ */
+
+/* EOF */
@@ -0,0 +1,119 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#ifndef BRICS_3D_PARALLELRANGE_H_
+#define BRICS_3D_PARALLELRANGE_H_
+
+#include <algorithm>
+#include <vector>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+
+namespace brics_3d {
+
+/**
+ * @brief Split the index range [begin, end) into contiguous ranges, one range per thread.
+ *
+ * The number of ranges is limited by numberOfThreads and by the number of indices divided by minimalSizePerThread,
+ * so small inputs are not distributed over more threads than pay off. Every range except the last one has a size
+ * that is a multiple of granularity, e.g. to keep vectorized loops on whole vectors.
+ *
+ * @param begin First index.
+ * @param end Index behind the last one.
+ * @param numberOfThreads Maximal number of ranges. 0 means one range per hardware core.
+ * @param minimalSizePerThread Minimal number of indices for an additional range.
+ * @param boundaries Returns the begin of every range followed by end. It is empty if the range is empty.
+ * @param granularity Range sizes are rounded up to multiples of this value.
+ */
+template <typename Index>
+void splitRange(Index begin, Index end, unsigned int numberOfThreads, Index minimalSizePerThread,
+		std::vector<Index>* boundaries, Index granularity = 1) {
+
+	boundaries->clear();
+	if (end <= begin) {
+		return;
+	}
+	Index size = end - begin;
+
+	if (numberOfThreads == 0) {
+		numberOfThreads = std::max(1u, boost::thread::hardware_concurrency());
+	}
+	Index numberOfRanges = std::max(static_cast<Index>(1), std::min(static_cast<Index>(numberOfThreads), size / std::max(static_cast<Index>(1), minimalSizePerThread)));
+	granularity = std::max(static_cast<Index>(1), granularity);
+	Index rangeSize = (size + numberOfRanges - 1) / numberOfRanges;
+	rangeSize = ((rangeSize + granularity - 1) / granularity) * granularity;
+
+	Index rangeBegin = begin;
+	boundaries->push_back(rangeBegin);
+	while (end - rangeBegin > rangeSize) {
+		rangeBegin += rangeSize;
+		boundaries->push_back(rangeBegin);
+	}
+	boundaries->push_back(end);
+}
+
+/**
+ * @brief Process a split range with one thread per range.
+ *
+ * Each range i is processed by <code>function(i, boundaries[i], boundaries[i + 1])</code>. A single range is
+ * processed by the calling thread. The call returns when all ranges are done.
+ *
+ * @param function Functor with the signature <code>void (unsigned int range, Index begin, Index end)</code>.
+ * @param boundaries Range boundaries as computed by splitRange().
+ */
+template <typename Function, typename Index>
+void forEachRange(Function function, const std::vector<Index>& boundaries) {
+	if (boundaries.size() < 2) {
+		return;
+	}
+	unsigned int numberOfRanges = static_cast<unsigned int>(boundaries.size() - 1);
+	if (numberOfRanges == 1) {
+		function(0u, boundaries[0], boundaries[1]);
+		return;
+	}
+
+	boost::thread_group threads;
+	for (unsigned int i = 0; i < numberOfRanges; ++i) {
+		threads.create_thread(boost::bind<void>(function, i, boundaries[i], boundaries[i + 1]));
+	}
+	threads.join_all();
+}
+
+/**
+ * @brief Split the index range [begin, end) and process the parts in parallel.
+ *
+ * Shortcut for splitRange() followed by forEachRange().
+ *
+ * @param function Functor with the signature <code>void (unsigned int range, Index begin, Index end)</code>.
+ * @return The number of ranges.
+ */
+template <typename Function, typename Index>
+unsigned int forEachRange(Function function, Index begin, Index end, unsigned int numberOfThreads, Index minimalSizePerThread,
+		Index granularity = 1) {
+	std::vector<Index> boundaries;
+	splitRange(begin, end, numberOfThreads, minimalSizePerThread, &boundaries, granularity);
+	forEachRange(function, boundaries);
+	return boundaries.empty() ? 0 : static_cast<unsigned int>(boundaries.size() - 1);
+}
+
+}
+
+#endif /* BRICS_3D_PARALLELRANGE_H_ */
+
+/* EOF */
@@ -36,10 +36,15 @@ namespace brics_3d {
  *
  * This typedef represents the a Cartesian coordinate.
  * Typically it is a set to a double, but it can be changed to float
- * if needed. Use redefinition with care.
+ * with the BRICS_3D_USE_FLOAT_COORDINATES compile flag (CMake option USE_FLOAT_COORDINATES).
+ * Use redefinition with care. To process single precision data next to double precision
+ * data use brics_3d::PointCloud3DF instead.
  */
+#ifdef BRICS_3D_USE_FLOAT_COORDINATES
+typedef float	Coordinate;				// coordinate data type
+#else
 typedef double	Coordinate;				// coordinate data type
-//typedef float	Coordinate;				// coordinate data type
+#endif
 
 class ColoredPoint3D;
 
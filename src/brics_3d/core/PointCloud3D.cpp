@@ -18,16 +18,145 @@
 ******************************************************************************/
 
 #include "PointCloud3D.h"
+#include "AsciiPointParser.h"
+#include "BatchTransformation.h"
+#include "MortonOrder.h"
+#include "ColoredPoint3D.h"
+#include "Point3DNormal.h"
+#include "Point3DIntensity.h"
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <sstream>
 #include <stdexcept>
+#include <typeinfo>
+#include <iterator>
+#include <algorithm>
+#include <assert.h>
 
 using namespace std;
 
 namespace brics_3d {
 
+const char* const PointCloud3D::rgbChannel = "rgb";
+const char* const PointCloud3D::normalChannel = "normal";
+const char* const PointCloud3D::intensityChannel = "intensity";
+const char* const PointCloud3D::labelChannel = "label";
+const char* const PointCloud3D::timestampChannel = "timestamp";
+
+namespace {
+
+/**
+ * Copy the attributes of the known decoration layers of a point into the channels of the storage.
+ * Missing channels will be added.
+ */
+void readAttributes(Point3D* point, PointCloud3DStorage& storage, unsigned int index) {
+	Point3D* layer = point;
+	Point3DDecorator* decorator;
+
+	while ((decorator = dynamic_cast<Point3DDecorator*>(layer)) != 0) {
+		if (ColoredPoint3D* coloredPoint = dynamic_cast<ColoredPoint3D*>(decorator)) {
+			storage.addChannel(PointCloud3D::rgbChannel, 3);
+			Coordinate* rgb = storage.getRawChannel(PointCloud3D::rgbChannel) + 3 * index;
+			rgb[0] = coloredPoint->getR();
+			rgb[1] = coloredPoint->getG();
+			rgb[2] = coloredPoint->getB();
+		} else if (Point3DNormal* pointWithNormal = dynamic_cast<Point3DNormal*>(decorator)) {
+			storage.addChannel(PointCloud3D::normalChannel, 3);
+			Coordinate* normal = storage.getRawChannel(PointCloud3D::normalChannel) + 3 * index;
+			Normal3D tmpNormal = pointWithNormal->getNormal();
+			normal[0] = tmpNormal.getX();
+			normal[1] = tmpNormal.getY();
+			normal[2] = tmpNormal.getZ();
+		} else if (Point3DIntensity* pointWithIntensity = dynamic_cast<Point3DIntensity*>(decorator)) {
+			storage.addChannel(PointCloud3D::intensityChannel, 1);
+			storage.getRawChannel(PointCloud3D::intensityChannel)[index] = static_cast<Coordinate>(pointWithIntensity->getIntensity());
+		}
+		layer = decorator->getPoint();
+	}
+}
+
+/// Decoration layers that have a channel representation.
+enum AttributeLayer {
+	COLOR_LAYER = 1,
+	NORMAL_LAYER = 2,
+	INTENSITY_LAYER = 4
+};
+
+/**
+ * Get the decoration layers of a point as bit mask of AttributeLayer values.
+ * @param[out] isRepresentable False if the point has other decoration layers, that cannot be represented by channels.
+ */
+unsigned int getLayerMask(Point3D* point, bool& isRepresentable) {
+	unsigned int mask = 0;
+	Point3D* layer = point;
+	Point3DDecorator* decorator;
+
+	isRepresentable = true;
+	while ((decorator = dynamic_cast<Point3DDecorator*>(layer)) != 0) {
+		if (typeid(*decorator) == typeid(ColoredPoint3D)) {
+			mask |= COLOR_LAYER;
+		} else if (typeid(*decorator) == typeid(Point3DNormal)) {
+			mask |= NORMAL_LAYER;
+		} else if (typeid(*decorator) == typeid(Point3DIntensity)) {
+			mask |= INTENSITY_LAYER;
+		} else {
+			isRepresentable = false;
+		}
+		layer = decorator->getPoint();
+	}
+	isRepresentable = isRepresentable && (typeid(*layer) == typeid(Point3D));
+	return mask;
+}
+
+/**
+ * Get the channels of a storage that have a decorator representation as bit mask of AttributeLayer values.
+ */
+unsigned int getChannelMask(const PointCloud3DStorage& storage) {
+	if (storage.getNumberOfChannels() == 0) {
+		return 0;
+	}
+	return (storage.hasChannel(PointCloud3D::rgbChannel) ? COLOR_LAYER : 0) |
+			(storage.hasChannel(PointCloud3D::normalChannel) ? NORMAL_LAYER : 0) |
+			(storage.hasChannel(PointCloud3D::intensityChannel) ? INTENSITY_LAYER : 0);
+}
+
+/**
+ * Create a point with decoration layers for all channels of the storage that have a decorator representation.
+ */
+Point3D* createPointView(const PointCloud3DStorage& storage, unsigned int index, const Coordinate* rgb, const Coordinate* normal, const Coordinate* intensity) {
+	Point3D* point = new Point3D(storage.getRawX()[index], storage.getRawY()[index], storage.getRawZ()[index]);
+	if (rgb != 0) {
+		point = new ColoredPoint3D(point,
+				static_cast<unsigned char>(rgb[3 * index]),
+				static_cast<unsigned char>(rgb[3 * index + 1]),
+				static_cast<unsigned char>(rgb[3 * index + 2]));
+	}
+	if (normal != 0) {
+		point = new Point3DNormal(point, Normal3D(normal[3 * index], normal[3 * index + 1], normal[3 * index + 2]));
+	}
+	if (intensity != 0) {
+		point = new Point3DIntensity(point, intensity[index]);
+	}
+	return point;
+}
+
+/**
+ * Get a decoration layer of the ith point. If the point does not have such a layer, it will be wrapped by a new one.
+ */
+template <class DecorationT>
+DecorationT* getOrAddDecoration(boost::ptr_vector<Point3D>* pointCloud, unsigned int index) {
+	DecorationT* decoration = getPointType<DecorationT>(&(*pointCloud)[index]);
+	if (decoration == 0) {
+		boost::ptr_vector<Point3D>::auto_type innerPoint = pointCloud->replace(index, new Point3D());
+		decoration = new DecorationT(innerPoint.release()); // takes over ownership of the inner point
+		pointCloud->replace(index, decoration);
+	}
+	return decoration;
+}
+
+}
+
 PointCloud3D::PointCloud3D() {
 
 #ifdef USE_POINTER_VECTOR
@@ -37,6 +166,27 @@ PointCloud3D::PointCloud3D() {
 #endif
 	pointCloud->clear();
 
+	storageIsValid = true;
+	pointCloudIsValid = true;
+	storageIsModified = false;
+	hasDecoratedPoints = false;
+}
+
+PointCloud3D::PointCloud3D(const PointCloud3D& other) {
+
+#ifdef USE_POINTER_VECTOR
+	pointCloud = new boost::ptr_vector<Point3D>();
+#else
+	pointCloud = new vector<Point3D> ();
+#endif
+	copyFrom(other);
+}
+
+PointCloud3D& PointCloud3D::operator=(const PointCloud3D& other) {
+	if (this != &other) {
+		copyFrom(other);
+	}
+	return *this;
 }
 
 PointCloud3D::~PointCloud3D() {
@@ -46,58 +196,458 @@ PointCloud3D::~PointCloud3D() {
 	}
 }
 
+void PointCloud3D::copyFrom(const PointCloud3D& other) {
+	storage = other.storage; // shares the arrays until one of the point clouds is modified
+
+	if (other.storageIsValid && !other.hasDecoratedPoints) { // the storage holds all data, so the Point3D vector can be created lazily
+		pointCloud->clear();
+		storageIsValid = true;
+		pointCloudIsValid = false;
+		storageIsModified = false;
+		hasDecoratedPoints = false;
+		return;
+	}
+
+#ifdef USE_POINTER_VECTOR
+	pointCloud->clear();
+	pointCloud->reserve(other.pointCloud->size());
+	for (unsigned int i = 0; i < other.pointCloud->size(); ++i) {
+		pointCloud->push_back((*other.pointCloud)[i].clone()); // clone keeps the decoration layers
+	}
+#else
+	*pointCloud = *other.pointCloud;
+#endif
+
+	storageIsValid = other.storageIsValid;
+	pointCloudIsValid = other.pointCloudIsValid;
+	storageIsModified = other.storageIsModified;
+	hasDecoratedPoints = other.hasDecoratedPoints;
+}
+
 #ifdef USE_POINTER_VECTOR
 
 void PointCloud3D::addPoint(Point3D point) {
-	pointCloud->push_back(new Point3D(point));
+	if (storageIsValid) {
+		if (getChannelMask(storage) != 0) { // a plain point in a cloud with e.g. colors
+			keepDecorationLayers();
+		}
+		storage.addPoint(point.getX(), point.getY(), point.getZ());
+		pointCloudIsValid = false; // only appended, so existing elements in the Point3D vector are still valid
+	} else {
+		pointCloud->push_back(new Point3D(point));
+	}
 }
 
 void PointCloud3D::addPointPtr(Point3D* point) {
+	if (!storageIsValid) {
+		pointCloud->push_back(point);
+		return;
+	}
+
+	bool isRepresentable;
+	unsigned int layerMask = getLayerMask(point, isRepresentable);
+	unsigned int channelMask = getChannelMask(storage);
+	bool isConsistent = isRepresentable && ((storage.getSize() == 0) ? ((channelMask & ~layerMask) == 0) : (layerMask == channelMask));
+	if (!isConsistent) { // e.g. a plain point in a cloud with colors
+		keepDecorationLayers();
+	}
+
+	if (layerMask == 0 && isRepresentable) { // plain points can be directly stored
+		storage.addPoint(point->getX(), point->getY(), point->getZ());
+		pointCloudIsValid = false;
+		delete point;
+		return;
+	}
+
+	/* decorated points are kept in the Point3D vector, the storage holds a copy of the coordinates and attributes */
+	if (!pointCloudIsValid) {
+		updatePointCloud();
+	}
+	storage.addPoint(point->getX(), point->getY(), point->getZ());
+	readAttributes(point, storage, storage.getSize() - 1);
 	pointCloud->push_back(point);
 }
 
 boost::ptr_vector<Point3D> *PointCloud3D::getPointCloud() {
+	if (!pointCloudIsValid) {
+		updatePointCloud();
+	}
+	storageIsValid = false; // caller might modify the data
 	return pointCloud;
 }
 
 void PointCloud3D::setPointCloud(boost::ptr_vector<Point3D> *pointCloud) {
-	if (pointCloud != NULL) {
-		pointCloud->clear();
-		delete pointCloud;
+	if ((this->pointCloud != NULL) && (this->pointCloud != pointCloud)) {
+		this->pointCloud->clear();
+		delete this->pointCloud;
 	}
 	this->pointCloud = pointCloud;
+	pointCloudIsValid = true;
+	storageIsValid = false;
+	storageIsModified = false;
+}
+
+void PointCloud3D::updatePointCloud() {
+	const PointCloud3DStorage& readOnlyStorage = storage; // read access must not detach shared arrays
+	unsigned int size = readOnlyStorage.getSize();
+	unsigned int validSize = static_cast<unsigned int>(pointCloud->size());
+	const Coordinate* x = readOnlyStorage.getRawX();
+	const Coordinate* y = readOnlyStorage.getRawY();
+	const Coordinate* z = readOnlyStorage.getRawZ();
+
+	if (validSize > size) {
+		pointCloud->erase(pointCloud->begin() + size, pointCloud->end());
+		validSize = size;
+	}
+
+	const Coordinate* rgb = readOnlyStorage.getRawChannel(rgbChannel);
+	const Coordinate* normal = readOnlyStorage.getRawChannel(normalChannel);
+	const Coordinate* intensity = readOnlyStorage.getRawChannel(intensityChannel);
+
+	if (storageIsModified) { // update in place to keep potential decoration layers
+		for (unsigned int i = 0; i < validSize; ++i) {
+			(*pointCloud)[i].setX(x[i]);
+			(*pointCloud)[i].setY(y[i]);
+			(*pointCloud)[i].setZ(z[i]);
+		}
+
+		/* the channels define the decoration layers, unless the points have individual layers */
+		if (rgb != 0) {
+			for (unsigned int i = 0; i < validSize; ++i) {
+				ColoredPoint3D* coloredPoint = hasDecoratedPoints ? getPointType<ColoredPoint3D>(&(*pointCloud)[i]) : getOrAddDecoration<ColoredPoint3D>(pointCloud, i);
+				if (coloredPoint != 0) {
+					coloredPoint->setR(static_cast<unsigned char>(rgb[3 * i]));
+					coloredPoint->setG(static_cast<unsigned char>(rgb[3 * i + 1]));
+					coloredPoint->setB(static_cast<unsigned char>(rgb[3 * i + 2]));
+				}
+			}
+		}
+		if (normal != 0) {
+			for (unsigned int i = 0; i < validSize; ++i) {
+				Point3DNormal* pointWithNormal = hasDecoratedPoints ? getPointType<Point3DNormal>(&(*pointCloud)[i]) : getOrAddDecoration<Point3DNormal>(pointCloud, i);
+				if (pointWithNormal != 0) {
+					pointWithNormal->setNormal(Normal3D(normal[3 * i], normal[3 * i + 1], normal[3 * i + 2]));
+				}
+			}
+		}
+		if (intensity != 0) {
+			for (unsigned int i = 0; i < validSize; ++i) {
+				Point3DIntensity* pointWithIntensity = hasDecoratedPoints ? getPointType<Point3DIntensity>(&(*pointCloud)[i]) : getOrAddDecoration<Point3DIntensity>(pointCloud, i);
+				if (pointWithIntensity != 0) {
+					pointWithIntensity->setIntensity(intensity[i]);
+				}
+			}
+		}
+	}
+
+	pointCloud->reserve(size);
+	if (hasDecoratedPoints || ((rgb == 0) && (normal == 0) && (intensity == 0))) {
+		for (unsigned int i = validSize; i < size; ++i) {
+			pointCloud->push_back(new Point3D(x[i], y[i], z[i]));
+		}
+	} else {
+		for (unsigned int i = validSize; i < size; ++i) {
+			pointCloud->push_back(createPointView(storage, i, rgb, normal, intensity));
+		}
+	}
+
+	pointCloudIsValid = true;
+	storageIsModified = false;
 }
 
 #else
 
 void PointCloud3D::addPoint(Point3D point) {
-	pointCloud->push_back(point);
+	if (storageIsValid) {
+		storage.addPoint(point.getX(), point.getY(), point.getZ());
+		pointCloudIsValid = false;
+	} else {
+		pointCloud->push_back(point);
+	}
 }
 
 void PointCloud3D::addPointPtr(Point3D* point) {
-	pointCloud->push_back(new Point3D(point));
+	addPoint(Point3D(point));
 	delete point;
 }
 
 std::vector<Point3D> *PointCloud3D::getPointCloud() {
+	if (!pointCloudIsValid) {
+		updatePointCloud();
+	}
+	storageIsValid = false; // caller might modify the data
 	return pointCloud;
 }
 
 void PointCloud3D::setPointCloud(std::vector<Point3D> *pointCloud) {
-	if (pointCloud != NULL) {
-		pointCloud->clear();
-		delete pointCloud;
+	if ((this->pointCloud != NULL) && (this->pointCloud != pointCloud)) {
+		this->pointCloud->clear();
+		delete this->pointCloud;
 	}
 	this->pointCloud = pointCloud;
+	pointCloudIsValid = true;
+	storageIsValid = false;
+	storageIsModified = false;
 }
 
+void PointCloud3D::updatePointCloud() {
+	const PointCloud3DStorage& readOnlyStorage = storage; // read access must not detach shared arrays
+	unsigned int size = readOnlyStorage.getSize();
+	const Coordinate* x = readOnlyStorage.getRawX();
+	const Coordinate* y = readOnlyStorage.getRawY();
+	const Coordinate* z = readOnlyStorage.getRawZ();
+
+	pointCloud->resize(size);
+	for (unsigned int i = 0; i < size; ++i) {
+		(*pointCloud)[i].setX(x[i]);
+		(*pointCloud)[i].setY(y[i]);
+		(*pointCloud)[i].setZ(z[i]);
+	}
+
+	pointCloudIsValid = true;
+	storageIsModified = false;
+}
 
 #endif
 
+void PointCloud3D::updateStorage() {
+	unsigned int size = static_cast<unsigned int>(pointCloud->size());
+	storage.removeChannel(rgbChannel); // these channels will be recreated from the decoration layers
+	storage.removeChannel(normalChannel);
+	storage.removeChannel(intensityChannel);
+	storage.resize(size);
+	Coordinate* x = storage.getRawX();
+	Coordinate* y = storage.getRawY();
+	Coordinate* z = storage.getRawZ();
+
+	/* the points are consistent with the channels, if all of them have the same known decoration layers */
+	bool isConsistent = true;
+	unsigned int firstLayerMask = 0;
+	for (unsigned int i = 0; i < size; ++i) {
+		Point3D& point = (*pointCloud)[i];
+		x[i] = point.getX();
+		y[i] = point.getY();
+		z[i] = point.getZ();
+
+		bool isRepresentable = true;
+		unsigned int layerMask = 0;
+		if (typeid(point) != typeid(Point3D)) {
+			readAttributes(&point, storage, i);
+			layerMask = getLayerMask(&point, isRepresentable);
+		}
+		if (i == 0) {
+			firstLayerMask = layerMask;
+		}
+		isConsistent = isConsistent && isRepresentable && (layerMask == firstLayerMask);
+	}
+	hasDecoratedPoints = !isConsistent;
+
+	storageIsValid = true;
+	storageIsModified = false;
+}
+
 unsigned int PointCloud3D::getSize() {
+	if (storageIsValid) {
+		return storage.getSize();
+	}
 	return pointCloud->size();
 }
 
+const PointCloud3DStorage* PointCloud3D::getStorage() {
+	if (!storageIsValid) {
+		updateStorage();
+	}
+	return &storage;
+}
+
+PointCloud3DStorage* PointCloud3D::getMutableStorage() {
+	if (!storageIsValid) {
+		updateStorage();
+	}
+	pointCloudIsValid = false;
+	storageIsModified = true;
+	return &storage;
+}
+
+void PointCloud3D::keepDecorationLayers() {
+	if (!hasDecoratedPoints) {
+		if (!pointCloudIsValid) {
+			updatePointCloud(); // create the views while the channels still define the decoration layers
+		}
+		hasDecoratedPoints = true;
+	}
+}
+
+void PointCloud3D::prepareAppend() {
+	if (!storageIsValid) {
+		updateStorage();
+	}
+	if (getChannelMask(storage) != 0) { // plain points in a cloud with e.g. colors
+		keepDecorationLayers();
+	}
+}
+
+void PointCloud3D::addPoints(const Coordinate* x, const Coordinate* y, const Coordinate* z, unsigned int count) {
+	prepareAppend();
+	storage.addPoints(x, y, z, count);
+	pointCloudIsValid = false;
+}
+
+void PointCloud3D::addPoints(const Coordinate* xyz, unsigned int count) {
+	prepareAppend();
+	storage.reserve(storage.getSize() + count);
+	for (unsigned int i = 0; i < count; ++i) {
+		storage.addPoint(xyz[3 * i], xyz[3 * i + 1], xyz[3 * i + 2]);
+	}
+	pointCloudIsValid = false;
+}
+
+void PointCloud3D::addPoints(PointCloud3D* pointCloud, const std::vector<int>& indices) {
+	assert(pointCloud != 0);
+	assert(pointCloud != this);
+	if (!storageIsValid) {
+		updateStorage();
+	}
+	const PointCloud3DStorage* source = pointCloud->getStorage();
+	unsigned int sourceChannelMask = getChannelMask(*source);
+
+	if (sourceChannelMask == 0) {
+		prepareAppend();
+	} else if (pointCloud->hasDecoratedPoints || hasDecoratedPoints ||
+			((storage.getSize() != 0) && (getChannelMask(storage) != sourceChannelMask))) {
+#ifdef USE_POINTER_VECTOR
+		/* the decoration layers differ from point to point, so copy them one by one */
+		boost::ptr_vector<Point3D>* sourcePoints = pointCloud->getPointCloud();
+		for (unsigned int i = 0; i < indices.size(); ++i) {
+			addPointPtr((*sourcePoints)[indices[i]].clone());
+		}
+		return;
+#endif
+	}
+
+	vector<string> channelNames;
+	source->getChannelNames(channelNames);
+	for (unsigned int j = 0; j < channelNames.size(); ++j) {
+		storage.addChannel(channelNames[j], source->getChannelWidth(channelNames[j]));
+	}
+
+	unsigned int offset = storage.getSize();
+	const Coordinate* sourceX = source->getRawX();
+	const Coordinate* sourceY = source->getRawY();
+	const Coordinate* sourceZ = source->getRawZ();
+	storage.reserve(offset + static_cast<unsigned int>(indices.size()));
+	for (unsigned int i = 0; i < indices.size(); ++i) {
+		storage.addPoint(sourceX[indices[i]], sourceY[indices[i]], sourceZ[indices[i]]);
+	}
+
+	for (unsigned int j = 0; j < channelNames.size(); ++j) {
+		unsigned int width = source->getChannelWidth(channelNames[j]);
+		const Coordinate* sourceChannel = source->getRawChannel(channelNames[j]);
+		Coordinate* channel = storage.getRawChannel(channelNames[j]);
+		if (sourceChannel == 0 || channel == 0) {
+			continue;
+		}
+		for (unsigned int i = 0; i < indices.size(); ++i) {
+			std::copy(sourceChannel + width * indices[i], sourceChannel + width * (indices[i] + 1), channel + width * (offset + i));
+		}
+	}
+	pointCloudIsValid = false;
+}
+
+void PointCloud3D::reorder(const std::vector<unsigned int>& order) {
+	if (!storageIsValid) {
+		updateStorage();
+	}
+	assert(order.size() == storage.getSize());
+
+	if (hasDecoratedPoints) { // the points hold individual decoration layers, so they are moved as well
+		if (!pointCloudIsValid) {
+			updatePointCloud();
+		}
+#ifdef USE_POINTER_VECTOR
+		Point3D** points = pointCloud->c_array();
+		std::vector<Point3D*> permutedPoints(order.size());
+		for (unsigned int i = 0; i < order.size(); ++i) {
+			permutedPoints[i] = points[order[i]];
+		}
+		std::copy(permutedPoints.begin(), permutedPoints.end(), points);
+#else
+		std::vector<Point3D> permutedPoints(order.size());
+		for (unsigned int i = 0; i < order.size(); ++i) {
+			permutedPoints[i] = (*pointCloud)[order[i]];
+		}
+		pointCloud->swap(permutedPoints);
+#endif
+		storage.permute(order);
+		return;
+	}
+
+	storage.permute(order);
+	pointCloudIsValid = false;
+	storageIsModified = true;
+}
+
+void PointCloud3D::sortByMortonOrder(std::vector<unsigned int>* order) {
+	std::vector<unsigned int> mortonOrder;
+	MortonOrder sorter;
+	sorter.computeOrder(getStorage(), mortonOrder);
+	reorder(mortonOrder);
+	if (order != 0) {
+		order->swap(mortonOrder);
+	}
+}
+
+void PointCloud3D::reserve(unsigned int capacity) {
+	if (storageIsValid) {
+		storage.reserve(capacity);
+	} else {
+		pointCloud->reserve(capacity);
+	}
+}
+
+unsigned int PointCloud3D::getCapacity() {
+	if (storageIsValid) {
+		return storage.getCapacity();
+	}
+	return static_cast<unsigned int>(pointCloud->capacity());
+}
+
+void PointCloud3D::clear() {
+	if (storage.isShared()) { // do not copy data that is going to be removed
+		PointCloud3DStorage emptyStorage;
+		storage.swap(emptyStorage);
+	} else {
+		vector<string> channelNames;
+		storage.getChannelNames(channelNames);
+		for (unsigned int j = 0; j < channelNames.size(); ++j) {
+			storage.removeChannel(channelNames[j]);
+		}
+		storage.clear();
+	}
+	pointCloud->clear();
+
+	storageIsValid = true;
+	pointCloudIsValid = true;
+	storageIsModified = false;
+	hasDecoratedPoints = false;
+}
+
+void PointCloud3D::swap(PointCloud3D& other) {
+	storage.swap(other.storage);
+	std::swap(pointCloud, other.pointCloud);
+	std::swap(storageIsValid, other.storageIsValid);
+	std::swap(pointCloudIsValid, other.pointCloudIsValid);
+	std::swap(storageIsModified, other.storageIsModified);
+	std::swap(hasDecoratedPoints, other.hasDecoratedPoints);
+}
+
+bool PointCloud3D::containsDecoratedPoints() {
+	if (!storageIsValid) {
+		updateStorage();
+	}
+	return hasDecoratedPoints;
+}
+
 void PointCloud3D::storeToPlyFile(std::string filename) {
 	ofstream outputFile;
 	outputFile.open(filename.c_str());
@@ -107,7 +657,7 @@ void PointCloud3D::storeToPlyFile(std::string filename) {
 	outputFile << "ply" << endl;
 	outputFile << "format ascii 1.0" << endl;
 	outputFile << "comment created by brics_3d::PointCloud3D::storeToPlyFile" << endl;
-	outputFile << "element vertex " << pointCloud->size() << endl;
+	outputFile << "element vertex " << getSize() << endl;
 	outputFile << "property float32 x" << endl;
 	outputFile << "property float32 y" << endl;
 	outputFile << "property float32 z" << endl;
@@ -125,10 +675,14 @@ void PointCloud3D::storeToPlyFile(std::string filename) {
 	*/
 
 	/* add data to file */
-	for (unsigned int i = 0; i < pointCloud->size(); ++i) {
-		outputFile << (*pointCloud)[i].getX() << " ";
-		outputFile << (*pointCloud)[i].getY() << " ";
-		outputFile << (*pointCloud)[i].getZ() << endl;
+	const PointCloud3DStorage* data = getStorage();
+	const Coordinate* x = data->getRawX();
+	const Coordinate* y = data->getRawY();
+	const Coordinate* z = data->getRawZ();
+	for (unsigned int i = 0; i < data->getSize(); ++i) {
+		outputFile << x[i] << " ";
+		outputFile << y[i] << " ";
+		outputFile << z[i] << endl;
 	}
 
 	outputFile.close();
@@ -139,10 +693,14 @@ void PointCloud3D::storeToTxtFile(std::string filename) {
 	outputFile.open(filename.c_str());
 	cout << "INFO: Saving point cloud to: " << filename << endl;
 
-	for (unsigned int i = 0; i < pointCloud->size(); ++i) {
-		outputFile << (*pointCloud)[i].getX() << " ";
-		outputFile << (*pointCloud)[i].getY() << " ";
-		outputFile << (*pointCloud)[i].getZ() << endl;
+	const PointCloud3DStorage* data = getStorage();
+	const Coordinate* x = data->getRawX();
+	const Coordinate* y = data->getRawY();
+	const Coordinate* z = data->getRawZ();
+	for (unsigned int i = 0; i < data->getSize(); ++i) {
+		outputFile << x[i] << " ";
+		outputFile << y[i] << " ";
+		outputFile << z[i] << endl;
 	}
 
 	outputFile.close();
@@ -150,55 +708,112 @@ void PointCloud3D::storeToTxtFile(std::string filename) {
 
 void PointCloud3D::readFromTxtFile(std::string filename) {
 	ifstream inputFile;
-	string line;
-
-	inputFile.open(filename.c_str());
+	inputFile.open(filename.c_str(), ios::in | ios::binary);
 
 	if(inputFile.is_open()){
 		cout << "INFO: Reading point cloud from: " << filename << endl;
-		while(getline(inputFile, line)) {
-		Point3D tmpPoint;
-		stringstream lineStream(line);
-		if (!inputFile.good()) {
-			throw runtime_error("ERROR: cannot read point.");
+		inputFile.seekg(0, ios::end);
+		std::streamoff fileSize = inputFile.tellg();
+		inputFile.seekg(0, ios::beg);
+		if (fileSize > 0) {
+			std::vector<char> buffer(static_cast<size_t>(fileSize));
+			inputFile.read(&buffer[0], fileSize);
+			appendFromText(&buffer[0], static_cast<unsigned long>(inputFile.gcount()));
 		}
-		lineStream >> tmpPoint;
-		this->addPoint(&tmpPoint);
-	}
-	inputFile.close();
+		inputFile.close();
 	} else {
 		cout << "INFO: Error reading point cloud from: " << filename << endl;
 	}
 }
 
-istream& operator>>(istream &inStream, PointCloud3D &pointCloud) {
-	string line;
-
-	while(getline(inStream, line)) {
-		Point3D tmpPoint;
-		stringstream lineStream(line);
-		if (!lineStream.good()) {
-			throw runtime_error("ERROR: cannot read point.");
-		}
-		lineStream >> tmpPoint;
-		pointCloud.addPoint(&tmpPoint);
+void PointCloud3D::appendFromText(const char* data, unsigned long size) {
+	if (!storageIsValid) {
+		updateStorage();
 	}
+	AsciiPointParser parser;
+	parser.parse(data, size, &storage);
+	pointCloudIsValid = false; // points have only been appended
+}
+
+istream& operator>>(istream &inStream, PointCloud3D &pointCloud) {
+	std::string text((std::istreambuf_iterator<char>(inStream)), std::istreambuf_iterator<char>());
+	pointCloud.appendFromText(text.data(), static_cast<unsigned long>(text.size()));
 
 	return inStream;
 }
 
 ostream& operator<<(ostream &outStream, PointCloud3D &pointCloud) {
-	for (unsigned int i = 0; i < pointCloud.getSize(); ++i) {
-		outStream << (*pointCloud.getPointCloud())[i] << endl;
+	const PointCloud3DStorage* data = pointCloud.getStorage();
+	const Coordinate* x = data->getRawX();
+	const Coordinate* y = data->getRawY();
+	const Coordinate* z = data->getRawZ();
+	for (unsigned int i = 0; i < data->getSize(); ++i) {
+		outStream << x[i] << " " << y[i] << " " << z[i] << endl;
 	}
 
 	return outStream;
 }
 
 void PointCloud3D::homogeneousTransformation(IHomogeneousMatrix44 *transformation) {
-	for (unsigned int i = 0; i < pointCloud->size(); ++i) {
-		(*pointCloud)[i].homogeneousTransformation(transformation);
+	if (!storageIsValid) {
+		updateStorage();
+	}
+	if (hasDecoratedPoints) { // unknown decoration layers might need to be transformed as well
+		getPointCloud();
+		for (unsigned int i = 0; i < pointCloud->size(); ++i) {
+			(*pointCloud)[i].homogeneousTransformation(transformation);
+		}
+		return;
 	}
+
+	BatchTransformation batchTransformation;
+	batchTransformation.transform(transformation, &storage, &storage);
+	if (storage.hasChannel(normalChannel)) {
+		batchTransformation.rotate(transformation, storage.getRawChannel(normalChannel), storage.getSize());
+	}
+
+	pointCloudIsValid = false;
+	storageIsModified = true;
+}
+
+void PointCloud3D::homogeneousTransformation(IHomogeneousMatrix44* transformation, PointCloud3D* resultPointCloud) {
+	assert(resultPointCloud != 0);
+	if (resultPointCloud == this) {
+		homogeneousTransformation(transformation);
+		return;
+	}
+
+	if (!storageIsValid) {
+		updateStorage();
+	}
+	if (hasDecoratedPoints) { // decoration layers have to be copied
+		*resultPointCloud = *this;
+		resultPointCloud->homogeneousTransformation(transformation);
+		return;
+	}
+
+	if (storage.getNumberOfChannels() == 0) {
+		std::vector<std::string> channelNames;
+		resultPointCloud->storage.getChannelNames(channelNames);
+		for (unsigned int i = 0; i < channelNames.size(); ++i) {
+			resultPointCloud->storage.removeChannel(channelNames[i]);
+		}
+		BatchTransformation batchTransformation;
+		batchTransformation.transform(transformation, &storage, &resultPointCloud->storage);
+	} else { // the channels have to be copied as well
+		resultPointCloud->storage = storage;
+		BatchTransformation batchTransformation;
+		batchTransformation.transform(transformation, &resultPointCloud->storage, &resultPointCloud->storage);
+		if (storage.hasChannel(normalChannel)) {
+			batchTransformation.rotate(transformation, resultPointCloud->storage.getRawChannel(normalChannel), storage.getSize());
+		}
+	}
+
+	resultPointCloud->pointCloud->clear();
+	resultPointCloud->storageIsValid = true;
+	resultPointCloud->pointCloudIsValid = false;
+	resultPointCloud->storageIsModified = false;
+	resultPointCloud->hasDecoratedPoints = false;
 }
 
 }
@@ -25,6 +25,7 @@
 #include <boost/ptr_container/ptr_vector.hpp>
 
 #include "Point3D.h"
+#include "PointCloud3DStorage.h"
 
 #define USE_POINTER_VECTOR
 
@@ -32,6 +33,32 @@ namespace brics_3d {
 
 /**
  * @brief Class to represent a Cartesian 3D point cloud
+ *
+ * The points are primarily stored in a contiguous brics_3d::PointCloud3DStorage (one array per coordinate).
+ * Algorithms should prefer getStorage() to process the raw coordinate arrays.
+ * For compatibility the point cloud can still be accessed as a vector of Point3D via getPointCloud().
+ * This vector is an adapter that is lazily synchronized with the storage: it is only created when
+ * getPointCloud() is invoked and it is updated in place (i.e. potential decoration layers of the points are kept)
+ * whenever the storage has been modified in the meanwhile.
+ *
+ * As the vector returned by getPointCloud() can be modified by the caller, the storage is considered outdated
+ * after each call of getPointCloud() and it will be re-synchronized with the next invocation of getStorage().
+ * Thus do not hold the pointer returned by getPointCloud() across calls to getStorage(), getMutableStorage() or
+ * homogeneousTransformation(). Note that the synchronization is not thread safe: invoke getStorage() once before
+ * the data is shared among multiple threads.
+ *
+ * Per point attributes are kept as optional channels of the storage (see rgbChannel, normalChannel,
+ * intensityChannel, labelChannel and timestampChannel). A channel always applies to all points of the cloud.
+ * Producers should fill these channels directly via getMutableStorage(), which avoids allocating decoration layers
+ * per point. For compatibility getPointCloud() returns points with the decoration layers brics_3d::ColoredPoint3D,
+ * brics_3d::Point3DNormal and brics_3d::Point3DIntensity as a view on these channels, so algorithms that rely on
+ * the decorator API (e.g. asColoredPoint3D()) still work. Decorated points that are added via addPointPtr() are kept
+ * as they are and their attributes are mirrored into the channels. Mixing points with different decoration layers
+ * is still possible, but then algorithms have to fall back to the slower processing of the individual points.
+ *
+ * Copies share the arrays of the storage until one of them is modified (copy-on-write). So a point cloud that is
+ * owned by someone else, e.g. the data of a brics_3d::rsg::PointCloud in the world model, can be copied for free
+ * and handed to an algorithm that modifies it in place. The arrays are only duplicated with the first modification.
  */
 class PointCloud3D {
 public:
@@ -39,11 +66,38 @@ public:
 	typedef boost::shared_ptr<PointCloud3D> PointCloud3DPtr;
 	typedef boost::shared_ptr<PointCloud3D const> PointCloud3DConstPtr;
 
+	/// Name of the color channel: red, green and blue values in [0, 255] per point. Represented by brics_3d::ColoredPoint3D.
+	static const char* const rgbChannel;
+
+	/// Name of the normal channel: x, y and z of the normal per point. Represented by brics_3d::Point3DNormal.
+	static const char* const normalChannel;
+
+	/// Name of the intensity channel: one value per point. Represented by brics_3d::Point3DIntensity.
+	static const char* const intensityChannel;
+
+	/// Name of the label channel: one (integral) value per point e.g. a segment or class ID.
+	static const char* const labelChannel;
+
+	/// Name of the timestamp channel: one value per point e.g. the acquisition time in seconds.
+	static const char* const timestampChannel;
+
 	/**
 	 * @brief Standard constuctor
 	 */
 	PointCloud3D();
 
+	/**
+	 * @brief Copy constructor. Creates a copy including all potential decoration layers of the points.
+	 * The arrays of the storage are shared until one of the point clouds is modified.
+	 */
+	PointCloud3D(const PointCloud3D& other);
+
+	/**
+	 * @brief Assignment operator. Creates a copy including all potential decoration layers of the points.
+	 * The arrays of the storage are shared until one of the point clouds is modified.
+	 */
+	PointCloud3D& operator=(const PointCloud3D& other);
+
 	/**
 	 * @brief Standard destructor
 	 */
@@ -62,6 +116,73 @@ public:
 	 */
 	void addPointPtr(Point3D* point);
 
+	/**
+	 * @brief Add a set of points given as separate coordinate arrays.
+	 * @param x Array of x coordinates with count elements.
+	 * @param y Array of y coordinates with count elements.
+	 * @param z Array of z coordinates with count elements.
+	 * @param count Number of points that will be added.
+	 */
+	void addPoints(const Coordinate* x, const Coordinate* y, const Coordinate* z, unsigned int count);
+
+	/**
+	 * @brief Add a set of points given as one buffer with interleaved coordinates (x0 y0 z0 x1 y1 z1 ...).
+	 * @param xyz Buffer with 3 * count elements.
+	 * @param count Number of points that will be added.
+	 */
+	void addPoints(const Coordinate* xyz, unsigned int count);
+
+	/**
+	 * @brief Add a range of points, e.g. from a std::vector<Point3D>.
+	 * Only the coordinates are copied. Use reserve() before, if the number of points is known.
+	 * @param begin Iterator to the first point. Dereferencing must yield a (const) Point3D reference.
+	 * @param end Iterator behind the last point.
+	 */
+	template <typename PointIterator>
+	void addPoints(PointIterator begin, PointIterator end) {
+		prepareAppend();
+		for (; begin != end; ++begin) {
+			storage.addPoint(begin->getX(), begin->getY(), begin->getZ());
+		}
+		pointCloudIsValid = false;
+	}
+
+	/**
+	 * @brief Add a subset of the points of another point cloud.
+	 * The attribute channels and decoration layers are copied as well.
+	 * @param pointCloud The source point cloud.
+	 * @param indices Indices of the points in the source point cloud.
+	 */
+	void addPoints(PointCloud3D* pointCloud, const std::vector<int>& indices);
+
+	/**
+	 * @brief Pre-allocate memory for a given number of points.
+	 * @param capacity Number of points.
+	 */
+	void reserve(unsigned int capacity);
+
+	/**
+	 * @brief Get the number of points that can be stored without further memory allocation.
+	 */
+	unsigned int getCapacity();
+
+	/**
+	 * @brief Remove all points and attribute channels. Allocated memory is kept for further usage.
+	 */
+	void clear();
+
+	/**
+	 * @brief Exchange the content with another point cloud in constant time.
+	 *
+	 * Use it to transfer the data of a (temporary) point cloud without copying it:
+	 *  @code
+	 *	PointCloud3D result;
+	 *	result.swap(temporaryPointCloud); // temporaryPointCloud is empty afterwards
+	 * @endcode
+	 * @param other The other point cloud.
+	 */
+	void swap(PointCloud3D& other);
+
 #ifdef USE_POINTER_VECTOR
 	/**
 	 * @brief Get the pointer to the point cloud
@@ -86,8 +207,30 @@ public:
      */
     unsigned int getSize();
 
+    /**
+     * @brief Get read-only access to the contiguous coordinate arrays.
+     * If the point cloud has been modified via getPointCloud() before, the storage will be updated first.
+     * @return Pointer to the storage. It remains valid as long as the point cloud exists.
+     */
+    const PointCloud3DStorage* getStorage();
+
+    /**
+     * @brief Get writable access to the contiguous coordinate arrays.
+     * Modifications are visible with the next invocation of getPointCloud().
+     * Raw arrays obtained from it must be requested again after the point cloud has been copied.
+     * @return Pointer to the storage. It remains valid as long as the point cloud exists.
+     */
+    PointCloud3DStorage* getMutableStorage();
+
+    /**
+     * @brief Check if the point cloud contains points with individual decoration layers, that are not represented
+     * by the channels, e.g. a mix of colored and plain points. If not, all data is represented by the storage.
+     */
+    bool containsDecoratedPoints();
+
     /**
      * @brief Stores the point cloud into a ply file (Stanford polygon file format)
+     * The file is written in ascii format. Use brics_3d::PlyFileHandler for binary files.
      * @param filename Specifies the name of the file .e.g. point_cloud.ply
      */
     void storeToPlyFile(std::string filename);
@@ -100,6 +243,7 @@ public:
 
     /**
      * @brief Reads data from a simple text file (x y z) and appends it to this point cloud
+     * Large files are parsed in parallel by brics_3d::AsciiPointParser.
      * @param filename Specifies the name of the file .e.g. point_cloud.txt
      */
     void readFromTxtFile(std::string filename);
@@ -129,12 +273,61 @@ public:
 	/**
 	 * @brief Applies a homogeneous transformation to the point cloud
 	 *
+	 * Point clouds without decoration layers are transformed by brics_3d::BatchTransformation.
 	 * @param[in] transformation The homogeneous transformation matrix that will be applied
 	 */
 	void homogeneousTransformation(IHomogeneousMatrix44* transformation);
 
+	/**
+	 * @brief Applies a homogeneous transformation and stores the transformed points in another point cloud
+	 *
+	 * The data of this point cloud remains unchanged. This avoids an explicit copy before the transformation.
+	 * @param[in] transformation The homogeneous transformation matrix that will be applied
+	 * @param[out] resultPointCloud The point cloud that will hold the transformed points. Existing points will be replaced.
+	 */
+	void homogeneousTransformation(IHomogeneousMatrix44* transformation, PointCloud3D* resultPointCloud);
+
+	/**
+	 * @brief Reorder the points together with all attribute channels and decoration layers.
+	 * @param order Original index of each point in the new order, i.e. point i is the former point order[i].
+	 *        Has to be a permutation of [0, getSize()).
+	 */
+	void reorder(const std::vector<unsigned int>& order);
+
+	/**
+	 * @brief Sort the points along the Morton (Z-order) curve, see brics_3d::MortonOrder.
+	 *
+	 * Points that are close in space become close in memory. This speeds up algorithms that run neighborhood queries
+	 * for all points (e.g. normal estimation or clustering) on data in scan order. Search structures that were
+	 * created on the data before have to be set up again.
+	 * @param[out] order Optional. Original index of each point in the new order, e.g. to map results back to the
+	 *             previous indices.
+	 */
+	void sortByMortonOrder(std::vector<unsigned int>* order = 0);
+
 protected:
 
+	/// Update the Point3D vector with the data from the storage.
+	void updatePointCloud();
+
+	/// Update the storage with the data from the Point3D vector.
+	void updateStorage();
+
+	/**
+	 * Switch to points with individual decoration layers, e.g. if a plain point is added to a colored point cloud.
+	 * Afterwards the Point3D vector is not a view on the channels anymore.
+	 */
+	void keepDecorationLayers();
+
+	/// Make sure that plain points can be appended to the storage.
+	void prepareAppend();
+
+	/// Copy the data of another point cloud. Existing data will be overridden.
+	void copyFrom(const PointCloud3D& other);
+
+	/// Parse plain text "x y z" lines and append the points to the storage.
+	void appendFromText(const char* data, unsigned long size);
+
 #ifdef USE_POINTER_VECTOR
 
 	///Pointer to vector which represents a Cartesian point cloud
@@ -144,8 +337,36 @@ protected:
 	std::vector<Point3D>* pointCloud;
 #endif
 
+	/// Contiguous storage of the coordinates.
+	PointCloud3DStorage storage;
+
+	/// True if the storage holds the current data.
+	bool storageIsValid;
+
+	/// True if the Point3D vector holds the current data.
+	bool pointCloudIsValid;
+
+	/**
+	 * True if the storage has been modified in place since the last synchronization of the Point3D vector.
+	 * Otherwise points have only been appended and the Point3D vector is valid up to its current size.
+	 */
+	bool storageIsModified;
+
+	/**
+	 * True if the Point3D vector contains points with individual decoration layers that the storage does not represent,
+	 * e.g. a mix of colored and plain points or unknown decorations. Otherwise the points are a view on the channels.
+	 */
+	bool hasDecoratedPoints;
+
 };
 
+/**
+ * @brief Exchange the content of two point clouds in constant time.
+ */
+inline void swap(PointCloud3D& first, PointCloud3D& second) {
+	first.swap(second);
+}
+
 }
 
 #endif /* BRICS_3D_CARTESIANPOINTCLOUD_H_ */
@@ -0,0 +1,131 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#include "PointCloud3DF.h"
+#include "AsciiPointParser.h"
+#include "BatchTransformation.h"
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <stdexcept>
+#include <assert.h>
+
+using namespace std;
+
+namespace brics_3d {
+
+PointCloud3DF::PointCloud3DF() {
+
+}
+
+PointCloud3DF::PointCloud3DF(PointCloud3D* pointCloud) {
+	fromPointCloud3D(pointCloud);
+}
+
+PointCloud3DF::~PointCloud3DF() {
+
+}
+
+void PointCloud3DF::addPoint(Point3D point) {
+	storage.addPoint(static_cast<float>(point.getX()), static_cast<float>(point.getY()), static_cast<float>(point.getZ()));
+}
+
+void PointCloud3DF::fromPointCloud3D(PointCloud3D* pointCloud) {
+	assert(pointCloud != 0);
+	const PointCloud3DStorage* source = pointCloud->getStorage();
+	const Coordinate* sourceX = source->getRawX();
+	const Coordinate* sourceY = source->getRawY();
+	const Coordinate* sourceZ = source->getRawZ();
+
+	storage.clear();
+	storage.resize(source->getSize());
+	float* x = storage.getRawX();
+	float* y = storage.getRawY();
+	float* z = storage.getRawZ();
+
+	for (unsigned int i = 0; i < source->getSize(); ++i) {
+		x[i] = static_cast<float>(sourceX[i]);
+		y[i] = static_cast<float>(sourceY[i]);
+		z[i] = static_cast<float>(sourceZ[i]);
+	}
+}
+
+void PointCloud3DF::toPointCloud3D(PointCloud3D* pointCloud) const {
+	assert(pointCloud != 0);
+	const float* x = storage.getRawX();
+	const float* y = storage.getRawY();
+	const float* z = storage.getRawZ();
+
+	for (unsigned int i = 0; i < storage.getSize(); ++i) {
+		pointCloud->addPoint(Point3D(static_cast<Coordinate>(x[i]), static_cast<Coordinate>(y[i]), static_cast<Coordinate>(z[i])));
+	}
+}
+
+void PointCloud3DF::storeToTxtFile(std::string filename) {
+	ofstream outputFile;
+	outputFile.open(filename.c_str());
+	cout << "INFO: Saving point cloud to: " << filename << endl;
+
+	const float* x = storage.getRawX();
+	const float* y = storage.getRawY();
+	const float* z = storage.getRawZ();
+	for (unsigned int i = 0; i < storage.getSize(); ++i) {
+		outputFile << x[i] << " ";
+		outputFile << y[i] << " ";
+		outputFile << z[i] << endl;
+	}
+
+	outputFile.close();
+}
+
+void PointCloud3DF::readFromTxtFile(std::string filename) {
+	ifstream inputFile;
+	inputFile.open(filename.c_str(), ios::in | ios::binary);
+
+	if(inputFile.is_open()){
+		cout << "INFO: Reading point cloud from: " << filename << endl;
+		inputFile.seekg(0, ios::end);
+		std::streamoff fileSize = inputFile.tellg();
+		inputFile.seekg(0, ios::beg);
+		if (fileSize > 0) {
+			std::vector<char> buffer(static_cast<size_t>(fileSize));
+			inputFile.read(&buffer[0], fileSize);
+			AsciiPointParser parser;
+			parser.parse(&buffer[0], static_cast<unsigned long>(inputFile.gcount()), &storage);
+		}
+		inputFile.close();
+	} else {
+		cout << "INFO: Error reading point cloud from: " << filename << endl;
+	}
+}
+
+void PointCloud3DF::homogeneousTransformation(IHomogeneousMatrix44* transformation) {
+	BatchTransformation batchTransformation;
+	batchTransformation.transform(transformation, &storage, &storage);
+}
+
+void PointCloud3DF::homogeneousTransformation(IHomogeneousMatrix44* transformation, PointCloud3DF* resultPointCloud) {
+	assert(resultPointCloud != 0);
+	BatchTransformation batchTransformation;
+	batchTransformation.transform(transformation, &storage, resultPointCloud->getMutableStorage());
+}
+
+}
+
+/* EOF */
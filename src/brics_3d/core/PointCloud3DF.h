@@ -0,0 +1,146 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#ifndef BRICS_3D_POINTCLOUD3DF_H_
+#define BRICS_3D_POINTCLOUD3DF_H_
+
+#include <string>
+#include <boost/shared_ptr.hpp>
+
+#include "PointCloud3D.h"
+#include "PointCloud3DStorage.h"
+
+namespace brics_3d {
+
+/**
+ * @brief Single precision variant of a Cartesian 3D point cloud.
+ *
+ * The points are stored as float values in a contiguous brics_3d::PointCloud3DStorageF. Compared to
+ * brics_3d::PointCloud3D this halves the required memory and memory bandwidth, so sensor processing pipelines
+ * can work end-to-end in float. There is no Point3D vector representation, thus decorated points are not supported.
+ *
+ * Use fromPointCloud3D() and toPointCloud3D() for explicit conversions wherever double precision matters,
+ * e.g. for registration.
+ */
+class PointCloud3DF {
+public:
+
+	typedef boost::shared_ptr<PointCloud3DF> PointCloud3DFPtr;
+	typedef boost::shared_ptr<PointCloud3DF const> PointCloud3DFConstPtr;
+
+	/**
+	 * @brief Standard constructor
+	 */
+	PointCloud3DF();
+
+	/**
+	 * @brief Constructor that converts a (double precision) point cloud.
+	 * @param pointCloud The point cloud that will be copied.
+	 */
+	PointCloud3DF(PointCloud3D* pointCloud);
+
+	/**
+	 * @brief Standard destructor
+	 */
+	virtual ~PointCloud3DF();
+
+	/**
+	 * @brief Add a point to the point cloud
+	 */
+	inline void addPoint(float x, float y, float z) {
+		storage.addPoint(x, y, z);
+	}
+
+	/**
+	 * @brief Add a point to the point cloud. The coordinates will be converted to float.
+	 */
+	void addPoint(Point3D point);
+
+	/**
+	 * @brief Get the number of points in the point cloud
+	 */
+	inline unsigned int getSize() const {
+		return storage.getSize();
+	}
+
+	/**
+	 * @brief Get read-only access to the contiguous coordinate arrays.
+	 */
+	inline const PointCloud3DStorageF* getStorage() const {
+		return &storage;
+	}
+
+	/**
+	 * @brief Get writable access to the contiguous coordinate arrays.
+	 */
+	inline PointCloud3DStorageF* getMutableStorage() {
+		return &storage;
+	}
+
+	/**
+	 * @brief Replace the content of this point cloud by a float copy of a (double precision) point cloud.
+	 * @param pointCloud The point cloud that will be copied.
+	 */
+	void fromPointCloud3D(PointCloud3D* pointCloud);
+
+	/**
+	 * @brief Append all points of this point cloud to a (double precision) point cloud.
+	 * @param[out] pointCloud The point cloud where the points will be added.
+	 */
+	void toPointCloud3D(PointCloud3D* pointCloud) const;
+
+	/**
+	 * @brief Stores the point cloud into a sipmle text file (x y z)
+	 * @param filename Specifies the name of the file .e.g. point_cloud.txt
+	 */
+	void storeToTxtFile(std::string filename);
+
+	/**
+	 * @brief Reads data from a simple text file (x y z) and appends it to this point cloud
+	 * @param filename Specifies the name of the file .e.g. point_cloud.txt
+	 */
+	void readFromTxtFile(std::string filename);
+
+	/**
+	 * @brief Applies a homogeneous transformation to the point cloud
+	 *
+	 * The matrix entries are converted once to float, the transformation itself is computed in single precision.
+	 * @param[in] transformation The homogeneous transformation matrix that will be applied
+	 */
+	void homogeneousTransformation(IHomogeneousMatrix44* transformation);
+
+	/**
+	 * @brief Applies a homogeneous transformation and stores the transformed points in another point cloud
+	 * @param[in] transformation The homogeneous transformation matrix that will be applied
+	 * @param[out] resultPointCloud The point cloud that will hold the transformed points. Existing points will be replaced.
+	 */
+	void homogeneousTransformation(IHomogeneousMatrix44* transformation, PointCloud3DF* resultPointCloud);
+
+protected:
+
+	/// Contiguous storage of the coordinates.
+	PointCloud3DStorageF storage;
+
+};
+
+}
+
+#endif /* BRICS_3D_POINTCLOUD3DF_H_ */
+
+/* EOF */
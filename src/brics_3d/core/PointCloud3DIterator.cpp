@@ -20,11 +20,18 @@
 
 #include "PointCloud3DIterator.h"
 #include "HomogeneousMatrix44.h"
+#include "BatchTransformation.h"
 #include "Logger.h"
 
+#include <algorithm>
+
 namespace brics_3d {
 
 PointCloud3DIterator::PointCloud3DIterator() {
+	currentX = 0;
+	currentY = 0;
+	currentZ = 0;
+	currentSize = 0;
 	begin();
 }
 
@@ -48,15 +55,8 @@ void PointCloud3DIterator::begin() {
 	}
 
 	if ( !end() ) {
-
-		Point3D* tmpHandle = &((*pointCloudsIterator->first->getPointCloud())[index]); //only one operator[] access - which is sightly faster
-		currentTransformedPoint.setX(tmpHandle->getX());
-		currentTransformedPoint.setY(tmpHandle->getY());
-		currentTransformedPoint.setZ(tmpHandle->getZ());
-		if(*associatedTransformIsIdentityIterator == false) { // the non "lazyness" case
-			currentTransformedPoint.homogeneousTransformation(pointCloudsIterator->second.get());
-		}
-
+		updateCurrentPointCloud();
+		updateCurrentPoint();
 	} else {
 		pointCloudsIterator = pointCloudsWithTransforms.end(); // empty iterator
 	}
@@ -67,7 +67,7 @@ void PointCloud3DIterator::next() {
 
 	if ( !end() ) {
 
-		if(index >= pointCloudsIterator->first->getSize()) { //wrap over - advance to next point cloud
+		if(index >= currentSize) { //wrap over - advance to next point cloud
 			index = 0;
 			pointCloudsIterator++;
 			associatedTransformIsIdentityIterator++;
@@ -77,18 +77,14 @@ void PointCloud3DIterator::next() {
 				associatedTransformIsIdentityIterator++;
 				LOG(WARNING) << "PointCloud3DIterator contains empty point clouds.";
 			}
-		}
 
-		if ( !end() ) { // end could be reach meanwhile so we have to check again
-
-			Point3D* tmpHandle = &((*pointCloudsIterator->first->getPointCloud())[index]); //only one operator[] access - which is slightly faster
-			currentTransformedPoint.setX(tmpHandle->getX());
-			currentTransformedPoint.setY(tmpHandle->getY());
-			currentTransformedPoint.setZ(tmpHandle->getZ());
-			if(*associatedTransformIsIdentityIterator == false) { // the non "lazyness" case
-				currentTransformedPoint.homogeneousTransformation(pointCloudsIterator->second.get());
+			if ( !end() ) {
+				updateCurrentPointCloud();
 			}
+		}
 
+		if ( !end() ) { // end could be reach meanwhile so we have to check again
+			updateCurrentPoint();
 		}
 	} else {
 		/* no further iterations, we are at the end */
@@ -118,6 +114,45 @@ Point3D* PointCloud3DIterator::getRawData() {
 	return &(*pointCloudsIterator->first->getPointCloud())[index];
 }
 
+unsigned int PointCloud3DIterator::getNextBlock(Coordinate* x, Coordinate* y, Coordinate* z, unsigned int maxCount) {
+	unsigned int count = 0;
+	BatchTransformation batchTransformation;
+
+	while ((count < maxCount) && !end()) {
+		unsigned int blockSize = std::min(maxCount - count, currentSize - index); // do not cross the border of a point cloud
+		if(*associatedTransformIsIdentityIterator == true) {
+			std::copy(currentX + index, currentX + index + blockSize, x + count);
+			std::copy(currentY + index, currentY + index + blockSize, y + count);
+			std::copy(currentZ + index, currentZ + index + blockSize, z + count);
+		} else {
+			batchTransformation.transform(pointCloudsIterator->second.get(), currentX + index, currentY + index, currentZ + index,
+					x + count, y + count, z + count, blockSize);
+		}
+		count += blockSize;
+		index += blockSize - 1;
+		next(); // handles the advance to the next point cloud
+	}
+
+	return count;
+}
+
+void PointCloud3DIterator::updateCurrentPointCloud() {
+	const PointCloud3DStorage* storage = pointCloudsIterator->first->getStorage();
+	currentX = storage->getRawX();
+	currentY = storage->getRawY();
+	currentZ = storage->getRawZ();
+	currentSize = storage->getSize();
+}
+
+void PointCloud3DIterator::updateCurrentPoint() {
+	currentTransformedPoint.setX(currentX[index]);
+	currentTransformedPoint.setY(currentY[index]);
+	currentTransformedPoint.setZ(currentZ[index]);
+	if(*associatedTransformIsIdentityIterator == false) { // the non "lazyness" case
+		currentTransformedPoint.homogeneousTransformation(pointCloudsIterator->second.get());
+	}
+}
+
 void PointCloud3DIterator::insert(PointCloud3D::PointCloud3DPtr pointCloud, IHomogeneousMatrix44::IHomogeneousMatrix44Ptr associatedTransform) {
 	assert(pointCloud != 0);
 	assert(associatedTransform != 0);
@@ -84,6 +84,7 @@ public:
 	virtual Coordinate getY(); // (possibly) transformed
 	virtual Coordinate getZ(); // (possibly) transformed
 	virtual Point3D* getRawData(); //not transformed, but might have additional data like color, etc.
+	virtual unsigned int getNextBlock(Coordinate* x, Coordinate* y, Coordinate* z, unsigned int maxCount);
 
 	/**
 	 * @brief Add a point cloud with its associated transform.
@@ -128,6 +129,20 @@ protected:
 
 	/// The cached data.
 	Point3D currentTransformedPoint;
+
+	/// Coordinate arrays of the storage of the current point cloud.
+	const Coordinate* currentX;
+	const Coordinate* currentY;
+	const Coordinate* currentZ;
+
+	/// Number of points in the current point cloud.
+	unsigned int currentSize;
+
+	/// Fetch the coordinate arrays of the current point cloud.
+	void updateCurrentPointCloud();
+
+	/// Update currentTransformedPoint with the point at the current index.
+	void updateCurrentPoint();
 };
 
 
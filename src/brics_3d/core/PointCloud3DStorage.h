@@ -0,0 +1,518 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#ifndef BRICS_3D_POINTCLOUD3DSTORAGE_H_
+#define BRICS_3D_POINTCLOUD3DSTORAGE_H_
+
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <assert.h>
+#include <string>
+#include <boost/shared_ptr.hpp>
+#include <boost/detail/atomic_count.hpp>
+
+#include "Point3D.h"
+#include "AlignedAllocator.h"
+
+namespace brics_3d {
+
+/**
+ * @brief Contiguous structure-of-arrays storage for the points of a brics_3d::PointCloud3D.
+ *
+ * The x, y and z coordinates are kept in three separate, contiguous arrays. Additional per point
+ * data can be attached as named channels, where each channel holds a fixed number of values per point.
+ * All arrays always have the same amount of points.
+ *
+ * The raw arrays can be directly handed to algorithms. That avoids to copy the coordinates
+ * out of the point cloud one (virtual) function call at a time and allows the compiler to
+ * vectorize loops over the data:
+ *
+ *  @code
+ *	const PointCloud3DStorage* storage = pointCloud->getStorage();
+ *	const Coordinate* x = storage->getRawX();
+ *	const Coordinate* y = storage->getRawY();
+ *	const Coordinate* z = storage->getRawZ();
+ *	for (unsigned int i = 0; i < storage->getSize(); ++i) {
+ *		sum += x[i] + y[i] + z[i];
+ *	}
+ * @endcode
+ *
+ * Copies of a storage share the arrays (copy-on-write): copying is a constant time operation and
+ * the arrays are only duplicated when one of the copies is accessed by a non-const function.
+ * Hence, prefer the const accessors for reading. Pointers returned by the non-const accessors
+ * must not be used anymore after the storage has been copied; request them again instead.
+ *
+ * The coordinate arrays and channels start at addresses that are aligned to coordinateAlignment bytes, so
+ * vectorized kernels can use aligned loads.
+ *
+ * Each state of the content is identified by a revision number (see getRevision()), so derived data like a
+ * search structure can be cached and only rebuilt if the points have changed.
+ *
+ * The template parameter defines the scalar type. brics_3d::PointCloud3DStorage uses the
+ * default brics_3d::Coordinate type, brics_3d::PointCloud3DStorageF is the single precision variant.
+ */
+template <typename T>
+class PointCloud3DStorageT {
+public:
+
+	/// Scalar type of the coordinates and channel values
+	typedef T ValueType;
+
+	/// Contiguous, aligned array of coordinates
+	typedef std::vector<T, AlignedAllocator<T> > CoordinateArray;
+
+	/**
+	 * @brief Standard constructor
+	 */
+	PointCloud3DStorageT();
+
+	/**
+	 * @brief Standard destructor
+	 */
+	virtual ~PointCloud3DStorageT();
+
+	/**
+	 * @brief Get the number of stored points
+	 */
+	inline unsigned int getSize() const {
+		return static_cast<unsigned int>(buffers->x.size());
+	}
+
+	/**
+	 * @brief Get the number of points that can be stored without further memory allocation.
+	 */
+	inline unsigned int getCapacity() const {
+		return static_cast<unsigned int>(buffers->x.capacity());
+	}
+
+	/**
+	 * @brief Pre-allocate memory for a given number of points (including all channels).
+	 * @param capacity Number of points.
+	 */
+	void reserve(unsigned int capacity);
+
+	/**
+	 * @brief Change the number of stored points. New points and channel values are set to zero.
+	 * @param size New number of points.
+	 */
+	void resize(unsigned int size);
+
+	/**
+	 * @brief Remove all points. Channels stay registered but will be empty.
+	 */
+	void clear();
+
+	/**
+	 * @brief Append a point. Values of all channels are set to zero for this point.
+	 */
+	inline void addPoint(T x, T y, T z) {
+		detach();
+		buffers->x.push_back(x);
+		buffers->y.push_back(y);
+		buffers->z.push_back(z);
+		if (!buffers->channels.empty()) {
+			appendChannelDefaults();
+		}
+	}
+
+	/**
+	 * @brief Append a set of points given as separate coordinate arrays. Values of all channels are set to zero for these points.
+	 * @param x Array of x coordinates with count elements.
+	 * @param y Array of y coordinates with count elements.
+	 * @param z Array of z coordinates with count elements.
+	 * @param count Number of points.
+	 */
+	void addPoints(const T* x, const T* y, const T* z, unsigned int count);
+
+	/**
+	 * @brief Exchange the content with another storage in constant time.
+	 */
+	void swap(PointCloud3DStorageT<T>& other);
+
+	/**
+	 * @brief Reorder the points together with the values of all channels.
+	 * @param order Original index of each point in the new order, i.e. point i is the former point order[i].
+	 *        Has to be a permutation of [0, getSize()).
+	 */
+	void permute(const std::vector<unsigned int>& order);
+
+	/**
+	 * @brief Overwrite the coordinates of the ith point.
+	 */
+	inline void setPoint(unsigned int index, T x, T y, T z) {
+		detach();
+		buffers->x[index] = x;
+		buffers->y[index] = y;
+		buffers->z[index] = z;
+	}
+
+	/// Get the pointer to the contiguous array of x coordinates.
+	inline T* getRawX() {
+		detach();
+		return buffers->x.empty() ? 0 : &buffers->x[0];
+	}
+
+	/// Get the pointer to the contiguous array of y coordinates.
+	inline T* getRawY() {
+		detach();
+		return buffers->y.empty() ? 0 : &buffers->y[0];
+	}
+
+	/// Get the pointer to the contiguous array of z coordinates.
+	inline T* getRawZ() {
+		detach();
+		return buffers->z.empty() ? 0 : &buffers->z[0];
+	}
+
+	/// Get the read-only pointer to the contiguous array of x coordinates.
+	inline const T* getRawX() const {
+		return buffers->x.empty() ? 0 : &buffers->x[0];
+	}
+
+	/// Get the read-only pointer to the contiguous array of y coordinates.
+	inline const T* getRawY() const {
+		return buffers->y.empty() ? 0 : &buffers->y[0];
+	}
+
+	/// Get the read-only pointer to the contiguous array of z coordinates.
+	inline const T* getRawZ() const {
+		return buffers->z.empty() ? 0 : &buffers->z[0];
+	}
+
+	/**
+	 * @brief Register a new channel for additional per point data.
+	 * Existing points get zero values. If a channel with that name already exists nothing happens.
+	 * @param name Unique name of the channel e.g. "curvature".
+	 * @param width Number of values per point e.g. 1 for scalars or 3 for vectors.
+	 */
+	void addChannel(std::string name, unsigned int width = 1);
+
+	/**
+	 * @brief Check if a channel is registered.
+	 */
+	bool hasChannel(std::string name) const;
+
+	/**
+	 * @brief Remove a channel and its data.
+	 */
+	void removeChannel(std::string name);
+
+	/**
+	 * @brief Get the number of values per point of a channel.
+	 * @return The width or 0 if no such channel exists.
+	 */
+	unsigned int getChannelWidth(std::string name) const;
+
+	/**
+	 * @brief Get the number of registered channels.
+	 */
+	inline unsigned int getNumberOfChannels() const {
+		return static_cast<unsigned int>(buffers->channels.size());
+	}
+
+	/**
+	 * @brief Get the names of all registered channels.
+	 */
+	void getChannelNames(std::vector<std::string>& names) const;
+
+	/**
+	 * @brief Get the contiguous data of a channel.
+	 * The values of the ith point are stored at [i * width, (i+1) * width).
+	 * @return Pointer to the data or null if there is no such channel or the storage is empty.
+	 */
+	T* getRawChannel(std::string name);
+
+	/**
+	 * @brief Get the read-only contiguous data of a channel.
+	 * @return Pointer to the data or null if there is no such channel or the storage is empty.
+	 */
+	const T* getRawChannel(std::string name) const;
+
+	/**
+	 * @brief Check if the arrays are currently shared with a copy of this storage.
+	 */
+	inline bool isShared() const {
+		return !buffers.unique();
+	}
+
+	/**
+	 * @brief Get an approximation of the consumed memory in bytes.
+	 * Shared arrays are accounted for in every storage that refers to them.
+	 */
+	unsigned long getMemoryFootprint() const;
+
+	/**
+	 * @brief Get a number that identifies the current content.
+	 *
+	 * Every modification (i.e. any call of a non-const function) leads to a new, process-wide unique revision.
+	 * Copies share the revision of the original until one of them is modified. Thus equal revisions imply
+	 * equal content. The revision is assigned by the modifying function, so this function only reads and can be
+	 * called concurrently with other const functions. Writing through a pointer that has been obtained by a
+	 * non-const accessor is not detected, so request such pointers again.
+	 */
+	inline unsigned long getRevision() const {
+		return revision;
+	}
+
+protected:
+
+	/// A named channel for additional per point data.
+	struct Channel {
+		/// Number of values per point.
+		unsigned int width;
+
+		/// The values, stored point by point.
+		CoordinateArray data;
+	};
+
+	/// All arrays of a storage. They can be shared between copies.
+	struct Buffers {
+		/// Contiguous array of x coordinates
+		CoordinateArray x;
+
+		/// Contiguous array of y coordinates
+		CoordinateArray y;
+
+		/// Contiguous array of z coordinates
+		CoordinateArray z;
+
+		/// Additional channels, indexed by their names.
+		std::map<std::string, Channel> channels;
+	};
+
+	/// Get a new, process-wide unique revision.
+	static unsigned long newRevision();
+
+	/// Make sure the arrays are not shared, before they are modified.
+	inline void detach() {
+		revision = newRevision();
+		if (!buffers.unique()) {
+			buffers.reset(new Buffers(*buffers));
+		}
+	}
+
+	/// Append zero values for one point to all channels.
+	void appendChannelDefaults();
+
+	/// The arrays. Copies of the storage share them until one of the copies is modified.
+	boost::shared_ptr<Buffers> buffers;
+
+	/// Revision of the content
+	unsigned long revision;
+
+};
+
+template <typename T>
+PointCloud3DStorageT<T>::PointCloud3DStorageT() : buffers(new Buffers()), revision(newRevision()) {
+
+}
+
+template <typename T>
+PointCloud3DStorageT<T>::~PointCloud3DStorageT() {
+
+}
+
+template <typename T>
+void PointCloud3DStorageT<T>::reserve(unsigned int capacity) {
+	detach();
+	buffers->x.reserve(capacity);
+	buffers->y.reserve(capacity);
+	buffers->z.reserve(capacity);
+	for (typename std::map<std::string, Channel>::iterator it = buffers->channels.begin(); it != buffers->channels.end(); ++it) {
+		it->second.data.reserve(capacity * it->second.width);
+	}
+}
+
+template <typename T>
+void PointCloud3DStorageT<T>::resize(unsigned int size) {
+	detach();
+	buffers->x.resize(size, 0);
+	buffers->y.resize(size, 0);
+	buffers->z.resize(size, 0);
+	for (typename std::map<std::string, Channel>::iterator it = buffers->channels.begin(); it != buffers->channels.end(); ++it) {
+		it->second.data.resize(size * it->second.width, 0);
+	}
+}
+
+template <typename T>
+void PointCloud3DStorageT<T>::clear() {
+	revision = newRevision();
+	if (!buffers.unique()) { // no need to copy data that will be removed anyway
+		boost::shared_ptr<Buffers> emptyBuffers(new Buffers());
+		for (typename std::map<std::string, Channel>::const_iterator it = buffers->channels.begin(); it != buffers->channels.end(); ++it) {
+			emptyBuffers->channels[it->first].width = it->second.width;
+		}
+		buffers = emptyBuffers;
+		return;
+	}
+	buffers->x.clear();
+	buffers->y.clear();
+	buffers->z.clear();
+	for (typename std::map<std::string, Channel>::iterator it = buffers->channels.begin(); it != buffers->channels.end(); ++it) {
+		it->second.data.clear();
+	}
+}
+
+template <typename T>
+void PointCloud3DStorageT<T>::addPoints(const T* x, const T* y, const T* z, unsigned int count) {
+	detach();
+	buffers->x.insert(buffers->x.end(), x, x + count);
+	buffers->y.insert(buffers->y.end(), y, y + count);
+	buffers->z.insert(buffers->z.end(), z, z + count);
+	for (typename std::map<std::string, Channel>::iterator it = buffers->channels.begin(); it != buffers->channels.end(); ++it) {
+		it->second.data.resize(buffers->x.size() * it->second.width, 0);
+	}
+}
+
+template <typename T>
+void PointCloud3DStorageT<T>::swap(PointCloud3DStorageT<T>& other) {
+	buffers.swap(other.buffers);
+	std::swap(revision, other.revision);
+}
+
+template <typename T>
+void PointCloud3DStorageT<T>::permute(const std::vector<unsigned int>& order) {
+	const Buffers& source = *buffers;
+	unsigned int size = static_cast<unsigned int>(order.size());
+	assert(size == getSize());
+
+	/* written into new buffers, so shared arrays are not copied first */
+	boost::shared_ptr<Buffers> permuted(new Buffers());
+	permuted->x.resize(size);
+	permuted->y.resize(size);
+	permuted->z.resize(size);
+	for (unsigned int i = 0; i < size; ++i) {
+		permuted->x[i] = source.x[order[i]];
+		permuted->y[i] = source.y[order[i]];
+		permuted->z[i] = source.z[order[i]];
+	}
+	for (typename std::map<std::string, Channel>::const_iterator it = source.channels.begin(); it != source.channels.end(); ++it) {
+		unsigned int width = it->second.width;
+		Channel& channel = permuted->channels[it->first];
+		channel.width = width;
+		channel.data.resize(size * width);
+		for (unsigned int i = 0; i < size; ++i) {
+			std::copy(it->second.data.begin() + width * order[i], it->second.data.begin() + width * (order[i] + 1), channel.data.begin() + width * i);
+		}
+	}
+	buffers = permuted;
+	revision = newRevision();
+}
+
+template <typename T>
+void PointCloud3DStorageT<T>::addChannel(std::string name, unsigned int width) {
+	if (hasChannel(name)) {
+		return;
+	}
+	detach();
+	Channel& channel = buffers->channels[name];
+	channel.width = width;
+	channel.data.reserve(buffers->x.capacity() * width);
+	channel.data.resize(buffers->x.size() * width, 0);
+}
+
+template <typename T>
+bool PointCloud3DStorageT<T>::hasChannel(std::string name) const {
+	return buffers->channels.find(name) != buffers->channels.end();
+}
+
+template <typename T>
+void PointCloud3DStorageT<T>::removeChannel(std::string name) {
+	if (!hasChannel(name)) {
+		return;
+	}
+	detach();
+	buffers->channels.erase(name);
+}
+
+template <typename T>
+unsigned int PointCloud3DStorageT<T>::getChannelWidth(std::string name) const {
+	typename std::map<std::string, Channel>::const_iterator it = buffers->channels.find(name);
+	if (it == buffers->channels.end()) {
+		return 0;
+	}
+	return it->second.width;
+}
+
+template <typename T>
+void PointCloud3DStorageT<T>::getChannelNames(std::vector<std::string>& names) const {
+	names.clear();
+	for (typename std::map<std::string, Channel>::const_iterator it = buffers->channels.begin(); it != buffers->channels.end(); ++it) {
+		names.push_back(it->first);
+	}
+}
+
+template <typename T>
+T* PointCloud3DStorageT<T>::getRawChannel(std::string name) {
+	if (!hasChannel(name)) {
+		return 0;
+	}
+	detach();
+	typename std::map<std::string, Channel>::iterator it = buffers->channels.find(name);
+	if (it->second.data.empty()) {
+		return 0;
+	}
+	return &(it->second.data[0]);
+}
+
+template <typename T>
+const T* PointCloud3DStorageT<T>::getRawChannel(std::string name) const {
+	typename std::map<std::string, Channel>::const_iterator it = buffers->channels.find(name);
+	if (it == buffers->channels.end() || it->second.data.empty()) {
+		return 0;
+	}
+	return &(it->second.data[0]);
+}
+
+template <typename T>
+unsigned long PointCloud3DStorageT<T>::getMemoryFootprint() const {
+	unsigned long bytes = sizeof(PointCloud3DStorageT<T>) + sizeof(Buffers);
+	bytes += (buffers->x.capacity() + buffers->y.capacity() + buffers->z.capacity()) * sizeof(T);
+	for (typename std::map<std::string, Channel>::const_iterator it = buffers->channels.begin(); it != buffers->channels.end(); ++it) {
+		bytes += it->second.data.capacity() * sizeof(T) + it->first.size();
+	}
+	return bytes;
+}
+
+template <typename T>
+unsigned long PointCloud3DStorageT<T>::newRevision() {
+	static boost::detail::atomic_count lastRevision(0);
+	return ++lastRevision;
+}
+
+template <typename T>
+void PointCloud3DStorageT<T>::appendChannelDefaults() {
+	for (typename std::map<std::string, Channel>::iterator it = buffers->channels.begin(); it != buffers->channels.end(); ++it) {
+		for (unsigned int i = 0; i < it->second.width; ++i) {
+			it->second.data.push_back(0);
+		}
+	}
+}
+
+typedef PointCloud3DStorageT<Coordinate> PointCloud3DStorage;
+
+/// Single precision storage
+typedef PointCloud3DStorageT<float> PointCloud3DStorageF;
+
+}
+
+#endif /* BRICS_3D_POINTCLOUD3DSTORAGE_H_ */
+
+/* EOF */
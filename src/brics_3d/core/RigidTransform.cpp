@@ -0,0 +1,190 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#include "RigidTransform.h"
+
+#include <cmath>
+
+namespace brics_3d {
+
+namespace {
+
+/*
+ * result = a * b for 3x4 column-major matrices with an implicit last row (0 0 0 1).
+ * result must not alias a or b. The loops work column wise on independent rows, so they
+ * are easy to vectorize for the compiler.
+ */
+inline void compose(const double* a, const double* b, double* result) {
+	for (int column = 0; column < 4; ++column) {
+		const double* bColumn = b + 3 * column;
+		double* resultColumn = result + 3 * column;
+		for (int row = 0; row < 3; ++row) {
+			resultColumn[row] = a[row] * bColumn[0] + a[3 + row] * bColumn[1] + a[6 + row] * bColumn[2];
+		}
+	}
+	for (int row = 0; row < 3; ++row) {
+		result[9 + row] += a[9 + row];
+	}
+}
+
+}
+
+RigidTransform::RigidTransform() {
+	setIdentity();
+}
+
+RigidTransform::RigidTransform(const IHomogeneousMatrix44& matrix) {
+	fromMatrix(matrix);
+}
+
+RigidTransform::RigidTransform(double r0, double r1, double r2, double r3, double r4, double r5, double r6, double r7, double r8, double t0, double t1, double t2) {
+	data[0] = r0;
+	data[3] = r1;
+	data[6] = r2;
+	data[1] = r3;
+	data[4] = r4;
+	data[7] = r5;
+	data[2] = r6;
+	data[5] = r7;
+	data[8] = r8;
+	data[9] = t0;
+	data[10] = t1;
+	data[11] = t2;
+}
+
+void RigidTransform::setIdentity() {
+	for (int i = 0; i < numberOfElements; ++i) {
+		data[i] = 0.0;
+	}
+	data[0] = 1.0;
+	data[4] = 1.0;
+	data[8] = 1.0;
+}
+
+void RigidTransform::fromMatrix(const IHomogeneousMatrix44& matrix) {
+	const double* matrixData = matrix.getRawData();
+	for (int column = 0; column < 4; ++column) {
+		for (int row = 0; row < 3; ++row) {
+			data[3 * column + row] = matrixData[4 * column + row];
+		}
+	}
+}
+
+void RigidTransform::toMatrix(IHomogeneousMatrix44* matrix) const {
+	double* matrixData = matrix->setRawData();
+	for (int column = 0; column < 4; ++column) {
+		for (int row = 0; row < 3; ++row) {
+			matrixData[4 * column + row] = data[3 * column + row];
+		}
+	}
+	matrixData[3] = 0.0;
+	matrixData[7] = 0.0;
+	matrixData[11] = 0.0;
+	matrixData[15] = 1.0;
+}
+
+const double* RigidTransform::getRawData() const {
+	return data;
+}
+
+double* RigidTransform::setRawData() {
+	return data;
+}
+
+RigidTransform RigidTransform::operator*(const RigidTransform& other) const {
+	RigidTransform result;
+	compose(data, other.data, result.data);
+	return result;
+}
+
+RigidTransform& RigidTransform::operator*=(const RigidTransform& other) {
+	double result[numberOfElements];
+	compose(data, other.data, result);
+	for (int i = 0; i < numberOfElements; ++i) {
+		data[i] = result[i];
+	}
+	return *this;
+}
+
+RigidTransform RigidTransform::inverse() const {
+	RigidTransform result;
+	double* inverted = result.data;
+
+	/* R^T */
+	for (int column = 0; column < 3; ++column) {
+		for (int row = 0; row < 3; ++row) {
+			inverted[3 * column + row] = data[3 * row + column];
+		}
+	}
+
+	/* -R^T * t */
+	for (int row = 0; row < 3; ++row) {
+		inverted[9 + row] = -(inverted[row] * data[9] + inverted[3 + row] * data[10] + inverted[6 + row] * data[11]);
+	}
+
+	return result;
+}
+
+bool RigidTransform::isRigid(const IHomogeneousMatrix44& matrix, double precision) {
+	const double* matrixData = matrix.getRawData();
+
+	/* last row (column-major 4x4 layout) */
+	if (std::fabs(matrixData[3]) > precision || std::fabs(matrixData[7]) > precision || std::fabs(matrixData[11]) > precision
+			|| std::fabs(matrixData[15] - 1.0) > precision) {
+		return false;
+	}
+
+	/* orthonormal columns of the rotation part */
+	for (int i = 0; i < 3; ++i) {
+		for (int j = i; j < 3; ++j) {
+			double dot = matrixData[4 * i] * matrixData[4 * j] + matrixData[4 * i + 1] * matrixData[4 * j + 1]
+					+ matrixData[4 * i + 2] * matrixData[4 * j + 2];
+			double expected = (i == j) ? 1.0 : 0.0;
+			if (std::fabs(dot - expected) > precision) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+void RigidTransform::transformPoint(double& x, double& y, double& z) const {
+	double xTemp = data[0] * x + data[3] * y + data[6] * z + data[9];
+	double yTemp = data[1] * x + data[4] * y + data[7] * z + data[10];
+	double zTemp = data[2] * x + data[5] * y + data[8] * z + data[11];
+	x = xTemp;
+	y = yTemp;
+	z = zTemp;
+}
+
+bool RigidTransform::isIdentity(double precision) const {
+	for (int column = 0; column < 4; ++column) {
+		for (int row = 0; row < 3; ++row) {
+			double expected = (column == row) ? 1.0 : 0.0;
+			if (std::fabs(data[3 * column + row] - expected) > precision) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+}
+
+/* EOF */
@@ -0,0 +1,147 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#ifndef BRICS_3D_RIGIDTRANSFORM_H_
+#define BRICS_3D_RIGIDTRANSFORM_H_
+
+#include "IHomogeneousMatrix44.h"
+
+namespace brics_3d {
+
+/**
+ * @brief Fixed size value type for a rigid 3D transformation.
+ *
+ * In contrast to IHomogeneousMatrix44 this class is not polymorphic and can be placed on the stack, so
+ * chains of transformations can be composed without any heap allocations. It only stores the upper 3x4 part
+ * of a homogeneous matrix, the last row is always (0 0 0 1).
+ *
+ * The 12 values are stored in column-major order:
+ * 0 3 6 9 <br>
+ * 1 4 7 10 <br>
+ * 2 5 8 11 <br>
+ *
+ * Conversions from and to the IHomogeneousMatrix44 interface are provided, so this type can be used internally
+ * while the public interfaces keep using IHomogeneousMatrix44::IHomogeneousMatrix44Ptr.
+ *
+ * Example:
+ * @code
+ * RigidTransform accumulated; // identity
+ * for (unsigned int i = 0; i < transforms.size(); ++i) {
+ *     accumulated *= RigidTransform(*transforms[i]);
+ * }
+ * accumulated.toMatrix(resultMatrix);
+ * @endcode
+ */
+class RigidTransform {
+public:
+
+	/// Number of stored elements (3x4).
+	static const int numberOfElements = 12;
+
+	/**
+	 * @brief Default constructor. Creates an identity transformation.
+	 */
+	RigidTransform();
+
+	/**
+	 * @brief Constructor that copies the upper 3x4 part of a homogeneous matrix.
+	 *
+	 * The last row of the matrix is ignored. Use isRigid() to check if a matrix can be represented.
+	 */
+	explicit RigidTransform(const IHomogeneousMatrix44& matrix);
+
+	/**
+	 * @brief Constructor with a rotation (row by row, as in the HomogeneousMatrix44 constructor) and a translation.
+	 */
+	RigidTransform(double r0, double r1, double r2, double r3, double r4, double r5, double r6, double r7, double r8, double t0, double t1, double t2);
+
+	/**
+	 * @brief Set to identity.
+	 */
+	void setIdentity();
+
+	/**
+	 * @brief Copy the upper 3x4 part of a homogeneous matrix.
+	 */
+	void fromMatrix(const IHomogeneousMatrix44& matrix);
+
+	/**
+	 * @brief Write this transformation into a homogeneous matrix. All 16 elements will be set.
+	 */
+	void toMatrix(IHomogeneousMatrix44* matrix) const;
+
+	/**
+	 * @brief Returns a pointer to the 12 values in column-major order.
+	 */
+	const double* getRawData() const;
+
+	/**
+	 * @brief Returns a pointer to the writable 12 values in column-major order.
+	 */
+	double* setRawData();
+
+	/**
+	 * @brief Compose two transformations. The result is this * other, i.e. other is applied first.
+	 */
+	RigidTransform operator*(const RigidTransform& other) const;
+
+	/**
+	 * @brief Compose in place: this = this * other.
+	 */
+	RigidTransform& operator*=(const RigidTransform& other);
+
+	/**
+	 * @brief Returns the inverse transformation.
+	 *
+	 * The rotation part is assumed to be orthonormal, so the inverse is computed as [R^T | -R^T t].
+	 */
+	RigidTransform inverse() const;
+
+	/**
+	 * @brief Check if a homogeneous matrix is a rigid transformation.
+	 *
+	 * That is the case if the rotation part is orthonormal and the last row is (0 0 0 1). Only then the matrix
+	 * is represented exactly by a RigidTransform and inverse() is valid.
+	 * @param matrix The matrix to check.
+	 * @param precision Maximal absolute deviation per element.
+	 */
+	static bool isRigid(const IHomogeneousMatrix44& matrix, double precision = 0.00001);
+
+	/**
+	 * @brief Apply the transformation to a single point.
+	 */
+	void transformPoint(double& x, double& y, double& z) const;
+
+	/**
+	 * @brief Quick check if this transformation is approximately the identity.
+	 * @param precision Maximal absolute deviation per element.
+	 */
+	bool isIdentity(double precision = 0.00001) const;
+
+private:
+
+	/// 3x4 values in column-major order
+	double data[numberOfElements];
+};
+
+}
+
+#endif /* BRICS_3D_RIGIDTRANSFORM_H_ */
+
+/* EOF */
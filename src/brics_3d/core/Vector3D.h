@@ -32,10 +32,13 @@ namespace brics_3d {
  *
  * This typedef represents the a Cartesian coordinate.
  * Typically it is a set to a double, but it can be changed to float
- * if needed. Use redefinition with care.
+ * with the BRICS_3D_USE_FLOAT_COORDINATES compile flag. Has to be consistent with Point3D.h.
  */
+#ifdef BRICS_3D_USE_FLOAT_COORDINATES
+typedef float	Coordinate;				// coordinate data type
+#else
 typedef double	Coordinate;				// coordinate data type
-//typedef float	Coordinate;				// coordinate data type
+#endif
 
 
 class Vector3D {
@@ -406,8 +406,13 @@ public:
 			/* as there is no zize method in the iterator we have to loop ofer it a priori */
 			int numberOfPoints = 0;
 			IPoint3DIterator::IPoint3DIteratorPtr it = shape->getPointCloudIterator();
-			for (it->begin(); !it->end(); it->next()) {
-				numberOfPoints++;
+			Coordinate blockX[IPoint3DIterator::defaultBlockSize];
+			Coordinate blockY[IPoint3DIterator::defaultBlockSize];
+			Coordinate blockZ[IPoint3DIterator::defaultBlockSize];
+			unsigned int blockSize;
+			it->begin();
+			while ((blockSize = it->getNextBlock(blockX, blockY, blockZ, IPoint3DIterator::defaultBlockSize)) > 0) {
+				numberOfPoints += static_cast<int>(blockSize);
 			}
 			LOG(DEBUG) << "numberOfPoints = " << numberOfPoints;
 
@@ -148,6 +148,9 @@ PointCloud3D* IpaDatasetLoader::getPointCloud() {
 PointCloud3D* IpaDatasetLoader::getColoredPointCloud() {
 
 	PointCloud3D* pointCloud = new PointCloud3D();
+	PointCloud3DStorage* storage = pointCloud->getMutableStorage(); // colors go directly into the channel
+	storage->addChannel(PointCloud3D::rgbChannel, 3);
+	storage->reserve(xyzImage->height * xyzImage->width);
 
 	double x = 0.0;
 	double y = 0.0;
@@ -163,7 +166,11 @@ PointCloud3D* IpaDatasetLoader::getColoredPointCloud() {
 			this->getData(row, col, x, y, z, red, green, blue);
 
 			if (!((red == 0) && (green == 0) && (blue == 0))) { //discard "black" points as they don't belong to the object itself
-				pointCloud->addPointPtr(new ColoredPoint3D(new Point3D(x, y, z), red, green, blue));
+				storage->addPoint(x, y, z);
+				Coordinate* rgb = storage->getRawChannel(PointCloud3D::rgbChannel) + 3 * (storage->getSize() - 1);
+				rgb[0] = red;
+				rgb[1] = green;
+				rgb[2] = blue;
 			}
 		}
 	}
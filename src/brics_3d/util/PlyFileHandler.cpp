@@ -0,0 +1,493 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#include "PlyFileHandler.h"
+#include "brics_3d/core/Logger.h"
+#include "brics_3d/core/AsciiPointParser.h"
+#include "brics_3d/core/MappedFile.h"
+
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <algorithm>
+#include <assert.h>
+
+using namespace std;
+
+namespace brics_3d {
+
+namespace {
+
+inline bool isLittleEndianHost() {
+	const unsigned short probe = 1;
+	return *reinterpret_cast<const unsigned char*>(&probe) == 1;
+}
+
+inline void swapByteOrder(char* bytes, unsigned int size) {
+	for (unsigned int i = 0; i < size / 2; ++i) {
+		char tmp = bytes[i];
+		bytes[i] = bytes[size - 1 - i];
+		bytes[size - 1 - i] = tmp;
+	}
+}
+
+template <typename T>
+inline void putValue(char*& cursor, T value, bool swapBytes) {
+	memcpy(cursor, &value, sizeof(T));
+	if (swapBytes) {
+		swapByteOrder(cursor, sizeof(T));
+	}
+	cursor += sizeof(T);
+}
+
+int findProperty(const std::vector<std::string>& names, std::string name) {
+	for (unsigned int i = 0; i < names.size(); ++i) {
+		if (names[i] == name) {
+			return static_cast<int>(i);
+		}
+	}
+	return -1;
+}
+
+}
+
+PlyFileHandler::PlyFileHandler() {
+	useDoublePrecision = false;
+}
+
+PlyFileHandler::~PlyFileHandler() {
+
+}
+
+bool PlyFileHandler::read(std::string filename, PointCloud3D* pointCloud) {
+	assert(pointCloud != 0);
+
+	MappedFile file;
+	if (!file.open(filename)) {
+		LOG(ERROR) << "Cannot open PLY file " << filename;
+		return false;
+	}
+	LOG(INFO) << "Reading point cloud from: " << filename;
+
+	PlyHeader header;
+	unsigned long dataOffset = parseHeader(file.data, file.size, header);
+	if (dataOffset == 0) {
+		LOG(ERROR) << "Invalid or unsupported PLY header in " << filename;
+		return false;
+	}
+
+	/* map the properties */
+	std::vector<std::string> names;
+	for (unsigned int i = 0; i < header.vertexProperties.size(); ++i) {
+		names.push_back(header.vertexProperties[i].name);
+	}
+	int xIndex = findProperty(names, "x");
+	int yIndex = findProperty(names, "y");
+	int zIndex = findProperty(names, "z");
+	int redIndex = findProperty(names, "red");
+	int greenIndex = findProperty(names, "green");
+	int blueIndex = findProperty(names, "blue");
+	int nxIndex = findProperty(names, "nx");
+	int nyIndex = findProperty(names, "ny");
+	int nzIndex = findProperty(names, "nz");
+	int intensityIndex = findProperty(names, "intensity");
+
+	if (xIndex < 0 || yIndex < 0 || zIndex < 0) {
+		LOG(ERROR) << "PLY file " << filename << " has no x, y and z vertex properties.";
+		return false;
+	}
+	bool hasColor = (redIndex >= 0 && greenIndex >= 0 && blueIndex >= 0);
+	bool hasNormal = (nxIndex >= 0 && nyIndex >= 0 && nzIndex >= 0);
+	bool hasIntensity = (intensityIndex >= 0);
+
+	unsigned int vertexCount = header.vertexCount;
+	const char* record = file.data + dataOffset;
+	const char* dataEnd = file.data + file.size;
+	bool swapBytes = false;
+	if (header.format != PLY_ASCII) {
+		if (dataOffset + static_cast<unsigned long>(vertexCount) * header.vertexSize > file.size) {
+			LOG(ERROR) << "PLY file " << filename << " is truncated.";
+			return false;
+		}
+		swapBytes = ((header.format == PLY_BINARY_LITTLE_ENDIAN) != isLittleEndianHost());
+	}
+
+	/* the points are directly appended to the storage, the attributes go into the according channels */
+	PointCloud3DStorage* storage = pointCloud->getMutableStorage();
+	if (hasColor) {
+		storage->addChannel(PointCloud3D::rgbChannel, 3);
+	}
+	if (hasNormal) {
+		storage->addChannel(PointCloud3D::normalChannel, 3);
+	}
+	if (hasIntensity) {
+		storage->addChannel(PointCloud3D::intensityChannel, 1);
+	}
+	unsigned int offset = storage->getSize();
+	storage->resize(offset + vertexCount);
+	Coordinate* x = storage->getRawX() + offset;
+	Coordinate* y = storage->getRawY() + offset;
+	Coordinate* z = storage->getRawZ() + offset;
+	Coordinate* rgb = hasColor ? storage->getRawChannel(PointCloud3D::rgbChannel) + 3 * offset : 0;
+	Coordinate* normal = hasNormal ? storage->getRawChannel(PointCloud3D::normalChannel) + 3 * offset : 0;
+	Coordinate* intensity = hasIntensity ? storage->getRawChannel(PointCloud3D::intensityChannel) + offset : 0;
+
+	if (header.format != PLY_ASCII) {
+		const std::vector<PlyProperty>& properties = header.vertexProperties;
+		for (unsigned int i = 0; i < vertexCount; ++i) {
+			x[i] = static_cast<Coordinate>(readValue(record + properties[xIndex].offset, properties[xIndex].type, swapBytes));
+			y[i] = static_cast<Coordinate>(readValue(record + properties[yIndex].offset, properties[yIndex].type, swapBytes));
+			z[i] = static_cast<Coordinate>(readValue(record + properties[zIndex].offset, properties[zIndex].type, swapBytes));
+			if (hasColor) {
+				rgb[3 * i] = static_cast<Coordinate>(readValue(record + properties[redIndex].offset, properties[redIndex].type, swapBytes));
+				rgb[3 * i + 1] = static_cast<Coordinate>(readValue(record + properties[greenIndex].offset, properties[greenIndex].type, swapBytes));
+				rgb[3 * i + 2] = static_cast<Coordinate>(readValue(record + properties[blueIndex].offset, properties[blueIndex].type, swapBytes));
+			}
+			if (hasNormal) {
+				normal[3 * i] = static_cast<Coordinate>(readValue(record + properties[nxIndex].offset, properties[nxIndex].type, swapBytes));
+				normal[3 * i + 1] = static_cast<Coordinate>(readValue(record + properties[nyIndex].offset, properties[nyIndex].type, swapBytes));
+				normal[3 * i + 2] = static_cast<Coordinate>(readValue(record + properties[nzIndex].offset, properties[nzIndex].type, swapBytes));
+			}
+			if (hasIntensity) {
+				intensity[i] = static_cast<Coordinate>(readValue(record + properties[intensityIndex].offset, properties[intensityIndex].type, swapBytes));
+			}
+			record += header.vertexSize;
+		}
+		return true;
+	}
+
+	std::vector<double> values(header.vertexProperties.size(), 0.0);
+	for (unsigned int i = 0; i < vertexCount; ++i) {
+		for (unsigned int j = 0; j < values.size(); ++j) {
+			while (record < dataEnd && (*record == '\n' || *record == '\r')) {
+				++record;
+			}
+			if (!AsciiPointParser::parseNumber(record, dataEnd, values[j])) {
+				LOG(ERROR) << "Cannot read vertex " << i << " of PLY file " << filename;
+				storage->resize(offset);
+				return false;
+			}
+		}
+		x[i] = static_cast<Coordinate>(values[xIndex]);
+		y[i] = static_cast<Coordinate>(values[yIndex]);
+		z[i] = static_cast<Coordinate>(values[zIndex]);
+		if (hasColor) {
+			rgb[3 * i] = static_cast<Coordinate>(values[redIndex]);
+			rgb[3 * i + 1] = static_cast<Coordinate>(values[greenIndex]);
+			rgb[3 * i + 2] = static_cast<Coordinate>(values[blueIndex]);
+		}
+		if (hasNormal) {
+			normal[3 * i] = static_cast<Coordinate>(values[nxIndex]);
+			normal[3 * i + 1] = static_cast<Coordinate>(values[nyIndex]);
+			normal[3 * i + 2] = static_cast<Coordinate>(values[nzIndex]);
+		}
+		if (hasIntensity) {
+			intensity[i] = static_cast<Coordinate>(values[intensityIndex]);
+		}
+	}
+
+	return true;
+}
+
+bool PlyFileHandler::write(std::string filename, PointCloud3D* pointCloud) {
+	assert(pointCloud != 0);
+
+	const PointCloud3DStorage* storage = pointCloud->getStorage();
+	const Coordinate* x = storage->getRawX();
+	const Coordinate* y = storage->getRawY();
+	const Coordinate* z = storage->getRawZ();
+	const Coordinate* rgb = storage->getRawChannel(PointCloud3D::rgbChannel);
+	const Coordinate* normal = storage->getRawChannel(PointCloud3D::normalChannel);
+	const Coordinate* intensity = storage->getRawChannel(PointCloud3D::intensityChannel);
+	bool hasColor = (rgb != 0);
+	bool hasNormal = (normal != 0);
+	bool hasIntensity = (intensity != 0);
+	unsigned int vertexCount = storage->getSize();
+
+	ofstream outputFile(filename.c_str(), ios::out | ios::binary);
+	if (!outputFile.is_open()) {
+		LOG(ERROR) << "Cannot write PLY file " << filename;
+		return false;
+	}
+	LOG(INFO) << "Saving point cloud to: " << filename;
+
+	/* write ply header */
+	string coordinateType = useDoublePrecision ? "double" : "float";
+	outputFile << "ply\n";
+	outputFile << "format binary_little_endian 1.0\n";
+	outputFile << "comment created by brics_3d::PlyFileHandler\n";
+	outputFile << "element vertex " << vertexCount << "\n";
+	outputFile << "property " << coordinateType << " x\n";
+	outputFile << "property " << coordinateType << " y\n";
+	outputFile << "property " << coordinateType << " z\n";
+	if (hasNormal) {
+		outputFile << "property float nx\n";
+		outputFile << "property float ny\n";
+		outputFile << "property float nz\n";
+	}
+	if (hasIntensity) {
+		outputFile << "property float intensity\n";
+	}
+	if (hasColor) {
+		outputFile << "property uchar red\n";
+		outputFile << "property uchar green\n";
+		outputFile << "property uchar blue\n";
+	}
+	outputFile << "end_header\n";
+
+	/* write the vertex block in chunks */
+	const bool swapBytes = !isLittleEndianHost();
+	const unsigned int recordSize = 3 * (useDoublePrecision ? sizeof(double) : sizeof(float))
+			+ (hasNormal ? 3 * sizeof(float) : 0)
+			+ (hasIntensity ? sizeof(float) : 0)
+			+ (hasColor ? 3 * sizeof(unsigned char) : 0);
+	const unsigned int recordsPerChunk = 65536;
+	std::vector<char> buffer(recordSize * recordsPerChunk);
+
+	for (unsigned int chunkBegin = 0; chunkBegin < vertexCount; chunkBegin += recordsPerChunk) {
+		unsigned int chunkEnd = std::min(chunkBegin + recordsPerChunk, vertexCount);
+		char* cursor = &buffer[0];
+		for (unsigned int i = chunkBegin; i < chunkEnd; ++i) {
+			if (useDoublePrecision) {
+				putValue<double>(cursor, x[i], swapBytes);
+				putValue<double>(cursor, y[i], swapBytes);
+				putValue<double>(cursor, z[i], swapBytes);
+			} else {
+				putValue<float>(cursor, static_cast<float>(x[i]), swapBytes);
+				putValue<float>(cursor, static_cast<float>(y[i]), swapBytes);
+				putValue<float>(cursor, static_cast<float>(z[i]), swapBytes);
+			}
+			if (hasNormal) {
+				putValue<float>(cursor, static_cast<float>(normal[3 * i]), swapBytes);
+				putValue<float>(cursor, static_cast<float>(normal[3 * i + 1]), swapBytes);
+				putValue<float>(cursor, static_cast<float>(normal[3 * i + 2]), swapBytes);
+			}
+			if (hasIntensity) {
+				putValue<float>(cursor, static_cast<float>(intensity[i]), swapBytes);
+			}
+			if (hasColor) {
+				putValue<unsigned char>(cursor, static_cast<unsigned char>(rgb[3 * i]), false);
+				putValue<unsigned char>(cursor, static_cast<unsigned char>(rgb[3 * i + 1]), false);
+				putValue<unsigned char>(cursor, static_cast<unsigned char>(rgb[3 * i + 2]), false);
+			}
+		}
+		outputFile.write(&buffer[0], cursor - &buffer[0]);
+	}
+
+	outputFile.close();
+	return !outputFile.fail();
+}
+
+bool PlyFileHandler::getUseDoublePrecision() const {
+	return useDoublePrecision;
+}
+
+void PlyFileHandler::setUseDoublePrecision(bool useDoublePrecision) {
+	this->useDoublePrecision = useDoublePrecision;
+}
+
+unsigned long PlyFileHandler::parseHeader(const char* data, unsigned long size, PlyHeader& header) {
+	header.format = PLY_ASCII;
+	header.vertexCount = 0;
+	header.vertexSize = 0;
+	header.vertexProperties.clear();
+
+	unsigned long position = 0;
+	bool isFirstLine = true;
+	bool formatFound = false;
+	bool vertexElementFound = false;
+	bool isVertexElement = false;
+
+	while (position < size) {
+		unsigned long lineEnd = position;
+		while (lineEnd < size && data[lineEnd] != '\n') {
+			++lineEnd;
+		}
+		if (lineEnd >= size) {
+			return 0; // header is not terminated
+		}
+		std::string line(data + position, lineEnd - position);
+		if (!line.empty() && line[line.size() - 1] == '\r') {
+			line.erase(line.size() - 1);
+		}
+		position = lineEnd + 1;
+
+		std::istringstream lineStream(line);
+		std::string keyword;
+		lineStream >> keyword;
+
+		if (isFirstLine) {
+			if (keyword != "ply") {
+				return 0;
+			}
+			isFirstLine = false;
+		} else if (keyword == "format") {
+			std::string format;
+			lineStream >> format;
+			if (format == "ascii") {
+				header.format = PLY_ASCII;
+			} else if (format == "binary_little_endian") {
+				header.format = PLY_BINARY_LITTLE_ENDIAN;
+			} else if (format == "binary_big_endian") {
+				header.format = PLY_BINARY_BIG_ENDIAN;
+			} else {
+				return 0;
+			}
+			formatFound = true;
+		} else if (keyword == "element") {
+			std::string name;
+			unsigned long count = 0;
+			lineStream >> name >> count;
+			isVertexElement = (name == "vertex");
+			if (isVertexElement) {
+				header.vertexCount = static_cast<unsigned int>(count);
+				vertexElementFound = true;
+			} else if (!vertexElementFound && count > 0) {
+				LOG(ERROR) << "PLY elements in front of the vertex element are not supported.";
+				return 0;
+			}
+		} else if (keyword == "property") {
+			if (!isVertexElement) {
+				continue; // properties of e.g. faces are not relevant
+			}
+			std::string typeName;
+			lineStream >> typeName;
+			if (typeName == "list") {
+				LOG(ERROR) << "PLY list properties of vertices are not supported.";
+				return 0;
+			}
+			PlyProperty property;
+			property.type = getType(typeName);
+			if (property.type == PLY_INVALID) {
+				LOG(ERROR) << "Unknown PLY property type " << typeName;
+				return 0;
+			}
+			lineStream >> property.name;
+			property.offset = header.vertexSize;
+			header.vertexSize += getTypeSize(property.type);
+			header.vertexProperties.push_back(property);
+		} else if (keyword == "end_header") {
+			if (!formatFound || !vertexElementFound) {
+				return 0;
+			}
+			return position;
+		}
+		// comment and obj_info lines are ignored
+	}
+
+	return 0;
+}
+
+PlyFileHandler::PlyType PlyFileHandler::getType(std::string typeName) {
+	if (typeName == "char" || typeName == "int8") {
+		return PLY_INT8;
+	} else if (typeName == "uchar" || typeName == "uint8") {
+		return PLY_UINT8;
+	} else if (typeName == "short" || typeName == "int16") {
+		return PLY_INT16;
+	} else if (typeName == "ushort" || typeName == "uint16") {
+		return PLY_UINT16;
+	} else if (typeName == "int" || typeName == "int32") {
+		return PLY_INT32;
+	} else if (typeName == "uint" || typeName == "uint32") {
+		return PLY_UINT32;
+	} else if (typeName == "float" || typeName == "float32") {
+		return PLY_FLOAT32;
+	} else if (typeName == "double" || typeName == "float64") {
+		return PLY_FLOAT64;
+	}
+	return PLY_INVALID;
+}
+
+unsigned int PlyFileHandler::getTypeSize(PlyType type) {
+	switch (type) {
+	case PLY_INT8:
+	case PLY_UINT8:
+		return 1;
+	case PLY_INT16:
+	case PLY_UINT16:
+		return 2;
+	case PLY_INT32:
+	case PLY_UINT32:
+	case PLY_FLOAT32:
+		return 4;
+	case PLY_FLOAT64:
+		return 8;
+	default:
+		return 0;
+	}
+}
+
+double PlyFileHandler::readValue(const char* data, PlyType type, bool swapBytes) {
+	char bytes[8];
+	unsigned int size = getTypeSize(type);
+	memcpy(bytes, data, size);
+	if (swapBytes) {
+		swapByteOrder(bytes, size);
+	}
+
+	switch (type) {
+	case PLY_INT8: {
+		signed char value;
+		memcpy(&value, bytes, sizeof(value));
+		return value;
+	}
+	case PLY_UINT8: {
+		unsigned char value;
+		memcpy(&value, bytes, sizeof(value));
+		return value;
+	}
+	case PLY_INT16: {
+		short value;
+		memcpy(&value, bytes, sizeof(value));
+		return value;
+	}
+	case PLY_UINT16: {
+		unsigned short value;
+		memcpy(&value, bytes, sizeof(value));
+		return value;
+	}
+	case PLY_INT32: {
+		int value;
+		memcpy(&value, bytes, sizeof(value));
+		return value;
+	}
+	case PLY_UINT32: {
+		unsigned int value;
+		memcpy(&value, bytes, sizeof(value));
+		return value;
+	}
+	case PLY_FLOAT32: {
+		float value;
+		memcpy(&value, bytes, sizeof(value));
+		return value;
+	}
+	case PLY_FLOAT64: {
+		double value;
+		memcpy(&value, bytes, sizeof(value));
+		return value;
+	}
+	default:
+		return 0.0;
+	}
+}
+
+}
+
+/* EOF */
@@ -0,0 +1,146 @@
+/******************************************************************************
+* BRICS_3D - 3D Perception and Modeling Library
+* Copyright (c) 2011, GPS GmbH
+*
+* Author: Sebastian Blumenthal
+*
+*
+* This software is published under a dual-license: GNU Lesser General Public
+* License LGPL 2.1 and Modified BSD license. The dual-license implies that
+* users of this code may choose which terms they prefer.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License LGPL and the BSD license for
+* more details.
+*
+******************************************************************************/
+
+#ifndef BRICS_3D_PLYFILEHANDLER_H_
+#define BRICS_3D_PLYFILEHANDLER_H_
+
+#include <string>
+#include <vector>
+
+#include "brics_3d/core/PointCloud3D.h"
+
+namespace brics_3d {
+
+/**
+ * @brief Reads and writes point clouds in the PLY (Stanford polygon) file format.
+ *
+ * Supported are the vertex elements of ascii, binary_little_endian and binary_big_endian files.
+ * Besides the x, y and z coordinates the following optional vertex properties are mapped to channels
+ * of the brics_3d::PointCloud3DStorage:
+ *  - red, green, blue   -> PointCloud3D::rgbChannel
+ *  - nx, ny, nz         -> PointCloud3D::normalChannel
+ *  - intensity          -> PointCloud3D::intensityChannel
+ *
+ * Other properties are skipped. The reader maps the file into memory and converts the binary vertex block
+ * record by record without any token parsing directly into the storage of the point cloud.
+ *
+ * The writer always produces binary_little_endian files. The written properties are deduced from
+ * the channels of the point cloud.
+ */
+class PlyFileHandler {
+public:
+
+	/**
+	 * @brief Standard constructor
+	 */
+	PlyFileHandler();
+
+	/**
+	 * @brief Standard destructor
+	 */
+	virtual ~PlyFileHandler();
+
+	/**
+	 * @brief Reads the vertices of a PLY file and appends them to a point cloud.
+	 * @param filename Name of the file e.g. point_cloud.ply
+	 * @param[out] pointCloud The point cloud where the points will be added.
+	 * @return True on success, false if the file could not be opened or has an unsupported format.
+	 */
+	bool read(std::string filename, PointCloud3D* pointCloud);
+
+	/**
+	 * @brief Writes a point cloud as binary_little_endian PLY file.
+	 * @param filename Name of the file e.g. point_cloud.ply
+	 * @param pointCloud The point cloud that will be stored.
+	 * @return True on success, false if the file could not be written.
+	 */
+	bool write(std::string filename, PointCloud3D* pointCloud);
+
+	/**
+	 * @brief If true the coordinates are written as double values, otherwise as float values. Default is false.
+	 */
+	bool getUseDoublePrecision() const;
+
+	void setUseDoublePrecision(bool useDoublePrecision);
+
+protected:
+
+	/// Scalar types of PLY properties.
+	enum PlyType {
+		PLY_INT8,
+		PLY_UINT8,
+		PLY_INT16,
+		PLY_UINT16,
+		PLY_INT32,
+		PLY_UINT32,
+		PLY_FLOAT32,
+		PLY_FLOAT64,
+		PLY_INVALID
+	};
+
+	/// Encoding of the data section.
+	enum PlyFormat {
+		PLY_ASCII,
+		PLY_BINARY_LITTLE_ENDIAN,
+		PLY_BINARY_BIG_ENDIAN
+	};
+
+	/// A single property of the vertex element.
+	struct PlyProperty {
+		std::string name;
+		PlyType type;
+		unsigned int offset; // byte offset within a binary vertex record
+	};
+
+	/// The relevant parts of a PLY header.
+	struct PlyHeader {
+		PlyFormat format;
+		unsigned int vertexCount;
+		unsigned int vertexSize; // size in bytes of a binary vertex record
+		std::vector<PlyProperty> vertexProperties;
+	};
+
+	/**
+	 * @brief Parse the header.
+	 * @param data Begin of the file.
+	 * @param size Size of the file in bytes.
+	 * @param[out] header The parsed header.
+	 * @return Offset of the data section or 0 if the header is invalid.
+	 */
+	unsigned long parseHeader(const char* data, unsigned long size, PlyHeader& header);
+
+	/// Get the type for a PLY type name like "float" or "uchar".
+	static PlyType getType(std::string typeName);
+
+	/// Get the size in bytes of a PLY type.
+	static unsigned int getTypeSize(PlyType type);
+
+	/// Read a binary value and convert it to double.
+	static double readValue(const char* data, PlyType type, bool swapBytes);
+
+	/// If true the coordinates are written as double values.
+	bool useDoublePrecision;
+
+};
+
+}
+
+#endif /* BRICS_3D_PLYFILEHANDLER_H_ */
+
+/* EOF */
@@ -74,6 +74,9 @@ class ISceneGraphQuery {
 
     /**
      * @brief Get the data of a GeometryNode.
+     *
+     * The shape is shared with the scene graph. Copy point cloud data before modifying it (see rsg::PointCloud::data),
+     * which is cheap as the point arrays are only duplicated on the first modification.
      */
     virtual bool getGeometry(Id id, Shape::ShapePtr& shape, TimeStamp& timeStamp) = 0;
 
@@ -66,6 +66,16 @@ class PointCloud : public Shape {
     	return IPoint3DIterator::IPoint3DIteratorPtr(); // kind of null
     };
 
+    /**
+     * @brief The point cloud data.
+     *
+     * Algorithms that modify a point cloud in place (e.g. a filter or the data of the ICP) should work on a copy,
+     * so the version in the scene graph remains intact. Copies of brics_3d::PointCloud3D share the point arrays
+     * until the first modification, so this costs no extra copy if the algorithm only reads the data:
+     *  @code
+     *	brics_3d::PointCloud3D::PointCloud3DPtr workingCopy(new brics_3d::PointCloud3D(*pointCloud->data));
+     * @endcode
+     */
     boost::shared_ptr<PointCloudT> data;
 
 };
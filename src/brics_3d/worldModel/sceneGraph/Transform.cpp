@@ -21,6 +21,7 @@
 
 /* for transform tools: */
 #include "brics_3d/core/HomogeneousMatrix44.h"
+#include "brics_3d/core/RigidTransform.h"
 #include "brics_3d/core/Logger.h"
 #include "PathCollector.h"
 
@@ -28,28 +29,109 @@ namespace brics_3d {
 
 namespace rsg {
 
-IHomogeneousMatrix44::IHomogeneousMatrix44Ptr getGlobalTransformAlongPath(Node::NodePath nodePath, TimeStamp timeStamp){
-	IHomogeneousMatrix44::IHomogeneousMatrix44Ptr result(new HomogeneousMatrix44()); //identity matrix
+namespace {
+
+/// matrix = matrix * other as general 4x4 matrices
+void multiplyInPlace(HomogeneousMatrix44* matrix, const IHomogeneousMatrix44& other) {
+	Eigen::Map<Eigen::Matrix4d> result(matrix->setRawData());
+	Eigen::Map<const Eigen::Matrix4d> multiplicand(other.getRawData());
+	result = (result * multiplicand).eval();
+}
+
+/// Inverse of a general 4x4 matrix, including a projective part
+void invertInPlace(HomogeneousMatrix44* matrix) {
+	Eigen::Map<Eigen::Matrix4d> result(matrix->setRawData());
+	result = result.inverse().eval();
+}
+
+/*
+ * The accumulation is done with stack allocated RigidTransform values. Only the final
+ * result is converted into a (heap allocated) IHomogeneousMatrix44.
+ *
+ * The scene graph accepts arbitrary homogeneous matrices though. As soon as a transform is not rigid
+ * (e.g. it scales or has a projective part) the accumulation continues with general 4x4 matrices.
+ */
+class AccumulatedTransform {
+public:
+	AccumulatedTransform() : rigid(true) {
+	}
+
+	/// this = this * transform
+	void append(const IHomogeneousMatrix44& transform) {
+		if (rigid && RigidTransform::isRigid(transform)) {
+			rigidTransform *= RigidTransform(transform);
+			return;
+		}
+		makeGeneral();
+		multiplyInPlace(&general, transform);
+	}
+
+	/// this = this * other
+	void append(const AccumulatedTransform& other) {
+		if (rigid && other.rigid) {
+			rigidTransform *= other.rigidTransform;
+			return;
+		}
+		HomogeneousMatrix44 otherMatrix;
+		other.toMatrix(&otherMatrix);
+		makeGeneral();
+		multiplyInPlace(&general, otherMatrix);
+	}
+
+	void invert() {
+		if (rigid) {
+			rigidTransform = rigidTransform.inverse();
+		} else {
+			invertInPlace(&general);
+		}
+	}
+
+	void toMatrix(IHomogeneousMatrix44* matrix) const {
+		if (rigid) {
+			rigidTransform.toMatrix(matrix);
+		} else {
+			*matrix = general;
+		}
+	}
+
+private:
+	void makeGeneral() {
+		if (rigid) {
+			rigidTransform.toMatrix(&general);
+			rigid = false;
+		}
+	}
+
+	/// Valid as long as all accumulated transforms are rigid
+	RigidTransform rigidTransform;
+
+	/// Valid as soon as a transform is not rigid
+	HomogeneousMatrix44 general;
+
+	/// Flag which of both representations is valid
+	bool rigid;
+};
+
+AccumulatedTransform accumulateTransformAlongPath(const Node::NodePath& nodePath, TimeStamp timeStamp) {
+	AccumulatedTransform accumulatedTransform; //identity
 	for (unsigned int i = 0; i < static_cast<unsigned int>(nodePath.size()); ++i) {
 		Transform* tmpTransform = dynamic_cast<Transform*>(nodePath[i]);
 		if (tmpTransform) {
-			*result = *( (*result) * (*tmpTransform->getTransform(timeStamp)) );
+			accumulatedTransform.append(*tmpTransform->getTransform(timeStamp));
 		}
 	}
-	return result;
+	return accumulatedTransform;
 }
 
-IHomogeneousMatrix44::IHomogeneousMatrix44Ptr getGlobalTransform(Node::NodePtr node, TimeStamp timeStamp) {
-	IHomogeneousMatrix44::IHomogeneousMatrix44Ptr result(new HomogeneousMatrix44()); //identity matrix
-	IHomogeneousMatrix44::IHomogeneousMatrix44Ptr accumulatedTransform;
+AccumulatedTransform accumulateGlobalTransform(Node::NodePtr node, TimeStamp timeStamp) {
+	AccumulatedTransform accumulatedTransform; //identity
 
 	/* accumulate parent paths and take the _first_ found path  */
-	PathCollector* pathCollector = new PathCollector();
-	node->accept(pathCollector);
-	if (static_cast<unsigned int>(pathCollector->getNodePaths().size()) > 0) { // != root
-		//*result = *((*result) * (*(getGlobalTransformAlongPath(pathCollector->getNodePaths()[0], timeStamp))));
-		*result = *((*result) * (*(getGlobalTransformAlongPath(pathCollector->getNodePaths().back(), timeStamp))));
-		if (static_cast<unsigned int>(pathCollector->getNodePaths().size()) > 1) {
+	PathCollector pathCollector;
+	node->accept(&pathCollector);
+	if (static_cast<unsigned int>(pathCollector.getNodePaths().size()) > 0) { // != root
+		accumulatedTransform.append(accumulateTransformAlongPath(pathCollector.getNodePaths().back(), timeStamp));
+		if (static_cast<unsigned int>(pathCollector.getNodePaths().size()) > 1) {
 			LOG(WARNING) << "Multiple transform paths to this node detected. Taking last path and ignoring the rest.";
 		}
 	}
@@ -57,22 +139,35 @@ IHomogeneousMatrix44::IHomogeneousMatrix44Ptr getGlobalTransform(Node::NodePtr n
 	/* check if node is a transform on its own ... */
 	Transform::TransformPtr tmpTransform = boost::dynamic_pointer_cast<Transform>(node);
 	if (tmpTransform) {
-		*result = *( (*result) * (*tmpTransform->getTransform(timeStamp)) );
+		accumulatedTransform.append(*tmpTransform->getTransform(timeStamp));
 	}
 
-	delete pathCollector;
+	return accumulatedTransform;
+}
+
+IHomogeneousMatrix44::IHomogeneousMatrix44Ptr toMatrix(const AccumulatedTransform& transform) {
+	IHomogeneousMatrix44::IHomogeneousMatrix44Ptr result(new HomogeneousMatrix44());
+	transform.toMatrix(result.get());
 	return result;
 }
 
-IHomogeneousMatrix44::IHomogeneousMatrix44Ptr getTransformBetweenNodes(Node::NodePtr node, Node::NodePtr referenceNode, TimeStamp timeStamp) {
-	IHomogeneousMatrix44::IHomogeneousMatrix44Ptr result(new HomogeneousMatrix44()); //identity matrix
-	IHomogeneousMatrix44::IHomogeneousMatrix44Ptr rootToNodeTransform = getGlobalTransform(node, timeStamp);
-	IHomogeneousMatrix44::IHomogeneousMatrix44Ptr rootToReferenceNodeTransform = getGlobalTransform(referenceNode, timeStamp);
+}
 
-	rootToReferenceNodeTransform->inverse();
-	*result = *( (*rootToReferenceNodeTransform) * (*rootToNodeTransform) ); //cf. Craig p39
+IHomogeneousMatrix44::IHomogeneousMatrix44Ptr getGlobalTransformAlongPath(Node::NodePath nodePath, TimeStamp timeStamp){
+	return toMatrix(accumulateTransformAlongPath(nodePath, timeStamp));
+}
 
-	return result;
+IHomogeneousMatrix44::IHomogeneousMatrix44Ptr getGlobalTransform(Node::NodePtr node, TimeStamp timeStamp) {
+	return toMatrix(accumulateGlobalTransform(node, timeStamp));
+}
+
+IHomogeneousMatrix44::IHomogeneousMatrix44Ptr getTransformBetweenNodes(Node::NodePtr node, Node::NodePtr referenceNode, TimeStamp timeStamp) {
+	AccumulatedTransform rootToNodeTransform = accumulateGlobalTransform(node, timeStamp);
+	AccumulatedTransform result = accumulateGlobalTransform(referenceNode, timeStamp); // root to reference node
+
+	result.invert();
+	result.append(rootToNodeTransform); //cf. Craig p39
+	return toMatrix(result);
 }
 
 
@@ -0,0 +1,181 @@
+/**
+ * @file 
+ * AsciiPointParserTest.cpp
+ *
+ * @date: Oct 18, 2026
+ * @author: sblume
+ */
+
+#include "AsciiPointParserTest.h"
+
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <clocale>
+#include <stdexcept>
+#include "brics_3d/core/Logger.h"
+
+namespace unitTests {
+
+CPPUNIT_TEST_SUITE_REGISTRATION( AsciiPointParserTest );
+
+void AsciiPointParserTest::setUp() {
+
+}
+
+void AsciiPointParserTest::tearDown() {
+
+}
+
+void AsciiPointParserTest::testNumbers() {
+	const char* numbers[] = {"0", "-0.06325", "0.0359793", "1.893792", "-1e-3", "+42", "123456789.987654321",
+			"1.7976931348623157e308", "4.9e-324", "0.1", "3.14159265358979323846264338", "100000000000000000000000", "nan"};
+
+	for (unsigned int i = 0; i < sizeof(numbers) / sizeof(numbers[0]); ++i) {
+		const char* cursor = numbers[i];
+		const char* end = numbers[i] + strlen(numbers[i]);
+		double value = 0;
+		CPPUNIT_ASSERT(AsciiPointParser::parseNumber(cursor, end, value));
+		CPPUNIT_ASSERT(cursor == end);
+		double expected = strtod(numbers[i], 0);
+		if (expected == expected) { // not nan
+			CPPUNIT_ASSERT_EQUAL(expected, value); // bit exact
+		} else {
+			CPPUNIT_ASSERT(value != value);
+		}
+	}
+
+	/* random values are converted exactly as by strtod */
+	std::srand(0);
+	for (int i = 0; i < 10000; ++i) {
+		std::stringstream numberStream;
+		numberStream.precision(1 + i % 17);
+		numberStream << (std::rand() - RAND_MAX / 2) / static_cast<double>(1 + std::rand() % 100000);
+		std::string number = numberStream.str();
+		const char* cursor = number.c_str();
+		double value = 0;
+		CPPUNIT_ASSERT(AsciiPointParser::parseNumber(cursor, number.c_str() + number.size(), value));
+		CPPUNIT_ASSERT_EQUAL(strtod(number.c_str(), 0), value);
+	}
+
+	/* the text does not need to be null terminated */
+	const char* text = "12.5 7";
+	const char* cursor = text;
+	double value = 0;
+	CPPUNIT_ASSERT(AsciiPointParser::parseNumber(cursor, text + 3, value));
+	CPPUNIT_ASSERT_EQUAL(12.0, value);
+
+	cursor = "  abc";
+	CPPUNIT_ASSERT(!AsciiPointParser::parseNumber(cursor, cursor + 5, value));
+}
+
+void AsciiPointParserTest::testCommaDecimalLocale() {
+	/* numbers that are not handled by the fast path */
+	const char* numbers[] = {"3.14159265358979323846264338", "1.7976931348623157e308", "4.9e-324", "-2.5e-30", "100000000000000000000000.5"};
+	const unsigned int numberOfNumbers = sizeof(numbers) / sizeof(numbers[0]);
+	double expected[numberOfNumbers];
+	for (unsigned int i = 0; i < numberOfNumbers; ++i) {
+		expected[i] = strtod(numbers[i], 0); // still with the "C" locale
+	}
+
+	std::string previousLocale = setlocale(LC_NUMERIC, 0);
+	const char* commaLocales[] = {"de_DE.UTF-8", "de_DE.utf8", "de_DE", "German_Germany"};
+	bool hasCommaLocale = false;
+	for (unsigned int i = 0; i < sizeof(commaLocales) / sizeof(commaLocales[0]) && !hasCommaLocale; ++i) {
+		hasCommaLocale = (setlocale(LC_NUMERIC, commaLocales[i]) != 0);
+	}
+	if (!hasCommaLocale) {
+		LOG(WARNING) << "AsciiPointParserTest::testCommaDecimalLocale skipped: no locale with a decimal comma is installed.";
+		return;
+	}
+
+	for (unsigned int i = 0; i < numberOfNumbers; ++i) {
+		const char* cursor = numbers[i];
+		const char* end = numbers[i] + strlen(numbers[i]);
+		double value = 0;
+		bool isParsed = AsciiPointParser::parseNumber(cursor, end, value);
+		bool isAtEnd = (cursor == end);
+		if (!isParsed || !isAtEnd || value != expected[i]) {
+			setlocale(LC_NUMERIC, previousLocale.c_str());
+		}
+		CPPUNIT_ASSERT(isParsed);
+		CPPUNIT_ASSERT(isAtEnd);
+		CPPUNIT_ASSERT_EQUAL(expected[i], value); // bit exact
+	}
+	setlocale(LC_NUMERIC, previousLocale.c_str());
+}
+
+void AsciiPointParserTest::testChunks() {
+	std::stringstream text;
+	std::srand(0);
+	for (int i = 0; i < 5000; ++i) {
+		text << std::rand() / 1000.0 << " " << -i << "\t" << i * 0.001;
+		if (i % 7 == 0) {
+			text << " 255 255 255"; // additional values are ignored
+		}
+		if (i % 11 == 0) {
+			text << "\r\n\n"; // empty lines are skipped
+		} else {
+			text << "\n";
+		}
+	}
+	text << "1 2 3"; // no trailing newline
+	std::string data = text.str();
+
+	AsciiPointParser singleThreadedParser;
+	singleThreadedParser.setNumberOfThreads(1);
+	CPPUNIT_ASSERT_EQUAL(1u, singleThreadedParser.getNumberOfThreads());
+	PointCloud3DStorage referenceStorage;
+	singleThreadedParser.parse(data.c_str(), data.size(), &referenceStorage);
+	CPPUNIT_ASSERT_EQUAL(5001u, referenceStorage.getSize());
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(-4999.0, referenceStorage.getRawY()[4999], 1e-12);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(3.0, referenceStorage.getRawZ()[5000], 1e-12);
+
+	AsciiPointParser parser;
+	parser.setNumberOfThreads(4);
+	parser.setMinimalChunkSize(100);
+	CPPUNIT_ASSERT_EQUAL(100ul, parser.getMinimalChunkSize());
+	PointCloud3DStorage storage;
+	storage.addPoint(-1, -1, -1);
+	parser.parse(data.c_str(), data.size(), &storage);
+	CPPUNIT_ASSERT_EQUAL(5002u, storage.getSize());
+	for (unsigned int i = 0; i < referenceStorage.getSize(); ++i) {
+		CPPUNIT_ASSERT_EQUAL(referenceStorage.getRawX()[i], storage.getRawX()[i + 1]);
+		CPPUNIT_ASSERT_EQUAL(referenceStorage.getRawY()[i], storage.getRawY()[i + 1]);
+		CPPUNIT_ASSERT_EQUAL(referenceStorage.getRawZ()[i], storage.getRawZ()[i + 1]);
+	}
+
+	/* streaming into a point cloud yields the same result */
+	PointCloud3D pointCloud;
+	std::stringstream inputStream(data);
+	inputStream >> pointCloud;
+	CPPUNIT_ASSERT_EQUAL(5001u, pointCloud.getSize());
+	CPPUNIT_ASSERT_EQUAL(referenceStorage.getRawX()[123], (*pointCloud.getPointCloud())[123].getX());
+
+	PointCloud3DStorageF storageF;
+	parser.parse(data.c_str(), data.size(), &storageF);
+	CPPUNIT_ASSERT_EQUAL(5001u, storageF.getSize());
+	CPPUNIT_ASSERT_EQUAL(static_cast<float>(referenceStorage.getRawX()[4000]), storageF.getRawX()[4000]);
+}
+
+void AsciiPointParserTest::testInvalidData() {
+	AsciiPointParser parser;
+	parser.setNumberOfThreads(2);
+	parser.setMinimalChunkSize(1);
+	PointCloud3DStorage storage;
+
+	std::string data = "1 2 3\n4 5\n6 7 8\n";
+	CPPUNIT_ASSERT_THROW(parser.parse(data.c_str(), data.size(), &storage), std::runtime_error);
+	CPPUNIT_ASSERT_EQUAL(0u, storage.getSize());
+
+	data = "1 2 3\n4 5 x\n";
+	CPPUNIT_ASSERT_THROW(parser.parse(data.c_str(), data.size(), &storage), std::runtime_error);
+
+	data = "";
+	parser.parse(data.c_str(), data.size(), &storage);
+	CPPUNIT_ASSERT_EQUAL(0u, storage.getSize());
+}
+
+}
+
+/* EOF */
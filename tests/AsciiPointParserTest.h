@@ -0,0 +1,46 @@
+/**
+ * @file 
+ * AsciiPointParserTest.h
+ *
+ * @date: Oct 18, 2026
+ * @author: sblume
+ */
+
+#ifndef ASCIIPOINTPARSERTEST_H_
+#define ASCIIPOINTPARSERTEST_H_
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "brics_3d/core/AsciiPointParser.h"
+#include "brics_3d/core/PointCloud3D.h"
+
+using namespace brics_3d;
+
+namespace unitTests {
+
+class AsciiPointParserTest : public CPPUNIT_NS::TestFixture {
+
+	CPPUNIT_TEST_SUITE( AsciiPointParserTest );
+	CPPUNIT_TEST( testNumbers );
+	CPPUNIT_TEST( testCommaDecimalLocale );
+	CPPUNIT_TEST( testChunks );
+	CPPUNIT_TEST( testInvalidData );
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void setUp();
+	void tearDown();
+
+	void testNumbers();
+	void testCommaDecimalLocale();
+	void testChunks();
+	void testInvalidData();
+
+};
+
+}
+
+#endif /* ASCIIPOINTPARSERTEST_H_ */
+
+/* EOF */
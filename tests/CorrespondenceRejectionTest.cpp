@@ -0,0 +1,205 @@
+/**
+ * @file 
+ * CorrespondenceRejectionTest.cpp
+ *
+ * @date: Oct 18, 2026
+ * @author: sblume
+ */
+
+#include "CorrespondenceRejectionTest.h"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace unitTests {
+
+CPPUNIT_TEST_SUITE_REGISTRATION( CorrespondenceRejectionTest );
+
+void CorrespondenceRejectionTest::setUp() {
+	model = new PointCloud3D();
+	data = new PointCloud3D();
+	indexPairs = new vector<CorrespondenceIndexPair>();
+	for (int i = 0; i < 10; ++i) {
+		model->addPoint(Point3D(i, 0, 0));
+		data->addPoint(Point3D(i, (i < 9) ? 0.1 : 5.0, 0));
+		indexPairs->push_back(CorrespondenceIndexPair(i, i));
+	}
+	weights = new vector<double>(indexPairs->size(), 1.0);
+}
+
+void CorrespondenceRejectionTest::tearDown() {
+	delete model;
+	delete data;
+	delete indexPairs;
+	delete weights;
+}
+
+void CorrespondenceRejectionTest::testDistance() {
+	CorrespondenceRejectionDistance rejection(1.0);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, rejection.getMaxDistance(), maxTolerance);
+	CPPUNIT_ASSERT_THROW(rejection.setMaxDistance(0.0), runtime_error);
+
+	rejection.rejectCorrespondences(model, data, indexPairs, weights);
+	CPPUNIT_ASSERT_EQUAL(9u, static_cast<unsigned int>(indexPairs->size()));
+	CPPUNIT_ASSERT_EQUAL(9u, static_cast<unsigned int>(weights->size()));
+	for (unsigned int i = 0; i < indexPairs->size(); ++i) {
+		CPPUNIT_ASSERT_EQUAL(i, (*indexPairs)[i].firstIndex);
+		CPPUNIT_ASSERT_EQUAL(i, (*indexPairs)[i].secondIndex);
+	}
+
+	/* nothing left to reject */
+	rejection.setMaxDistance(0.05);
+	rejection.rejectCorrespondences(model, data, indexPairs, weights);
+	CPPUNIT_ASSERT(indexPairs->empty());
+	CPPUNIT_ASSERT(weights->empty());
+}
+
+void CorrespondenceRejectionTest::testPercentile() {
+	CPPUNIT_ASSERT_THROW(CorrespondenceRejectionPercentile(0.0, 3.0), runtime_error);
+	CPPUNIT_ASSERT_THROW(CorrespondenceRejectionPercentile(1.5, 3.0), runtime_error);
+	CPPUNIT_ASSERT_THROW(CorrespondenceRejectionPercentile(0.5, 0.5), runtime_error);
+
+	/* all pairs up to the largest distance */
+	CorrespondenceRejectionPercentile rejection(1.0, 1.0);
+	rejection.rejectCorrespondences(model, data, indexPairs, weights);
+	CPPUNIT_ASSERT_EQUAL(10u, static_cast<unsigned int>(indexPairs->size()));
+
+	/* three times the median distance */
+	rejection.setPercentile(0.5);
+	rejection.setFactor(3.0);
+	rejection.rejectCorrespondences(model, data, indexPairs, weights);
+	CPPUNIT_ASSERT_EQUAL(9u, static_cast<unsigned int>(indexPairs->size()));
+	CPPUNIT_ASSERT_EQUAL(9u, static_cast<unsigned int>(weights->size()));
+	CPPUNIT_ASSERT_EQUAL(8u, (*indexPairs)[8].secondIndex);
+}
+
+void CorrespondenceRejectionTest::testReciprocal() {
+	/* two data points are assigned to the first model point, only the closer one is reciprocal */
+	PointCloud3D model;
+	model.addPoint(Point3D(0, 0, 0));
+	model.addPoint(Point3D(1, 0, 0));
+	PointCloud3D data;
+	data.addPoint(Point3D(0.1, 0, 0));
+	data.addPoint(Point3D(0.4, 0, 0));
+	data.addPoint(Point3D(1, 0, 0));
+	vector<CorrespondenceIndexPair> indexPairs;
+	indexPairs.push_back(CorrespondenceIndexPair(0, 0));
+	indexPairs.push_back(CorrespondenceIndexPair(0, 1));
+	indexPairs.push_back(CorrespondenceIndexPair(1, 2));
+	vector<double> weights(indexPairs.size(), 1.0);
+	weights[2] = 0.5;
+
+	CorrespondenceRejectionReciprocal rejection;
+	rejection.rejectCorrespondences(&model, &data, &indexPairs, &weights);
+	CPPUNIT_ASSERT_EQUAL(2u, static_cast<unsigned int>(indexPairs.size()));
+	CPPUNIT_ASSERT_EQUAL(0u, indexPairs[0].secondIndex);
+	CPPUNIT_ASSERT_EQUAL(2u, indexPairs[1].secondIndex);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, weights[1], maxTolerance);
+}
+
+void CorrespondenceRejectionTest::testNormal() {
+	CPPUNIT_ASSERT_THROW(CorrespondenceRejectionNormal(-0.1), runtime_error);
+	CPPUNIT_ASSERT_THROW(CorrespondenceRejectionNormal(2.0), runtime_error);
+
+	/* model normals point upwards; data normals are flipped, perpendicular and slightly tilted */
+	const double dataNormals[3][3] = {{0, 0, -1}, {1, 0, 0}, {0, 0.1, 1}};
+	PointCloud3D model;
+	PointCloud3D data;
+	vector<CorrespondenceIndexPair> indexPairs;
+	for (int i = 0; i < 3; ++i) {
+		model.addPoint(Point3D(i, 0, 0));
+		data.addPoint(Point3D(i, 0, 0.1));
+		indexPairs.push_back(CorrespondenceIndexPair(i, i));
+	}
+	model.getMutableStorage()->addChannel(PointCloud3D::normalChannel, 3);
+	data.getMutableStorage()->addChannel(PointCloud3D::normalChannel, 3);
+	Coordinate* modelNormal = model.getMutableStorage()->getRawChannel(PointCloud3D::normalChannel);
+	Coordinate* dataNormal = data.getMutableStorage()->getRawChannel(PointCloud3D::normalChannel);
+	for (int i = 0; i < 3; ++i) {
+		modelNormal[3 * i] = 0;
+		modelNormal[3 * i + 1] = 0;
+		modelNormal[3 * i + 2] = 1;
+		for (int j = 0; j < 3; ++j) {
+			dataNormal[3 * i + j] = dataNormals[i][j];
+		}
+	}
+	vector<double> weights(indexPairs.size(), 1.0);
+
+	CorrespondenceRejectionNormal rejection;
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(M_PI_4, rejection.getMaxAngle(), maxTolerance);
+	rejection.rejectCorrespondences(&model, &data, &indexPairs, &weights);
+	CPPUNIT_ASSERT_EQUAL(2u, static_cast<unsigned int>(indexPairs.size()));
+	CPPUNIT_ASSERT_EQUAL(0u, indexPairs[0].secondIndex);
+	CPPUNIT_ASSERT_EQUAL(2u, indexPairs[1].secondIndex);
+
+	/* the tilted normal deviates by about 5.7 degree */
+	rejection.setMaxAngle(0.05);
+	rejection.rejectCorrespondences(&model, &data, &indexPairs, &weights);
+	CPPUNIT_ASSERT_EQUAL(1u, static_cast<unsigned int>(indexPairs.size()));
+	CPPUNIT_ASSERT_EQUAL(0u, indexPairs[0].secondIndex);
+
+	/* available normals are kept, missing ones are estimated once and rotated along with the points */
+	rejection.prepareData(&data);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(-1.0, data.getStorage()->getRawChannel(PointCloud3D::normalChannel)[2], maxTolerance);
+	PointCloud3D plane;
+	for (int i = 0; i < 5; ++i) {
+		for (int j = 0; j < 5; ++j) {
+			plane.addPoint(Point3D(0.1 * i, 0.1 * j, 0.0));
+		}
+	}
+	rejection.prepareData(&plane);
+	CPPUNIT_ASSERT(plane.getStorage()->hasChannel(PointCloud3D::normalChannel));
+	double rotationX[16] = {1, 0, 0, 0, 0, 0, 1, 0, 0, -1, 0, 0, 0, 0, 0, 1}; // 90 degree about the x axis, column major
+	HomogeneousMatrix44 rotation;
+	for (int i = 0; i < 16; ++i) {
+		rotation.setRawData()[i] = rotationX[i];
+	}
+	plane.homogeneousTransformation(&rotation);
+	const Coordinate* planeNormal = plane.getStorage()->getRawChannel(PointCloud3D::normalChannel);
+	for (unsigned int i = 0; i < plane.getSize(); ++i) {
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, planeNormal[3 * i], 1e-6);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, std::abs(planeNormal[3 * i + 1]), 1e-6);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, planeNormal[3 * i + 2], 1e-6);
+	}
+}
+
+void CorrespondenceRejectionTest::testRobustKernel() {
+	CorrespondenceRejectionRobustKernel rejection;
+	CPPUNIT_ASSERT_EQUAL(robustKernel::huber, rejection.getKernel());
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, rejection.getScale(), maxTolerance);
+	CPPUNIT_ASSERT_THROW(rejection.setScale(-1.0), runtime_error);
+	CPPUNIT_ASSERT_THROW(rejection.setTuningConstant(-1.0), runtime_error);
+
+	/* Huber: the inliers keep their weights, the outlier is down-weighted */
+	rejection.setScale(0.1);
+	rejection.setTuningConstant(1.0);
+	weights->assign(indexPairs->size(), 0.5);
+	rejection.rejectCorrespondences(model, data, indexPairs, weights);
+	CPPUNIT_ASSERT_EQUAL(10u, static_cast<unsigned int>(indexPairs->size()));
+	for (unsigned int i = 0; i < 9; ++i) {
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, (*weights)[i], maxTolerance);
+	}
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5 * 0.1 / 5.0, (*weights)[9], maxTolerance);
+
+	/* Huber with the scale estimated from the median distance */
+	rejection.setScale(0.0);
+	rejection.setTuningConstant(0.0);
+	weights->assign(indexPairs->size(), 1.0);
+	rejection.rejectCorrespondences(model, data, indexPairs, weights);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(1.345 * 1.4826 * 0.1 / 5.0, (*weights)[9], maxTolerance);
+
+	/* Tukey: all weights decrease, the outlier is rejected */
+	rejection.setKernel(robustKernel::tukey);
+	rejection.setScale(0.1);
+	rejection.setTuningConstant(2.0);
+	weights->assign(indexPairs->size(), 1.0);
+	rejection.rejectCorrespondences(model, data, indexPairs, weights);
+	CPPUNIT_ASSERT_EQUAL(9u, static_cast<unsigned int>(indexPairs->size()));
+	for (unsigned int i = 0; i < 9; ++i) {
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5625, (*weights)[i], maxTolerance);
+	}
+}
+
+}  // namespace unitTests
+
+/* EOF */
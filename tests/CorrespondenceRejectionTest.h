@@ -0,0 +1,69 @@
+/**
+ * @file 
+ * CorrespondenceRejectionTest.h
+ *
+ * @date: Oct 18, 2026
+ * @author: sblume
+ */
+
+#ifndef CORRESPONDENCEREJECTIONTEST_H_
+#define CORRESPONDENCEREJECTIONTEST_H_
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "brics_3d/core/PointCloud3D.h"
+#include "brics_3d/core/HomogeneousMatrix44.h"
+#include "brics_3d/algorithm/registration/CorrespondenceRejectionDistance.h"
+#include "brics_3d/algorithm/registration/CorrespondenceRejectionPercentile.h"
+#include "brics_3d/algorithm/registration/CorrespondenceRejectionReciprocal.h"
+#include "brics_3d/algorithm/registration/CorrespondenceRejectionNormal.h"
+#include "brics_3d/algorithm/registration/CorrespondenceRejectionRobustKernel.h"
+
+using namespace std;
+using namespace brics_3d;
+
+namespace unitTests {
+
+class CorrespondenceRejectionTest : public CPPUNIT_NS::TestFixture {
+
+	CPPUNIT_TEST_SUITE( CorrespondenceRejectionTest );
+	CPPUNIT_TEST( testDistance );
+	CPPUNIT_TEST( testPercentile );
+	CPPUNIT_TEST( testReciprocal );
+	CPPUNIT_TEST( testNormal );
+	CPPUNIT_TEST( testRobustKernel );
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void setUp();
+	void tearDown();
+
+	void testDistance();
+	void testPercentile();
+	void testReciprocal();
+	void testNormal();
+	void testRobustKernel();
+
+private:
+
+	/// Points on a line
+	PointCloud3D* model;
+
+	/// The model points shifted by 0.1, except of the last one which is an outlier
+	PointCloud3D* data;
+
+	/// Correspondences of the points with the same index
+	vector<CorrespondenceIndexPair>* indexPairs;
+
+	/// Weights of the correspondences, initially 1
+	vector<double>* weights;
+
+	static const double maxTolerance = 0.00001;
+};
+
+}  // namespace unitTests
+
+#endif /* CORRESPONDENCEREJECTIONTEST_H_ */
+
+/* EOF */
@@ -563,6 +563,72 @@ void HomogeneousMatrixTest::testDistance() {
 	CPPUNIT_ASSERT_DOUBLES_EQUAL(3.4641, distance, maxTolerance);
 }
 
+void HomogeneousMatrixTest::testRigidTransform() {
+	RigidTransform identity;
+	CPPUNIT_ASSERT(identity.isIdentity());
+
+	/* same coefficient order as HomogeneousMatrix44 */
+	HomogeneousMatrix44 translation(1,0,0, 0,1,0, 0,0,1, 1,2,3);
+	RigidTransform rigidTranslation(1,0,0, 0,1,0, 0,0,1, 1,2,3);
+	HomogeneousMatrix44 converted;
+	rigidTranslation.toMatrix(&converted);
+	for (int i = 0; i < 16; ++i) {
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(translation.getRawData()[i], converted.getRawData()[i], maxTolerance);
+	}
+	CPPUNIT_ASSERT(!rigidTranslation.isIdentity());
+
+	IHomogeneousMatrix44::IHomogeneousMatrix44Ptr transform1(new HomogeneousMatrix44());
+	IHomogeneousMatrix44::IHomogeneousMatrix44Ptr transform2(new HomogeneousMatrix44());
+	HomogeneousMatrix44::xyzRollPitchYawToMatrix(1.0, -2.0, 0.5, 0.1, -0.4, 1.2, transform1);
+	HomogeneousMatrix44::xyzRollPitchYawToMatrix(-3.0, 0.2, 4.0, -1.1, 0.3, -2.5, transform2);
+	RigidTransform rigid1(*transform1);
+	RigidTransform rigid2(*transform2);
+
+	/* composition equals matrix multiplication */
+	HomogeneousMatrix44 expected;
+	expected = *transform1;
+	expected * (*transform2); // multiplies in place
+	HomogeneousMatrix44 result;
+	(rigid1 * rigid2).toMatrix(&result);
+	for (int i = 0; i < 16; ++i) {
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.getRawData()[i], result.getRawData()[i], maxTolerance);
+	}
+
+	RigidTransform accumulated;
+	accumulated *= rigid1;
+	accumulated *= rigid2;
+	accumulated.toMatrix(&result);
+	for (int i = 0; i < 16; ++i) {
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.getRawData()[i], result.getRawData()[i], maxTolerance);
+	}
+
+	/* inverse */
+	HomogeneousMatrix44 expectedInverse;
+	expectedInverse = *transform1;
+	expectedInverse.inverse();
+	rigid1.inverse().toMatrix(&result);
+	for (int i = 0; i < 16; ++i) {
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(expectedInverse.getRawData()[i], result.getRawData()[i], maxTolerance);
+	}
+	CPPUNIT_ASSERT((rigid1 * rigid1.inverse()).isIdentity());
+	CPPUNIT_ASSERT((rigid2.inverse() * rigid2).isIdentity());
+
+	/* point transformation */
+	double x = 1.0;
+	double y = 2.0;
+	double z = 3.0;
+	rigidTranslation.transformPoint(x, y, z);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, x, maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(4.0, y, maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(6.0, z, maxTolerance);
+
+	rigid1.transformPoint(x, y, z);
+	rigid1.inverse().transformPoint(x, y, z);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, x, maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(4.0, y, maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(6.0, z, maxTolerance);
+}
+
 } // namespace unitTests
 
 /* EOF */
@@ -14,6 +14,7 @@
 
 #include <Eigen/Geometry>
 #include "brics_3d/core/HomogeneousMatrix44.h"
+#include "brics_3d/core/RigidTransform.h"
 
 namespace unitTests {
 
@@ -39,6 +40,7 @@ class HomogeneousMatrixTest : public CPPUNIT_NS::TestFixture {
 	CPPUNIT_TEST( testRPYConversions );
 	CPPUNIT_TEST( testMatrixEntries );
 	CPPUNIT_TEST( testDistance );
+	CPPUNIT_TEST( testRigidTransform );
 	CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -57,6 +59,7 @@ public:
 	  void testRPYConversions();
 	  void testMatrixEntries();
 	  void testDistance();
+	  void testRigidTransform();
 
 	  EIGEN_MAKE_ALIGNED_OPERATOR_NEW //Required by Eigen2
 
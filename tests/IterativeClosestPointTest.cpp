@@ -16,6 +16,21 @@ using namespace Eigen;
 
 namespace unitTests {
 
+/// Nearest neighbor search that counts how often its search structure is built.
+class CountingNearestNeighbor : public NearestNeighborKDTree3D {
+public:
+	CountingNearestNeighbor(int* setDataCount) : setDataCount(setDataCount) {}
+
+	using NearestNeighborKDTree3D::setData;
+
+	void setData(PointCloud3D* data) {
+		++(*setDataCount);
+		NearestNeighborKDTree3D::setData(data);
+	}
+
+private:
+	int* setDataCount;
+};
 
 CPPUNIT_TEST_SUITE_REGISTRATION( IterativeClosestPointTest );
 
@@ -369,6 +384,236 @@ void IterativeClosestPointTest::testSetupInterface(){
 
 }
 
+/// Sample the floor and two walls of a room corner with an edge length of 1m and a spacing of 0.02m.
+static void createCorner(PointCloud3D* pointCloud, double offset) {
+	for (int i = 0; i < 50; ++i) {
+		for (int j = 0; j < 50; ++j) {
+			double u = i * 0.02 + offset;
+			double v = j * 0.02 + offset;
+			pointCloud->addPoint(Point3D(u, v, 0));
+			pointCloud->addPoint(Point3D(0, u, v));
+			pointCloud->addPoint(Point3D(u, 0, v));
+		}
+	}
+}
+
+void IterativeClosestPointTest::testPointToPlane() {
+	/* model and data sample the same surfaces at different positions */
+	PointCloud3D model;
+	PointCloud3D initialData;
+	createCorner(&model, 0.0);
+	createCorner(&initialData, 0.01);
+
+	AngleAxis<double> rotation(M_PI / 36.0, Vector3d(1,2,3).normalized());
+	Transform3d transformation;
+	transformation = Translation3d(0.05, -0.03, 0.02) * rotation;
+	HomogeneousMatrix44 homogeneousTrans(&transformation);
+	initialData.homogeneousTransformation(&homogeneousTrans);
+
+	int iterations[2];
+	for (int e = 0; e < 2; ++e) {
+		IRigidTransformationEstimation* estimator = 0;
+		if (e == 0) {
+			estimator = new RigidTransformationEstimationSVD();
+		} else {
+			estimator = new RigidTransformationEstimationPointToPlane();
+		}
+		icp = new IterativeClosestPoint(new PointCorrespondenceKDTree(), estimator, 0.000001, 100);
+
+		PointCloud3D data = initialData;
+		HomogeneousMatrix44 resultTransformation;
+		icp->match(&model, &data, &resultTransformation);
+		iterations[e] = icp->icpresultIterations;
+		delete icp;
+		icp = 0;
+
+		/* every point lies on one of the surfaces */
+		const PointCloud3DStorage* storage = data.getStorage();
+		double maxDistance = 0.0;
+		for (unsigned int i = 0; i < storage->getSize(); ++i) {
+			double distance = min(abs(storage->getRawX()[i]), min(abs(storage->getRawY()[i]), abs(storage->getRawZ()[i])));
+			maxDistance = max(maxDistance, distance);
+		}
+		if (e == 1) {
+			CPPUNIT_ASSERT(maxDistance < 0.001);
+		}
+	}
+	CPPUNIT_ASSERT(iterations[1] < iterations[0]);
+
+	/* without normals the point-to-point error is minimized */
+	RigidTransformationEstimationPointToPlane estimator;
+	AngleAxis<double> cubeRotation(M_PI_2/4.0, Vector3d(1,0,0));
+	transformation = cubeRotation;
+	HomogeneousMatrix44 cubeTransformation(&transformation);
+	pointCloudCubeCopy->homogeneousTransformation(&cubeTransformation);
+	vector<CorrespondencePoint3DPair> pointPairs;
+	for (unsigned int i = 0;  i < pointCloudCube->getSize(); ++ i) {
+		pointPairs.push_back(CorrespondencePoint3DPair((*pointCloudCube->getPointCloud())[i], (*pointCloudCubeCopy->getPointCloud())[i]));
+	}
+	HomogeneousMatrix44 resultTransformation;
+	estimator.estimateTransformation(&pointPairs, &resultTransformation);
+	pointCloudCubeCopy->homogeneousTransformation(&resultTransformation);
+	for (unsigned int i = 0;  i < pointCloudCube->getSize(); ++ i) {
+		CPPUNIT_ASSERT_DOUBLES_EQUAL((*pointCloudCube->getPointCloud())[i].getX(), (*pointCloudCubeCopy->getPointCloud())[i].getX(), maxTolerance);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL((*pointCloudCube->getPointCloud())[i].getY(), (*pointCloudCubeCopy->getPointCloud())[i].getY(), maxTolerance);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL((*pointCloudCube->getPointCloud())[i].getZ(), (*pointCloudCubeCopy->getPointCloud())[i].getZ(), maxTolerance);
+	}
+}
+
+void IterativeClosestPointTest::testMultiResolution() {
+	PointCloud3D model;
+	PointCloud3D initialData;
+	createCorner(&model, 0.0);
+	createCorner(&initialData, 0.01);
+
+	AngleAxis<double> rotation(M_PI / 12.0, Vector3d(1,2,3).normalized());
+	Transform3d transformation;
+	transformation = Translation3d(0.2, -0.15, 0.1) * rotation;
+	HomogeneousMatrix44 homogeneousTrans(&transformation);
+	initialData.homogeneousTransformation(&homogeneousTrans);
+
+	IterativeClosestPoint* multiResolutionIcp = new IterativeClosestPoint(new PointCorrespondenceKDTree(),
+			new RigidTransformationEstimationPointToPlane(), 0.000001, 100);
+	CPPUNIT_ASSERT_EQUAL(1, multiResolutionIcp->getNumberOfResolutionLevels());
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, multiResolutionIcp->getCoarsestVoxelSize(), maxTolerance);
+	CPPUNIT_ASSERT_THROW(multiResolutionIcp->setNumberOfResolutionLevels(0), runtime_error);
+	CPPUNIT_ASSERT_THROW(multiResolutionIcp->setCoarsestVoxelSize(-0.1), runtime_error);
+	multiResolutionIcp->setNumberOfResolutionLevels(3);
+	multiResolutionIcp->setCoarsestVoxelSize(0.2);
+	double maxCorrespondenceDistance = multiResolutionIcp->getAssigner()->getMaxCorrespondenceDistance();
+
+	/* match twice, the second run reuses the downsampled model */
+	for (int run = 0; run < 2; ++run) {
+		PointCloud3D data = initialData;
+		HomogeneousMatrix44 resultTransformation;
+		multiResolutionIcp->match(&model, &data, &resultTransformation);
+		CPPUNIT_ASSERT(multiResolutionIcp->icpresultIterations > 0);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(maxCorrespondenceDistance, multiResolutionIcp->getAssigner()->getMaxCorrespondenceDistance(), maxTolerance);
+
+		/* every point lies on one of the surfaces */
+		const PointCloud3DStorage* storage = data.getStorage();
+		double maxDistance = 0.0;
+		for (unsigned int i = 0; i < storage->getSize(); ++i) {
+			double distance = min(abs(storage->getRawX()[i]), min(abs(storage->getRawY()[i]), abs(storage->getRawZ()[i])));
+			maxDistance = max(maxDistance, distance);
+		}
+		CPPUNIT_ASSERT(maxDistance < 0.001);
+
+	}
+	delete multiResolutionIcp;
+
+	/* the search structure of the assigner is only used for the full resolution and is not rebuilt by a second match */
+	int setDataCount = 0;
+	multiResolutionIcp = new IterativeClosestPoint(new PointCorrespondenceGenericNN(new CountingNearestNeighbor(&setDataCount)),
+			new RigidTransformationEstimationPointToPlane(), 0.000001, 100);
+	multiResolutionIcp->setNumberOfResolutionLevels(3);
+	multiResolutionIcp->setCoarsestVoxelSize(0.2);
+	multiResolutionIcp->addCorrespondenceRejection(new CorrespondenceRejectionNormal());
+	for (int run = 0; run < 2; ++run) {
+		PointCloud3D data = initialData;
+		HomogeneousMatrix44 resultTransformation;
+		multiResolutionIcp->match(&model, &data, &resultTransformation);
+		CPPUNIT_ASSERT(multiResolutionIcp->icpResultError >= 0.0);
+		CPPUNIT_ASSERT_EQUAL(1, setDataCount);
+		CPPUNIT_ASSERT(!data.getStorage()->hasChannel(PointCloud3D::normalChannel)); // the estimated data normals are removed
+	}
+	delete multiResolutionIcp;
+}
+
+void IterativeClosestPointTest::testCorrespondenceRejection() {
+	/* the data contains the corner and a cluster of outliers that are not part of the model */
+	PointCloud3D model;
+	PointCloud3D initialData;
+	createCorner(&model, 0.0);
+	createCorner(&initialData, 0.01);
+	unsigned int numberOfInliers = initialData.getSize();
+	srand(42);
+	for (int i = 0; i < 1500; ++i) {
+		initialData.addPoint(Point3D(0.6 + 0.3 * rand() / RAND_MAX, 0.6 + 0.3 * rand() / RAND_MAX, 0.3 + 0.1 * rand() / RAND_MAX));
+	}
+
+	AngleAxis<double> rotation(M_PI / 36.0, Vector3d(1,2,3).normalized());
+	Transform3d transformation;
+	transformation = Translation3d(0.05, -0.03, 0.02) * rotation;
+	HomogeneousMatrix44 homogeneousTrans(&transformation);
+	initialData.homogeneousTransformation(&homogeneousTrans);
+
+	double maxDistances[2];
+	for (int r = 0; r < 2; ++r) {
+		IterativeClosestPoint* rejectionIcp = new IterativeClosestPoint(new PointCorrespondenceKDTree(),
+				new RigidTransformationEstimationSVD(), 0.000001, 100);
+		if (r == 1) {
+			rejectionIcp->addCorrespondenceRejection(new CorrespondenceRejectionPercentile(0.5, 3.0));
+			rejectionIcp->addCorrespondenceRejection(new CorrespondenceRejectionRobustKernel(robustKernel::huber));
+			CPPUNIT_ASSERT_EQUAL(2u, static_cast<unsigned int>(rejectionIcp->getCorrespondenceRejections().size()));
+		}
+
+		PointCloud3D data = initialData;
+		HomogeneousMatrix44 resultTransformation;
+		rejectionIcp->match(&model, &data, &resultTransformation);
+		delete rejectionIcp;
+
+		/* distance of the inliers to the surfaces */
+		const PointCloud3DStorage* storage = data.getStorage();
+		maxDistances[r] = 0.0;
+		for (unsigned int i = 0; i < numberOfInliers; ++i) {
+			double distance = min(abs(storage->getRawX()[i]), min(abs(storage->getRawY()[i]), abs(storage->getRawZ()[i])));
+			maxDistances[r] = max(maxDistances[r], distance);
+		}
+	}
+	LOG(DEBUG) << "Max inlier distance without rejection: " << maxDistances[0] << ", with rejection: " << maxDistances[1];
+	CPPUNIT_ASSERT(maxDistances[1] < 0.5 * maxDistances[0]);
+	CPPUNIT_ASSERT(maxDistances[1] < 0.02); // the point-to-point error cannot reach the surfaces exactly, see testPointToPlane
+
+	/* the stages are owned by the ICP */
+	IterativeClosestPoint setupIcp;
+	setupIcp.addCorrespondenceRejection(new CorrespondenceRejectionPercentile());
+	setupIcp.clearCorrespondenceRejections();
+	CPPUNIT_ASSERT(setupIcp.getCorrespondenceRejections().empty());
+}
+
+void IterativeClosestPointTest::testNotEnoughCorrespondences() {
+	/* model and data are too far apart to find any correspondence */
+	PointCloud3D model;
+	PointCloud3D initialData;
+	createCorner(&model, 0.0);
+	createCorner(&initialData, 0.0);
+	HomogeneousMatrix44 shift(1,0,0, 0,1,0, 0,0,1, 100,0,0);
+	initialData.homogeneousTransformation(&shift);
+
+	for (int levels = 1; levels <= 3; levels += 2) {
+		PointCorrespondenceKDTree* assigner = new PointCorrespondenceKDTree();
+		assigner->setMaxCorrespondenceDistance(0.5);
+		IterativeClosestPoint failingIcp(assigner, new RigidTransformationEstimationSVD(), 0.000001, 20);
+		failingIcp.setNumberOfResolutionLevels(levels);
+		failingIcp.setCoarsestVoxelSize(0.2);
+
+		PointCloud3D data = initialData;
+		HomogeneousMatrix44 resultTransformation(1,0,0, 0,1,0, 0,0,1, 1,2,3);
+		failingIcp.match(&model, &data, &resultTransformation);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(-1.0, failingIcp.icpResultError, maxTolerance);
+
+		/* result and data are unchanged */
+		const double* matrixData = resultTransformation.getRawData();
+		HomogeneousMatrix44 expected(1,0,0, 0,1,0, 0,0,1, 1,2,3);
+		for (int i = 0; i < 16; ++i) {
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.getRawData()[i], matrixData[i], maxTolerance);
+		}
+		CPPUNIT_ASSERT_EQUAL(initialData.getSize(), data.getSize());
+		for (unsigned int i = 0; i < data.getSize(); ++i) {
+			CPPUNIT_ASSERT_DOUBLES_EQUAL((*initialData.getPointCloud())[i].getX(), (*data.getPointCloud())[i].getX(), maxTolerance);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL((*initialData.getPointCloud())[i].getY(), (*data.getPointCloud())[i].getY(), maxTolerance);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL((*initialData.getPointCloud())[i].getZ(), (*data.getPointCloud())[i].getZ(), maxTolerance);
+		}
+
+		/* same for a single iteration */
+		failingIcp.setModel(&model);
+		failingIcp.setData(&data);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(-1.0, failingIcp.performNextIteration(), maxTolerance);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(100.0, (*data.getPointCloud())[0].getX() - (*model.getPointCloud())[0].getX(), maxTolerance);
+	}
+}
+
 }  // namespace unitTests
 
 /* EOF */
@@ -15,11 +15,17 @@
 #include "brics_3d/core/PointCloud3D.h"
 #include "brics_3d/core/HomogeneousMatrix44.h"
 #include "brics_3d/algorithm/registration/PointCorrespondenceKDTree.h"
+#include "brics_3d/algorithm/registration/PointCorrespondenceGenericNN.h"
+#include "brics_3d/algorithm/nearestNeighbor/NearestNeighborKDTree3D.h"
 #include "brics_3d/algorithm/registration/RigidTransformationEstimationSVD.h"
 #include "brics_3d/algorithm/registration/RigidTransformationEstimationQUAT.h"
 #include "brics_3d/algorithm/registration/RigidTransformationEstimationHELIX.h"
 #include "brics_3d/algorithm/registration/RigidTransformationEstimationAPX.h"
+#include "brics_3d/algorithm/registration/RigidTransformationEstimationPointToPlane.h"
 #include "brics_3d/algorithm/registration/IterativeClosestPoint.h"
+#include "brics_3d/algorithm/registration/CorrespondenceRejectionPercentile.h"
+#include "brics_3d/algorithm/registration/CorrespondenceRejectionRobustKernel.h"
+#include "brics_3d/algorithm/registration/CorrespondenceRejectionNormal.h"
 
 #include <Eigen/Geometry>
 #include <iostream>
@@ -39,6 +45,10 @@ class IterativeClosestPointTest : public CPPUNIT_NS::TestFixture {
 	CPPUNIT_TEST( testSimpleAlignmentAPX );
 	CPPUNIT_TEST( testStatefullInterface );
 	CPPUNIT_TEST( testSetupInterface );
+	CPPUNIT_TEST( testPointToPlane );
+	CPPUNIT_TEST( testMultiResolution );
+	CPPUNIT_TEST( testCorrespondenceRejection );
+	CPPUNIT_TEST( testNotEnoughCorrespondences );
 	CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -52,6 +62,10 @@ public:
 	void testSimpleAlignmentAPX();
 	void testStatefullInterface();
 	void testSetupInterface();
+	void testPointToPlane();
+	void testMultiResolution();
+	void testCorrespondenceRejection();
+	void testNotEnoughCorrespondences();
 
 	EIGEN_MAKE_ALIGNED_OPERATOR_NEW //Required by Eigen2
 
@@ -9,7 +9,10 @@
 #include "NearestNeighborTest.h"
 
 #include <sstream>
+#include <fstream>
+#include <cstdio>
 #include <stdexcept>
+#include <algorithm>
 
 using std::runtime_error;
 
@@ -17,6 +20,33 @@ namespace unitTests {
 
 CPPUNIT_TEST_SUITE_REGISTRATION( NearestNeighborTest );
 
+/// Euclidean distance between two points
+static double pointDistance(Point3D& first, Point3D& second) {
+	double dx = first.getX() - second.getX();
+	double dy = first.getY() - second.getY();
+	double dz = first.getZ() - second.getZ();
+	return sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+/// Add uniformly distributed points of the unit cube, shifted by the offset
+static void addRandomPoints(PointCloud3D* cloud, int count, double offsetX = 0.0, double offsetY = 0.0, double offsetZ = 0.0) {
+	for (int i = 0; i < count; ++i) {
+		double x = offsetX + rand() / (RAND_MAX + 1.0);
+		double y = offsetY + rand() / (RAND_MAX + 1.0);
+		double z = offsetZ + rand() / (RAND_MAX + 1.0);
+		cloud->addPoint(Point3D(x, y, z));
+	}
+}
+
+/// Copy a file and overwrite the 32 bit value at the given byte offset of the copy
+static void copyAndPatchFile(const std::string& source, const std::string& destination, long offset, unsigned int value) {
+	std::ifstream inputFile(source.c_str(), std::ios::in | std::ios::binary);
+	std::ofstream outputFile(destination.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	outputFile << inputFile.rdbuf();
+	outputFile.seekp(offset);
+	outputFile.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
 void NearestNeighborTest::setUp() {
 	pointCloudCube = new PointCloud3D();
 
@@ -675,6 +705,796 @@ void NearestNeighborTest::testANNHighDimension() {
 
 }
 
+void NearestNeighborTest::checkBatchQueries(INearestPoint3DNeighbor* nearestNeighbor, INearestNeighborSetup* setup, PointCloud3D* data, PointCloud3D* queries) {
+	vector<int> batchResultIndices;
+	vector<int> resultIndices;
+	double maxDistances[] = {-1.0, 0.05};
+	unsigned int ks[] = {1, 5};
+
+	nearestNeighbor->setData(data);
+	for (int d = 0; d < 2; ++d) {
+		setup->setMaxDistance(maxDistances[d]);
+		for (int n = 0; n < 2; ++n) {
+			unsigned int k = ks[n];
+			nearestNeighbor->findNearestNeighbors(queries, &batchResultIndices, k);
+			CPPUNIT_ASSERT_EQUAL(queries->getSize() * k, static_cast<unsigned int>(batchResultIndices.size()));
+
+			for (unsigned int i = 0; i < queries->getSize(); ++i) {
+				nearestNeighbor->findNearestNeighbors(&(*queries->getPointCloud())[i], &resultIndices, k);
+				CPPUNIT_ASSERT(resultIndices.size() <= k);
+				for (unsigned int j = 0; j < k; ++j) {
+					if (j < resultIndices.size()) {
+						CPPUNIT_ASSERT_EQUAL(resultIndices[j], batchResultIndices[i * k + j]);
+					} else {
+						CPPUNIT_ASSERT_EQUAL(-1, batchResultIndices[i * k + j]); // exceeds max distance
+					}
+				}
+			}
+
+			/* a range has the same results as the corresponding rows */
+			vector<int> rangeResultIndices;
+			unsigned int begin = 100;
+			unsigned int end = 2345;
+			nearestNeighbor->findNearestNeighbors(queries, begin, end, &rangeResultIndices, k);
+			CPPUNIT_ASSERT_EQUAL((end - begin) * k, static_cast<unsigned int>(rangeResultIndices.size()));
+			for (unsigned int i = 0; i < rangeResultIndices.size(); ++i) {
+				CPPUNIT_ASSERT_EQUAL(batchResultIndices[begin * k + i], rangeResultIndices[i]);
+			}
+
+			nearestNeighbor->findNearestNeighbors(queries, begin, begin, &rangeResultIndices, k);
+			CPPUNIT_ASSERT_EQUAL(0u, static_cast<unsigned int>(rangeResultIndices.size()));
+		}
+	}
+	setup->setMaxDistance(-1.0);
+
+	CPPUNIT_ASSERT_THROW(nearestNeighbor->findNearestNeighbors(queries, &batchResultIndices, data->getSize() + 1), runtime_error);
+}
+
+void NearestNeighborTest::testBatchQueries() {
+	PointCloud3D data;
+	PointCloud3D queries;
+	srand(42);
+	addRandomPoints(&data, 3000);
+	addRandomPoints(&queries, 5000);
+
+	NearestNeighborANN ann;
+	checkBatchQueries(&ann, &ann, &data, &queries);
+
+	NearestNeighborFLANN flann;
+	checkBatchQueries(&flann, &flann, &data, &queries);
+
+	NearestNeighborSTANN stann;
+	CPPUNIT_ASSERT_EQUAL(0u, stann.getNumberOfThreads()); // default: all cores
+	stann.setNumberOfThreads(4); // 5000 queries result in 4 ranges
+	checkBatchQueries(&stann, &stann, &data, &queries);
+	stann.setNumberOfThreads(1);
+	checkBatchQueries(&stann, &stann, &data, &queries);
+}
+
+void NearestNeighborTest::checkRadiusSearch(INearestPoint3DNeighbor* nearestNeighbor, PointCloud3D* data, PointCloud3D* queries, bool isExact) {
+	vector<int> resultIndices;
+	double radius = 0.1;
+	unsigned int maxResults = 5;
+	unsigned int totalResults = 0;
+
+	nearestNeighbor->setData(data);
+	for (unsigned int i = 0; i < queries->getSize(); ++i) {
+		Point3D* query = &(*queries->getPointCloud())[i];
+
+		/* brute force reference */
+		vector<std::pair<double, int> > reference;
+		for (unsigned int j = 0; j < data->getSize(); ++j) {
+			double distance = pointDistance(*query, (*data->getPointCloud())[j]);
+			if (distance <= radius) {
+				reference.push_back(std::make_pair(distance, static_cast<int>(j)));
+			}
+		}
+		std::sort(reference.begin(), reference.end());
+
+		nearestNeighbor->findNeighborsWithinRadius(query, &resultIndices, radius);
+		totalResults += resultIndices.size();
+		if (isExact) {
+			CPPUNIT_ASSERT_EQUAL(reference.size(), resultIndices.size());
+		} else {
+			CPPUNIT_ASSERT(resultIndices.size() <= reference.size()); // approximate search might miss some
+		}
+		double previousDistance = 0.0;
+		for (unsigned int j = 0; j < resultIndices.size(); ++j) {
+			double distance = pointDistance(*query, (*data->getPointCloud())[resultIndices[j]]);
+			CPPUNIT_ASSERT(distance <= radius + maxTolerance);
+			CPPUNIT_ASSERT(distance >= previousDistance - maxTolerance); // sorted by distance
+			if (isExact) {
+				CPPUNIT_ASSERT_DOUBLES_EQUAL(reference[j].first, distance, maxTolerance);
+			}
+			previousDistance = distance;
+		}
+
+		/* limited number of results: the closest ones */
+		vector<int> limitedResultIndices;
+		nearestNeighbor->findNeighborsWithinRadius(query, &limitedResultIndices, radius, maxResults);
+		CPPUNIT_ASSERT(limitedResultIndices.size() <= maxResults);
+		if (isExact) {
+			CPPUNIT_ASSERT_EQUAL(std::min(static_cast<unsigned int>(reference.size()), maxResults), static_cast<unsigned int>(limitedResultIndices.size()));
+			for (unsigned int j = 0; j < limitedResultIndices.size(); ++j) {
+				double distance = pointDistance(*query, (*data->getPointCloud())[limitedResultIndices[j]]);
+				CPPUNIT_ASSERT_DOUBLES_EQUAL(reference[j].first, distance, maxTolerance);
+			}
+		}
+	}
+	CPPUNIT_ASSERT(totalResults > queries->getSize()); // the test data has some neighbors on average
+
+	nearestNeighbor->findNeighborsWithinRadius(&(*queries->getPointCloud())[0], &resultIndices, -1.0);
+	CPPUNIT_ASSERT_EQUAL(0u, static_cast<unsigned int>(resultIndices.size()));
+}
+
+void NearestNeighborTest::checkDistanceQueries(INearestPoint3DNeighbor* nearestNeighbor, INearestNeighborSetup* setup, PointCloud3D* data, PointCloud3D* queries) {
+	vector<int> resultIndices;
+	vector<int> referenceIndices;
+	vector<double> resultDistances;
+	unsigned int k = 4;
+	double radius = 0.1;
+	double tolerance = 0.0001; // FLANN works with single precision
+
+	nearestNeighbor->setData(data);
+	for (unsigned int i = 0; i < queries->getSize(); ++i) {
+		Point3D* query = &(*queries->getPointCloud())[i];
+
+		/* k nearest neighbors: same indices as without distances */
+		nearestNeighbor->findNearestNeighbors(query, &referenceIndices, k);
+		nearestNeighbor->findNearestNeighbors(query, &resultIndices, &resultDistances, k);
+		CPPUNIT_ASSERT_EQUAL(k, static_cast<unsigned int>(resultIndices.size()));
+		CPPUNIT_ASSERT_EQUAL(k, static_cast<unsigned int>(resultDistances.size()));
+		for (unsigned int j = 0; j < k; ++j) {
+			CPPUNIT_ASSERT_EQUAL(referenceIndices[j], resultIndices[j]);
+			double distance = pointDistance(*query, (*data->getPointCloud())[resultIndices[j]]);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(distance, resultDistances[j], tolerance);
+		}
+
+		nearestNeighbor->findNearestNeighbors(query, &resultIndices, &resultDistances, k, neighborDistance::squaredEuclidean);
+		CPPUNIT_ASSERT_EQUAL(k, static_cast<unsigned int>(resultDistances.size()));
+		for (unsigned int j = 0; j < k; ++j) {
+			double distance = pointDistance(*query, (*data->getPointCloud())[resultIndices[j]]);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(distance * distance, resultDistances[j], tolerance);
+		}
+
+		/* fixed radius */
+		nearestNeighbor->findNeighborsWithinRadius(query, &referenceIndices, radius);
+		nearestNeighbor->findNeighborsWithinRadius(query, &resultIndices, &resultDistances, radius);
+		CPPUNIT_ASSERT_EQUAL(referenceIndices.size(), resultIndices.size());
+		CPPUNIT_ASSERT_EQUAL(resultIndices.size(), resultDistances.size());
+		for (unsigned int j = 0; j < resultIndices.size(); ++j) {
+			CPPUNIT_ASSERT_EQUAL(referenceIndices[j], resultIndices[j]);
+			double distance = pointDistance(*query, (*data->getPointCloud())[resultIndices[j]]);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(distance, resultDistances[j], tolerance);
+			CPPUNIT_ASSERT(resultDistances[j] <= radius + tolerance);
+		}
+
+		nearestNeighbor->findNeighborsWithinRadius(query, &resultIndices, &resultDistances, radius, 2, neighborDistance::squaredEuclidean);
+		CPPUNIT_ASSERT(resultIndices.size() <= 2);
+		CPPUNIT_ASSERT_EQUAL(resultIndices.size(), resultDistances.size());
+		for (unsigned int j = 0; j < resultIndices.size(); ++j) {
+			double distance = pointDistance(*query, (*data->getPointCloud())[resultIndices[j]]);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(distance * distance, resultDistances[j], tolerance);
+		}
+	}
+
+	/* batch: -1 for both index and distance beyond the max distance */
+	setup->setMaxDistance(0.05);
+	nearestNeighbor->findNearestNeighbors(queries, 0, queries->getSize(), &referenceIndices, k);
+	nearestNeighbor->findNearestNeighbors(queries, 0, queries->getSize(), &resultIndices, &resultDistances, k);
+	CPPUNIT_ASSERT_EQUAL(queries->getSize() * k, static_cast<unsigned int>(resultIndices.size()));
+	CPPUNIT_ASSERT_EQUAL(queries->getSize() * k, static_cast<unsigned int>(resultDistances.size()));
+	unsigned int rejected = 0;
+	for (unsigned int i = 0; i < resultIndices.size(); ++i) {
+		CPPUNIT_ASSERT_EQUAL(referenceIndices[i], resultIndices[i]);
+		if (resultIndices[i] < 0) {
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(-1.0, resultDistances[i], 0.0);
+			rejected++;
+			continue;
+		}
+		double distance = pointDistance((*queries->getPointCloud())[i / k], (*data->getPointCloud())[resultIndices[i]]);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(distance, resultDistances[i], tolerance);
+		CPPUNIT_ASSERT(resultDistances[i] <= 0.05 + tolerance);
+	}
+	CPPUNIT_ASSERT(rejected > 0);
+	CPPUNIT_ASSERT(rejected < resultIndices.size());
+
+	nearestNeighbor->findNearestNeighbors(queries, 10, 20, &resultIndices, &resultDistances, k, neighborDistance::squaredEuclidean);
+	CPPUNIT_ASSERT_EQUAL(10 * k, static_cast<unsigned int>(resultDistances.size()));
+	for (unsigned int i = 0; i < resultIndices.size(); ++i) {
+		if (resultIndices[i] >= 0) {
+			double distance = pointDistance((*queries->getPointCloud())[10 + i / k], (*data->getPointCloud())[resultIndices[i]]);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(distance * distance, resultDistances[i], tolerance);
+		}
+	}
+	setup->setMaxDistance(-1.0);
+}
+
+void NearestNeighborTest::testDistanceQueries() {
+	PointCloud3D data;
+	PointCloud3D queries;
+	srand(7);
+	addRandomPoints(&data, 2000);
+	addRandomPoints(&queries, 300);
+
+	NearestNeighborANN ann;
+	checkDistanceQueries(&ann, &ann, &data, &queries);
+
+	NearestNeighborFLANN flann;
+	checkDistanceQueries(&flann, &flann, &data, &queries);
+
+	NearestNeighborSTANN stann;
+	stann.setNumberOfThreads(2);
+	checkDistanceQueries(&stann, &stann, &data, &queries);
+}
+
+void NearestNeighborTest::testRadiusSearch() {
+	PointCloud3D data;
+	PointCloud3D queries;
+	srand(23);
+	addRandomPoints(&data, 2000);
+	addRandomPoints(&queries, 200);
+
+	NearestNeighborANN ann;
+	checkRadiusSearch(&ann, &data, &queries, true);
+
+	NearestNeighborSTANN stann;
+	checkRadiusSearch(&stann, &data, &queries, true);
+
+	NearestNeighborFLANN flann;
+	checkRadiusSearch(&flann, &data, &queries, false);
+
+	/* small data sets are searched completely by FLANN */
+	vector<int> resultIndices;
+	flann.setData(pointCloudCube);
+	flann.findNeighborsWithinRadius(point000, &resultIndices, 1.0);
+	CPPUNIT_ASSERT_EQUAL(4u, static_cast<unsigned int>(resultIndices.size())); // the point itself and 3 neighbors
+	flann.findNeighborsWithinRadius(point000, &resultIndices, 0.999);
+	CPPUNIT_ASSERT_EQUAL(1u, static_cast<unsigned int>(resultIndices.size()));
+
+	/* generic interface */
+	vector< vector<double> > genericData;
+	for (unsigned int i = 0; i < pointCloudCube->getSize(); ++i) {
+		vector<double> point(3);
+		point[0] = (*pointCloudCube->getPointCloud())[i].getX();
+		point[1] = (*pointCloudCube->getPointCloud())[i].getY();
+		point[2] = (*pointCloudCube->getPointCloud())[i].getZ();
+		genericData.push_back(point);
+	}
+	ann.setData(&genericData);
+	ann.findNeighborsWithinRadius(&genericData[0], &resultIndices, 1.0);
+	CPPUNIT_ASSERT_EQUAL(4u, static_cast<unsigned int>(resultIndices.size()));
+	CPPUNIT_ASSERT_EQUAL(0, resultIndices[0]);
+	ann.findNeighborsWithinRadius(&genericData[0], &resultIndices, 1.0, 2);
+	CPPUNIT_ASSERT_EQUAL(2u, static_cast<unsigned int>(resultIndices.size()));
+
+	flann.setData(&genericData);
+	flann.findNeighborsWithinRadius(&genericData[0], &resultIndices, 1.0);
+	CPPUNIT_ASSERT_EQUAL(4u, static_cast<unsigned int>(resultIndices.size()));
+	CPPUNIT_ASSERT_EQUAL(0, resultIndices[0]);
+
+	vector<double> invalidQuery(4);
+	CPPUNIT_ASSERT_THROW(ann.findNeighborsWithinRadius(&invalidQuery, &resultIndices, 1.0), runtime_error);
+	CPPUNIT_ASSERT_THROW(flann.findNeighborsWithinRadius(&invalidQuery, &resultIndices, 1.0), runtime_error);
+}
+
+void NearestNeighborTest::testKDTree3D() {
+	NearestNeighborKDTree3D kdTree;
+	CPPUNIT_ASSERT_EQUAL(16u, kdTree.getMaxLeafSize());
+	kdTree.setMaxLeafSize(6);
+	CPPUNIT_ASSERT_EQUAL(8u, kdTree.getMaxLeafSize()); // multiple of the SIMD width
+	kdTree.setMaxLeafSize(0);
+	CPPUNIT_ASSERT_EQUAL(4u, kdTree.getMaxLeafSize());
+
+	/* a cloud far from the origin with duplicates */
+	PointCloud3D data;
+	PointCloud3D queries;
+	srand(11);
+	addRandomPoints(&data, 3000, 1000.0, -500.0);
+	for (int i = 0; i < 50; ++i) {
+		data.addPoint(Point3D(1000.5, -499.5, 0.5));
+	}
+	addRandomPoints(&queries, 5000, 1000.0, -500.0);
+
+	/* same neighbors as the ANN reference */
+	NearestNeighborANN ann;
+	ann.setData(&data);
+	vector<int> resultIndices;
+	vector<int> referenceIndices;
+	unsigned int leafSizes[] = {4, 16, 64};
+	for (int l = 0; l < 3; ++l) {
+		kdTree.setMaxLeafSize(leafSizes[l]);
+		kdTree.setData(&data);
+		CPPUNIT_ASSERT_EQUAL(data.getSize(), kdTree.getSize());
+		CPPUNIT_ASSERT_EQUAL(3, kdTree.getDimension());
+		for (unsigned int i = 0; i < 500; ++i) {
+			Point3D* query = &(*queries.getPointCloud())[i];
+			kdTree.findNearestNeighbors(query, &resultIndices, 5);
+			ann.findNearestNeighbors(query, &referenceIndices, 5);
+			CPPUNIT_ASSERT_EQUAL(referenceIndices.size(), resultIndices.size());
+			for (unsigned int j = 0; j < resultIndices.size(); ++j) { // compare distances as the order of equal distances is arbitrary
+				CPPUNIT_ASSERT_DOUBLES_EQUAL(pointDistance(*query, (*data.getPointCloud())[referenceIndices[j]]),
+						pointDistance(*query, (*data.getPointCloud())[resultIndices[j]]), maxTolerance);
+			}
+		}
+	}
+
+	kdTree.setMaxLeafSize(16);
+	kdTree.setNumberOfThreads(4);
+	checkBatchQueries(&kdTree, &kdTree, &data, &queries);
+	checkRadiusSearch(&kdTree, &data, &queries, true);
+	checkDistanceQueries(&kdTree, &kdTree, &data, &queries);
+
+	/* the duplicates are found with the radius search */
+	Point3D duplicate(1000.5, -499.5, 0.5);
+	kdTree.setData(&data);
+	kdTree.findNeighborsWithinRadius(&duplicate, &resultIndices, 0.0);
+	CPPUNIT_ASSERT_EQUAL(50u, static_cast<unsigned int>(resultIndices.size()));
+
+	/* points exactly on the radius are found, as with the double precision backends */
+	for (unsigned int i = 0; i < 200; ++i) {
+		Point3D* query = &(*queries.getPointCloud())[i];
+		double radius = pointDistance(*query, (*data.getPointCloud())[i]);
+		kdTree.findNeighborsWithinRadius(query, &resultIndices, radius);
+		CPPUNIT_ASSERT(std::find(resultIndices.begin(), resultIndices.end(), static_cast<int>(i)) != resultIndices.end());
+		for (unsigned int j = 0; j < resultIndices.size(); ++j) {
+			CPPUNIT_ASSERT(pointDistance(*query, (*data.getPointCloud())[resultIndices[j]]) <= radius);
+		}
+	}
+
+	/* small data sets and the generic interface */
+	kdTree.setData(pointCloudCube);
+	kdTree.findNearestNeighbors(point000, &resultIndices, 1);
+	CPPUNIT_ASSERT_EQUAL(1u, static_cast<unsigned int>(resultIndices.size()));
+	CPPUNIT_ASSERT_EQUAL(0, resultIndices[0]);
+	kdTree.findNeighborsWithinRadius(point000, &resultIndices, 1.0);
+	CPPUNIT_ASSERT_EQUAL(4u, static_cast<unsigned int>(resultIndices.size()));
+	CPPUNIT_ASSERT_THROW(kdTree.findNearestNeighbors(point000, &resultIndices, pointCloudCube->getSize() + 1), runtime_error);
+
+	vector< vector<double> > genericData;
+	for (unsigned int i = 0; i < pointCloudCube->getSize(); ++i) {
+		vector<double> point(3);
+		point[0] = (*pointCloudCube->getPointCloud())[i].getX();
+		point[1] = (*pointCloudCube->getPointCloud())[i].getY();
+		point[2] = (*pointCloudCube->getPointCloud())[i].getZ();
+		genericData.push_back(point);
+	}
+	kdTree.setData(&genericData);
+	kdTree.findNearestNeighbors(&genericData[0], &resultIndices, 1);
+	CPPUNIT_ASSERT_EQUAL(1u, static_cast<unsigned int>(resultIndices.size()));
+	CPPUNIT_ASSERT_EQUAL(0, resultIndices[0]);
+
+	vector<double> invalidQuery(4);
+	CPPUNIT_ASSERT_THROW(kdTree.findNearestNeighbors(&invalidQuery, &resultIndices, 1), runtime_error);
+	vector< vector<double> > invalidData(2, invalidQuery);
+	CPPUNIT_ASSERT_THROW(kdTree.setData(&invalidData), runtime_error);
+
+	/* empty data */
+	PointCloud3D emptyCloud;
+	kdTree.setData(&emptyCloud);
+	kdTree.findNeighborsWithinRadius(point000, &resultIndices, 1.0);
+	CPPUNIT_ASSERT_EQUAL(0u, static_cast<unsigned int>(resultIndices.size()));
+	CPPUNIT_ASSERT_THROW(kdTree.findNearestNeighbors(point000, &resultIndices, 1), runtime_error);
+}
+
+void NearestNeighborTest::testVoxelGrid() {
+	NearestNeighborVoxelGrid voxelGrid;
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, voxelGrid.getVoxelSize(), maxTolerance); // automatic
+	CPPUNIT_ASSERT_THROW(voxelGrid.setVoxelSize(-1.0), runtime_error);
+
+	PointCloud3D data;
+	PointCloud3D queries;
+	srand(13);
+	addRandomPoints(&data, 3000);
+	addRandomPoints(&queries, 5000);
+	for (int i = 0; i < 20; ++i) { // some queries outside of the grid
+		queries.addPoint(Point3D(-2.0 + 0.5 * i, 1.5, -0.3));
+	}
+
+	/* same neighbors as the ANN reference for different voxel sizes */
+	NearestNeighborANN ann;
+	ann.setData(&data);
+	vector<int> resultIndices;
+	vector<int> referenceIndices;
+	double voxelSizes[] = {0.0, 0.02, 0.1, 0.5, 2.0};
+	for (int v = 0; v < 5; ++v) {
+		voxelGrid.setVoxelSize(voxelSizes[v]);
+		voxelGrid.setNumberOfThreads(3);
+		voxelGrid.setData(&data);
+		CPPUNIT_ASSERT_EQUAL(data.getSize(), voxelGrid.getSize());
+		CPPUNIT_ASSERT(voxelGrid.getEffectiveVoxelSize() > 0.0);
+		CPPUNIT_ASSERT(voxelGrid.getNumberOfVoxels() > 0);
+		CPPUNIT_ASSERT(voxelGrid.getNumberOfVoxels() <= data.getSize());
+		for (unsigned int i = 0; i < queries.getSize(); i += 10) {
+			Point3D* query = &(*queries.getPointCloud())[i];
+			voxelGrid.findNearestNeighbors(query, &resultIndices, 5);
+			ann.findNearestNeighbors(query, &referenceIndices, 5);
+			CPPUNIT_ASSERT_EQUAL(referenceIndices.size(), resultIndices.size());
+			for (unsigned int j = 0; j < resultIndices.size(); ++j) {
+				CPPUNIT_ASSERT_DOUBLES_EQUAL(pointDistance(*query, (*data.getPointCloud())[referenceIndices[j]]),
+						pointDistance(*query, (*data.getPointCloud())[resultIndices[j]]), maxTolerance);
+			}
+		}
+	}
+
+	/* parallel construction gives the same grid as a sequential one */
+	NearestNeighborVoxelGrid sequentialGrid(0.1);
+	sequentialGrid.setNumberOfThreads(1);
+	sequentialGrid.setData(&data);
+	voxelGrid.setVoxelSize(0.1);
+	voxelGrid.setNumberOfThreads(4);
+	voxelGrid.setData(&data);
+	CPPUNIT_ASSERT_EQUAL(sequentialGrid.getNumberOfVoxels(), voxelGrid.getNumberOfVoxels());
+
+	checkBatchQueries(&voxelGrid, &voxelGrid, &data, &queries);
+	checkRadiusSearch(&voxelGrid, &data, &queries, true);
+	checkDistanceQueries(&voxelGrid, &voxelGrid, &data, &queries);
+
+	/* a large radius compared to the voxel size finds all points */
+	voxelGrid.setVoxelSize(0.02);
+	voxelGrid.setData(&data);
+	voxelGrid.findNeighborsWithinRadius(&(*queries.getPointCloud())[0], &resultIndices, 10.0);
+	CPPUNIT_ASSERT_EQUAL(data.getSize(), static_cast<unsigned int>(resultIndices.size()));
+	voxelGrid.findNeighborsWithinRadius(&(*queries.getPointCloud())[0], &resultIndices, 10.0, 7);
+	CPPUNIT_ASSERT_EQUAL(7u, static_cast<unsigned int>(resultIndices.size()));
+
+	/* planar data with the automatic voxel size */
+	PointCloud3D plane;
+	for (int i = 0; i < 100; ++i) {
+		for (int j = 0; j < 100; ++j) {
+			plane.addPoint(Point3D(0.01 * i, 0.01 * j, 5.0));
+		}
+	}
+	voxelGrid.setVoxelSize(0.0);
+	voxelGrid.setData(&plane);
+	CPPUNIT_ASSERT(voxelGrid.getNumberOfVoxels() > 100);
+	Point3D planeQuery(0.5, 0.5, 5.001);
+	voxelGrid.findNeighborsWithinRadius(&planeQuery, &resultIndices, 0.0101);
+	CPPUNIT_ASSERT_EQUAL(5u, static_cast<unsigned int>(resultIndices.size())); // the closest point and its 4 neighbors
+	voxelGrid.findNearestNeighbors(&planeQuery, &resultIndices, 1);
+	CPPUNIT_ASSERT_EQUAL(50 * 100 + 50, resultIndices[0]);
+
+	/* small and empty data */
+	voxelGrid.setData(pointCloudCube);
+	voxelGrid.findNearestNeighbors(point000, &resultIndices, 1);
+	CPPUNIT_ASSERT_EQUAL(0, resultIndices[0]);
+	voxelGrid.findNeighborsWithinRadius(point000, &resultIndices, 1.0);
+	CPPUNIT_ASSERT_EQUAL(4u, static_cast<unsigned int>(resultIndices.size()));
+	CPPUNIT_ASSERT_THROW(voxelGrid.findNearestNeighbors(point000, &resultIndices, pointCloudCube->getSize() + 1), runtime_error);
+
+	PointCloud3D emptyCloud;
+	voxelGrid.setData(&emptyCloud);
+	voxelGrid.findNeighborsWithinRadius(point000, &resultIndices, 1.0);
+	CPPUNIT_ASSERT_EQUAL(0u, static_cast<unsigned int>(resultIndices.size()));
+	CPPUNIT_ASSERT_THROW(voxelGrid.findNearestNeighbors(point000, &resultIndices, 1), runtime_error);
+}
+
+void NearestNeighborTest::testDynamicKDTree3D() {
+	NearestNeighborDynamicKDTree3D dynamicTree;
+	CPPUNIT_ASSERT_EQUAL(0u, dynamicTree.getSize());
+
+	/* all points in the order of insertion, i.e. the position is the index of the dynamic tree */
+	PointCloud3D allPoints;
+	PointCloud3D scans[3];
+	PointCloud3D queries;
+	srand(17);
+	for (int s = 0; s < 3; ++s) {
+		addRandomPoints(&scans[s], 1000);
+		for (unsigned int i = 0; i < scans[s].getSize(); ++i) {
+			allPoints.addPoint((*scans[s].getPointCloud())[i]);
+		}
+	}
+	addRandomPoints(&queries, 3000);
+
+	dynamicTree.setData(&scans[0]);
+	CPPUNIT_ASSERT_EQUAL(1000u, dynamicTree.addPoints(&scans[1]));
+	CPPUNIT_ASSERT_EQUAL(2000u, dynamicTree.addPoints(&scans[2]));
+	CPPUNIT_ASSERT_EQUAL(3000u, dynamicTree.getSize());
+	CPPUNIT_ASSERT_EQUAL(3000u, dynamicTree.getNumberOfIndices());
+
+	/* remove every third point and a large block, that compacts a sub-tree */
+	vector<int> removeIndices;
+	for (int i = 0; i < 3000; i += 3) {
+		removeIndices.push_back(i);
+	}
+	for (int i = 1000; i < 1600; ++i) {
+		removeIndices.push_back(i);
+	}
+	dynamicTree.removePoints(removeIndices);
+	dynamicTree.removePoints(removeIndices); // already removed points are ignored
+	CPPUNIT_ASSERT(dynamicTree.isRemoved(3));
+	CPPUNIT_ASSERT(!dynamicTree.isRemoved(4));
+	CPPUNIT_ASSERT(dynamicTree.isRemoved(1001));
+	vector<int> invalidIndices(1, 3000);
+	CPPUNIT_ASSERT_THROW(dynamicTree.removePoints(invalidIndices), runtime_error);
+
+	/* reference: a static tree of the remaining points */
+	PointCloud3D remainingPoints;
+	vector<int> remainingIndices;
+	for (unsigned int i = 0; i < allPoints.getSize(); ++i) {
+		if (!dynamicTree.isRemoved(i)) {
+			remainingPoints.addPoint((*allPoints.getPointCloud())[i]);
+			remainingIndices.push_back(i);
+		}
+	}
+	CPPUNIT_ASSERT_EQUAL(remainingPoints.getSize(), dynamicTree.getSize());
+	NearestNeighborKDTree3D reference;
+	reference.setData(&remainingPoints);
+
+	vector<int> resultIndices;
+	vector<int> referenceIndices;
+	for (unsigned int i = 0; i < queries.getSize(); i += 10) {
+		Point3D* query = &(*queries.getPointCloud())[i];
+		dynamicTree.findNearestNeighbors(query, &resultIndices, 5);
+		reference.findNearestNeighbors(query, &referenceIndices, 5);
+		CPPUNIT_ASSERT_EQUAL(referenceIndices.size(), resultIndices.size());
+		for (unsigned int j = 0; j < resultIndices.size(); ++j) {
+			CPPUNIT_ASSERT(!dynamicTree.isRemoved(resultIndices[j]));
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(pointDistance(*query, (*remainingPoints.getPointCloud())[referenceIndices[j]]),
+					pointDistance(*query, (*allPoints.getPointCloud())[resultIndices[j]]), maxTolerance);
+		}
+
+		dynamicTree.findNeighborsWithinRadius(query, &resultIndices, 0.1);
+		reference.findNeighborsWithinRadius(query, &referenceIndices, 0.1);
+		CPPUNIT_ASSERT_EQUAL(referenceIndices.size(), resultIndices.size());
+		for (unsigned int j = 0; j < resultIndices.size(); ++j) {
+			CPPUNIT_ASSERT_EQUAL(remainingIndices[referenceIndices[j]], resultIndices[j]);
+		}
+		dynamicTree.findNeighborsWithinRadius(query, &resultIndices, 0.1, 3);
+		CPPUNIT_ASSERT(resultIndices.size() <= 3);
+		for (unsigned int j = 0; j < resultIndices.size(); ++j) {
+			CPPUNIT_ASSERT_EQUAL(remainingIndices[referenceIndices[j]], resultIndices[j]);
+		}
+	}
+
+	/* batched queries skip the removed points as well */
+	dynamicTree.setNumberOfThreads(3);
+	vector<int> batchResultIndices;
+	dynamicTree.findNearestNeighbors(&queries, &batchResultIndices, 3);
+	for (unsigned int i = 0; i < queries.getSize(); i += 10) {
+		dynamicTree.findNearestNeighbors(&(*queries.getPointCloud())[i], &resultIndices, 3);
+		for (unsigned int j = 0; j < 3; ++j) {
+			CPPUNIT_ASSERT_EQUAL(resultIndices[j], batchResultIndices[i * 3 + j]);
+		}
+	}
+
+	/* many small updates keep the number of sub-trees logarithmic */
+	for (unsigned int i = 0; i < 500; ++i) {
+		PointCloud3D singlePoint;
+		addRandomPoints(&singlePoint, 1);
+		CPPUNIT_ASSERT_EQUAL(3000u + i, dynamicTree.addPoints(&singlePoint));
+		CPPUNIT_ASSERT(dynamicTree.getNumberOfSubtrees() <= 12);
+	}
+	CPPUNIT_ASSERT_EQUAL(remainingPoints.getSize() + 500, dynamicTree.getSize());
+
+	/* removing all points leaves an empty index */
+	vector<int> allIndices;
+	for (unsigned int i = 0; i < dynamicTree.getNumberOfIndices(); ++i) {
+		allIndices.push_back(i);
+	}
+	dynamicTree.removePoints(allIndices);
+	CPPUNIT_ASSERT_EQUAL(0u, dynamicTree.getSize());
+	CPPUNIT_ASSERT_EQUAL(0u, dynamicTree.getNumberOfSubtrees());
+	dynamicTree.findNeighborsWithinRadius(point000, &resultIndices, 10.0);
+	CPPUNIT_ASSERT_EQUAL(0u, static_cast<unsigned int>(resultIndices.size()));
+	CPPUNIT_ASSERT_THROW(dynamicTree.findNearestNeighbors(point000, &resultIndices, 1), runtime_error);
+
+	/* without updates it behaves as the other search structures */
+	PointCloud3D data;
+	addRandomPoints(&data, 3000);
+	checkBatchQueries(&dynamicTree, &dynamicTree, &data, &queries);
+	checkRadiusSearch(&dynamicTree, &data, &queries, true);
+	checkDistanceQueries(&dynamicTree, &dynamicTree, &data, &queries);
+	CPPUNIT_ASSERT_EQUAL(data.getSize(), dynamicTree.getNumberOfIndices()); // setData starts again with index 0
+
+	dynamicTree.setData(pointCloudCube);
+	dynamicTree.findNearestNeighbors(point000, &resultIndices, 1);
+	CPPUNIT_ASSERT_EQUAL(0, resultIndices[0]);
+}
+
+void NearestNeighborTest::testKDTree3DFile() {
+	std::string filename = "brics_3d_nearest_neighbor_test.kdtree";
+	PointCloud3D data;
+	PointCloud3D queries;
+	srand(19);
+	addRandomPoints(&data, 3000);
+	addRandomPoints(&queries, 3000);
+
+	NearestNeighborKDTree3D kdTree;
+	kdTree.setMaxLeafSize(8);
+	kdTree.setData(&data);
+	CPPUNIT_ASSERT(!kdTree.save(filename, pointCloudCube->getStorage())); // not the data of the tree
+	CPPUNIT_ASSERT(kdTree.save(filename, data.getStorage()));
+
+	/* the loaded tree gives the same results as the original one */
+	NearestNeighborKDTree3D loadedTree;
+	PointCloud3DStorage storedData;
+	CPPUNIT_ASSERT(!loadedTree.getStoredData(&storedData));
+	CPPUNIT_ASSERT(loadedTree.load(filename, data.getStorage()));
+	CPPUNIT_ASSERT_EQUAL(data.getSize(), loadedTree.getSize());
+	CPPUNIT_ASSERT_EQUAL(8u, loadedTree.getMaxLeafSize());
+
+	vector<int> resultIndices;
+	vector<int> referenceIndices;
+	vector<double> resultDistances;
+	vector<double> referenceDistances;
+	for (unsigned int i = 0; i < queries.getSize(); i += 10) {
+		Point3D* query = &(*queries.getPointCloud())[i];
+		loadedTree.findNearestNeighbors(query, &resultIndices, &resultDistances, 5);
+		kdTree.findNearestNeighbors(query, &referenceIndices, &referenceDistances, 5);
+		CPPUNIT_ASSERT(referenceIndices == resultIndices);
+		CPPUNIT_ASSERT(referenceDistances == resultDistances);
+		loadedTree.findNeighborsWithinRadius(query, &resultIndices, 0.1);
+		kdTree.findNeighborsWithinRadius(query, &referenceIndices, 0.1);
+		CPPUNIT_ASSERT(referenceIndices == resultIndices);
+	}
+	loadedTree.setNumberOfThreads(3);
+	loadedTree.findNearestNeighbors(&queries, &resultIndices, 3);
+	kdTree.findNearestNeighbors(&queries, &referenceIndices, 3);
+	CPPUNIT_ASSERT(referenceIndices == resultIndices);
+
+	/* the points are stored along with the tree */
+	CPPUNIT_ASSERT(loadedTree.getStoredData(&storedData));
+	CPPUNIT_ASSERT_EQUAL(data.getSize(), storedData.getSize());
+	CPPUNIT_ASSERT_EQUAL(NearestNeighborKDTree3D::getDataHash(data.getStorage()), NearestNeighborKDTree3D::getDataHash(&storedData));
+
+	/* rejected files keep the current tree */
+	PointCloud3D changedData(data);
+	changedData.getMutableStorage()->setPoint(17, 0.5, 0.5, 0.5);
+	CPPUNIT_ASSERT(NearestNeighborKDTree3D::getDataHash(data.getStorage()) != NearestNeighborKDTree3D::getDataHash(changedData.getStorage()));
+	CPPUNIT_ASSERT(!loadedTree.load(filename, changedData.getStorage()));
+	CPPUNIT_ASSERT(!loadedTree.load("this_file_does_not_exist.kdtree"));
+	std::string invalidFilename = "brics_3d_nearest_neighbor_test_invalid.kdtree";
+	std::ofstream outputFile(invalidFilename.c_str());
+	outputFile << "no k-d tree";
+	outputFile.close();
+	CPPUNIT_ASSERT(!loadedTree.load(invalidFilename));
+	/* corrupt headers and nodes: the header has 56 bytes, the nodes start at byte 64 and have 32 bytes each */
+	copyAndPatchFile(filename, invalidFilename, 28, 0x08000001u); // numberOfNodes * nodeSize overflows 32 bit
+	CPPUNIT_ASSERT(!loadedTree.load(invalidFilename));
+	copyAndPatchFile(filename, invalidFilename, 64 + 16, 0xFFFFFFFFu); // right child of the root
+	CPPUNIT_ASSERT(!loadedTree.load(invalidFilename));
+	copyAndPatchFile(filename, invalidFilename, 64 + 16, 0u); // right child of the root refers to the root again
+	CPPUNIT_ASSERT(!loadedTree.load(invalidFilename));
+	copyAndPatchFile(filename, invalidFilename, 24, 1u); // numberOfPoints, the leafs refer to more points
+	CPPUNIT_ASSERT(!loadedTree.load(invalidFilename));
+	std::remove(invalidFilename.c_str());
+	CPPUNIT_ASSERT_EQUAL(data.getSize(), loadedTree.getSize());
+	loadedTree.findNearestNeighbors(&(*queries.getPointCloud())[0], &resultIndices, 1);
+	kdTree.findNearestNeighbors(&(*queries.getPointCloud())[0], &referenceIndices, 1);
+	CPPUNIT_ASSERT_EQUAL(referenceIndices[0], resultIndices[0]);
+
+	/* setData replaces a loaded tree */
+	loadedTree.setData(pointCloudCube);
+	CPPUNIT_ASSERT(!loadedTree.getStoredData(&storedData));
+	loadedTree.findNearestNeighbors(point000, &resultIndices, 1);
+	CPPUNIT_ASSERT_EQUAL(0, resultIndices[0]);
+
+	/* saving replaces the file, a tree that has loaded it is not affected */
+	CPPUNIT_ASSERT(loadedTree.load(filename, data.getStorage()));
+	kdTree.setData(pointCloudCube);
+	CPPUNIT_ASSERT(kdTree.save(filename, pointCloudCube->getStorage()));
+	CPPUNIT_ASSERT_EQUAL(data.getSize(), loadedTree.getSize());
+	loadedTree.findNeighborsWithinRadius(&(*queries.getPointCloud())[0], &resultIndices, 0.1);
+	CPPUNIT_ASSERT(resultIndices.size() > 0);
+
+	/* empty tree */
+	PointCloud3D emptyCloud;
+	kdTree.setData(&emptyCloud);
+	CPPUNIT_ASSERT(kdTree.save(filename, emptyCloud.getStorage()));
+	CPPUNIT_ASSERT(loadedTree.load(filename, emptyCloud.getStorage()));
+	CPPUNIT_ASSERT_EQUAL(0u, loadedTree.getSize());
+	loadedTree.findNeighborsWithinRadius(point000, &resultIndices, 1.0);
+	CPPUNIT_ASSERT_EQUAL(0u, static_cast<unsigned int>(resultIndices.size()));
+
+	std::remove(filename.c_str());
+}
+
+void NearestNeighborTest::testTuner() {
+	PointCloud3D data;
+	srand(23);
+	addRandomPoints(&data, 5000);
+
+	/* the factory creates the requested backends */
+	NearestNeighborFactory factory;
+	NearestNeighborConfiguration configuration;
+	CPPUNIT_ASSERT(configuration.implementation.compare("NearestNeighborKDTree3D") == 0);
+	CPPUNIT_ASSERT(dynamic_cast<NearestNeighborKDTree3D*>(factory.createNearestNeighbor().get()) != 0);
+	CPPUNIT_ASSERT(dynamic_cast<NearestNeighborKDTree3D*>(factory.createNearestNeighbor(configuration).get()) != 0);
+	configuration.implementation = "NearestNeighborANN";
+	CPPUNIT_ASSERT(dynamic_cast<NearestNeighborANN*>(factory.createNearestNeighbor(configuration).get()) != 0);
+	configuration.implementation = "NearestNeighborSTANN";
+	CPPUNIT_ASSERT(dynamic_cast<NearestNeighborSTANN*>(factory.createNearestNeighbor(configuration).get()) != 0);
+	configuration.implementation = "NearestNeighborDynamicKDTree3D";
+	CPPUNIT_ASSERT(dynamic_cast<NearestNeighborDynamicKDTree3D*>(factory.createNearestNeighbor(configuration).get()) != 0);
+	configuration.implementation = "NearestNeighborVoxelGrid";
+	configuration.voxelSize = 0.2;
+	INearestPoint3DNeighborPtr nearestNeighbor = factory.createNearestNeighbor(configuration);
+	CPPUNIT_ASSERT(dynamic_cast<NearestNeighborVoxelGrid*>(nearestNeighbor.get()) != 0);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(0.2, dynamic_cast<NearestNeighborVoxelGrid*>(nearestNeighbor.get())->getVoxelSize(), maxTolerance);
+	configuration.implementation = "NearestNeighborFLANN";
+	configuration.flannAlgorithm = "KMEANS";
+	configuration.checks = 128;
+	nearestNeighbor = factory.createNearestNeighbor(configuration);
+	NearestNeighborFLANN* flann = dynamic_cast<NearestNeighborFLANN*>(nearestNeighbor.get());
+	CPPUNIT_ASSERT(flann != 0);
+	CPPUNIT_ASSERT_EQUAL(KMEANS, flann->getParameters().algorithm);
+	CPPUNIT_ASSERT_EQUAL(128, flann->getParameters().checks);
+	configuration.implementation = "NoSuchImplementation";
+	CPPUNIT_ASSERT(dynamic_cast<NearestNeighborKDTree3D*>(factory.createNearestNeighbor(configuration).get()) != 0);
+
+	/* k nearest neighbors: the exact search reaches every target, a single check does not */
+	vector<NearestNeighborConfiguration> candidates(3);
+	candidates[0].implementation = "NearestNeighborFLANN";
+	candidates[0].trees = 1;
+	candidates[0].checks = 1;
+	candidates[1] = candidates[0];
+	candidates[1].checks = 2;
+	candidates[2].implementation = "NearestNeighborKDTree3D";
+	NearestNeighborTuner tuner;
+	tuner.setCandidates(candidates);
+	tuner.setK(5);
+	tuner.setNumberOfQueries(500);
+	tuner.setRecallTarget(0.99);
+	NearestNeighborConfiguration bestConfiguration;
+	CPPUNIT_ASSERT(tuner.tune(&data, 0, &bestConfiguration));
+	CPPUNIT_ASSERT_EQUAL(3u, static_cast<unsigned int>(tuner.getResults().size()));
+	CPPUNIT_ASSERT(tuner.getResults()[0].recall < 0.99);
+	CPPUNIT_ASSERT(tuner.getResults()[0].buildTime == tuner.getResults()[1].buildTime); // shared index
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, tuner.getResults()[2].recall, maxTolerance);
+	CPPUNIT_ASSERT(bestConfiguration.implementation.compare("NearestNeighborKDTree3D") == 0);
+
+	candidates.resize(1);
+	tuner.setCandidates(candidates);
+	tuner.setRecallTarget(1.0);
+	CPPUNIT_ASSERT(!tuner.tune(&data, 0, &bestConfiguration)); // the most accurate candidate is returned anyway
+	CPPUNIT_ASSERT(bestConfiguration.implementation.compare("NearestNeighborFLANN") == 0);
+	CPPUNIT_ASSERT_EQUAL(1, bestConfiguration.checks);
+
+	/* radius search with explicit queries */
+	PointCloud3D queries;
+	addRandomPoints(&queries, 200);
+	candidates.resize(2);
+	candidates[0] = NearestNeighborConfiguration();
+	candidates[0].implementation = "NearestNeighborANN";
+	candidates[1].implementation = "NearestNeighborVoxelGrid";
+	candidates[1].voxelSize = 0.1;
+	tuner.setCandidates(candidates);
+	tuner.setRadius(0.1);
+	CPPUNIT_ASSERT(tuner.tune(&data, &queries, &bestConfiguration));
+	CPPUNIT_ASSERT_EQUAL(2u, static_cast<unsigned int>(tuner.getResults().size()));
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, tuner.getResults()[0].recall, maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, tuner.getResults()[1].recall, maxTolerance);
+
+	/* default candidates for the radius workload */
+	tuner.getDefaultCandidates(candidates);
+	CPPUNIT_ASSERT(candidates.size() > 4);
+	for (unsigned int i = 0; i < candidates.size(); ++i) {
+		if (candidates[i].implementation.compare("NearestNeighborVoxelGrid") == 0) {
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(0.1, candidates[i].voxelSize, maxTolerance);
+		}
+	}
+
+	/* the result can be cached in a configuration file */
+	std::string filename = "brics_3d_nearest_neighbor_test.xml";
+	bestConfiguration.implementation = "NearestNeighborFLANN";
+	bestConfiguration.flannAlgorithm = "KDTREE";
+	bestConfiguration.trees = 4;
+	bestConfiguration.checks = 64;
+	CPPUNIT_ASSERT(factory.writeConfiguration(filename, bestConfiguration));
+#ifdef BRICS_XERCES_ENABLE
+	NearestNeighborConfiguration readConfiguration;
+	CPPUNIT_ASSERT(factory.readConfiguration(filename, &readConfiguration));
+	CPPUNIT_ASSERT(readConfiguration.implementation.compare("NearestNeighborFLANN") == 0);
+	CPPUNIT_ASSERT_EQUAL(4, readConfiguration.trees);
+	CPPUNIT_ASSERT_EQUAL(64, readConfiguration.checks);
+	CPPUNIT_ASSERT(dynamic_cast<NearestNeighborFLANN*>(factory.createNearestNeighbor(filename).get()) != 0);
+#else
+	CPPUNIT_ASSERT(dynamic_cast<NearestNeighborKDTree3D*>(factory.createNearestNeighbor(filename).get()) != 0); // default
+#endif
+	std::remove(filename.c_str());
+}
+
 }
 
 /* EOF */
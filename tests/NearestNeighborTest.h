@@ -15,6 +15,10 @@
 #include "brics_3d/algorithm/nearestNeighbor/NearestNeighborFLANN.h"
 #include "brics_3d/algorithm/nearestNeighbor/NearestNeighborSTANN.h"
 #include "brics_3d/algorithm/nearestNeighbor/NearestNeighborANN.h"
+#include "brics_3d/algorithm/nearestNeighbor/NearestNeighborKDTree3D.h"
+#include "brics_3d/algorithm/nearestNeighbor/NearestNeighborVoxelGrid.h"
+#include "brics_3d/algorithm/nearestNeighbor/NearestNeighborDynamicKDTree3D.h"
+#include "brics_3d/algorithm/nearestNeighbor/NearestNeighborTuner.h"
 #include "brics_3d/core/HomogeneousMatrix44.h"
 #include <Eigen/Geometry>
 
@@ -39,6 +43,14 @@ class NearestNeighborTest : public CPPUNIT_NS::TestFixture {
 	CPPUNIT_TEST( testANNSimple );
 	CPPUNIT_TEST( testANNExtended );
 	CPPUNIT_TEST( testANNHighDimension );
+	CPPUNIT_TEST( testBatchQueries );
+	CPPUNIT_TEST( testRadiusSearch );
+	CPPUNIT_TEST( testDistanceQueries );
+	CPPUNIT_TEST( testKDTree3D );
+	CPPUNIT_TEST( testVoxelGrid );
+	CPPUNIT_TEST( testDynamicKDTree3D );
+	CPPUNIT_TEST( testKDTree3DFile );
+	CPPUNIT_TEST( testTuner );
 	CPPUNIT_TEST_SUITE_END();
 
 
@@ -58,9 +70,26 @@ public:
 	void testANNSimple();
 	void testANNExtended();
 	void testANNHighDimension();
+	void testBatchQueries();
+	void testRadiusSearch();
+	void testDistanceQueries();
+	void testKDTree3D();
+	void testVoxelGrid();
+	void testDynamicKDTree3D();
+	void testKDTree3DFile();
+	void testTuner();
 
 private:
 
+	/// Compares the batched queries of a search algorithm against its single point queries.
+	void checkBatchQueries(INearestPoint3DNeighbor* nearestNeighbor, INearestNeighborSetup* setup, PointCloud3D* data, PointCloud3D* queries);
+
+	/// Compares the fixed radius search of a search algorithm against a brute force search.
+	void checkRadiusSearch(INearestPoint3DNeighbor* nearestNeighbor, PointCloud3D* data, PointCloud3D* queries, bool isExact);
+
+	/// Compares the returned distances of all query variants against the distances of the returned points.
+	void checkDistanceQueries(INearestPoint3DNeighbor* nearestNeighbor, INearestNeighborSetup* setup, PointCloud3D* data, PointCloud3D* queries);
+
 	INearestNeighbor* abstractNearestNeigbor;
 	NearestNeighborFLANN* nearestNeigborFLANN;
 	NearestNeighborSTANN* nearestNeigborSTANN;
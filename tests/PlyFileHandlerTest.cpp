@@ -0,0 +1,156 @@
+/**
+ * @file 
+ * PlyFileHandlerTest.cpp
+ *
+ * @date: Oct 18, 2026
+ * @author: sblume
+ */
+
+#include "PlyFileHandlerTest.h"
+#include "brics_3d/core/ColoredPoint3D.h"
+#include "brics_3d/core/Point3DNormal.h"
+#include "brics_3d/core/Point3DIntensity.h"
+
+#include <fstream>
+#include <cstdio>
+
+namespace unitTests {
+
+CPPUNIT_TEST_SUITE_REGISTRATION( PlyFileHandlerTest );
+
+void PlyFileHandlerTest::setUp() {
+	filename = "brics_3d_ply_file_handler_test.ply";
+}
+
+void PlyFileHandlerTest::tearDown() {
+	std::remove(filename.c_str());
+}
+
+void PlyFileHandlerTest::testBinaryPointCloud() {
+	PlyFileHandler plyHandler;
+	PointCloud3D pointCloud;
+	for (int i = 0; i < 1000; ++i) {
+		pointCloud.addPoint(Point3D(i * 0.5, -i * 0.25, i + 1000.0));
+	}
+
+	CPPUNIT_ASSERT(plyHandler.write(filename, &pointCloud));
+	PointCloud3D resultPointCloud;
+	CPPUNIT_ASSERT(plyHandler.read(filename, &resultPointCloud));
+	CPPUNIT_ASSERT_EQUAL(1000u, resultPointCloud.getSize());
+	CPPUNIT_ASSERT(!resultPointCloud.containsDecoratedPoints());
+	for (unsigned int i = 0; i < resultPointCloud.getSize(); ++i) {
+		CPPUNIT_ASSERT_DOUBLES_EQUAL((*pointCloud.getPointCloud())[i].getX(), (*resultPointCloud.getPointCloud())[i].getX(), maxTolerance);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL((*pointCloud.getPointCloud())[i].getY(), (*resultPointCloud.getPointCloud())[i].getY(), maxTolerance);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL((*pointCloud.getPointCloud())[i].getZ(), (*resultPointCloud.getPointCloud())[i].getZ(), maxTolerance);
+	}
+
+	/* reading appends to existing data */
+	CPPUNIT_ASSERT(plyHandler.read(filename, &resultPointCloud));
+	CPPUNIT_ASSERT_EQUAL(2000u, resultPointCloud.getSize());
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(1000.0 + 999.0, (*resultPointCloud.getPointCloud())[1999].getZ(), maxTolerance);
+
+	/* double precision */
+	PointCloud3D preciseCloud;
+	preciseCloud.addPoint(Point3D(123456.123456789, 0.000000001, -1.0));
+	plyHandler.setUseDoublePrecision(true);
+	CPPUNIT_ASSERT(plyHandler.getUseDoublePrecision());
+	CPPUNIT_ASSERT(plyHandler.write(filename, &preciseCloud));
+	PointCloud3D preciseResultCloud;
+	CPPUNIT_ASSERT(plyHandler.read(filename, &preciseResultCloud));
+	CPPUNIT_ASSERT_EQUAL(1u, preciseResultCloud.getSize());
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(123456.123456789, preciseResultCloud.getStorage()->getRawX()[0], 1e-12);
+}
+
+void PlyFileHandlerTest::testDecoratedPointCloud() {
+	PlyFileHandler plyHandler;
+	PointCloud3D pointCloud;
+	for (int i = 0; i < 10; ++i) {
+		Point3D* point = new Point3D(i, 2.0 * i, 3.0 * i);
+		point = new Point3DNormal(point, Normal3D(0, 0, 1));
+		point = new Point3DIntensity(point, 0.5 * i);
+		point = new ColoredPoint3D(point, 10 * i, 20, 30);
+		pointCloud.addPointPtr(point);
+	}
+
+	CPPUNIT_ASSERT(plyHandler.write(filename, &pointCloud));
+	PointCloud3D resultPointCloud;
+	CPPUNIT_ASSERT(plyHandler.read(filename, &resultPointCloud));
+	CPPUNIT_ASSERT_EQUAL(10u, resultPointCloud.getSize());
+	CPPUNIT_ASSERT(resultPointCloud.getStorage()->hasChannel(PointCloud3D::rgbChannel));
+	CPPUNIT_ASSERT(resultPointCloud.getStorage()->hasChannel(PointCloud3D::normalChannel));
+	CPPUNIT_ASSERT(resultPointCloud.getStorage()->hasChannel(PointCloud3D::intensityChannel));
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(3.5, resultPointCloud.getStorage()->getRawChannel(PointCloud3D::intensityChannel)[7], maxTolerance);
+
+	Point3D* point = &(*resultPointCloud.getPointCloud())[7];
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(7.0, point->getX(), maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(14.0, point->getY(), maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(21.0, point->getZ(), maxTolerance);
+
+	ColoredPoint3D* coloredPoint = point->asColoredPoint3D();
+	CPPUNIT_ASSERT(coloredPoint != 0);
+	CPPUNIT_ASSERT_EQUAL(70, static_cast<int>(coloredPoint->getR()));
+	CPPUNIT_ASSERT_EQUAL(20, static_cast<int>(coloredPoint->getG()));
+	CPPUNIT_ASSERT_EQUAL(30, static_cast<int>(coloredPoint->getB()));
+
+	Point3DIntensity* pointWithIntensity = getPointType<Point3DIntensity>(point);
+	CPPUNIT_ASSERT(pointWithIntensity != 0);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(3.5, pointWithIntensity->getIntensity(), maxTolerance);
+
+	Point3DNormal* pointWithNormal = getPointType<Point3DNormal>(point);
+	CPPUNIT_ASSERT(pointWithNormal != 0);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, pointWithNormal->getNormal().getZ(), maxTolerance);
+}
+
+void PlyFileHandlerTest::testAsciiFile() {
+	std::ofstream outputFile(filename.c_str());
+	outputFile << "ply" << std::endl;
+	outputFile << "format ascii 1.0" << std::endl;
+	outputFile << "comment test file" << std::endl;
+	outputFile << "element vertex 3" << std::endl;
+	outputFile << "property float x" << std::endl;
+	outputFile << "property float y" << std::endl;
+	outputFile << "property float z" << std::endl;
+	outputFile << "property uchar red" << std::endl;
+	outputFile << "property uchar green" << std::endl;
+	outputFile << "property uchar blue" << std::endl;
+	outputFile << "element face 0" << std::endl;
+	outputFile << "property list uchar int vertex_indices" << std::endl;
+	outputFile << "end_header" << std::endl;
+	outputFile << "1 2 3 255 0 0" << std::endl;
+	outputFile << "4 5 6 0 255 0" << std::endl;
+	outputFile << "7 8 9 0 0 255" << std::endl;
+	outputFile.close();
+
+	PlyFileHandler plyHandler;
+	PointCloud3D pointCloud;
+	CPPUNIT_ASSERT(plyHandler.read(filename, &pointCloud));
+	CPPUNIT_ASSERT_EQUAL(3u, pointCloud.getSize());
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(4.0, (*pointCloud.getPointCloud())[1].getX(), maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(9.0, (*pointCloud.getPointCloud())[2].getZ(), maxTolerance);
+	ColoredPoint3D* coloredPoint = (*pointCloud.getPointCloud())[1].asColoredPoint3D();
+	CPPUNIT_ASSERT(coloredPoint != 0);
+	CPPUNIT_ASSERT_EQUAL(255, static_cast<int>(coloredPoint->getG()));
+}
+
+void PlyFileHandlerTest::testInvalidFile() {
+	PlyFileHandler plyHandler;
+	PointCloud3D pointCloud;
+	CPPUNIT_ASSERT(!plyHandler.read("this_file_does_not_exist.ply", &pointCloud));
+
+	std::ofstream outputFile(filename.c_str());
+	outputFile << "no ply header" << std::endl;
+	outputFile.close();
+	CPPUNIT_ASSERT(!plyHandler.read(filename, &pointCloud));
+
+	/* truncated binary data */
+	outputFile.open(filename.c_str());
+	outputFile << "ply\nformat binary_little_endian 1.0\nelement vertex 100\nproperty float x\nproperty float y\nproperty float z\nend_header\n";
+	outputFile << "abc";
+	outputFile.close();
+	CPPUNIT_ASSERT(!plyHandler.read(filename, &pointCloud));
+	CPPUNIT_ASSERT_EQUAL(0u, pointCloud.getSize());
+}
+
+}
+
+/* EOF */
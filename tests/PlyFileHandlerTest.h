@@ -0,0 +1,52 @@
+/**
+ * @file 
+ * PlyFileHandlerTest.h
+ *
+ * @date: Oct 18, 2026
+ * @author: sblume
+ */
+
+#ifndef PLYFILEHANDLERTEST_H_
+#define PLYFILEHANDLERTEST_H_
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "brics_3d/util/PlyFileHandler.h"
+#include "brics_3d/core/PointCloud3D.h"
+
+using namespace brics_3d;
+
+namespace unitTests {
+
+class PlyFileHandlerTest : public CPPUNIT_NS::TestFixture {
+
+	CPPUNIT_TEST_SUITE( PlyFileHandlerTest );
+	CPPUNIT_TEST( testBinaryPointCloud );
+	CPPUNIT_TEST( testDecoratedPointCloud );
+	CPPUNIT_TEST( testAsciiFile );
+	CPPUNIT_TEST( testInvalidFile );
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void setUp();
+	void tearDown();
+
+	void testBinaryPointCloud();
+	void testDecoratedPointCloud();
+	void testAsciiFile();
+	void testInvalidFile();
+
+private:
+
+	static const double maxTolerance = 0.00001;
+
+	/// Temporary file for the tests
+	std::string filename;
+};
+
+}
+
+#endif /* PLYFILEHANDLERTEST_H_ */
+
+/* EOF */
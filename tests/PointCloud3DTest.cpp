@@ -9,10 +9,15 @@
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
+#include <cstdlib>
+#include <cmath>
+#include <typeinfo>
 
 #include "PointCloud3DTest.h"
 
 #include <brics_3d/core/HomogeneousMatrix44.h>
+#include <brics_3d/core/BatchTransformation.h>
+#include <brics_3d/core/MortonOrder.h>
 
 
 namespace unitTests {
@@ -274,6 +279,561 @@ void PointCloud3DTest::testTransformation() {
 	delete homogeneousTransformation;
 }
 
+void PointCloud3DTest::testStorage() {
+	const PointCloud3DStorage* storage = pointCloudCube->getStorage();
+	CPPUNIT_ASSERT(storage != 0);
+	CPPUNIT_ASSERT_EQUAL(8u, storage->getSize());
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, storage->getRawX()[2], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, storage->getRawY()[2], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, storage->getRawZ()[2], maxTolerance);
+
+	/* modifications of the storage are visible in the Point3D vector */
+	PointCloud3DStorage* mutableStorage = pointCloudCube->getMutableStorage();
+	mutableStorage->setPoint(2, 2.0, 3.0, 4.0);
+	mutableStorage->addPoint(5.0, 6.0, 7.0);
+	CPPUNIT_ASSERT_EQUAL(9u, pointCloudCube->getSize());
+	CPPUNIT_ASSERT_EQUAL(9u, static_cast<unsigned int>(pointCloudCube->getPointCloud()->size()));
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, (*pointCloudCube->getPointCloud())[2].getX(), maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(3.0, (*pointCloudCube->getPointCloud())[2].getY(), maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(4.0, (*pointCloudCube->getPointCloud())[2].getZ(), maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(5.0, (*pointCloudCube->getPointCloud())[8].getX(), maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(6.0, (*pointCloudCube->getPointCloud())[8].getY(), maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(7.0, (*pointCloudCube->getPointCloud())[8].getZ(), maxTolerance);
+
+	/* modifications of the Point3D vector are visible in the storage */
+	(*pointCloudCube->getPointCloud())[0].setX(-1.0);
+	pointCloudCube->getPointCloud()->pop_back();
+	storage = pointCloudCube->getStorage();
+	CPPUNIT_ASSERT_EQUAL(8u, storage->getSize());
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(-1.0, storage->getRawX()[0], maxTolerance);
+
+	/* points added after the Point3D vector has been accessed */
+	pointCloudCube->addPoint(Point3D(8.0, 9.0, 10.0));
+	CPPUNIT_ASSERT_EQUAL(9u, pointCloudCube->getSize());
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(8.0, (*pointCloudCube->getPointCloud())[8].getX(), maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(-1.0, (*pointCloudCube->getPointCloud())[0].getX(), maxTolerance);
+
+	/* decorated points survive modifications of the storage */
+	PointCloud3D* coloredCloud = new PointCloud3D();
+	coloredCloud->addPointPtr(new ColoredPoint3D(new Point3D(1.0, 2.0, 3.0), 255, 0, 0));
+	coloredCloud->addPointPtr(new Point3D(4.0, 5.0, 6.0));
+	CPPUNIT_ASSERT_EQUAL(2u, coloredCloud->getSize());
+	coloredCloud->getMutableStorage()->setPoint(0, 7.0, 8.0, 9.0);
+
+	ColoredPoint3D* coloredPoint = dynamic_cast<ColoredPoint3D*>(&(*coloredCloud->getPointCloud())[0]);
+	CPPUNIT_ASSERT(coloredPoint != 0);
+	CPPUNIT_ASSERT_EQUAL(255, static_cast<int>(coloredPoint->getR()));
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(7.0, coloredPoint->getX(), maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(8.0, coloredPoint->getY(), maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(9.0, coloredPoint->getZ(), maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(4.0, (*coloredCloud->getPointCloud())[1].getX(), maxTolerance);
+
+	/* copies are independent and keep the decoration layers */
+	PointCloud3D coloredCloudCopy(*coloredCloud);
+	coloredCloud->getMutableStorage()->setPoint(0, 0.0, 0.0, 0.0);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(7.0, coloredCloudCopy.getStorage()->getRawX()[0], maxTolerance);
+	CPPUNIT_ASSERT(dynamic_cast<ColoredPoint3D*>(&(*coloredCloudCopy.getPointCloud())[0]) != 0);
+	delete coloredCloud;
+
+	/* additional channels */
+	PointCloud3DStorage channelStorage;
+	channelStorage.addPoint(1.0, 2.0, 3.0);
+	channelStorage.addChannel("curvature");
+	channelStorage.addChannel("normal", 3);
+	channelStorage.addPoint(4.0, 5.0, 6.0);
+	CPPUNIT_ASSERT(channelStorage.hasChannel("normal"));
+	CPPUNIT_ASSERT(!channelStorage.hasChannel("intensity"));
+	CPPUNIT_ASSERT_EQUAL(3u, channelStorage.getChannelWidth("normal"));
+	channelStorage.getRawChannel("normal")[3 * 1 + 2] = 1.0;
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, channelStorage.getRawChannel("normal")[5], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, channelStorage.getRawChannel("curvature")[1], maxTolerance);
+	channelStorage.removeChannel("curvature");
+	CPPUNIT_ASSERT(!channelStorage.hasChannel("curvature"));
+}
+
+void PointCloud3DTest::testSinglePrecision() {
+	PointCloud3DF pointCloudCubeF(pointCloudCube);
+	CPPUNIT_ASSERT_EQUAL(8u, pointCloudCubeF.getSize());
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, pointCloudCubeF.getStorage()->getRawX()[6], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, pointCloudCubeF.getStorage()->getRawY()[6], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, pointCloudCubeF.getStorage()->getRawZ()[6], maxTolerance);
+
+	pointCloudCubeF.addPoint(2.0f, 3.0f, 4.0f);
+	CPPUNIT_ASSERT_EQUAL(9u, pointCloudCubeF.getSize());
+
+	/* the same transformation yields the same result as in double precision */
+	HomogeneousMatrix44* homogeneousTransformation = new HomogeneousMatrix44(0,-1,0, 1,0,0, 0,0,1, 10,20,30);
+	pointCloudCubeF.homogeneousTransformation(homogeneousTransformation);
+	pointCloudCube->homogeneousTransformation(homogeneousTransformation);
+	delete homogeneousTransformation;
+
+	PointCloud3D resultCloud;
+	pointCloudCubeF.toPointCloud3D(&resultCloud);
+	CPPUNIT_ASSERT_EQUAL(9u, resultCloud.getSize());
+	for (unsigned int i = 0; i < pointCloudCube->getSize(); ++i) {
+		CPPUNIT_ASSERT_DOUBLES_EQUAL((*pointCloudCube->getPointCloud())[i].getX(), (*resultCloud.getPointCloud())[i].getX(), maxTolerance);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL((*pointCloudCube->getPointCloud())[i].getY(), (*resultCloud.getPointCloud())[i].getY(), maxTolerance);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL((*pointCloudCube->getPointCloud())[i].getZ(), (*resultCloud.getPointCloud())[i].getZ(), maxTolerance);
+	}
+}
+
+void PointCloud3DTest::testBatchTransformation() {
+	HomogeneousMatrix44* homogeneousTransformation = new HomogeneousMatrix44(0.36,0.48,-0.8, -0.8,0.6,0, 0.48,0.64,0.6, 10,-20,30);
+
+	/* odd number of points to cover the non vectorized remainder */
+	PointCloud3D referenceCloud;
+	PointCloud3D batchCloud;
+	unsigned int seed = 0; // make sure, seed is always the same.
+	std::srand(seed);
+	for (unsigned int i = 0; i < 1001; ++i) {
+		Point3D point(std::rand() / static_cast<double>(RAND_MAX) - 0.5, std::rand() / static_cast<double>(RAND_MAX), i * 0.1);
+		referenceCloud.getPointCloud()->push_back(new Point3D(point));
+		batchCloud.addPoint(point);
+	}
+	PointCloud3D sourceCloud(batchCloud);
+
+	/* reference: transform each point individually (twice) */
+	for (unsigned int i = 0; i < 1001; ++i) {
+		(*referenceCloud.getPointCloud())[i].homogeneousTransformation(homogeneousTransformation);
+		(*referenceCloud.getPointCloud())[i].homogeneousTransformation(homogeneousTransformation);
+	}
+
+	/* in place with multiple threads */
+	BatchTransformation batchTransformation;
+	batchTransformation.setNumberOfThreads(3);
+	batchTransformation.setMinimalPointsPerThread(10);
+	batchTransformation.transform(homogeneousTransformation, batchCloud.getStorage(), batchCloud.getMutableStorage());
+	batchTransformation.transform(homogeneousTransformation, batchCloud.getStorage(), batchCloud.getMutableStorage());
+	CPPUNIT_ASSERT_EQUAL(1001u, batchCloud.getSize());
+	for (unsigned int i = 0; i < 1001; ++i) {
+		CPPUNIT_ASSERT_EQUAL((*referenceCloud.getPointCloud())[i].getX(), batchCloud.getStorage()->getRawX()[i]);
+		CPPUNIT_ASSERT_EQUAL((*referenceCloud.getPointCloud())[i].getY(), batchCloud.getStorage()->getRawY()[i]);
+		CPPUNIT_ASSERT_EQUAL((*referenceCloud.getPointCloud())[i].getZ(), batchCloud.getStorage()->getRawZ()[i]);
+	}
+
+	/* out of place: the source remains unchanged, existing points of the result are replaced */
+	PointCloud3D resultCloud;
+	resultCloud.addPoint(Point3D(1,2,3));
+	sourceCloud.homogeneousTransformation(homogeneousTransformation, &resultCloud);
+	resultCloud.homogeneousTransformation(homogeneousTransformation);
+	CPPUNIT_ASSERT_EQUAL(1001u, resultCloud.getSize());
+	CPPUNIT_ASSERT_EQUAL(1001u, sourceCloud.getSize());
+	for (unsigned int i = 0; i < 1001; ++i) {
+		CPPUNIT_ASSERT_EQUAL((*referenceCloud.getPointCloud())[i].getX(), (*resultCloud.getPointCloud())[i].getX());
+		CPPUNIT_ASSERT_EQUAL((*referenceCloud.getPointCloud())[i].getY(), (*resultCloud.getPointCloud())[i].getY());
+		CPPUNIT_ASSERT_EQUAL((*referenceCloud.getPointCloud())[i].getZ(), (*resultCloud.getPointCloud())[i].getZ());
+	}
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(100.0, sourceCloud.getStorage()->getRawZ()[1000], maxTolerance);
+
+	/* out of place with decorated points */
+	PointCloud3D decoratedCloud;
+	decoratedCloud.addPointPtr(new ColoredPoint3D(new Point3D(1,0,0), 255, 0, 0));
+	decoratedCloud.homogeneousTransformation(homogeneousTransformation, &resultCloud);
+	CPPUNIT_ASSERT_EQUAL(1u, resultCloud.getSize());
+	CPPUNIT_ASSERT(resultCloud.getStorage()->hasChannel(PointCloud3D::rgbChannel));
+	CPPUNIT_ASSERT((*resultCloud.getPointCloud())[0].asColoredPoint3D() != 0);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(10.36, (*resultCloud.getPointCloud())[0].getX(), maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, (*decoratedCloud.getPointCloud())[0].getX(), maxTolerance);
+
+	/* single precision */
+	PointCloud3DF floatCloud(&sourceCloud);
+	PointCloud3DF floatResultCloud;
+	floatCloud.homogeneousTransformation(homogeneousTransformation, &floatResultCloud);
+	floatResultCloud.homogeneousTransformation(homogeneousTransformation);
+	CPPUNIT_ASSERT_EQUAL(1001u, floatResultCloud.getSize());
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(100.0, floatCloud.getStorage()->getRawZ()[1000], maxTolerance);
+	for (unsigned int i = 0; i < 1001; ++i) {
+		CPPUNIT_ASSERT_DOUBLES_EQUAL((*referenceCloud.getPointCloud())[i].getX(), floatResultCloud.getStorage()->getRawX()[i], 0.001);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL((*referenceCloud.getPointCloud())[i].getY(), floatResultCloud.getStorage()->getRawY()[i], 0.001);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL((*referenceCloud.getPointCloud())[i].getZ(), floatResultCloud.getStorage()->getRawZ()[i], 0.001);
+	}
+
+	delete homogeneousTransformation;
+}
+
+void PointCloud3DTest::testAttributeChannels() {
+	PointCloud3D pointCloud;
+	for (int i = 0; i < 6; ++i) {
+		pointCloud.addPointPtr(new ColoredPoint3D(new Point3D(i, 0, 0), 10 * i, 20, 30));
+	}
+
+	/* decoration layers are mirrored into channels */
+	CPPUNIT_ASSERT_EQUAL(6u, pointCloud.getSize());
+	CPPUNIT_ASSERT(!pointCloud.containsDecoratedPoints());
+	const PointCloud3DStorage* storage = pointCloud.getStorage();
+	CPPUNIT_ASSERT_EQUAL(3u, storage->getChannelWidth(PointCloud3D::rgbChannel));
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(40.0, storage->getRawChannel(PointCloud3D::rgbChannel)[3 * 4], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(30.0, storage->getRawChannel(PointCloud3D::rgbChannel)[3 * 5 + 2], maxTolerance);
+
+	/* a mix of different decoration layers is kept as it is */
+	PointCloud3D mixedCloud;
+	mixedCloud.addPointPtr(new ColoredPoint3D(new Point3D(1, 0, 0), 10, 20, 30));
+	mixedCloud.addPointPtr(new Point3DIntensity(new Point3D(2, 0, 0), 0.5));
+	mixedCloud.addPoint(Point3D(3, 0, 0));
+	CPPUNIT_ASSERT(mixedCloud.containsDecoratedPoints());
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, mixedCloud.getStorage()->getRawChannel(PointCloud3D::intensityChannel)[1], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(10.0, mixedCloud.getStorage()->getRawChannel(PointCloud3D::rgbChannel)[0], maxTolerance);
+	CPPUNIT_ASSERT((*mixedCloud.getPointCloud())[1].asColoredPoint3D() == 0);
+	CPPUNIT_ASSERT(getPointType<Point3DIntensity>(&(*mixedCloud.getPointCloud())[0]) == 0);
+	CPPUNIT_ASSERT(typeid((*mixedCloud.getPointCloud())[2]) == typeid(Point3D));
+
+	/* the decorated points are kept */
+	Point3D* point = &(*pointCloud.getPointCloud())[3];
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(3.0, point->getX(), maxTolerance);
+	CPPUNIT_ASSERT(point->asColoredPoint3D() != 0);
+	CPPUNIT_ASSERT_EQUAL(30, static_cast<int>(point->asColoredPoint3D()->getR()));
+	CPPUNIT_ASSERT(getPointType<Point3DIntensity>(point) == 0);
+
+	/* modifications of the view are written back */
+	point->asColoredPoint3D()->setG(21);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(21.0, pointCloud.getStorage()->getRawChannel(PointCloud3D::rgbChannel)[3 * 3 + 1], maxTolerance);
+
+	/* modifications of the channels are visible in the view */
+	PointCloud3DStorage* mutableStorage = pointCloud.getMutableStorage();
+	mutableStorage->getRawChannel(PointCloud3D::rgbChannel)[3 * 3 + 2] = 31;
+	mutableStorage->addChannel(PointCloud3D::normalChannel, 3);
+	mutableStorage->getRawChannel(PointCloud3D::normalChannel)[3 * 3 + 2] = 1.0;
+	mutableStorage->addChannel(PointCloud3D::labelChannel);
+	mutableStorage->getRawChannel(PointCloud3D::labelChannel)[3] = 42;
+	point = &(*pointCloud.getPointCloud())[3];
+	CPPUNIT_ASSERT_EQUAL(31, static_cast<int>(point->asColoredPoint3D()->getB()));
+	CPPUNIT_ASSERT(getPointType<Point3DNormal>(point) != 0);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, getPointType<Point3DNormal>(point)->getNormal().getZ(), maxTolerance);
+
+	/* channels without decorator representation are kept */
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(42.0, pointCloud.getStorage()->getRawChannel(PointCloud3D::labelChannel)[3], maxTolerance);
+	CPPUNIT_ASSERT(!pointCloud.containsDecoratedPoints());
+
+	/* clouds that have been filled via the storage return views on the channels */
+	PointCloud3D channelCloud;
+	channelCloud.getMutableStorage()->addChannel(PointCloud3D::rgbChannel, 3);
+	channelCloud.getMutableStorage()->addPoint(1, 2, 3);
+	channelCloud.getMutableStorage()->getRawChannel(PointCloud3D::rgbChannel)[0] = 255;
+	CPPUNIT_ASSERT((*channelCloud.getPointCloud())[0].asColoredPoint3D() != 0);
+	CPPUNIT_ASSERT_EQUAL(255, static_cast<int>((*channelCloud.getPointCloud())[0].asColoredPoint3D()->getR()));
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, (*channelCloud.getPointCloud())[0].getY(), maxTolerance);
+
+	/* normals are rotated, but not translated */
+	HomogeneousMatrix44* homogeneousTransformation = new HomogeneousMatrix44(1,0,0, 0,0,-1, 0,1,0, 10,20,30);
+	PointCloud3D resultCloud;
+	pointCloud.homogeneousTransformation(homogeneousTransformation, &resultCloud);
+	pointCloud.homogeneousTransformation(homogeneousTransformation);
+	delete homogeneousTransformation;
+
+	PointCloud3D* clouds[] = {&pointCloud, &resultCloud};
+	for (int i = 0; i < 2; ++i) {
+		CPPUNIT_ASSERT_EQUAL(6u, clouds[i]->getSize());
+		const Coordinate* normal = clouds[i]->getStorage()->getRawChannel(PointCloud3D::normalChannel);
+		CPPUNIT_ASSERT(normal != 0);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, std::abs(normal[3 * 3 + 1]), maxTolerance);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, normal[3 * 3 + 2], maxTolerance);
+		point = &(*clouds[i]->getPointCloud())[3];
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(13.0, point->getX(), maxTolerance);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(normal[3 * 3 + 1], getPointType<Point3DNormal>(point)->getNormal().getY(), maxTolerance);
+		CPPUNIT_ASSERT_EQUAL(31, static_cast<int>(point->asColoredPoint3D()->getB()));
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(42.0, clouds[i]->getStorage()->getRawChannel(PointCloud3D::labelChannel)[3], maxTolerance);
+	}
+}
+
+void PointCloud3DTest::testBulkOperations() {
+	PointCloud3D pointCloud;
+	CPPUNIT_ASSERT_EQUAL(0u, pointCloud.getSize());
+
+	/* reserve */
+	pointCloud.reserve(100);
+	CPPUNIT_ASSERT(pointCloud.getCapacity() >= 100u);
+	CPPUNIT_ASSERT_EQUAL(0u, pointCloud.getSize());
+
+	/* separate coordinate arrays */
+	Coordinate x[] = {1, 2, 3};
+	Coordinate y[] = {4, 5, 6};
+	Coordinate z[] = {7, 8, 9};
+	pointCloud.addPoints(x, y, z, 3);
+	CPPUNIT_ASSERT_EQUAL(3u, pointCloud.getSize());
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, (*pointCloud.getPointCloud())[1].getX(), maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(5.0, (*pointCloud.getPointCloud())[1].getY(), maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(8.0, (*pointCloud.getPointCloud())[1].getZ(), maxTolerance);
+
+	/* interleaved coordinates */
+	Coordinate xyz[] = {10, 11, 12, 13, 14, 15};
+	pointCloud.addPoints(xyz, 2);
+	CPPUNIT_ASSERT_EQUAL(5u, pointCloud.getSize());
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(13.0, pointCloud.getStorage()->getRawX()[4], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(14.0, pointCloud.getStorage()->getRawY()[4], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(15.0, pointCloud.getStorage()->getRawZ()[4], maxTolerance);
+
+	/* iterator range */
+	std::vector<Point3D> points;
+	points.push_back(Point3D(20, 21, 22));
+	points.push_back(Point3D(23, 24, 25));
+	pointCloud.addPoints(points.begin(), points.end());
+	CPPUNIT_ASSERT_EQUAL(7u, pointCloud.getSize());
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(23.0, (*pointCloud.getPointCloud())[6].getX(), maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(25.0, (*pointCloud.getPointCloud())[6].getZ(), maxTolerance);
+
+	/* subset of another point cloud including the attributes */
+	PointCloud3D coloredPointCloud;
+	coloredPointCloud.getMutableStorage()->addChannel(PointCloud3D::rgbChannel, 3);
+	coloredPointCloud.getMutableStorage()->addChannel(PointCloud3D::labelChannel);
+	for (int i = 0; i < 4; ++i) {
+		coloredPointCloud.getMutableStorage()->addPoint(i, i, i);
+		coloredPointCloud.getMutableStorage()->getRawChannel(PointCloud3D::rgbChannel)[3 * i] = 10 * i;
+		coloredPointCloud.getMutableStorage()->getRawChannel(PointCloud3D::labelChannel)[i] = i + 100;
+	}
+	std::vector<int> indices;
+	indices.push_back(3);
+	indices.push_back(1);
+	PointCloud3D subset;
+	subset.addPoints(&coloredPointCloud, indices);
+	CPPUNIT_ASSERT_EQUAL(2u, subset.getSize());
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(3.0, subset.getStorage()->getRawX()[0], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, subset.getStorage()->getRawX()[1], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(10.0, subset.getStorage()->getRawChannel(PointCloud3D::rgbChannel)[3], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(103.0, subset.getStorage()->getRawChannel(PointCloud3D::labelChannel)[0], maxTolerance);
+	CPPUNIT_ASSERT((*subset.getPointCloud())[0].asColoredPoint3D() != 0);
+	CPPUNIT_ASSERT_EQUAL(30, static_cast<int>((*subset.getPointCloud())[0].asColoredPoint3D()->getR()));
+
+	/* mixed decoration layers are preserved */
+	PointCloud3D mixedPointCloud;
+	mixedPointCloud.addPointPtr(new Point3D(1, 1, 1));
+	mixedPointCloud.addPointPtr(new ColoredPoint3D(new Point3D(2, 2, 2), 1, 2, 3));
+	CPPUNIT_ASSERT(mixedPointCloud.containsDecoratedPoints());
+	indices.clear();
+	indices.push_back(1);
+	indices.push_back(0);
+	subset.addPoints(&mixedPointCloud, indices);
+	CPPUNIT_ASSERT_EQUAL(4u, subset.getSize());
+	CPPUNIT_ASSERT((*subset.getPointCloud())[2].asColoredPoint3D() != 0);
+	CPPUNIT_ASSERT_EQUAL(1, static_cast<int>((*subset.getPointCloud())[2].asColoredPoint3D()->getR()));
+	CPPUNIT_ASSERT(typeid((*subset.getPointCloud())[3]) == typeid(Point3D));
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, (*subset.getPointCloud())[3].getZ(), maxTolerance);
+
+	/* swap */
+	PointCloud3D other;
+	other.addPoint(Point3D(-1, -2, -3));
+	pointCloud.swap(other);
+	CPPUNIT_ASSERT_EQUAL(1u, pointCloud.getSize());
+	CPPUNIT_ASSERT_EQUAL(7u, other.getSize());
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(-2.0, (*pointCloud.getPointCloud())[0].getY(), maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(23.0, (*other.getPointCloud())[6].getX(), maxTolerance);
+	swap(pointCloud, other);
+	CPPUNIT_ASSERT_EQUAL(7u, pointCloud.getSize());
+	CPPUNIT_ASSERT_EQUAL(1u, other.getSize());
+
+	/* clear */
+	unsigned int capacity = subset.getCapacity();
+	subset.clear();
+	CPPUNIT_ASSERT_EQUAL(0u, subset.getSize());
+	CPPUNIT_ASSERT_EQUAL(0u, subset.getStorage()->getNumberOfChannels());
+	CPPUNIT_ASSERT(!subset.containsDecoratedPoints());
+	CPPUNIT_ASSERT(subset.getCapacity() == capacity);
+	subset.addPoint(Point3D(1, 2, 3));
+	CPPUNIT_ASSERT_EQUAL(1u, subset.getSize());
+	CPPUNIT_ASSERT(typeid((*subset.getPointCloud())[0]) == typeid(Point3D));
+}
+
+void PointCloud3DTest::testCopyOnWrite() {
+	PointCloud3D::PointCloud3DPtr original(new PointCloud3D());
+	original->getMutableStorage()->addChannel(PointCloud3D::labelChannel);
+	for (int i = 0; i < 10; ++i) {
+		original->addPoint(Point3D(i, 2 * i, 3 * i));
+	}
+	original->getMutableStorage()->getRawChannel(PointCloud3D::labelChannel)[5] = 42;
+
+	/* copies share the arrays */
+	PointCloud3D copy(*original);
+	PointCloud3D assigned;
+	assigned = *original;
+	CPPUNIT_ASSERT(original->getStorage()->isShared());
+	CPPUNIT_ASSERT(original->getStorage()->getRawX() == copy.getStorage()->getRawX());
+	CPPUNIT_ASSERT(original->getStorage()->getRawX() == assigned.getStorage()->getRawX());
+	CPPUNIT_ASSERT(original->getStorage()->getRawChannel(PointCloud3D::labelChannel) == copy.getStorage()->getRawChannel(PointCloud3D::labelChannel));
+	CPPUNIT_ASSERT_EQUAL(10u, copy.getSize());
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(4.0, (*copy.getPointCloud())[2].getY(), maxTolerance);
+
+	/* the first modification duplicates the arrays */
+	HomogeneousMatrix44* homogeneousTransformation = new HomogeneousMatrix44(1,0,0, 0,1,0, 0,0,1, 100,0,0);
+	copy.homogeneousTransformation(homogeneousTransformation);
+	delete homogeneousTransformation;
+	CPPUNIT_ASSERT(original->getStorage()->getRawX() != copy.getStorage()->getRawX());
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(102.0, copy.getStorage()->getRawX()[2], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, original->getStorage()->getRawX()[2], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, assigned.getStorage()->getRawX()[2], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(42.0, copy.getStorage()->getRawChannel(PointCloud3D::labelChannel)[5], maxTolerance);
+
+	assigned.addPoint(Point3D(-1, -1, -1));
+	CPPUNIT_ASSERT_EQUAL(11u, assigned.getSize());
+	CPPUNIT_ASSERT_EQUAL(10u, original->getSize());
+	CPPUNIT_ASSERT(!original->getStorage()->isShared());
+
+	/* modifications via the Point3D vector of a copy */
+	PointCloud3D secondCopy(*original);
+	(*secondCopy.getPointCloud())[0].setZ(-5);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(-5.0, secondCopy.getStorage()->getRawZ()[0], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, original->getStorage()->getRawZ()[0], maxTolerance);
+
+	/* a storage that is cleared while being shared */
+	PointCloud3DStorage storage = *original->getStorage();
+	storage.clear();
+	CPPUNIT_ASSERT_EQUAL(0u, storage.getSize());
+	CPPUNIT_ASSERT(storage.hasChannel(PointCloud3D::labelChannel));
+	CPPUNIT_ASSERT_EQUAL(10u, original->getSize());
+
+	/* decorated points are still copied */
+	PointCloud3D coloredPointCloud;
+	coloredPointCloud.addPointPtr(new Point3D(1, 1, 1));
+	coloredPointCloud.addPointPtr(new ColoredPoint3D(new Point3D(2, 2, 2), 1, 2, 3));
+	PointCloud3D coloredCopy(coloredPointCloud);
+	CPPUNIT_ASSERT(coloredCopy.containsDecoratedPoints());
+	CPPUNIT_ASSERT((*coloredCopy.getPointCloud())[1].asColoredPoint3D() != 0);
+	CPPUNIT_ASSERT(&(*coloredCopy.getPointCloud())[1] != &(*coloredPointCloud.getPointCloud())[1]);
+}
+
+/// Sum of the distances between consecutive points
+static double pathLength(PointCloud3D& pointCloud) {
+	const PointCloud3DStorage* storage = pointCloud.getStorage();
+	double length = 0.0;
+	for (unsigned int i = 1; i < storage->getSize(); ++i) {
+		double dx = storage->getRawX()[i] - storage->getRawX()[i - 1];
+		double dy = storage->getRawY()[i] - storage->getRawY()[i - 1];
+		double dz = storage->getRawZ()[i] - storage->getRawZ()[i - 1];
+		length += sqrt(dx * dx + dy * dy + dz * dz);
+	}
+	return length;
+}
+
+void PointCloud3DTest::testMortonOrder() {
+	/* bit interleaving */
+	CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(0), MortonOrder::encode(0, 0, 0));
+	CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(1), MortonOrder::encode(1, 0, 0));
+	CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(2), MortonOrder::encode(0, 1, 0));
+	CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(4), MortonOrder::encode(0, 0, 1));
+	CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(8), MortonOrder::encode(2, 0, 0));
+	boost::uint32_t ix, iy, iz;
+	MortonOrder::decode(MortonOrder::encode(0x1FFFFF, 12345, 987654), ix, iy, iz);
+	CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint32_t>(0x1FFFFF), ix);
+	CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint32_t>(12345), iy);
+	CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint32_t>(987654), iz);
+
+	/* random points with attribute channels */
+	PointCloud3D pointCloud;
+	PointCloud3DStorage* storage = pointCloud.getMutableStorage();
+	storage->addChannel(PointCloud3D::labelChannel);
+	storage->addChannel(PointCloud3D::normalChannel, 3);
+	srand(7);
+	unsigned int size = 1000;
+	for (unsigned int i = 0; i < size; ++i) {
+		storage->addPoint(rand() / (RAND_MAX + 1.0), rand() / (RAND_MAX + 1.0), rand() / (RAND_MAX + 1.0));
+		storage->getRawChannel(PointCloud3D::labelChannel)[i] = i;
+		storage->getRawChannel(PointCloud3D::normalChannel)[3 * i + 2] = i;
+	}
+	PointCloud3D original(pointCloud);
+	double originalPathLength = pathLength(original);
+
+	vector<unsigned int> order;
+	pointCloud.sortByMortonOrder(&order);
+	CPPUNIT_ASSERT_EQUAL(size, pointCloud.getSize());
+	CPPUNIT_ASSERT_EQUAL(size, static_cast<unsigned int>(order.size()));
+	vector<unsigned int> sortedOrder(order);
+	sort(sortedOrder.begin(), sortedOrder.end());
+	for (unsigned int i = 0; i < size; ++i) {
+		CPPUNIT_ASSERT_EQUAL(i, sortedOrder[i]); // a permutation
+	}
+
+	const PointCloud3DStorage* sorted = pointCloud.getStorage();
+	const PointCloud3DStorage* unsorted = original.getStorage();
+	for (unsigned int i = 0; i < size; ++i) {
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(unsorted->getRawX()[order[i]], sorted->getRawX()[i], maxTolerance);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(unsorted->getRawY()[order[i]], sorted->getRawY()[i], maxTolerance);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(unsorted->getRawZ()[order[i]], sorted->getRawZ()[i], maxTolerance);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(static_cast<double>(order[i]), sorted->getRawChannel(PointCloud3D::labelChannel)[i], maxTolerance);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(static_cast<double>(order[i]), sorted->getRawChannel(PointCloud3D::normalChannel)[3 * i + 2], maxTolerance);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(unsorted->getRawX()[order[i]], (*pointCloud.getPointCloud())[i].getX(), maxTolerance);
+	}
+
+	/* the codes are ascending and neighboring points are close */
+	vector<boost::uint64_t> codes;
+	MortonOrder mortonOrder;
+	mortonOrder.computeCodes(pointCloud.getStorage(), codes);
+	for (unsigned int i = 1; i < size; ++i) {
+		CPPUNIT_ASSERT(codes[i - 1] <= codes[i]);
+	}
+	CPPUNIT_ASSERT(pathLength(pointCloud) < 0.5 * originalPathLength);
+
+	/* points with individual decoration layers are moved together with their layers */
+	PointCloud3D decoratedPointCloud;
+	decoratedPointCloud.addPointPtr(new Point3D(1, 1, 1));
+	decoratedPointCloud.addPointPtr(new ColoredPoint3D(new Point3D(0, 0, 0), 1, 2, 3));
+	decoratedPointCloud.addPointPtr(new Point3D(0.9, 0.9, 0.9));
+	CPPUNIT_ASSERT(decoratedPointCloud.containsDecoratedPoints());
+	decoratedPointCloud.sortByMortonOrder(&order);
+	CPPUNIT_ASSERT_EQUAL(1u, order[0]);
+	CPPUNIT_ASSERT_EQUAL(2u, order[1]);
+	CPPUNIT_ASSERT_EQUAL(0u, order[2]);
+	CPPUNIT_ASSERT(decoratedPointCloud.containsDecoratedPoints());
+	ColoredPoint3D* coloredPoint = (*decoratedPointCloud.getPointCloud())[0].asColoredPoint3D();
+	CPPUNIT_ASSERT(coloredPoint != 0);
+	CPPUNIT_ASSERT_EQUAL(2, static_cast<int>(coloredPoint->getG()));
+	CPPUNIT_ASSERT((*decoratedPointCloud.getPointCloud())[1].asColoredPoint3D() == 0);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(0.9, (*decoratedPointCloud.getPointCloud())[1].getX(), maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, decoratedPointCloud.getStorage()->getRawZ()[2], maxTolerance);
+
+	/* empty point clouds are fine */
+	PointCloud3D emptyPointCloud;
+	emptyPointCloud.sortByMortonOrder(&order);
+	CPPUNIT_ASSERT_EQUAL(0u, static_cast<unsigned int>(order.size()));
+}
+
+void PointCloud3DTest::testRevision() {
+	PointCloud3D pointCloud;
+	PointCloud3D empty;
+	CPPUNIT_ASSERT(pointCloud.getStorage()->getRevision() != empty.getStorage()->getRevision());
+	for (int i = 0; i < 10; ++i) {
+		pointCloud.addPoint(Point3D(i, 2 * i, 3 * i));
+	}
+
+	/* reading does not change the revision */
+	unsigned long revision = pointCloud.getStorage()->getRevision();
+	CPPUNIT_ASSERT_EQUAL(revision, pointCloud.getStorage()->getRevision());
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(4.0, pointCloud.getStorage()->getRawY()[2], maxTolerance);
+	CPPUNIT_ASSERT_EQUAL(10u, pointCloud.getSize());
+	CPPUNIT_ASSERT_EQUAL(revision, pointCloud.getStorage()->getRevision());
+
+	/* copies share the revision until they are modified */
+	PointCloud3D copy(pointCloud);
+	CPPUNIT_ASSERT_EQUAL(revision, copy.getStorage()->getRevision());
+	copy.addPoint(Point3D(-1, -1, -1));
+	unsigned long copyRevision = copy.getStorage()->getRevision();
+	CPPUNIT_ASSERT(copyRevision != revision);
+	CPPUNIT_ASSERT_EQUAL(revision, pointCloud.getStorage()->getRevision());
+
+	/* any modification leads to a new revision */
+	HomogeneousMatrix44 translation(1,0,0, 0,1,0, 0,0,1, 1,0,0);
+	pointCloud.homogeneousTransformation(&translation);
+	unsigned long transformedRevision = pointCloud.getStorage()->getRevision();
+	CPPUNIT_ASSERT(transformedRevision != revision);
+	CPPUNIT_ASSERT(transformedRevision != copyRevision);
+
+	pointCloud.getMutableStorage()->getRawZ()[0] = 5.0;
+	CPPUNIT_ASSERT(pointCloud.getStorage()->getRevision() != transformedRevision);
+
+	(*pointCloud.getPointCloud())[0].setX(7.0); // the Point3D view is written back to the storage
+	revision = pointCloud.getStorage()->getRevision();
+	CPPUNIT_ASSERT(revision != transformedRevision);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(7.0, pointCloud.getStorage()->getRawX()[0], maxTolerance);
+
+	pointCloud.sortByMortonOrder();
+	CPPUNIT_ASSERT(pointCloud.getStorage()->getRevision() != revision);
+	revision = pointCloud.getStorage()->getRevision();
+
+	pointCloud.swap(copy);
+	CPPUNIT_ASSERT_EQUAL(revision, copy.getStorage()->getRevision());
+	CPPUNIT_ASSERT_EQUAL(copyRevision, pointCloud.getStorage()->getRevision());
+
+	copy.clear();
+	CPPUNIT_ASSERT(copy.getStorage()->getRevision() != revision);
+}
+
 }
 
 /* EOF */
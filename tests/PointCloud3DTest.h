@@ -13,7 +13,11 @@
 #include <cppunit/extensions/HelperMacros.h>
 
 #include "brics_3d/core/PointCloud3D.h"
+#include "brics_3d/core/PointCloud3DF.h"
 #include "brics_3d/core/HomogeneousMatrix44.h"
+#include "brics_3d/core/ColoredPoint3D.h"
+#include "brics_3d/core/Point3DNormal.h"
+#include "brics_3d/core/Point3DIntensity.h"
 
 using namespace std;
 using namespace brics_3d;
@@ -32,6 +36,14 @@ class PointCloud3DTest: public CPPUNIT_NS::TestFixture {
 	//CPPUNIT_TEST( testLimits ); //is time consuming
 	CPPUNIT_TEST( testStreaming );
 	CPPUNIT_TEST( testTransformation );
+	CPPUNIT_TEST( testStorage );
+	CPPUNIT_TEST( testSinglePrecision );
+	CPPUNIT_TEST( testBatchTransformation );
+	CPPUNIT_TEST( testAttributeChannels );
+	CPPUNIT_TEST( testBulkOperations );
+	CPPUNIT_TEST( testCopyOnWrite );
+	CPPUNIT_TEST( testMortonOrder );
+	CPPUNIT_TEST( testRevision );
 	CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -43,6 +55,14 @@ public:
 	  void testLimits();
 	  void testStreaming();
 	  void testTransformation();
+	  void testStorage();
+	  void testSinglePrecision();
+	  void testBatchTransformation();
+	  void testAttributeChannels();
+	  void testBulkOperations();
+	  void testCopyOnWrite();
+	  void testMortonOrder();
+	  void testRevision();
 
 	  EIGEN_MAKE_ALIGNED_OPERATOR_NEW //Required by Eigen2
 
@@ -7,8 +7,12 @@
  */
 
 #include "PointCorrespondenceTest.h"
+#include "brics_3d/algorithm/nearestNeighbor/NearestNeighborKDTree3D.h"
+#include "brics_3d/algorithm/registration/IterativeClosestPoint.h"
+#include "brics_3d/algorithm/registration/RigidTransformationEstimationSVD.h"
 
 #include <sstream>
+#include <algorithm>
 
 using namespace Eigen;
 
@@ -16,6 +20,35 @@ namespace unitTests {
 
 CPPUNIT_TEST_SUITE_REGISTRATION( PointCorrespondenceTest );
 
+/// Nearest neighbor search that counts how often it is set up with a point cloud
+class CountingNearestNeighbor : public NearestNeighborKDTree3D {
+public:
+	CountingNearestNeighbor(int* setDataCount) : setDataCount(setDataCount) {}
+
+	void setData(PointCloud3D* data) {
+		(*setDataCount)++;
+		NearestNeighborKDTree3D::setData(data);
+	}
+
+private:
+	int* setDataCount;
+};
+
+/// Correspondence search that only implements the point pair variant, like implementations written before the index variant existed
+class PointPairCorrespondence : public IPointCorrespondence {
+public:
+	PointPairCorrespondence() : genericAssigner(new NearestNeighborKDTree3D()) {}
+
+	void createNearestNeighborCorrespondence(PointCloud3D* pointCloud1, PointCloud3D* pointCloud2, std::vector<CorrespondencePoint3DPair>* resultPointPairs) {
+		genericAssigner.createNearestNeighborCorrespondence(pointCloud1, pointCloud2, resultPointPairs);
+		std::reverse(resultPointPairs->begin(), resultPointPairs->end());
+	}
+	using IPointCorrespondence::createNearestNeighborCorrespondence;
+
+private:
+	PointCorrespondenceGenericNN genericAssigner;
+};
+
 void PointCorrespondenceTest::setUp() {
 	assigner = 0;
 	abstractAssigner = 0;
@@ -150,5 +183,170 @@ void PointCorrespondenceTest::testSimpleCorrespondence() {
 	delete homogeneousTrans;
 }
 
+void PointCorrespondenceTest::testModelReuse() {
+	int setDataCount = 0;
+	PointCorrespondenceGenericNN* genericAssigner = new PointCorrespondenceGenericNN(new CountingNearestNeighbor(&setDataCount));
+	vector<CorrespondencePoint3DPair> pointPairs;
+
+	/* repeated invocations with the same model share one search structure */
+	genericAssigner->createNearestNeighborCorrespondence(pointCloudCube, pointCloudCubeCopy, &pointPairs);
+	CPPUNIT_ASSERT_EQUAL(1, setDataCount);
+	genericAssigner->createNearestNeighborCorrespondence(pointCloudCube, pointCloudCubeCopy, &pointPairs);
+	genericAssigner->createNearestNeighborCorrespondence(pointCloudCube, pointCloudCube, &pointPairs);
+	CPPUNIT_ASSERT_EQUAL(1, setDataCount);
+	CPPUNIT_ASSERT_EQUAL(8, (int)pointPairs.size());
+
+	/* a modified model is detected */
+	HomogeneousMatrix44 translation(1,0,0, 0,1,0, 0,0,1, 10,0,0);
+	pointCloudCube->homogeneousTransformation(&translation);
+	genericAssigner->createNearestNeighborCorrespondence(pointCloudCube, pointCloudCubeCopy, &pointPairs);
+	CPPUNIT_ASSERT_EQUAL(2, setDataCount);
+	CPPUNIT_ASSERT_EQUAL(8, (int)pointPairs.size());
+	for (unsigned int i = 0;  i < pointPairs.size(); ++ i) {
+		CPPUNIT_ASSERT(pointPairs[i].firstPoint.getX() > 9.0);
+	}
+
+	/* so is another model */
+	genericAssigner->createNearestNeighborCorrespondence(pointCloudCubeCopy, pointCloudCube, &pointPairs);
+	CPPUNIT_ASSERT_EQUAL(3, setDataCount);
+	CPPUNIT_ASSERT_EQUAL(8, (int)pointPairs.size());
+	for (unsigned int i = 0;  i < pointPairs.size(); ++ i) {
+		CPPUNIT_ASSERT(pointPairs[i].firstPoint.getX() < 2.0);
+	}
+
+	/* one setup for all iterations and successive matches of the ICP */
+	setDataCount = 0;
+	IterativeClosestPoint* icp = new IterativeClosestPoint(genericAssigner, new RigidTransformationEstimationSVD());
+	IHomogeneousMatrix44* resultTransformation = new HomogeneousMatrix44();
+	PointCloud3D data;
+	data.addPoint(Point3D(10.1, 0, 0));
+	data.addPoint(Point3D(10.1, 1, 1));
+	data.addPoint(Point3D(11.1, 0, 1));
+	data.addPoint(Point3D(11.1, 1, 0));
+	PointCloud3D data2 = data;
+	icp->match(pointCloudCube, &data, resultTransformation);
+	icp->match(pointCloudCube, &data2, resultTransformation);
+	CPPUNIT_ASSERT_EQUAL(1, setDataCount);
+	delete resultTransformation;
+	delete icp; // also deletes the assigner
+
+	/* the k-d tree based variant has to follow the model as well */
+	assigner = new PointCorrespondenceKDTree();
+	assigner->createNearestNeighborCorrespondence(pointCloudCubeCopy, pointCloudCubeCopy, &pointPairs);
+	CPPUNIT_ASSERT_EQUAL(8, (int)pointPairs.size());
+	pointCloudCubeCopy->homogeneousTransformation(&translation);
+	assigner->createNearestNeighborCorrespondence(pointCloudCubeCopy, pointCloudCube, &pointPairs);
+	CPPUNIT_ASSERT_EQUAL(8, (int)pointPairs.size());
+	for (unsigned int i = 0;  i < pointPairs.size(); ++ i) {
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(pointPairs[i].secondPoint.getX(), pointPairs[i].firstPoint.getX(), maxTolerance);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(pointPairs[i].secondPoint.getY(), pointPairs[i].firstPoint.getY(), maxTolerance);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(pointPairs[i].secondPoint.getZ(), pointPairs[i].firstPoint.getZ(), maxTolerance);
+	}
+}
+
+void PointCorrespondenceTest::testParallelCorrespondence() {
+	PointCloud3D model;
+	PointCloud3D data;
+	srand(7);
+	for (int i = 0; i < 50000; ++i) {
+		model.addPoint(Point3D(rand() / (RAND_MAX + 1.0), rand() / (RAND_MAX + 1.0), rand() / (RAND_MAX + 1.0)));
+		data.addPoint(Point3D(rand() / (RAND_MAX + 1.0), rand() / (RAND_MAX + 1.0), rand() / (RAND_MAX + 1.0)));
+	}
+	data.addPoint(Point3D(100, 100, 100)); // too far away for the k-d tree of 6D SLAM
+
+	PointCorrespondenceKDTree* kDTreeAssigner = new PointCorrespondenceKDTree();
+	NearestNeighborKDTree3D* kDTree3D = new NearestNeighborKDTree3D(); // the generic variant uses the threads of its search strategy
+	PointCorrespondenceGenericNN* genericAssigner = new PointCorrespondenceGenericNN(kDTree3D);
+	IPointCorrespondence* assigners[] = {kDTreeAssigner, genericAssigner};
+
+	vector<CorrespondenceIndexPair> serialPairs;
+	vector<CorrespondenceIndexPair> parallelPairs;
+	vector<CorrespondencePoint3DPair> pointPairs;
+	vector<CorrespondenceIndexPair> kDTreePairs;
+	for (int a = 0; a < 2; ++a) {
+		kDTreeAssigner->setNumberOfThreads(1);
+		kDTree3D->setNumberOfThreads(1);
+		assigners[a]->createNearestNeighborCorrespondence(&model, &data, &serialPairs);
+		kDTreeAssigner->setNumberOfThreads(4);
+		kDTree3D->setNumberOfThreads(4);
+		assigners[a]->createNearestNeighborCorrespondence(&model, &data, &parallelPairs);
+		assigners[a]->createNearestNeighborCorrespondence(&model, &data, &pointPairs);
+
+		/* the merged result is the same as the serial one */
+		CPPUNIT_ASSERT_EQUAL(serialPairs.size(), parallelPairs.size());
+		CPPUNIT_ASSERT_EQUAL(serialPairs.size(), pointPairs.size());
+		for (unsigned int i = 0; i < serialPairs.size(); ++i) {
+			CPPUNIT_ASSERT_EQUAL(serialPairs[i].firstIndex, parallelPairs[i].firstIndex);
+			CPPUNIT_ASSERT_EQUAL(serialPairs[i].secondIndex, parallelPairs[i].secondIndex);
+			if (i > 0) {
+				CPPUNIT_ASSERT(parallelPairs[i - 1].secondIndex < parallelPairs[i].secondIndex);
+			}
+
+			unsigned int first = parallelPairs[i].firstIndex;
+			unsigned int second = parallelPairs[i].secondIndex;
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(model.getStorage()->getRawX()[first], pointPairs[i].firstPoint.getX(), maxTolerance);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(model.getStorage()->getRawZ()[first], pointPairs[i].firstPoint.getZ(), maxTolerance);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(data.getStorage()->getRawY()[second], pointPairs[i].secondPoint.getY(), maxTolerance);
+		}
+
+		if (a == 0) {
+			CPPUNIT_ASSERT_EQUAL(50000, (int)parallelPairs.size());
+			kDTreePairs = parallelPairs;
+		} else {
+			CPPUNIT_ASSERT_EQUAL(50001, (int)parallelPairs.size());
+		}
+	}
+
+	/* both variants find the same nearest neighbors */
+	const PointCloud3DStorage* modelStorage = model.getStorage();
+	const PointCloud3DStorage* dataStorage = data.getStorage();
+	for (unsigned int i = 0; i < kDTreePairs.size(); ++i) {
+		CPPUNIT_ASSERT_EQUAL(kDTreePairs[i].secondIndex, parallelPairs[i].secondIndex);
+		double squaredDistance[2] = {0.0, 0.0};
+		unsigned int first[2] = {kDTreePairs[i].firstIndex, parallelPairs[i].firstIndex};
+		for (int a = 0; a < 2; ++a) {
+			double dx = dataStorage->getRawX()[i] - modelStorage->getRawX()[first[a]];
+			double dy = dataStorage->getRawY()[i] - modelStorage->getRawY()[first[a]];
+			double dz = dataStorage->getRawZ()[i] - modelStorage->getRawZ()[first[a]];
+			squaredDistance[a] = dx * dx + dy * dy + dz * dz;
+		}
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(squaredDistance[0], squaredDistance[1], 1e-6);
+	}
+
+	delete kDTreeAssigner;
+	delete genericAssigner;
+}
+
+void PointCorrespondenceTest::testDefaultIndexCorrespondence() {
+	PointCloud3D model;
+	PointCloud3D data;
+	srand(5);
+	for (int i = 0; i < 1000; ++i) {
+		model.addPoint(Point3D(rand() / (RAND_MAX + 1.0), rand() / (RAND_MAX + 1.0), rand() / (RAND_MAX + 1.0)));
+		data.addPoint(Point3D(rand() / (RAND_MAX + 1.0), rand() / (RAND_MAX + 1.0), rand() / (RAND_MAX + 1.0)));
+	}
+
+	PointPairCorrespondence pointPairAssigner;
+	PointCorrespondenceGenericNN genericAssigner(new NearestNeighborKDTree3D());
+	IPointCorrespondence* abstractPointPairAssigner = &pointPairAssigner;
+
+	/* the default limit of the maximal distance */
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(-1.0, abstractPointPairAssigner->getMaxCorrespondenceDistance(), maxTolerance);
+	abstractPointPairAssigner->setMaxCorrespondenceDistance(0.1);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(-1.0, abstractPointPairAssigner->getMaxCorrespondenceDistance(), maxTolerance);
+
+	/* the default index variant finds the indices of the point pairs and orders them by the second index */
+	vector<CorrespondenceIndexPair> defaultPairs;
+	vector<CorrespondenceIndexPair> expectedPairs;
+	abstractPointPairAssigner->createNearestNeighborCorrespondence(&model, &data, &defaultPairs);
+	genericAssigner.createNearestNeighborCorrespondence(&model, &data, &expectedPairs);
+	CPPUNIT_ASSERT_EQUAL(1000, (int)defaultPairs.size());
+	CPPUNIT_ASSERT_EQUAL(expectedPairs.size(), defaultPairs.size());
+	for (unsigned int i = 0; i < defaultPairs.size(); ++i) {
+		CPPUNIT_ASSERT_EQUAL(expectedPairs[i].firstIndex, defaultPairs[i].firstIndex);
+		CPPUNIT_ASSERT_EQUAL(expectedPairs[i].secondIndex, defaultPairs[i].secondIndex);
+	}
+}
+
 }
 /* EOF */
@@ -15,6 +15,7 @@
 #include "brics_3d/core/PointCloud3D.h"
 #include "brics_3d/core/HomogeneousMatrix44.h"
 #include "brics_3d/algorithm/registration/PointCorrespondenceKDTree.h"
+#include "brics_3d/algorithm/registration/PointCorrespondenceGenericNN.h"
 
 #include <Eigen/Geometry>
 #include <iostream>
@@ -29,6 +30,9 @@ class PointCorrespondenceTest : public CPPUNIT_NS::TestFixture {
 	CPPUNIT_TEST_SUITE( PointCorrespondenceTest );
 	CPPUNIT_TEST( testConstructor );
 	CPPUNIT_TEST( testSimpleCorrespondence );
+	CPPUNIT_TEST( testModelReuse );
+	CPPUNIT_TEST( testParallelCorrespondence );
+	CPPUNIT_TEST( testDefaultIndexCorrespondence );
 	CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -37,6 +41,9 @@ public:
 
 	void testConstructor();
 	void testSimpleCorrespondence();
+	void testModelReuse();
+	void testParallelCorrespondence();
+	void testDefaultIndexCorrespondence();
 
 	EIGEN_MAKE_ALIGNED_OPERATOR_NEW //Required by Eigen2
 
@@ -131,6 +131,49 @@ void RigidTransformationEstimationTest::testSVDTransformation(){
 	delete homogeneousTrans;
 }
 
+void RigidTransformationEstimationTest::testWeightedSVDTransformation() {
+
+	/* manipulate second point cloud */
+	AngleAxis<double> rotation(M_PI_2/4.0, Vector3d(1,0,0));
+	Transform3d transformation;
+	transformation = Translation3d(0.1, 0.2, -0.3) * rotation;
+	HomogeneousMatrix44 homogeneousTrans(&transformation);
+	pointCloudCubeCopy->homogeneousTransformation(&homogeneousTrans);
+	HomogeneousMatrix44 expectedTransformation(&transformation); // the estimation moves the data back to the model
+	expectedTransformation.inverse();
+
+	vector<CorrespondenceIndexPair> indexPairs;
+	for (unsigned int i = 0; i < pointCloudCube->getSize(); ++i) {
+		indexPairs.push_back(CorrespondenceIndexPair(i, i));
+	}
+	estimator = new RigidTransformationEstimationSVD();
+
+	/* only the ratios of the weights matter */
+	vector<double> weights(indexPairs.size(), 0.5);
+	HomogeneousMatrix44 weightedTransformation;
+	double error = estimator->estimateTransformation(pointCloudCube, pointCloudCubeCopy, &indexPairs, &weights, &weightedTransformation);
+	CPPUNIT_ASSERT(error > 0.0);
+	for (int i = 0; i < 16; ++i) {
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(expectedTransformation.getRawData()[i], weightedTransformation.getRawData()[i], maxTolerance);
+	}
+	weights.assign(indexPairs.size(), 2.0);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(error, estimator->estimateTransformation(pointCloudCube, pointCloudCubeCopy, &indexPairs, &weights, &weightedTransformation), maxTolerance);
+	for (int i = 0; i < 16; ++i) {
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(expectedTransformation.getRawData()[i], weightedTransformation.getRawData()[i], maxTolerance);
+	}
+
+	/* an outlier without weight has no influence */
+	PointCloud3D dataWithOutlier(*pointCloudCubeCopy);
+	dataWithOutlier.getMutableStorage()->getRawX()[3] += 5.0;
+	weights.assign(indexPairs.size(), 1.0);
+	weights[3] = 0.0;
+	error = estimator->estimateTransformation(pointCloudCube, &dataWithOutlier, &indexPairs, &weights, &weightedTransformation);
+	CPPUNIT_ASSERT(error > 0.0);
+	for (int i = 0; i < 16; ++i) {
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(expectedTransformation.getRawData()[i], weightedTransformation.getRawData()[i], maxTolerance);
+	}
+}
+
 void RigidTransformationEstimationTest::testQUATTransformation() {
 	/* manipulate second point cloud */
 	AngleAxis<double> rotation(M_PI_2/4.0, Vector3d(1,0,0));
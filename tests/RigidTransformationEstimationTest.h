@@ -38,6 +38,7 @@ class RigidTransformationEstimationTest : public CPPUNIT_NS::TestFixture {
 	CPPUNIT_TEST_SUITE( RigidTransformationEstimationTest );
 	CPPUNIT_TEST( testConstructor );
 	CPPUNIT_TEST( testSVDTransformation );
+	CPPUNIT_TEST( testWeightedSVDTransformation );
 	CPPUNIT_TEST( testQUATTransformation );
 	CPPUNIT_TEST( testHELIXTransformation );
 	CPPUNIT_TEST( testAPXTransformation );
@@ -50,6 +51,7 @@ public:
 
 	void testConstructor();
 	void testSVDTransformation();
+	void testWeightedSVDTransformation();
 	void testQUATTransformation();
 	void testHELIXTransformation();
 	void testAPXTransformation();
@@ -10,6 +10,7 @@
 #include <stdexcept>
 #include "brics_3d/core/Logger.h"
 #include "brics_3d/worldModel/sceneGraph/UuidGenerator.h"
+#include "brics_3d/core/RigidTransform.h"
 
 namespace unitTests {
 
@@ -2166,6 +2167,91 @@ void SceneGraphNodesTest::testGlobalTransformCalculation() {
 
 }
 
+void SceneGraphNodesTest::testNonRigidTransformCalculation() {
+	/* Graph structure:
+	 *            root(tf)
+	 *              |
+	 *        ------+-----
+	 *        |          |
+	 *       tf1        tf3
+	 *        |
+	 *       tf2
+	 *
+	 * tf1 is a scaling transform, so the rigid shortcut must not be used.
+	 */
+	rsg::Transform::TransformPtr root(new rsg::Transform());
+	root->setId(0);
+	rsg::Transform::TransformPtr tf1(new rsg::Transform());
+	tf1->setId(1);
+	rsg::Transform::TransformPtr tf2(new rsg::Transform());
+	tf2->setId(2);
+	rsg::Transform::TransformPtr tf3(new rsg::Transform());
+	tf3->setId(3);
+
+	TimeStamp dummyTime(1.0);
+	IHomogeneousMatrix44::IHomogeneousMatrix44Ptr transformScale(new HomogeneousMatrix44(2,0,0,  	//Rotation coefficients (scaled)
+	                                                             0,2,0,
+	                                                             0,0,2,
+	                                                             1,2,3)); 						//Translation coefficients
+	IHomogeneousMatrix44::IHomogeneousMatrix44Ptr transform100(new HomogeneousMatrix44(1,0,0,  	//Rotation coefficients
+	                                                             0,1,0,
+	                                                             0,0,1,
+	                                                             1,0,0)); 						//Translation coefficients
+	IHomogeneousMatrix44::IHomogeneousMatrix44Ptr transform005(new HomogeneousMatrix44(1,0,0,  	//Rotation coefficients
+	                                                             0,1,0,
+	                                                             0,0,1,
+	                                                             0,0,5)); 						//Translation coefficients
+	IHomogeneousMatrix44::IHomogeneousMatrix44Ptr identity(new HomogeneousMatrix44());
+	IHomogeneousMatrix44::IHomogeneousMatrix44Ptr resultTransform;
+	const double* matrixPtr;
+
+	root->insertTransform(identity, dummyTime);
+	tf1->insertTransform(transformScale, dummyTime);
+	tf2->insertTransform(transform100, dummyTime);
+	tf3->insertTransform(transform005, dummyTime);
+
+	root->addChild(tf1);
+	root->addChild(tf3);
+	tf1->addChild(tf2);
+
+	/* root -> tf2: scale 2 and translation 2*(1,0,0) + (1,2,3) */
+	resultTransform = getGlobalTransform(tf2, dummyTime);
+	matrixPtr = resultTransform->getRawData();
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, matrixPtr[0], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, matrixPtr[5], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, matrixPtr[10], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(3.0, matrixPtr[12], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, matrixPtr[13], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(3.0, matrixPtr[14], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, matrixPtr[15], maxTolerance);
+
+	/* tf2 seen from tf3 */
+	resultTransform = getTransformBetweenNodes(tf2, tf3, dummyTime);
+	matrixPtr = resultTransform->getRawData();
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, matrixPtr[0], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, matrixPtr[5], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, matrixPtr[10], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(3.0, matrixPtr[12], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, matrixPtr[13], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(-2.0, matrixPtr[14], maxTolerance);
+
+	/* tf3 seen from tf2: the reference path has to be inverted as a general matrix */
+	resultTransform = getTransformBetweenNodes(tf3, tf2, dummyTime);
+	matrixPtr = resultTransform->getRawData();
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, matrixPtr[0], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, matrixPtr[1], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, matrixPtr[5], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, matrixPtr[10], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(-1.5, matrixPtr[12], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(-1.0, matrixPtr[13], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, matrixPtr[14], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, matrixPtr[15], maxTolerance);
+
+	/* rigid detection */
+	CPPUNIT_ASSERT(RigidTransform::isRigid(*transform100));
+	CPPUNIT_ASSERT(!RigidTransform::isRigid(*transformScale));
+}
+
 void SceneGraphNodesTest::testAttributeFinder() {
 	/* Graph structure: (remember: nodes can only serve as are leaves)
 	 *                 root
@@ -3992,6 +4078,87 @@ void SceneGraphNodesTest::testPointIterator() {
 	CPPUNIT_ASSERT_EQUAL(3u, cloud3->getSize());
 }
 
+void SceneGraphNodesTest::testPointIteratorBlocks() {
+	PointCloud3D::PointCloud3DPtr cloud1(new PointCloud3D());
+	PointCloud3D::PointCloud3DPtr cloud2(new PointCloud3D());
+	PointCloud3D::PointCloud3DPtr emptyCloud(new PointCloud3D());
+	PointCloud3D::PointCloud3DPtr cloud3(new PointCloud3D());
+	for (int i = 0; i < 3; ++i) {
+		cloud1->addPoint(Point3D(i, i + 0.1, i + 0.2));
+	}
+	for (int i = 0; i < 2; ++i) {
+		cloud2->addPoint(Point3D(10 + i, 11 + i, 12 + i));
+	}
+	for (int i = 0; i < 3000; ++i) {
+		cloud3->addPoint(Point3D(0.5 * i, -0.25 * i, 0.125 * i));
+	}
+
+	IHomogeneousMatrix44::IHomogeneousMatrix44Ptr shift100 (new HomogeneousMatrix44 (1,0,0, 0,1,0, 0,0,1, 100, 100, 100));
+	IHomogeneousMatrix44::IHomogeneousMatrix44Ptr rotation(new HomogeneousMatrix44 (0,-1,0, 1,0,0, 0,0,1, 1, 2, 3));
+
+	PointCloud3DIterator::PointCloud3DIteratorPtr it(new PointCloud3DIterator());
+	it->insert(cloud1);
+	it->insert(cloud2, shift100);
+	it->insert(emptyCloud);
+	it->insert(cloud3, rotation);
+
+	/* reference: point by point */
+	std::vector<Coordinate> referenceX;
+	std::vector<Coordinate> referenceY;
+	std::vector<Coordinate> referenceZ;
+	for (it->begin(); !it->end(); it->next()) {
+		referenceX.push_back(it->getX());
+		referenceY.push_back(it->getY());
+		referenceZ.push_back(it->getZ());
+	}
+	CPPUNIT_ASSERT_EQUAL(3005u, static_cast<unsigned int>(referenceX.size()));
+
+	/* blocks of different sizes, also across the borders of the point clouds */
+	unsigned int blockSizes[] = {1, 2, 7, IPoint3DIterator::defaultBlockSize, 5000};
+	for (int j = 0; j < 5; ++j) {
+		std::vector<Coordinate> x(blockSizes[j]);
+		std::vector<Coordinate> y(blockSizes[j]);
+		std::vector<Coordinate> z(blockSizes[j]);
+		unsigned int count = 0;
+		unsigned int blockSize;
+		it->begin();
+		while ((blockSize = it->getNextBlock(&x[0], &y[0], &z[0], blockSizes[j])) > 0) {
+			CPPUNIT_ASSERT(blockSize <= blockSizes[j]);
+			for (unsigned int i = 0; i < blockSize; ++i) {
+				CPPUNIT_ASSERT_DOUBLES_EQUAL(referenceX[count + i], x[i], maxTolerance);
+				CPPUNIT_ASSERT_DOUBLES_EQUAL(referenceY[count + i], y[i], maxTolerance);
+				CPPUNIT_ASSERT_DOUBLES_EQUAL(referenceZ[count + i], z[i], maxTolerance);
+			}
+			count += blockSize;
+		}
+		CPPUNIT_ASSERT_EQUAL(3005u, count);
+		CPPUNIT_ASSERT(it->end());
+	}
+
+	/* mixed usage of blocks and single points */
+	Coordinate x[4];
+	Coordinate y[4];
+	Coordinate z[4];
+	it->begin();
+	it->next();
+	CPPUNIT_ASSERT_EQUAL(4u, it->getNextBlock(x, y, z, 4));
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(referenceX[1], x[0], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(referenceZ[4], z[3], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(referenceX[5], it->getX(), maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(referenceY[5], it->getY(), maxTolerance);
+
+	/* the generic implementation yields the same results */
+	it->begin();
+	CPPUNIT_ASSERT_EQUAL(4u, it->IPoint3DIterator::getNextBlock(x, y, z, 4));
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(referenceY[3], y[3], maxTolerance);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(referenceX[4], it->getX(), maxTolerance);
+
+	/* empty iterator */
+	PointCloud3DIterator emptyIterator;
+	emptyIterator.begin();
+	CPPUNIT_ASSERT_EQUAL(0u, emptyIterator.getNextBlock(x, y, z, 4));
+}
+
 void SceneGraphNodesTest::testScenePointIterator() {
 	/* Graph structure: (remember: nodes can only serve as are leaves)
 	 *                 root
@@ -224,6 +224,7 @@ class SceneGraphNodesTest : public CPPUNIT_NS::TestFixture {
 	CPPUNIT_TEST( testTransformVisitor );
 	CPPUNIT_TEST( testUncertainTransformVisitor );
 	CPPUNIT_TEST( testGlobalTransformCalculation );
+	CPPUNIT_TEST( testNonRigidTransformCalculation );
 	CPPUNIT_TEST( testAttributeFinder );
 	CPPUNIT_TEST( testOutdatedDataDeleter );
 	CPPUNIT_TEST( testIdGenerator );
@@ -234,6 +235,7 @@ class SceneGraphNodesTest : public CPPUNIT_NS::TestFixture {
 	CPPUNIT_TEST( testUpdateObserver );
 	CPPUNIT_TEST( testDotGraphGenerator );
 	CPPUNIT_TEST( testPointIterator );
+	CPPUNIT_TEST( testPointIteratorBlocks );
 	CPPUNIT_TEST( testScenePointIterator );
 	CPPUNIT_TEST( testSubGraphChecker );
 	CPPUNIT_TEST( testForcedIds );
@@ -266,6 +268,7 @@ public:
 	void testTransformVisitor();
 	void testUncertainTransformVisitor();
 	void testGlobalTransformCalculation();
+	void testNonRigidTransformCalculation();
 	void testAttributeFinder();
 	void testOutdatedDataDeleter();
 	void testIdGenerator();
@@ -276,6 +279,7 @@ public:
 	void testUpdateObserver();
 	void testDotGraphGenerator();
 	void testPointIterator();
+	void testPointIteratorBlocks();
 	void testScenePointIterator();
 	void testSubGraphChecker();
 	void testForcedIds();